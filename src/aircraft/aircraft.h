@@ -50,6 +50,7 @@ typedef struct {
     double total_distance;      /* 总距离 (米) */
     double max_altitude;       /* 最大高度 (米) */
     double min_altitude;       /* 最小高度 (米) */
+    unsigned int version;       /* 轨迹版本号，轨迹点经接口修改时递增 */
 } FlightTrajectory;
 
 /* 轨迹类型 */
@@ -17,6 +17,7 @@ FlightTrajectory* flight_trajectory_create(int max_points) {
         return NULL;
     }
     
+    trajectory->trajectory_id = 0;
     trajectory->point_count = 0;
     trajectory->max_points = max_points;
     trajectory->start_time = 0;
@@ -24,6 +25,7 @@ FlightTrajectory* flight_trajectory_create(int max_points) {
     trajectory->total_distance = 0.0;
     trajectory->max_altitude = 0.0;
     trajectory->min_altitude = 0.0;
+    trajectory->version = 0;
     
     return trajectory;
 }
@@ -48,6 +50,7 @@ int flight_trajectory_add_point(FlightTrajectory* trajectory, const TrajectoryPo
     
     memcpy(&trajectory->points[trajectory->point_count], point, sizeof(TrajectoryPoint));
     trajectory->point_count++;
+    trajectory->version++;
     
     /* 更新轨迹统计信息 */
     if (trajectory->point_count == 1) {
@@ -72,6 +75,7 @@ int flight_trajectory_clear(FlightTrajectory* trajectory) {
     if (trajectory == NULL) return 0;
     
     trajectory->point_count = 0;
+    trajectory->version++;
     trajectory->start_time = 0;
     trajectory->end_time = 0;
     trajectory->total_distance = 0.0;
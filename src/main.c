@@ -5,21 +5,8 @@
 #include "satellite/satellite.h"
 #include "utils/utils.h"
 
-int main(int argc, char* argv[]) {
-    printf("北斗导航卫星可见性分析系统\n");
-    printf("Beidou Navigation Satellite Visibility Analysis System\n");
-    printf("====================================================\n\n");
-    
-    /* 创建卫星数据管理器 */
-    SatelliteData* satellite_data = satellite_data_create(32);
-    if (satellite_data == NULL) {
-        printf("错误：无法创建卫星数据管理器\n");
-        return 1;
-    }
-    
-    printf("卫星数据管理器创建成功，最大容量：%d颗卫星\n", satellite_data->max_satellites);
-    
-    /* 添加测试卫星 */
+/* 未指定星历文件时使用的测试卫星 */
+static void add_test_satellite(SatelliteData* satellite_data) {
     Satellite test_sat = {0};
     test_sat.prn = 1;
     test_sat.system = SATELLITE_SYSTEM_BEIDOU;
@@ -57,38 +44,110 @@ int main(int argc, char* argv[]) {
     } else {
         printf("添加卫星失败\n");
     }
+}
+
+int main(int argc, char* argv[]) {
+    printf("北斗导航卫星可见性分析系统\n");
+    printf("Beidou Navigation Satellite Visibility Analysis System\n");
+    printf("====================================================\n\n");
+    
+    /* 命令行参数: --rinex <导航文件> [--snapshot <快照文件>] */
+    const char* rinex_file = NULL;
+    const char* snapshot_file = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rinex") == 0 && i + 1 < argc) {
+            rinex_file = argv[++i];
+        } else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            snapshot_file = argv[++i];
+        }
+    }
+    
+    /* 加载星历库，指定快照时源文件未变化则直接映射快照 */
+    EphemerisStore* ephemeris_store = NULL;
+    if (rinex_file != NULL) {
+        PerformanceTimer timer;
+        performance_timer_start(&timer, "ephemeris_load");
+        
+        ephemeris_store = ephemeris_store_create();
+        int loaded = snapshot_file != NULL
+                     ? ephemeris_store_load_cached(ephemeris_store, rinex_file, snapshot_file)
+                     : ephemeris_store_load_rinex(ephemeris_store, rinex_file, NULL);
+        
+        performance_timer_stop(&timer);
+        if (loaded) {
+            printf("星历加载完成：%d组星历，%d颗卫星，耗时%.1f ms\n",
+                   ephemeris_store->record_count, ephemeris_store->satellite_count,
+                   performance_timer_elapsed(&timer) * 1000.0);
+        } else {
+            printf("错误：无法加载星历文件 %s，改用测试卫星\n", rinex_file);
+            ephemeris_store_destroy(ephemeris_store);
+            ephemeris_store = NULL;
+        }
+    }
+    
+    /* 创建卫星数据管理器 (容量足够容纳星历库中的全部卫星) */
+    int capacity = 32;
+    if (ephemeris_store != NULL && ephemeris_store->satellite_count > capacity) {
+        capacity = ephemeris_store->satellite_count;
+    }
+    SatelliteData* satellite_data = satellite_data_create(capacity);
+    if (satellite_data == NULL) {
+        printf("错误：无法创建卫星数据管理器\n");
+        return 1;
+    }
+    
+    printf("卫星数据管理器创建成功，最大容量：%d颗卫星\n", satellite_data->max_satellites);
     
-    /* 计算卫星位置 */
+    /* 分析时刻的星历：从星历库为每颗卫星选最近的一组，未指定星历文件时使用测试卫星 */
     time_t current_time = time(NULL);
-    if (satellite_position_calculate(&test_sat, current_time)) {
-        printf("卫星位置计算成功：\n");
-        printf("  X: %.2f m\n", test_sat.pos.x);
-        printf("  Y: %.2f m\n", test_sat.pos.y);
-        printf("  Z: %.2f m\n", test_sat.pos.z);
+    if (ephemeris_store != NULL) {
+        int selected = ephemeris_store_select(ephemeris_store, 0, current_time, satellite_data);
+        
+        /* 星历文件与当前时间相差过大时按星历历元分析，避免长时间外推 */
+        if (selected > 0 && llabs((long long)(satellite_data->satellites[0].valid_time - current_time)) > 4 * 3600) {
+            current_time = satellite_data->satellites[0].valid_time;
+            selected = ephemeris_store_select(ephemeris_store, 0, current_time, satellite_data);
+        }
+        printf("从星历库选取%d颗卫星，分析时刻 %lld\n", selected, (long long)current_time);
     } else {
-        printf("卫星位置计算失败\n");
+        add_test_satellite(satellite_data);
     }
     
-    /* 计算卫星可见性 */
-    SatelliteVisibility visibility = {0};
+    /* 计算卫星位置和可见性 */
     double lat = 39.9042;  // 北京纬度
     double lon = 116.4074; // 北京经度
     double alt = 50.0;    // 海拔高度
+    int visible_count = 0;
     
-    if (satellite_visibility_calculate(&test_sat, lat, lon, alt, &visibility)) {
-        printf("卫星可见性分析：\n");
-        printf("  高度角：%.2f°\n", visibility.elevation);
-        printf("  方位角：%.2f°\n", visibility.azimuth);
-        printf("  距离：%.2f km\n", visibility.distance / 1000.0);
-        printf("  可见性：%s\n", visibility.is_visible ? "可见" : "不可见");
-        printf("  信号强度：%.2f dBm\n", visibility.signal_strength);
-    } else {
-        printf("卫星可见性计算失败\n");
+    /* 整个星座一次批量传播到分析时刻，没有可用星历的卫星不在批量中 */
+    SatelliteEphemerisBatch* batch = satellite_ephemeris_batch_create(satellite_data);
+    int propagated = satellite_data_propagate_batch(satellite_data, batch, current_time);
+    if (propagated < satellite_data->satellite_count) {
+        printf("%d颗卫星没有可用星历，位置计算失败\n", satellite_data->satellite_count - propagated);
+    }
+    
+    for (int k = 0; batch != NULL && k < batch->count; k++) {
+        const Satellite* sat = &satellite_data->satellites[batch->data_index[k]];
+        
+        SatelliteVisibility visibility = {0};
+        if (!satellite_visibility_calculate(sat, lat, lon, alt, &visibility)) {
+            printf("%s PRN %d：卫星可见性计算失败\n", satellite_system_to_string(sat->system), sat->prn);
+            continue;
+        }
+        
+        printf("%s PRN %d：X %.2f m, Y %.2f m, Z %.2f m，高度角 %.2f°，方位角 %.2f°，距离 %.2f km，%s，信号强度 %.2f dBm\n",
+               satellite_system_to_string(sat->system), sat->prn, sat->pos.x, sat->pos.y, sat->pos.z,
+               visibility.elevation, visibility.azimuth, visibility.distance / 1000.0,
+               visibility.is_visible ? "可见" : "不可见", visibility.signal_strength);
+        if (visibility.is_visible) visible_count++;
     }
+    satellite_ephemeris_batch_destroy(batch);
+    printf("卫星可见性分析：%d颗卫星中%d颗可见\n", satellite_data->satellite_count, visible_count);
     
     /* 清理资源 */
+    ephemeris_store_destroy(ephemeris_store);
     satellite_data_destroy(satellite_data);
     
     printf("\n系统测试完成！\n");
     return 0;
-}
\ No newline at end of file
+}
@@ -1,3 +1,799 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L  /* strtok_r */
+#endif
+
 #include "obstruction.h"
+#include "../utils/utils.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#define MESH_ALIGNMENT 32                /* AVX2寄存器宽度 (字节) */
+#define MESH_DET_EPSILON 1e-12           /* 射线与三角形平行的判定阈值 */
+#define MESH_T_EPSILON 1e-9              /* 忽略紧贴射线原点的交点 (天线自身所在表面) */
+#define MESH_LINE_LENGTH 1024
+#define STL_HEADER_SIZE 80
+#define STL_TRIANGLE_SIZE 50             /* 法向量 + 3个顶点 (各3个float) + 属性字 */
+
+_Static_assert(sizeof(TrianglePacket) % MESH_ALIGNMENT == 0, "三角形包大小须为对齐宽度的整数倍");
+
+/* 打包前的三角形 */
+typedef struct {
+    Vector3D v0, v1, v2;
+    AircraftPart part_type;
+    uint64_t morton;                     /* 质心Morton码，用于空间排序 */
+} MeshTriangle;
+
+/* =================== 求交内核 =================== */
+
+/* 网格遍历参数 (射线在机体坐标系中的表示) */
+typedef struct {
+    double origin[3];
+    double direction[3];
+    Vector3D inv_direction;
+} MeshRay;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MESH_HAVE_VECTOR_KERNEL 1
+
+/* 与ephemeris_batch.c相同的做法：同一内核分别按AVX2和基线SSE2编译，运行时选择 */
+typedef double MeshVec __attribute__((vector_size(32)));
+typedef long long MeshMask __attribute__((vector_size(32)));
+
+#define MESH_LOAD(packet, field) (*(const MeshVec*)(packet)->field)
+
+/* Möller–Trumbore，4个三角形一组；未命中的通道返回INFINITY */
+static inline __attribute__((always_inline)) void mesh_packet_hits(const TrianglePacket* packet,
+                                                                   const MeshRay* ray, double t_max,
+                                                                   MeshVec* hits) {
+    MeshVec e1x = MESH_LOAD(packet, e1x), e1y = MESH_LOAD(packet, e1y), e1z = MESH_LOAD(packet, e1z);
+    MeshVec e2x = MESH_LOAD(packet, e2x), e2y = MESH_LOAD(packet, e2y), e2z = MESH_LOAD(packet, e2z);
+    double dx = ray->direction[0], dy = ray->direction[1], dz = ray->direction[2];
+
+    MeshVec px = dy * e2z - dz * e2y;
+    MeshVec py = dz * e2x - dx * e2z;
+    MeshVec pz = dx * e2y - dy * e2x;
+    MeshVec det = e1x * px + e1y * py + e1z * pz;
+    MeshVec inv_det = 1.0 / det;
+
+    MeshVec tx = ray->origin[0] - MESH_LOAD(packet, v0x);
+    MeshVec ty = ray->origin[1] - MESH_LOAD(packet, v0y);
+    MeshVec tz = ray->origin[2] - MESH_LOAD(packet, v0z);
+    MeshVec u = (tx * px + ty * py + tz * pz) * inv_det;
+
+    MeshVec qx = ty * e1z - tz * e1y;
+    MeshVec qy = tz * e1x - tx * e1z;
+    MeshVec qz = tx * e1y - ty * e1x;
+    MeshVec v = (dx * qx + dy * qy + dz * qz) * inv_det;
+    MeshVec t = (e2x * qx + e2y * qy + e2z * qz) * inv_det;
+
+    /* 双面求交：网格法向不一定一致 */
+    MeshMask hit = ((det > MESH_DET_EPSILON) | (det < -MESH_DET_EPSILON)) &
+                   (u >= 0.0) & (v >= 0.0) & (u + v <= 1.0) &
+                   (t > MESH_T_EPSILON) & (t < t_max);
+
+    MeshVec miss = {INFINITY, INFINITY, INFINITY, INFINITY};
+    *hits = (MeshVec)((hit & (MeshMask)t) | (~hit & (MeshMask)miss));
+}
+
+/* 遍历所有分块；any_hit为真时找到任一交点即返回 */
+static inline __attribute__((always_inline)) int mesh_traverse(const TriangleMesh* mesh, const MeshRay* ray,
+                                                               double t_max, int any_hit,
+                                                               double* t_hit, int* slot_hit) {
+    Vector3D origin = vector3d_create(ray->origin[0], ray->origin[1], ray->origin[2]);
+    double closest = t_max;
+    int slot = -1;
+
+    for (int c = 0; c < mesh->chunk_count; c++) {
+        double t_near;
+        if (!ray_aabb_intersection(&mesh->chunk_bounds[c], &origin, &ray->inv_direction, closest, &t_near)) {
+            continue;
+        }
+
+        int first = c * TRIANGLE_MESH_CHUNK_PACKETS;
+        int last = first + TRIANGLE_MESH_CHUNK_PACKETS;
+        if (last > mesh->packet_count) last = mesh->packet_count;
+
+        for (int p = first; p < last; p++) {
+            MeshVec hits;
+            mesh_packet_hits(&mesh->packets[p], ray, closest, &hits);
+            for (int lane = 0; lane < TRIANGLE_PACKET_LANES; lane++) {
+                if (hits[lane] < closest) {
+                    closest = hits[lane];
+                    slot = p * TRIANGLE_PACKET_LANES + lane;
+                    if (any_hit) goto done;
+                }
+            }
+        }
+    }
+
+done:
+    if (slot < 0) return 0;
+    *t_hit = closest;
+    *slot_hit = slot;
+    return 1;
+}
+
+__attribute__((target("avx2")))
+static int mesh_traverse_avx2(const TriangleMesh* mesh, const MeshRay* ray, double t_max,
+                              int any_hit, double* t_hit, int* slot_hit) {
+    return mesh_traverse(mesh, ray, t_max, any_hit, t_hit, slot_hit);
+}
+
+static int mesh_traverse_sse2(const TriangleMesh* mesh, const MeshRay* ray, double t_max,
+                              int any_hit, double* t_hit, int* slot_hit) {
+    return mesh_traverse(mesh, ray, t_max, any_hit, t_hit, slot_hit);
+}
+#endif /* 向量化内核 */
+
+/* 标量回退 (非GCC/x86平台) */
+static int mesh_traverse_scalar(const TriangleMesh* mesh, const MeshRay* ray, double t_max,
+                                int any_hit, double* t_hit, int* slot_hit) {
+    Vector3D origin = vector3d_create(ray->origin[0], ray->origin[1], ray->origin[2]);
+    Vector3D direction = vector3d_create(ray->direction[0], ray->direction[1], ray->direction[2]);
+    double closest = t_max;
+    int slot = -1;
+
+    for (int c = 0; c < mesh->chunk_count; c++) {
+        double t_near;
+        if (!ray_aabb_intersection(&mesh->chunk_bounds[c], &origin, &ray->inv_direction, closest, &t_near)) {
+            continue;
+        }
+
+        int first = c * TRIANGLE_MESH_CHUNK_PACKETS;
+        int last = first + TRIANGLE_MESH_CHUNK_PACKETS;
+        if (last > mesh->packet_count) last = mesh->packet_count;
+
+        for (int p = first; p < last; p++) {
+            const TrianglePacket* packet = &mesh->packets[p];
+            for (int lane = 0; lane < TRIANGLE_PACKET_LANES; lane++) {
+                Vector3D e1 = vector3d_create(packet->e1x[lane], packet->e1y[lane], packet->e1z[lane]);
+                Vector3D e2 = vector3d_create(packet->e2x[lane], packet->e2y[lane], packet->e2z[lane]);
+                Vector3D v0 = vector3d_create(packet->v0x[lane], packet->v0y[lane], packet->v0z[lane]);
+
+                Vector3D pvec = vector3d_cross(&direction, &e2);
+                double det = vector3d_dot(&e1, &pvec);
+                if (fabs(det) <= MESH_DET_EPSILON) continue;
+
+                double inv_det = 1.0 / det;
+                Vector3D tvec = vector3d_subtract(&origin, &v0);
+                double u = vector3d_dot(&tvec, &pvec) * inv_det;
+                if (u < 0.0 || u > 1.0) continue;
+
+                Vector3D qvec = vector3d_cross(&tvec, &e1);
+                double v = vector3d_dot(&direction, &qvec) * inv_det;
+                if (v < 0.0 || u + v > 1.0) continue;
+
+                double t = vector3d_dot(&e2, &qvec) * inv_det;
+                if (t > MESH_T_EPSILON && t < closest) {
+                    closest = t;
+                    slot = p * TRIANGLE_PACKET_LANES + lane;
+                    if (any_hit) goto done;
+                }
+            }
+        }
+    }
+
+done:
+    if (slot < 0) return 0;
+    *t_hit = closest;
+    *slot_hit = slot;
+    return 1;
+}
+
+/* 按CPU能力选择内核，结果在首次调用时确定 */
+typedef enum {
+    MESH_KERNEL_UNSELECTED = 0,
+    MESH_KERNEL_SCALAR,
+    MESH_KERNEL_SSE2,
+    MESH_KERNEL_AVX2
+} MeshKernel;
+
+static MeshKernel mesh_kernel_select(void) {
+    static MeshKernel selected = MESH_KERNEL_UNSELECTED;
+
+    if (selected == MESH_KERNEL_UNSELECTED) {
+#ifdef MESH_HAVE_VECTOR_KERNEL
+        __builtin_cpu_init();
+        selected = __builtin_cpu_supports("avx2") ? MESH_KERNEL_AVX2 : MESH_KERNEL_SSE2;
+#else
+        selected = MESH_KERNEL_SCALAR;
+#endif
+    }
+
+    return selected;
+}
+
+static int mesh_intersect(const TriangleMesh* mesh, const Ray* ray, int any_hit,
+                          double* t_hit, int* slot_hit) {
+    MeshRay mesh_ray;
+    mesh_ray.origin[0] = ray->origin.x;
+    mesh_ray.origin[1] = ray->origin.y;
+    mesh_ray.origin[2] = ray->origin.z;
+    mesh_ray.direction[0] = ray->direction.x;
+    mesh_ray.direction[1] = ray->direction.y;
+    mesh_ray.direction[2] = ray->direction.z;
+    mesh_ray.inv_direction = vector3d_create(1.0 / ray->direction.x, 1.0 / ray->direction.y,
+                                             1.0 / ray->direction.z);
+
+    switch (mesh_kernel_select()) {
+#ifdef MESH_HAVE_VECTOR_KERNEL
+        case MESH_KERNEL_AVX2:
+            return mesh_traverse_avx2(mesh, &mesh_ray, ray->length, any_hit, t_hit, slot_hit);
+        case MESH_KERNEL_SSE2:
+            return mesh_traverse_sse2(mesh, &mesh_ray, ray->length, any_hit, t_hit, slot_hit);
+#endif
+        default:
+            return mesh_traverse_scalar(mesh, &mesh_ray, ray->length, any_hit, t_hit, slot_hit);
+    }
+}
+
+/**
+ * @brief 射线与网格的最近交点
+ * @param mesh 三角网格
+ * @param ray 射线 (机体坐标系)
+ * @param distance 交点距离 (输出，可为NULL)
+ * @param part_type 命中三角形的部件类型 (输出，可为NULL)
+ * @return 1表示相交，0表示不相交
+ */
+int triangle_mesh_intersect_closest(const TriangleMesh* mesh, const Ray* ray,
+                                    double* distance, AircraftPart* part_type) {
+    if (!mesh || !ray || mesh->packet_count == 0) {
+        return 0;
+    }
+
+    double t;
+    int slot;
+    if (!mesh_intersect(mesh, ray, 0, &t, &slot)) {
+        return 0;
+    }
+
+    if (distance) *distance = t;
+    if (part_type) *part_type = mesh->part_types[slot];
+    return 1;
+}
+
+/**
+ * @brief 射线是否与网格相交 (找到任一交点即返回)
+ * @param mesh 三角网格
+ * @param ray 射线 (机体坐标系)
+ * @return 1表示相交，0表示不相交
+ */
+int triangle_mesh_intersect_any(const TriangleMesh* mesh, const Ray* ray) {
+    if (!mesh || !ray || mesh->packet_count == 0) {
+        return 0;
+    }
+
+    double t;
+    int slot;
+    return mesh_intersect(mesh, ray, 1, &t, &slot);
+}
+
+/**
+ * @brief 当前使用的求交内核名称
+ * @return "AVX2"、"SSE2"或"SCALAR"
+ */
+const char* triangle_mesh_kernel_name(void) {
+    switch (mesh_kernel_select()) {
+        case MESH_KERNEL_AVX2: return "AVX2";
+        case MESH_KERNEL_SSE2: return "SSE2";
+        default: return "SCALAR";
+    }
+}
+
+/* =================== 网格构建 =================== */
+
+/* 把10位整数的各位间隔两位展开 */
+static uint64_t morton_spread(uint64_t x) {
+    x &= 0x3FF;
+    x = (x | (x << 16)) & 0x30000FF;
+    x = (x | (x << 8)) & 0x300F00F;
+    x = (x | (x << 4)) & 0x30C30C3;
+    x = (x | (x << 2)) & 0x9249249;
+    return x;
+}
+
+static int compare_morton(const void* a, const void* b) {
+    uint64_t ma = ((const MeshTriangle*)a)->morton;
+    uint64_t mb = ((const MeshTriangle*)b)->morton;
+    return (ma > mb) - (ma < mb);
+}
+
+static void bounds_include(BoundingBox* bounds, const Vector3D* point) {
+    bounds->min.x = fmin(bounds->min.x, point->x);
+    bounds->min.y = fmin(bounds->min.y, point->y);
+    bounds->min.z = fmin(bounds->min.z, point->z);
+    bounds->max.x = fmax(bounds->max.x, point->x);
+    bounds->max.y = fmax(bounds->max.y, point->y);
+    bounds->max.z = fmax(bounds->max.z, point->z);
+}
+
+static void bounds_empty(BoundingBox* bounds) {
+    bounds->min = vector3d_create(INFINITY, INFINITY, INFINITY);
+    bounds->max = vector3d_create(-INFINITY, -INFINITY, -INFINITY);
+}
+
+/**
+ * @brief 从三角形列表构建网格 (排序并打包，会重排triangles)
+ * @param triangles 三角形数组
+ * @param count 三角形数量
+ * @return 创建的网格，失败返回NULL
+ */
+static TriangleMesh* mesh_build(MeshTriangle* triangles, int count) {
+    TriangleMesh* mesh = (TriangleMesh*)malloc(sizeof(TriangleMesh));
+    if (!mesh) {
+        error_set(ERROR_MEMORY, "网格内存分配失败", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+    memset(mesh, 0, sizeof(TriangleMesh));
+    bounds_empty(&mesh->bounds);
+
+    for (int i = 0; i < count; i++) {
+        bounds_include(&mesh->bounds, &triangles[i].v0);
+        bounds_include(&mesh->bounds, &triangles[i].v1);
+        bounds_include(&mesh->bounds, &triangles[i].v2);
+    }
+
+    // 按质心Morton码排序，使同一分块内的三角形在空间上相邻
+    Vector3D extent = vector3d_subtract(&mesh->bounds.max, &mesh->bounds.min);
+    for (int i = 0; i < count; i++) {
+        Vector3D sum = vector3d_add(&triangles[i].v0, &triangles[i].v1);
+        sum = vector3d_add(&sum, &triangles[i].v2);
+        Vector3D centroid = vector3d_multiply(&sum, 1.0 / 3.0);
+
+        uint64_t q[3];
+        double c[3] = {centroid.x - mesh->bounds.min.x, centroid.y - mesh->bounds.min.y,
+                       centroid.z - mesh->bounds.min.z};
+        double e[3] = {extent.x, extent.y, extent.z};
+        for (int k = 0; k < 3; k++) {
+            q[k] = e[k] > 0.0 ? (uint64_t)(c[k] / e[k] * 1023.0) : 0;
+        }
+        triangles[i].morton = morton_spread(q[0]) | (morton_spread(q[1]) << 1) | (morton_spread(q[2]) << 2);
+    }
+    qsort(triangles, (size_t)count, sizeof(MeshTriangle), compare_morton);
+
+    mesh->triangle_count = count;
+    mesh->packet_count = (count + TRIANGLE_PACKET_LANES - 1) / TRIANGLE_PACKET_LANES;
+    mesh->chunk_count = (mesh->packet_count + TRIANGLE_MESH_CHUNK_PACKETS - 1) / TRIANGLE_MESH_CHUNK_PACKETS;
+
+    size_t slots = (size_t)mesh->packet_count * TRIANGLE_PACKET_LANES;
+    mesh->packets = (TrianglePacket*)aligned_alloc(MESH_ALIGNMENT, (size_t)mesh->packet_count * sizeof(TrianglePacket));
+    mesh->part_types = (AircraftPart*)malloc(sizeof(AircraftPart) * slots);
+    mesh->chunk_bounds = (BoundingBox*)malloc(sizeof(BoundingBox) * mesh->chunk_count);
+
+    if (!mesh->packets || !mesh->part_types || !mesh->chunk_bounds) {
+        triangle_mesh_destroy(mesh);
+        error_set(ERROR_MEMORY, "网格内存分配失败", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+
+    // 填充槽位为零 (退化三角形，求交时被剔除)
+    memset(mesh->packets, 0, (size_t)mesh->packet_count * sizeof(TrianglePacket));
+    for (size_t i = 0; i < slots; i++) {
+        mesh->part_types[i] = AIRCRAFT_PART_FUSELAGE;
+    }
+    for (int c = 0; c < mesh->chunk_count; c++) {
+        bounds_empty(&mesh->chunk_bounds[c]);
+    }
+
+    for (int i = 0; i < count; i++) {
+        const MeshTriangle* tri = &triangles[i];
+        TrianglePacket* packet = &mesh->packets[i / TRIANGLE_PACKET_LANES];
+        int lane = i % TRIANGLE_PACKET_LANES;
+
+        packet->v0x[lane] = tri->v0.x;
+        packet->v0y[lane] = tri->v0.y;
+        packet->v0z[lane] = tri->v0.z;
+        packet->e1x[lane] = tri->v1.x - tri->v0.x;
+        packet->e1y[lane] = tri->v1.y - tri->v0.y;
+        packet->e1z[lane] = tri->v1.z - tri->v0.z;
+        packet->e2x[lane] = tri->v2.x - tri->v0.x;
+        packet->e2y[lane] = tri->v2.y - tri->v0.y;
+        packet->e2z[lane] = tri->v2.z - tri->v0.z;
+        mesh->part_types[i] = tri->part_type;
+
+        BoundingBox* chunk = &mesh->chunk_bounds[i / (TRIANGLE_PACKET_LANES * TRIANGLE_MESH_CHUNK_PACKETS)];
+        bounds_include(chunk, &tri->v0);
+        bounds_include(chunk, &tri->v1);
+        bounds_include(chunk, &tri->v2);
+    }
+
+    return mesh;
+}
+
+/**
+ * @brief 从索引三角形创建网格
+ * @param vertices 顶点数组 (机体坐标系，米)
+ * @param vertex_count 顶点数量
+ * @param indices 三角形顶点索引 (每个三角形3个，从0开始)
+ * @param part_types 每个三角形的部件类型 (可为NULL，默认机身)
+ * @param triangle_count 三角形数量
+ * @return 创建的网格，失败返回NULL
+ */
+TriangleMesh* triangle_mesh_create(const Vector3D* vertices, int vertex_count,
+                                   const int* indices, const AircraftPart* part_types,
+                                   int triangle_count) {
+    if (!vertices || !indices || vertex_count <= 0 || triangle_count <= 0) {
+        error_set(ERROR_PARAMETER, "无效的网格参数", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+
+    MeshTriangle* triangles = (MeshTriangle*)malloc(sizeof(MeshTriangle) * triangle_count);
+    if (!triangles) {
+        error_set(ERROR_MEMORY, "网格内存分配失败", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+
+    for (int i = 0; i < triangle_count; i++) {
+        const int* tri = &indices[i * 3];
+        if (tri[0] < 0 || tri[0] >= vertex_count || tri[1] < 0 || tri[1] >= vertex_count ||
+            tri[2] < 0 || tri[2] >= vertex_count) {
+            free(triangles);
+            error_set(ERROR_PARAMETER, "三角形顶点索引越界", __func__, __FILE__, __LINE__);
+            return NULL;
+        }
+
+        triangles[i].v0 = vertices[tri[0]];
+        triangles[i].v1 = vertices[tri[1]];
+        triangles[i].v2 = vertices[tri[2]];
+        triangles[i].part_type = part_types ? part_types[i] : AIRCRAFT_PART_FUSELAGE;
+    }
+
+    TriangleMesh* mesh = mesh_build(triangles, triangle_count);
+    free(triangles);
+    return mesh;
+}
+
+/**
+ * @brief 销毁网格
+ * @param mesh 三角网格
+ */
+void triangle_mesh_destroy(TriangleMesh* mesh) {
+    if (!mesh) {
+        return;
+    }
+
+    free(mesh->packets);  /* aligned_alloc分配的内存 */
+    free(mesh->part_types);
+    free(mesh->chunk_bounds);
+    free(mesh);
+}
+
+/* =================== 文件加载 =================== */
+
+/* 可增长的三角形列表 */
+typedef struct {
+    MeshTriangle* items;
+    int count;
+    int capacity;
+} TriangleList;
+
+static int triangle_list_push(TriangleList* list, const Vector3D* v0, const Vector3D* v1,
+                              const Vector3D* v2, AircraftPart part_type) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity * 2 : 256;
+        MeshTriangle* items = (MeshTriangle*)realloc(list->items, sizeof(MeshTriangle) * capacity);
+        if (!items) {
+            error_set(ERROR_MEMORY, "网格内存分配失败", __func__, __FILE__, __LINE__);
+            return 0;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+
+    MeshTriangle* tri = &list->items[list->count++];
+    tri->v0 = *v0;
+    tri->v1 = *v1;
+    tri->v2 = *v2;
+    tri->part_type = part_type;
+    return 1;
+}
+
+static TriangleMesh* triangle_list_finish(TriangleList* list, const char* filename) {
+    TriangleMesh* mesh = NULL;
+    if (list->count == 0) {
+        error_set(ERROR_PARSE, "模型文件中没有三角形", __func__, __FILE__, __LINE__);
+    } else {
+        mesh = mesh_build(list->items, list->count);
+        if (mesh) {
+            LOG_INFO_FMT("加载飞机网格模型 %s: %d个三角形, %d个分块", filename,
+                         mesh->triangle_count, mesh->chunk_count);
+        }
+    }
+
+    free(list->items);
+    return mesh;
+}
+
+/* 名称按非字母字符分词后是否含有完整的单词 (避免 "wing_rear" 中的 "_r" 之类误匹配) */
+static int name_has_word(const char* lower, const char* word) {
+    size_t word_length = strlen(word);
+    const char* p = lower;
+
+    while (*p) {
+        while (*p && !isalpha((unsigned char)*p)) p++;
+        const char* start = p;
+        while (*p && isalpha((unsigned char)*p)) p++;
+        if ((size_t)(p - start) == word_length && strncmp(start, word, word_length) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 按组名/材质名推断部件类型
+ * @param name 名称 (如 "left_wing", "Engine2", "tail_fin", "wing_r")
+ * @return 部件类型，无法识别时为机身
+ * @note 左右和"fin"按完整单词匹配，其余关键字按子串匹配
+ */
+AircraftPart aircraft_part_from_name(const char* name) {
+    if (!name) {
+        return AIRCRAFT_PART_FUSELAGE;
+    }
+
+    char lower[128];
+    size_t length = strlen(name);
+    if (length >= sizeof(lower)) length = sizeof(lower) - 1;
+    for (size_t i = 0; i < length; i++) {
+        lower[i] = (char)tolower((unsigned char)name[i]);
+    }
+    lower[length] = '\0';
+
+    if (strstr(lower, "engine") || strstr(lower, "nacelle")) return AIRCRAFT_PART_ENGINE;
+    if (strstr(lower, "tail") || strstr(lower, "stabilizer") || name_has_word(lower, "fin")) {
+        return AIRCRAFT_PART_TAIL;
+    }
+    if (strstr(lower, "wing")) {
+        return (name_has_word(lower, "right") || name_has_word(lower, "r"))
+               ? AIRCRAFT_PART_WING_RIGHT : AIRCRAFT_PART_WING_LEFT;
+    }
+    return AIRCRAFT_PART_FUSELAGE;
+}
+
+/* 解析OBJ面元素中的顶点索引 ("7", "7/1", "7//3", "-1/2/3")，返回从0开始的下标，失败返回-1 */
+static int obj_vertex_index(const char* token, int vertex_count) {
+    char* end;
+    long index = strtol(token, &end, 10);
+    if (end == token || index == 0) {
+        return -1;
+    }
+
+    // 负数索引相对于当前已读入的顶点
+    long resolved = index > 0 ? index - 1 : vertex_count + index;
+    return (resolved >= 0 && resolved < vertex_count) ? (int)resolved : -1;
+}
+
+/**
+ * @brief 加载Wavefront OBJ模型 (v/f/g/o/usemtl，多边形按扇形三角化)
+ * @param filename 文件名
+ * @return 创建的网格，失败返回NULL
+ * @note 坐标按机体坐标系 (米) 解释；组名或材质名用于推断部件类型
+ */
+TriangleMesh* triangle_mesh_load_obj(const char* filename) {
+    if (!filename) {
+        return NULL;
+    }
+
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        error_set(ERROR_FILE, "无法打开OBJ模型文件", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+
+    Vector3D* vertices = NULL;
+    int vertex_count = 0;
+    int vertex_capacity = 0;
+    TriangleList list = {NULL, 0, 0};
+    AircraftPart part_type = AIRCRAFT_PART_FUSELAGE;
+    char line[MESH_LINE_LENGTH];
+    int ok = 1;
+
+    while (ok && fgets(line, sizeof(line), file)) {
+        if (line[0] == 'v' && line[1] == ' ') {
+            if (vertex_count == vertex_capacity) {
+                vertex_capacity = vertex_capacity > 0 ? vertex_capacity * 2 : 256;
+                Vector3D* grown = (Vector3D*)realloc(vertices, sizeof(Vector3D) * vertex_capacity);
+                if (!grown) {
+                    error_set(ERROR_MEMORY, "网格内存分配失败", __func__, __FILE__, __LINE__);
+                    ok = 0;
+                    break;
+                }
+                vertices = grown;
+            }
+
+            Vector3D* v = &vertices[vertex_count];
+            if (sscanf(line + 2, "%lf %lf %lf", &v->x, &v->y, &v->z) != 3) {
+                error_set(ERROR_PARSE, "OBJ顶点格式错误", __func__, __FILE__, __LINE__);
+                ok = 0;
+                break;
+            }
+            vertex_count++;
+        } else if (line[0] == 'f' && line[1] == ' ') {
+            int first = -1;
+            int previous = -1;
+            char* save_ptr = NULL;
+            char* token = strtok_r(line + 2, " \t\r\n", &save_ptr);
+
+            for (; token != NULL; token = strtok_r(NULL, " \t\r\n", &save_ptr)) {
+                int index = obj_vertex_index(token, vertex_count);
+                if (index < 0) {
+                    error_set(ERROR_PARSE, "OBJ面顶点索引无效", __func__, __FILE__, __LINE__);
+                    ok = 0;
+                    break;
+                }
+
+                if (first < 0) {
+                    first = index;
+                } else if (previous >= 0) {
+                    if (!triangle_list_push(&list, &vertices[first], &vertices[previous],
+                                            &vertices[index], part_type)) {
+                        ok = 0;
+                        break;
+                    }
+                }
+                if (first != index) previous = index;
+            }
+        } else if ((line[0] == 'g' || line[0] == 'o') && line[1] == ' ') {
+            line[strcspn(line, "\r\n")] = '\0';
+            part_type = aircraft_part_from_name(line + 2);
+        } else if (strncmp(line, "usemtl ", 7) == 0) {
+            line[strcspn(line, "\r\n")] = '\0';
+            part_type = aircraft_part_from_name(line + 7);
+        }
+    }
+
+    fclose(file);
+    free(vertices);
+
+    if (!ok) {
+        free(list.items);
+        return NULL;
+    }
+
+    return triangle_list_finish(&list, filename);
+}
+
+static float stl_read_float(const unsigned char* data) {
+    /* STL二进制格式为小端序 */
+    uint32_t bits = (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+                    ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static Vector3D stl_read_vertex(const unsigned char* data) {
+    return vector3d_create(stl_read_float(data), stl_read_float(data + 4), stl_read_float(data + 8));
+}
+
+/**
+ * @brief 加载STL模型 (自动识别二进制和ASCII格式)
+ * @param filename 文件名
+ * @return 创建的网格，失败返回NULL
+ * @note STL没有分组信息，所有三角形视为机身
+ */
+TriangleMesh* triangle_mesh_load_stl(const char* filename) {
+    if (!filename) {
+        return NULL;
+    }
+
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        error_set(ERROR_FILE, "无法打开STL模型文件", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+
+    TriangleList list = {NULL, 0, 0};
+    unsigned char header[STL_HEADER_SIZE + 4];
+    size_t header_read = fread(header, 1, sizeof(header), file);
+    long size = file_size(filename);
+
+    // 二进制STL的长度由三角形数量唯一确定；以"solid"开头的二进制文件也能据此区分
+    uint32_t binary_count = 0;
+    if (header_read == sizeof(header)) {
+        binary_count = (uint32_t)header[80] | ((uint32_t)header[81] << 8) |
+                       ((uint32_t)header[82] << 16) | ((uint32_t)header[83] << 24);
+    }
+    int is_binary = header_read == sizeof(header) &&
+                    size == (long)(STL_HEADER_SIZE + 4 + (long)binary_count * STL_TRIANGLE_SIZE);
+
+    int ok = 1;
+    if (is_binary) {
+        unsigned char record[STL_TRIANGLE_SIZE];
+        for (uint32_t i = 0; ok && i < binary_count; i++) {
+            if (fread(record, 1, sizeof(record), file) != sizeof(record)) {
+                error_set(ERROR_PARSE, "STL文件被截断", __func__, __FILE__, __LINE__);
+                ok = 0;
+                break;
+            }
+            Vector3D v0 = stl_read_vertex(record + 12);
+            Vector3D v1 = stl_read_vertex(record + 24);
+            Vector3D v2 = stl_read_vertex(record + 36);
+            ok = triangle_list_push(&list, &v0, &v1, &v2, AIRCRAFT_PART_FUSELAGE);
+        }
+    } else {
+        rewind(file);
+        char line[MESH_LINE_LENGTH];
+        Vector3D facet[3];
+        int vertex_index = 0;
+
+        while (ok && fgets(line, sizeof(line), file)) {
+            const char* text = line;
+            while (isspace((unsigned char)*text)) text++;
+
+            if (strncmp(text, "vertex", 6) == 0) {
+                Vector3D* v = &facet[vertex_index < 3 ? vertex_index : 2];
+                if (vertex_index >= 3 || sscanf(text + 6, "%lf %lf %lf", &v->x, &v->y, &v->z) != 3) {
+                    error_set(ERROR_PARSE, "STL顶点格式错误", __func__, __FILE__, __LINE__);
+                    ok = 0;
+                    break;
+                }
+                vertex_index++;
+            } else if (strncmp(text, "endfacet", 8) == 0) {
+                if (vertex_index != 3) {
+                    error_set(ERROR_PARSE, "STL面片顶点数不为3", __func__, __FILE__, __LINE__);
+                    ok = 0;
+                    break;
+                }
+                ok = triangle_list_push(&list, &facet[0], &facet[1], &facet[2], AIRCRAFT_PART_FUSELAGE);
+                vertex_index = 0;
+            }
+        }
+    }
+
+    fclose(file);
+
+    if (!ok) {
+        free(list.items);
+        return NULL;
+    }
+
+    return triangle_list_finish(&list, filename);
+}
+
+/**
+ * @brief 按扩展名加载网格模型 (.obj / .stl)
+ * @param filename 文件名
+ * @return 创建的网格，失败返回NULL
+ */
+TriangleMesh* triangle_mesh_load(const char* filename) {
+    if (!filename) {
+        return NULL;
+    }
+
+    const char* extension = strrchr(filename, '.');
+    if (extension && tolower((unsigned char)extension[1]) == 'o' && tolower((unsigned char)extension[2]) == 'b' &&
+        tolower((unsigned char)extension[3]) == 'j' && extension[4] == '\0') {
+        return triangle_mesh_load_obj(filename);
+    }
+    if (extension && tolower((unsigned char)extension[1]) == 's' && tolower((unsigned char)extension[2]) == 't' &&
+        tolower((unsigned char)extension[3]) == 'l' && extension[4] == '\0') {
+        return triangle_mesh_load_stl(filename);
+    }
+
+    error_set(ERROR_PARAMETER, "不支持的模型文件格式", __func__, __FILE__, __LINE__);
+    return NULL;
+}
+
+/**
+ * @brief 为几何模型设置三角网格 (几何模型接管网格所有权)
+ * @param geometry 几何模型
+ * @param mesh 三角网格，NULL表示移除
+ * @return 成功返回1，失败返回0
+ */
+int aircraft_geometry_set_mesh(AircraftGeometry* geometry, TriangleMesh* mesh) {
+    if (!geometry) {
+        return 0;
+    }
 
-// Placeholder for aircraft model related functions
+    if (geometry->mesh && geometry->mesh != mesh) {
+        triangle_mesh_destroy(geometry->mesh);
+    }
+    geometry->mesh = mesh;
+    geometry->version++;
+    return 1;
+}
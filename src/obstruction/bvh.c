@@ -0,0 +1,415 @@
+#include "obstruction.h"
+#include "../utils/utils.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+
+/* 叶节点最多容纳的部件数 */
+#define BVH_LEAF_SIZE 4
+/* 遍历栈深度 (中位数划分，树高不超过log2(n)+1) */
+#define BVH_STACK_SIZE 64
+/* 包围盒外扩量，抵消旋转后包围盒计算的舍入误差 */
+#define BVH_BOUNDS_EPSILON 1e-9
+
+/**
+ * @brief 计算部件在机体坐标系中的轴对齐包围盒
+ * @param component 飞机部件
+ * @param bounds 包围盒 (输出)
+ */
+static void component_world_bounds(const AircraftComponent* component, BoundingBox* bounds) {
+    RotationMatrix local_to_world;
+    const RotationMatrix* rotation = &component->local_to_world;
+    if (!aircraft_component_transform_is_current(component)) {
+        local_to_world = rotation_matrix_create_from_euler(
+            component->rotation.x, component->rotation.y, component->rotation.z
+        );
+        rotation = &local_to_world;
+    }
+
+    double half[3] = {component->size.x / 2.0, component->size.y / 2.0, component->size.z / 2.0};
+    double center[3] = {component->position.x, component->position.y, component->position.z};
+    double extent[3];
+
+    // 有向包围盒投影到各坐标轴上的半宽
+    for (int i = 0; i < 3; i++) {
+        extent[i] = fabs(rotation->m[i][0]) * half[0] +
+                    fabs(rotation->m[i][1]) * half[1] +
+                    fabs(rotation->m[i][2]) * half[2] + BVH_BOUNDS_EPSILON;
+    }
+
+    bounds->min = vector3d_create(center[0] - extent[0], center[1] - extent[1], center[2] - extent[2]);
+    bounds->max = vector3d_create(center[0] + extent[0], center[1] + extent[1], center[2] + extent[2]);
+}
+
+static void bounds_reset(BoundingBox* bounds) {
+    bounds->min = vector3d_create(DBL_MAX, DBL_MAX, DBL_MAX);
+    bounds->max = vector3d_create(-DBL_MAX, -DBL_MAX, -DBL_MAX);
+}
+
+static void bounds_merge(BoundingBox* bounds, const BoundingBox* other) {
+    bounds->min.x = fmin(bounds->min.x, other->min.x);
+    bounds->min.y = fmin(bounds->min.y, other->min.y);
+    bounds->min.z = fmin(bounds->min.z, other->min.z);
+    bounds->max.x = fmax(bounds->max.x, other->max.x);
+    bounds->max.y = fmax(bounds->max.y, other->max.y);
+    bounds->max.z = fmax(bounds->max.z, other->max.z);
+}
+
+static double vector_axis(const Vector3D* v, int axis) {
+    return axis == 0 ? v->x : (axis == 1 ? v->y : v->z);
+}
+
+/**
+ * @brief 射线与轴对齐包围盒的slab检测
+ * @param bounds 包围盒
+ * @param origin 射线原点
+ * @param inv_direction 射线方向的倒数
+ * @param max_distance 最大检测距离
+ * @param t_near 进入距离 (输出)
+ * @return 1表示相交，0表示不相交
+ */
+int ray_aabb_intersection(const BoundingBox* bounds, const Vector3D* origin,
+                          const Vector3D* inv_direction, double max_distance, double* t_near) {
+    double t1 = (bounds->min.x - origin->x) * inv_direction->x;
+    double t2 = (bounds->max.x - origin->x) * inv_direction->x;
+    double t_min = fmin(t1, t2);
+    double t_max = fmax(t1, t2);
+
+    t1 = (bounds->min.y - origin->y) * inv_direction->y;
+    t2 = (bounds->max.y - origin->y) * inv_direction->y;
+    t_min = fmax(t_min, fmin(t1, t2));
+    t_max = fmin(t_max, fmax(t1, t2));
+
+    t1 = (bounds->min.z - origin->z) * inv_direction->z;
+    t2 = (bounds->max.z - origin->z) * inv_direction->z;
+    t_min = fmax(t_min, fmin(t1, t2));
+    t_max = fmin(t_max, fmax(t1, t2));
+
+    if (t_max < 0.0 || t_min > t_max || t_min > max_distance) {
+        return 0;
+    }
+
+    *t_near = t_min;
+    return 1;
+}
+
+/* =================== 构建 =================== */
+
+typedef struct {
+    GeometryBvh* bvh;
+    const BoundingBox* component_bounds;  /* 按部件下标索引 */
+    const Vector3D* centroids;
+} BvhBuilder;
+
+/**
+ * @brief 快速选择：使indices[k]为按质心坐标排序后的第k个，左侧均不大于它
+ * @param indices 部件下标
+ * @param count 数量
+ * @param k 目标位置
+ * @param centroids 质心
+ * @param axis 坐标轴
+ */
+static void bvh_select_median(int* indices, int count, int k, const Vector3D* centroids, int axis) {
+    int low = 0;
+    int high = count - 1;
+
+    while (low < high) {
+        double pivot = vector_axis(&centroids[indices[(low + high) / 2]], axis);
+        int i = low;
+        int j = high;
+        while (i <= j) {
+            while (vector_axis(&centroids[indices[i]], axis) < pivot) i++;
+            while (vector_axis(&centroids[indices[j]], axis) > pivot) j--;
+            if (i <= j) {
+                int temp = indices[i];
+                indices[i] = indices[j];
+                indices[j] = temp;
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) {
+            high = j;
+        } else if (k >= i) {
+            low = i;
+        } else {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief 递归构建子树
+ * @param builder 构建上下文
+ * @param node_index 当前节点下标
+ * @param first indices中的起始位置
+ * @param count 部件数量
+ */
+static void bvh_build_node(BvhBuilder* builder, int node_index, int first, int count) {
+    GeometryBvh* bvh = builder->bvh;
+    BvhNode* node = &bvh->nodes[node_index];
+
+    bounds_reset(&node->bounds);
+    BoundingBox centroid_bounds;
+    bounds_reset(&centroid_bounds);
+    for (int i = first; i < first + count; i++) {
+        int component = bvh->indices[i];
+        bounds_merge(&node->bounds, &builder->component_bounds[component]);
+        BoundingBox point = {builder->centroids[component], builder->centroids[component]};
+        bounds_merge(&centroid_bounds, &point);
+    }
+
+    if (count <= BVH_LEAF_SIZE) {
+        node->first = first;
+        node->count = count;
+        return;
+    }
+
+    // 选择质心分布最长的轴，按中位数划分 (保证树高为log2(n))
+    Vector3D extent = vector3d_subtract(&centroid_bounds.max, &centroid_bounds.min);
+    int axis = 0;
+    if (extent.y > extent.x) axis = 1;
+    if (extent.z > vector_axis(&extent, axis)) axis = 2;
+
+    int left_count = count / 2;
+    bvh_select_median(bvh->indices + first, count, left_count, builder->centroids, axis);
+
+    int left_child = bvh->node_count;
+    bvh->node_count += 2;
+    node->first = left_child;
+    node->count = 0;
+
+    bvh_build_node(builder, left_child, first, left_count);
+    bvh_build_node(builder, left_child + 1, first + left_count, count - left_count);
+}
+
+/**
+ * @brief 在部件数组上构建BVH (只收录产生遮挡的部件)
+ * @param components 部件数组
+ * @param component_count 部件数量
+ * @return 创建的BVH，失败返回NULL
+ */
+GeometryBvh* geometry_bvh_create(const AircraftComponent* components, int component_count) {
+    if (component_count < 0 || (component_count > 0 && !components)) {
+        return NULL;
+    }
+
+    GeometryBvh* bvh = (GeometryBvh*)malloc(sizeof(GeometryBvh));
+    if (!bvh) {
+        return NULL;
+    }
+    memset(bvh, 0, sizeof(GeometryBvh));
+    bvh->component_count = component_count;
+
+    int obstructing = 0;
+    for (int i = 0; i < component_count; i++) {
+        if (components[i].is_obstructing) obstructing++;
+    }
+    if (obstructing == 0) {
+        return bvh;
+    }
+
+    // n个图元的二叉树最多2n-1个节点
+    bvh->indices = (int*)malloc(sizeof(int) * obstructing);
+    bvh->nodes = (BvhNode*)malloc(sizeof(BvhNode) * (2 * obstructing - 1));
+    BoundingBox* component_bounds = (BoundingBox*)malloc(sizeof(BoundingBox) * component_count);
+    Vector3D* centroids = (Vector3D*)malloc(sizeof(Vector3D) * component_count);
+
+    if (!bvh->indices || !bvh->nodes || !component_bounds || !centroids) {
+        free(component_bounds);
+        free(centroids);
+        geometry_bvh_destroy(bvh);
+        error_set(ERROR_MEMORY, "BVH内存分配失败", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+
+    for (int i = 0; i < component_count; i++) {
+        if (!components[i].is_obstructing) continue;
+
+        component_world_bounds(&components[i], &component_bounds[i]);
+        centroids[i] = components[i].position;
+        bvh->indices[bvh->index_count++] = i;
+    }
+
+    BvhBuilder builder = {bvh, component_bounds, centroids};
+    bvh->node_count = 1;
+    bvh_build_node(&builder, 0, 0, bvh->index_count);
+
+    free(component_bounds);
+    free(centroids);
+    return bvh;
+}
+
+/**
+ * @brief 销毁BVH
+ * @param bvh BVH
+ */
+void geometry_bvh_destroy(GeometryBvh* bvh) {
+    if (!bvh) {
+        return;
+    }
+
+    free(bvh->nodes);
+    free(bvh->indices);
+    free(bvh);
+}
+
+/**
+ * @brief 部件位姿变化后更新包围盒 (保持树结构，不申请内存)
+ * @param bvh BVH
+ * @param components 部件数组 (须与构建时一一对应)
+ * @param component_count 部件数量
+ * @return 成功返回1，部件数量不匹配返回0
+ */
+int geometry_bvh_refit(GeometryBvh* bvh, const AircraftComponent* components, int component_count) {
+    if (!bvh || component_count != bvh->component_count) {
+        return 0;
+    }
+
+    // 子节点下标总是大于父节点，逆序遍历即自底向上
+    for (int n = bvh->node_count - 1; n >= 0; n--) {
+        BvhNode* node = &bvh->nodes[n];
+        bounds_reset(&node->bounds);
+
+        if (node->count > 0) {
+            for (int i = node->first; i < node->first + node->count; i++) {
+                BoundingBox bounds;
+                component_world_bounds(&components[bvh->indices[i]], &bounds);
+                bounds_merge(&node->bounds, &bounds);
+            }
+        } else {
+            bounds_merge(&node->bounds, &bvh->nodes[node->first].bounds);
+            bounds_merge(&node->bounds, &bvh->nodes[node->first + 1].bounds);
+        }
+    }
+
+    return 1;
+}
+
+/* =================== 查询 =================== */
+
+static Vector3D ray_inverse_direction(const Ray* ray) {
+    return vector3d_create(1.0 / ray->direction.x, 1.0 / ray->direction.y, 1.0 / ray->direction.z);
+}
+
+/**
+ * @brief 任意命中查询 (遮挡判断，找到第一个交点即返回)
+ * @param bvh BVH
+ * @param components 部件数组
+ * @param ray 射线
+ * @return 1表示射线被遮挡，0表示未遮挡
+ */
+int geometry_bvh_intersect_any(const GeometryBvh* bvh, const AircraftComponent* components,
+                               const Ray* ray) {
+    if (!bvh || !components || !ray || bvh->node_count == 0) {
+        return 0;
+    }
+
+    Vector3D inv_direction = ray_inverse_direction(ray);
+    int stack[BVH_STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const BvhNode* node = &bvh->nodes[stack[--top]];
+        double t_near;
+        if (!ray_aabb_intersection(&node->bounds, &ray->origin, &inv_direction, ray->length, &t_near)) {
+            continue;
+        }
+
+        if (node->count > 0) {
+            for (int i = node->first; i < node->first + node->count; i++) {
+                if (ray_component_intersection(ray, &components[bvh->indices[i]], NULL, NULL)) {
+                    return 1;
+                }
+            }
+        } else {
+            stack[top++] = node->first;
+            stack[top++] = node->first + 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 最近命中查询
+ * @param bvh BVH
+ * @param components 部件数组
+ * @param ray 射线
+ * @param intersection 最近交点 (输出，可为NULL)
+ * @param distance 最近距离 (输出，可为NULL)
+ * @param component_index 命中部件下标 (输出，可为NULL)
+ * @return 1表示有交点，0表示无交点
+ */
+int geometry_bvh_intersect_closest(const GeometryBvh* bvh, const AircraftComponent* components,
+                                   const Ray* ray, Vector3D* intersection, double* distance,
+                                   int* component_index) {
+    if (!bvh || !components || !ray || bvh->node_count == 0) {
+        return 0;
+    }
+
+    Vector3D inv_direction = ray_inverse_direction(ray);
+    double closest = ray->length;
+    int hit = -1;
+    Vector3D closest_point = vector3d_create(0.0, 0.0, 0.0);
+
+    int stack[BVH_STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const BvhNode* node = &bvh->nodes[stack[--top]];
+        double t_near;
+        if (!ray_aabb_intersection(&node->bounds, &ray->origin, &inv_direction, closest, &t_near)) {
+            continue;
+        }
+
+        if (node->count > 0) {
+            for (int i = node->first; i < node->first + node->count; i++) {
+                int index = bvh->indices[i];
+                Vector3D point;
+                // 距离相同时取下标小的部件，与线性遍历结果一致
+                double t;
+                if (ray_component_intersection(ray, &components[index], &point, &t) &&
+                    (t < closest || (t == closest && index < hit))) {
+                    closest = t;
+                    closest_point = point;
+                    hit = index;
+                }
+            }
+            continue;
+        }
+
+        // 近的子节点后入栈先遍历，尽早收紧最近距离
+        int near_child = node->first;
+        int far_child = node->first + 1;
+        double t_left, t_right;
+        int left_hit = ray_aabb_intersection(&bvh->nodes[near_child].bounds, &ray->origin,
+                                             &inv_direction, closest, &t_left);
+        int right_hit = ray_aabb_intersection(&bvh->nodes[far_child].bounds, &ray->origin,
+                                              &inv_direction, closest, &t_right);
+        if (left_hit && right_hit && t_right < t_left) {
+            near_child = node->first + 1;
+            far_child = node->first;
+        }
+        if (left_hit && right_hit) {
+            stack[top++] = far_child;
+            stack[top++] = near_child;
+        } else if (left_hit) {
+            stack[top++] = node->first;
+        } else if (right_hit) {
+            stack[top++] = node->first + 1;
+        }
+    }
+
+    if (hit < 0) {
+        return 0;
+    }
+
+    if (intersection) *intersection = closest_point;
+    if (distance) *distance = closest;
+    if (component_index) *component_index = hit;
+    return 1;
+}
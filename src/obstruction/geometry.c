@@ -167,6 +167,66 @@ RotationMatrix rotation_matrix_multiply(const RotationMatrix* m1, const Rotation
     return result;
 }
 
+/**
+ * @brief 旋转矩阵转置 (正交矩阵的逆)
+ * @param matrix 旋转矩阵
+ * @return 转置矩阵
+ */
+RotationMatrix rotation_matrix_transpose(const RotationMatrix* matrix) {
+    RotationMatrix result;
+    
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            result.m[i][j] = matrix->m[j][i];
+        }
+    }
+    
+    return result;
+}
+
+/**
+ * @brief 直接设置部件变换缓存 (同一姿态下多个部件共用一个矩阵时避免重复计算三角函数)
+ * @param component 飞机部件
+ * @param local_to_world 与component->rotation对应的旋转矩阵
+ */
+void aircraft_component_set_transform(AircraftComponent* component, const RotationMatrix* local_to_world) {
+    if (!component || !local_to_world) {
+        return;
+    }
+    
+    component->local_to_world = *local_to_world;
+    component->world_to_local = rotation_matrix_transpose(local_to_world);
+    component->cached_rotation = component->rotation;
+    component->transform_cached = 1;
+}
+
+/**
+ * @brief 按部件当前欧拉角刷新变换缓存 (未变化时不重新计算)
+ * @param component 飞机部件
+ */
+void aircraft_component_update_transform(AircraftComponent* component) {
+    if (!component || aircraft_component_transform_is_current(component)) {
+        return;
+    }
+    
+    RotationMatrix local_to_world = rotation_matrix_create_from_euler(
+        component->rotation.x, component->rotation.y, component->rotation.z
+    );
+    aircraft_component_set_transform(component, &local_to_world);
+}
+
+/**
+ * @brief 检查部件变换缓存是否与当前欧拉角一致
+ * @param component 飞机部件
+ * @return 一致返回1，否则返回0
+ */
+int aircraft_component_transform_is_current(const AircraftComponent* component) {
+    return component->transform_cached &&
+           component->cached_rotation.x == component->rotation.x &&
+           component->cached_rotation.y == component->rotation.y &&
+           component->cached_rotation.z == component->rotation.z;
+}
+
 /**
  * @brief 射线与长方体相交检测
  * @param ray 射线
@@ -281,36 +341,33 @@ int ray_box_intersection(const Ray* ray, const ObstructionBody* box,
  */
 int ray_component_intersection(const Ray* ray, const AircraftComponent* component,
                                Vector3D* intersection, double* distance) {
-    // 创建遮挡体
+    // 优先使用缓存的变换，缓存缺失或过期时临时计算
+    RotationMatrix local_to_world, world_to_local;
+    const RotationMatrix* to_world = &component->local_to_world;
+    const RotationMatrix* to_local = &component->world_to_local;
+    
+    if (!aircraft_component_transform_is_current(component)) {
+        local_to_world = rotation_matrix_create_from_euler(
+            component->rotation.x, component->rotation.y, component->rotation.z
+        );
+        world_to_local = rotation_matrix_transpose(&local_to_world);
+        to_world = &local_to_world;
+        to_local = &world_to_local;
+    }
+    
+    // 局部坐标系中部件以原点为中心
     ObstructionBody body;
-    body.center = component->position;
+    body.center = vector3d_create(0.0, 0.0, 0.0);
     body.size = component->size;
-    body.rotation = rotation_matrix_create_from_euler(
-        component->rotation.x, component->rotation.y, component->rotation.z
-    );
+    body.rotation = *to_world;
     body.part_type = component->part_type;
     
     // 将射线转换到部件的局部坐标系
     Vector3D local_origin = vector3d_subtract(&ray->origin, &component->position);
     
-    // 逆旋转射线
-    RotationMatrix inv_rotation = body.rotation;
-    // 简化处理：假设旋转矩阵的逆等于转置
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < i; j++) {
-            double temp = inv_rotation.m[i][j];
-            inv_rotation.m[i][j] = inv_rotation.m[j][i];
-            inv_rotation.m[j][i] = temp;
-        }
-    }
-    
-    Vector3D local_direction = vector3d_rotate(&ray->direction, &inv_rotation);
-    Vector3D rotated_origin = vector3d_rotate(&local_origin, &inv_rotation);
-    
-    // 创建局部射线
     Ray local_ray;
-    local_ray.origin = rotated_origin;
-    local_ray.direction = local_direction;
+    local_ray.origin = vector3d_rotate(&local_origin, to_local);
+    local_ray.direction = vector3d_rotate(&ray->direction, to_local);
     local_ray.length = ray->length;
     
     // 检测相交
@@ -323,7 +380,7 @@ int ray_component_intersection(const Ray* ray, const AircraftComponent* componen
     
     // 将交点转换回世界坐标系
     if (intersection) {
-        Vector3D world_intersection = vector3d_rotate(&local_intersection, &body.rotation);
+        Vector3D world_intersection = vector3d_rotate(&local_intersection, to_world);
         *intersection = vector3d_add(&world_intersection, &component->position);
     }
     
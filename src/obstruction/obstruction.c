@@ -1,4 +1,5 @@
 #include "obstruction.h"
+#include "../utils/utils.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -33,7 +34,7 @@ static Ray create_satellite_ray(const SatellitePosition* satellite_pos, const Ve
  * @param part_type 遮挡部件类型
  * @return 信号衰减 (dB)
  */
-static double calculate_signal_loss(double obstruction_distance, AircraftPart part_type) {
+double obstruction_signal_loss(double obstruction_distance, AircraftPart part_type) {
     // 基础衰减系数
     double base_loss = 0.0;
     
@@ -91,113 +92,594 @@ static double calculate_obstruction_angle(const Vector3D* intersection,
     if (dot_product < -1.0) dot_product = -1.0;
     
     // 计算角度
-    double angle_rad = acos(dot_product);
+    double angle_rad = math_acos(dot_product);
     return angle_rad * 180.0 / M_PI;
 }
 
+/* 旧接口每次调用在栈上变换的部件数上限，超出时临时申请一次堆内存 */
+#define OBSTRUCTION_STACK_COMPONENTS 32
+
 /**
- * @brief 遮挡计算核心函数
- * @param geometry 飞机几何模型
- * @param satellite_pos 卫星位置
- * @param aircraft_state 飞机状态
- * @param params 计算参数
- * @param result 计算结果
+ * @brief 初始化变换几何模型 (使用调用方提供的存储)
+ * @param transformed 变换几何模型
+ * @param storage 部件存储
+ * @param capacity 存储容量 (部件数)
  * @return 成功返回1，失败返回0
  */
-int obstruction_calculate(const AircraftGeometry* geometry,
-                         const SatellitePosition* satellite_pos,
-                         const AircraftState* aircraft_state,
-                         const ObstructionParams* params,
-                         ObstructionResult* result) {
-    if (!geometry || !satellite_pos || !aircraft_state || !params || !result) {
+int transformed_geometry_init(TransformedGeometry* transformed,
+                              AircraftComponent* storage, int capacity) {
+    if (!transformed || capacity < 0 || (capacity > 0 && !storage)) {
         return 0;
     }
     
-    // 初始化结果
-    memset(result, 0, sizeof(ObstructionResult));
-    result->is_obstructed = 0;
+    memset(transformed, 0, sizeof(TransformedGeometry));
+    transformed->components = storage;
+    transformed->capacity = capacity;
+    transformed->owns_storage = 0;
+    
+    return 1;
+}
+
+/**
+ * @brief 创建变换几何模型 (一次性分配存储，之后可反复更新)
+ * @param capacity 存储容量 (部件数)
+ * @return 创建的变换几何模型
+ */
+TransformedGeometry* transformed_geometry_create(int capacity) {
+    if (capacity < 0) {
+        return NULL;
+    }
     
-    // 更新飞机几何模型的位置和姿态
-    AircraftGeometry* updated_geometry = aircraft_geometry_create(geometry->model_type);
-    if (!updated_geometry) {
+    TransformedGeometry* transformed = (TransformedGeometry*)malloc(sizeof(TransformedGeometry));
+    if (!transformed) {
+        return NULL;
+    }
+    
+    AircraftComponent* storage = NULL;
+    if (capacity > 0) {
+        storage = (AircraftComponent*)malloc(sizeof(AircraftComponent) * capacity);
+        if (!storage) {
+            free(transformed);
+            return NULL;
+        }
+    }
+    
+    transformed_geometry_init(transformed, storage, capacity);
+    transformed->owns_storage = 1;
+    
+    return transformed;
+}
+
+/**
+ * @brief 销毁变换几何模型
+ * @param transformed 变换几何模型
+ */
+void transformed_geometry_destroy(TransformedGeometry* transformed) {
+    if (!transformed) {
+        return;
+    }
+    
+    if (transformed->owns_storage && transformed->components) {
+        free(transformed->components);
+    }
+    
+    free(transformed);
+}
+
+/**
+ * @brief 按飞机姿态变换几何模型
+ * @param transformed 变换几何模型 (输出)
+ * @param geometry 源几何模型
+ * @param attitude 飞机姿态
+ * @return 成功返回1，存储不足或参数无效返回0
+ */
+int transformed_geometry_update(TransformedGeometry* transformed,
+                                const AircraftGeometry* geometry,
+                                const AircraftAttitude* attitude) {
+    if (!transformed || !geometry || !attitude) {
         return 0;
     }
     
-    // 复制部件信息
-    updated_geometry->component_count = geometry->component_count;
-    updated_geometry->components = (AircraftComponent*)malloc(
-        sizeof(AircraftComponent) * geometry->component_count);
+    if (geometry->component_count > transformed->capacity) {
+        error_set(ERROR_MEMORY, "变换几何模型存储不足", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+    
+    transformed->model_type = geometry->model_type;
+    transformed->component_count = geometry->component_count;
+    transformed->geometry = geometry;
+    transformed->geometry_version = geometry->version;
+    transformed->antenna_position = geometry->antenna_position;
+    
+    // antenna_position为主天线，其余天线依次排在后面
+    transformed->antenna_count = geometry->antenna_count > 0 ? geometry->antenna_count : 1;
+    transformed->antennas[0] = geometry->antenna_position;
+    for (int i = 1; i < transformed->antenna_count; i++) {
+        transformed->antennas[i] = geometry->antennas[i];
+    }
+    
+    // 所有部件共用同一姿态，旋转矩阵只计算一次
+    RotationMatrix local_to_world = rotation_matrix_create_from_euler(
+        attitude->pitch, attitude->roll, attitude->yaw
+    );
+    
+    // 网格随机体整体旋转，求交时把射线变换到机体坐标系，网格本身不需要复制
+    transformed->mesh = geometry->mesh;
+    transformed->body_to_world = local_to_world;
+    transformed->world_to_body = rotation_matrix_transpose(&local_to_world);
     
-    if (!updated_geometry->components) {
-        aircraft_geometry_destroy(updated_geometry);
+    // 部件与网格同属一个刚体：朝向和相对机体中心的位置一起随姿态旋转，写入调用方存储
+    for (int i = 0; i < geometry->component_count; i++) {
+        AircraftComponent* component = &transformed->components[i];
+        *component = geometry->components[i];
+        component->position = vector3d_rotate(&geometry->components[i].position, &local_to_world);
+        component->rotation.x = attitude->pitch;
+        component->rotation.y = attitude->roll;
+        component->rotation.z = attitude->yaw;
+        aircraft_component_set_transform(component, &local_to_world);
+    }
+    
+    // 树结构不变，只按新姿态更新包围盒
+    if (transformed->bvh && !geometry_bvh_refit(transformed->bvh, transformed->components,
+                                                transformed->component_count)) {
+        error_set(ERROR_PARAMETER, "BVH与几何模型部件数量不一致", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+    
+    // 掩码只在几何模型或天线位置变化后重建
+    if (transformed->mask && !obstruction_mask_update(transformed->mask, geometry)) {
+        return 0;
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief 为变换几何模型挂接遮挡掩码 (由调用方创建和销毁)
+ * @param transformed 变换几何模型
+ * @param mask 遮挡掩码，NULL表示取消挂接
+ * @return 成功返回1，失败返回0
+ * @note 挂接后在transformed_geometry_update时按需重建；params->precision不低于掩码分辨率时
+ *       查表代替部件和网格的射线求交
+ */
+int transformed_geometry_set_mask(TransformedGeometry* transformed, ObstructionMask* mask) {
+    if (!transformed) {
+        return 0;
+    }
+    
+    transformed->mask = mask;
+    return 1;
+}
+
+/**
+ * @brief 把卫星射线变换到网格所在的机体坐标系 (天线随机体旋转，射线原点不变)
+ * @param transformed 变换几何模型
+ * @param ray 卫星射线
+ * @return 机体坐标系中的射线
+ */
+static Ray mesh_body_ray(const TransformedGeometry* transformed, const Ray* ray) {
+    Ray body_ray = *ray;
+    body_ray.direction = vector3d_rotate(&ray->direction, &transformed->world_to_body);
+    return body_ray;
+}
+
+/**
+ * @brief 把卫星射线的原点 (机体坐标系中的天线) 随机体旋转到部件所在的世界坐标系
+ * @param transformed 变换几何模型
+ * @param ray 卫星射线
+ * @return 世界坐标系中的射线
+ */
+static Ray component_world_ray(const TransformedGeometry* transformed, const Ray* ray) {
+    Ray world_ray = *ray;
+    world_ray.origin = vector3d_rotate(&ray->origin, &transformed->body_to_world);
+    return world_ray;
+}
+
+/**
+ * @brief 为变换几何模型挂接BVH (由调用方创建和销毁)
+ * @param transformed 变换几何模型
+ * @param bvh 在同一几何模型部件上构建的BVH，NULL表示取消挂接
+ * @return 成功返回1，失败返回0
+ */
+int transformed_geometry_set_bvh(TransformedGeometry* transformed, GeometryBvh* bvh) {
+    if (!transformed) {
         return 0;
     }
     
-    memcpy(updated_geometry->components, geometry->components, 
-           sizeof(AircraftComponent) * geometry->component_count);
+    transformed->bvh = bvh;
+    if (bvh && transformed->component_count > 0) {
+        return geometry_bvh_refit(bvh, transformed->components, transformed->component_count);
+    }
     
-    // 更新几何变换
-    if (!aircraft_geometry_update_transform(updated_geometry, &aircraft_state->attitude)) {
-        aircraft_geometry_destroy(updated_geometry);
+    return 1;
+}
+
+/**
+ * @brief 判断卫星射线是否被任一部件遮挡 (命中即返回，不计算最近交点)
+ * @param transformed 变换几何模型
+ * @param satellite_pos 卫星位置
+ * @return 被遮挡返回1，否则返回0
+ */
+int obstruction_ray_blocked(const TransformedGeometry* transformed,
+                            const SatellitePosition* satellite_pos) {
+    if (!transformed || !satellite_pos) {
         return 0;
     }
     
-    // 计算天线位置
-    Vector3D antenna_pos = updated_geometry->antenna_position;
+    Ray satellite_ray = create_satellite_ray(satellite_pos, &transformed->antenna_position);
+    
+    if (transformed->mesh) {
+        Ray body_ray = mesh_body_ray(transformed, &satellite_ray);
+        if (triangle_mesh_intersect_any(transformed->mesh, &body_ray)) {
+            return 1;
+        }
+    }
+    
+    Ray world_ray = component_world_ray(transformed, &satellite_ray);
+    if (transformed->bvh) {
+        return geometry_bvh_intersect_any(transformed->bvh, transformed->components, &world_ray);
+    }
+    
+    for (int i = 0; i < transformed->component_count; i++) {
+        const AircraftComponent* component = &transformed->components[i];
+        if (component->is_obstructing &&
+            ray_component_intersection(&world_ray, component, NULL, NULL)) {
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief 对长方体部件做射线求交 (部件随机体整体旋转)
+ * @param transformed 变换几何模型
+ * @param satellite_ray 卫星射线
+ * @param distance 最近遮挡距离 (输入为射线长度，有遮挡时输出)
+ * @param intersection 最近交点 (输出，沿原射线取，与网格交点处于同一坐标系)
+ * @param part_type 遮挡部件 (输出)
+ * @return 有遮挡返回1，否则返回0
+ */
+static int raycast_components(const TransformedGeometry* transformed, const Ray* satellite_ray,
+                              double* distance, Vector3D* intersection, AircraftPart* part_type) {
+    Ray world_ray = component_world_ray(transformed, satellite_ray);
+    int found_obstruction = 0;
+    
+    if (transformed->bvh) {
+        // 层次包围盒最近命中查询
+        int index;
+        double hit_distance;
+        if (geometry_bvh_intersect_closest(transformed->bvh, transformed->components,
+                                           &world_ray, NULL, &hit_distance, &index)) {
+            *distance = hit_distance;
+            *part_type = transformed->components[index].part_type;
+            found_obstruction = 1;
+        }
+    } else {
+        for (int i = 0; i < transformed->component_count; i++) {
+            const AircraftComponent* component = &transformed->components[i];
+            
+            if (!component->is_obstructing) {
+                continue; // 跳过不产生遮挡的部件
+            }
+            
+            double hit_distance;
+            
+            if (ray_component_intersection(&world_ray, component, NULL, &hit_distance)) {
+                if (hit_distance < *distance) {
+                    *distance = hit_distance;
+                    *part_type = component->part_type;
+                    found_obstruction = 1;
+                }
+            }
+        }
+    }
+    
+    if (found_obstruction) {
+        Vector3D offset = vector3d_multiply(&satellite_ray->direction, *distance);
+        *intersection = vector3d_add(&satellite_ray->origin, &offset);
+    }
+    return found_obstruction;
+}
+
+/**
+ * @brief 对变换几何模型做射线求交 (部件 + 三角网格)
+ * @param transformed 变换几何模型
+ * @param satellite_ray 卫星射线
+ * @param distance 最近遮挡距离 (输出)
+ * @param intersection 最近交点 (输出)
+ * @param part_type 遮挡部件 (输出)
+ * @return 有遮挡返回1，否则返回0
+ */
+static int raycast_transformed(const TransformedGeometry* transformed, const Ray* satellite_ray,
+                               double* distance, Vector3D* intersection, AircraftPart* part_type) {
+    // 检测与所有部件的相交
+    double min_distance = satellite_ray->length;
+    Vector3D closest_intersection = vector3d_create(0.0, 0.0, 0.0);
+    AircraftPart closest_part = AIRCRAFT_PART_FUSELAGE;
+    int found_obstruction = raycast_components(transformed, satellite_ray, &min_distance,
+                                               &closest_intersection, &closest_part);
+    
+    // 三角网格：交点沿原射线取，与部件交点处于同一坐标系
+    if (transformed->mesh) {
+        Ray body_ray = mesh_body_ray(transformed, satellite_ray);
+        double mesh_distance;
+        AircraftPart mesh_part;
+        if (triangle_mesh_intersect_closest(transformed->mesh, &body_ray, &mesh_distance, &mesh_part) &&
+            (!found_obstruction || mesh_distance < min_distance)) {
+            Vector3D offset = vector3d_multiply(&satellite_ray->direction, mesh_distance);
+            min_distance = mesh_distance;
+            closest_intersection = vector3d_add(&satellite_ray->origin, &offset);
+            closest_part = mesh_part;
+            found_obstruction = 1;
+        }
+    }
+    
+    if (found_obstruction) {
+        *distance = min_distance;
+        *intersection = closest_intersection;
+        *part_type = closest_part;
+    }
+    return found_obstruction;
+}
+
+/**
+ * @brief 检查掩码是否可用于指定天线 (掩码只对构建时的天线位置有效)
+ * @param transformed 变换几何模型
+ * @param antenna_pos 天线位置
+ * @param params 计算参数
+ * @return 可以查表返回1，否则返回0
+ */
+static int mask_applies(const TransformedGeometry* transformed, const Vector3D* antenna_pos,
+                        const ObstructionParams* params) {
+    const ObstructionMask* mask = transformed->mask;
+    return mask && mask->valid && params->precision >= OBSTRUCTION_MASK_RESOLUTION &&
+           mask->antenna_position.x == antenna_pos->x &&
+           mask->antenna_position.y == antenna_pos->y &&
+           mask->antenna_position.z == antenna_pos->z;
+}
+
+/**
+ * @brief 按最近遮挡填充遮挡计算结果
+ * @param antenna_pos 天线位置
+ * @param satellite_pos 卫星位置
+ * @param params 计算参数
+ * @param distance 遮挡距离
+ * @param intersection 交点
+ * @param part_type 遮挡部件
+ * @param signal_loss 信号损失 (dB)
+ * @param result 计算结果
+ */
+static void obstruction_fill_result(const Vector3D* antenna_pos, const SatellitePosition* satellite_pos,
+                                    const ObstructionParams* params, double distance,
+                                    const Vector3D* intersection, AircraftPart part_type,
+                                    double signal_loss, ObstructionResult* result) {
+    result->is_obstructed = 1;
+    result->obstruction_distance = distance;
+    result->intersection_point = *intersection;
+    result->obstruction_part = part_type;
+    
+    // 计算遮挡角度
+    result->obstruction_angle = calculate_obstruction_angle(intersection, antenna_pos, satellite_pos);
+    result->signal_loss = signal_loss;
+    
+    // 检查是否超过最小遮挡角度阈值
+    if (result->obstruction_angle < params->min_obstruction_angle) {
+        result->is_obstructed = 0;
+    }
+}
+
+/**
+ * @brief 计算指定天线位置对单颗卫星的遮挡
+ * @param transformed 变换几何模型
+ * @param antenna_pos 天线位置
+ * @param satellite_pos 卫星位置
+ * @param params 计算参数
+ * @param result 计算结果
+ * @return 成功返回1，失败返回0
+ */
+static int obstruction_calculate_from(const TransformedGeometry* transformed,
+                                      Vector3D antenna_pos,
+                                      const SatellitePosition* satellite_pos,
+                                      const ObstructionParams* params,
+                                      ObstructionResult* result) {
+    // 初始化结果
+    memset(result, 0, sizeof(ObstructionResult));
+    result->is_obstructed = 0;
     
     // 创建卫星射线
     Ray satellite_ray = create_satellite_ray(satellite_pos, &antenna_pos);
     
-    // 检测与所有部件的相交
     double min_distance = satellite_ray.length;
-    int found_obstruction = 0;
     Vector3D closest_intersection;
     AircraftPart closest_part = AIRCRAFT_PART_FUSELAGE;
+    int found_obstruction;
+    ObstructionMaskCell cell;
+    int use_mask = 0;
     
-    for (int i = 0; i < updated_geometry->component_count; i++) {
-        AircraftComponent* component = &updated_geometry->components[i];
-        
-        if (!component->is_obstructing) {
-            continue; // 跳过不产生遮挡的部件
-        }
-        
-        Vector3D intersection;
-        double distance;
-        
-        if (ray_component_intersection(&satellite_ray, component, &intersection, &distance)) {
-            if (distance < min_distance) {
-                min_distance = distance;
-                closest_intersection = intersection;
-                closest_part = component->part_type;
-                found_obstruction = 1;
-            }
+    if (mask_applies(transformed, &antenna_pos, params)) {
+        // 掩码模式：视线旋转到机体坐标系后查表，部件和网格都不再求交
+        Vector3D body_direction = vector3d_rotate(&satellite_ray.direction, &transformed->world_to_body);
+        use_mask = obstruction_mask_lookup(transformed->mask, &body_direction, &cell);
+        found_obstruction = use_mask && cell.blocked;
+        if (found_obstruction) {
+            Vector3D offset = vector3d_multiply(&satellite_ray.direction, cell.distance);
+            min_distance = cell.distance;
+            closest_intersection = vector3d_add(&satellite_ray.origin, &offset);
+            closest_part = (AircraftPart)cell.part_type;
         }
+    } else {
+        found_obstruction = raycast_transformed(transformed, &satellite_ray, &min_distance,
+                                                &closest_intersection, &closest_part);
     }
     
-    // 填充结果
+    // 填充结果 (掩码中已预先计算信号衰减)
     if (found_obstruction) {
-        result->is_obstructed = 1;
-        result->obstruction_distance = min_distance;
-        result->intersection_point = closest_intersection;
-        result->obstruction_part = closest_part;
-        
-        // 计算遮挡角度
-        result->obstruction_angle = calculate_obstruction_angle(
-            &closest_intersection, &antenna_pos, satellite_pos);
-        
-        // 计算信号衰减
-        result->signal_loss = calculate_signal_loss(min_distance, closest_part);
-        
-        // 检查是否超过最小遮挡角度阈值
-        if (result->obstruction_angle < params->min_obstruction_angle) {
-            result->is_obstructed = 0;
+        double signal_loss = use_mask ? cell.signal_loss : obstruction_signal_loss(min_distance, closest_part);
+        obstruction_fill_result(&antenna_pos, satellite_pos, params, min_distance,
+                                &closest_intersection, closest_part, signal_loss, result);
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief 对已变换的几何模型计算单颗卫星的遮挡 (不申请堆内存)
+ * @param transformed 变换几何模型
+ * @param satellite_pos 卫星位置
+ * @param params 计算参数
+ * @param result 计算结果
+ * @return 成功返回1，失败返回0
+ */
+int obstruction_calculate_transformed(const TransformedGeometry* transformed,
+                                     const SatellitePosition* satellite_pos,
+                                     const ObstructionParams* params,
+                                     ObstructionResult* result) {
+    if (!transformed || !satellite_pos || !params || !result) {
+        return 0;
+    }
+    
+    return obstruction_calculate_from(transformed, transformed->antenna_position,
+                                      satellite_pos, params, result);
+}
+
+/**
+ * @brief 计算指定天线对单颗卫星的遮挡
+ * @param transformed 变换几何模型
+ * @param antenna_index 天线下标 (0为主天线)
+ * @param satellite_pos 卫星位置
+ * @param params 计算参数
+ * @param result 计算结果
+ * @return 成功返回1，失败返回0
+ */
+int obstruction_calculate_antenna(const TransformedGeometry* transformed,
+                                  int antenna_index,
+                                  const SatellitePosition* satellite_pos,
+                                  const ObstructionParams* params,
+                                  ObstructionResult* result) {
+    if (!transformed || !satellite_pos || !params || !result) {
+        return 0;
+    }
+    
+    if (antenna_index < 0 || antenna_index >= transformed->antenna_count) {
+        error_set(ERROR_PARAMETER, "天线下标超出范围", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+    
+    return obstruction_calculate_from(transformed, transformed->antennas[antenna_index],
+                                      satellite_pos, params, result);
+}
+
+/**
+ * @brief 同一姿态下批量计算多颗卫星的遮挡 (主天线，SoA射线包一次求交)
+ * @param transformed 变换几何模型
+ * @param satellite_positions 卫星位置数组
+ * @param count 卫星数量
+ * @param params 计算参数
+ * @param packet 射线包 (容量不小于count，可在多次调用间复用)
+ * @param results 计算结果数组
+ * @return 成功返回1，失败返回0
+ * @note 结果与逐颗调用obstruction_calculate_transformed一致；部件交点沿射线取，
+ *       与逐颗计算的交点只在舍入误差内不同
+ */
+int obstruction_calculate_packet(const TransformedGeometry* transformed,
+                                 const SatellitePosition* satellite_positions, int count,
+                                 const ObstructionParams* params,
+                                 RayPacket* packet, ObstructionResult* results) {
+    if (!transformed || !params || !packet || count < 0 ||
+        (count > 0 && (!satellite_positions || !results))) {
+        return 0;
+    }
+    
+    if (count > packet->capacity) {
+        error_set(ERROR_PARAMETER, "射线包容量不足", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+    
+    Vector3D antenna_pos = transformed->antenna_position;
+    
+    // 掩码查表比求交更快，可用时逐颗查表
+    if (mask_applies(transformed, &antenna_pos, params)) {
+        for (int i = 0; i < count; i++) {
+            obstruction_calculate_from(transformed, antenna_pos, &satellite_positions[i], params, &results[i]);
+        }
+        return 1;
+    }
+    
+    ray_packet_reset(packet, &antenna_pos);
+    for (int i = 0; i < count; i++) {
+        Ray satellite_ray = create_satellite_ray(&satellite_positions[i], &antenna_pos);
+        packet->dx[i] = satellite_ray.direction.x;
+        packet->dy[i] = satellite_ray.direction.y;
+        packet->dz[i] = satellite_ray.direction.z;
+        packet->length[i] = satellite_ray.length;
+    }
+    packet->count = count;
+    
+    ray_packet_intersect_transformed(packet, transformed);
+    
+    for (int i = 0; i < count; i++) {
+        ObstructionResult* result = &results[i];
+        memset(result, 0, sizeof(ObstructionResult));
+        if (!packet->blocked[i]) {
+            continue;
         }
+        
+        double distance = packet->distance[i];
+        AircraftPart part = (AircraftPart)packet->part_type[i];
+        Vector3D intersection = vector3d_create(antenna_pos.x + packet->dx[i] * distance,
+                                                antenna_pos.y + packet->dy[i] * distance,
+                                                antenna_pos.z + packet->dz[i] * distance);
+        obstruction_fill_result(&antenna_pos, &satellite_positions[i], params, distance, &intersection,
+                                part, obstruction_signal_loss(distance, part), result);
     }
     
-    aircraft_geometry_destroy(updated_geometry);
     return 1;
 }
 
+/**
+ * @brief 遮挡计算核心函数
+ * @param geometry 飞机几何模型
+ * @param satellite_pos 卫星位置
+ * @param aircraft_state 飞机状态
+ * @param params 计算参数
+ * @param result 计算结果
+ * @return 成功返回1，失败返回0
+ * @note 多颗卫星共享同一姿态时应使用transformed_geometry_update +
+ *       obstruction_calculate_transformed，避免每颗卫星重复变换
+ */
+int obstruction_calculate(const AircraftGeometry* geometry,
+                         const SatellitePosition* satellite_pos,
+                         const AircraftState* aircraft_state,
+                         const ObstructionParams* params,
+                         ObstructionResult* result) {
+    if (!geometry || !satellite_pos || !aircraft_state || !params || !result) {
+        return 0;
+    }
+    
+    // 部件较少时直接在栈上变换
+    AircraftComponent stack_components[OBSTRUCTION_STACK_COMPONENTS];
+    AircraftComponent* storage = stack_components;
+    int capacity = OBSTRUCTION_STACK_COMPONENTS;
+    if (geometry->component_count > OBSTRUCTION_STACK_COMPONENTS) {
+        capacity = geometry->component_count;
+        storage = (AircraftComponent*)malloc(sizeof(AircraftComponent) * capacity);
+        if (!storage) {
+            return 0;
+        }
+    }
+    
+    TransformedGeometry transformed;
+    int ok = transformed_geometry_init(&transformed, storage, capacity) &&
+             transformed_geometry_update(&transformed, geometry, &aircraft_state->attitude) &&
+             obstruction_calculate_transformed(&transformed, satellite_pos, params, result);
+    
+    if (storage != stack_components) {
+        free(storage);
+    }
+    return ok;
+}
+
 /**
  * @brief 创建飞机几何模型
  * @param model_type 飞机模型类型
@@ -217,6 +699,8 @@ AircraftGeometry* aircraft_geometry_create(AircraftModelType model_type) {
     
     // 设置默认天线位置（在飞机顶部）
     geometry->antenna_position = vector3d_create(0.0, 0.0, 2.0);
+    geometry->antennas[0] = geometry->antenna_position;
+    geometry->antenna_count = 1;
     
     return geometry;
 }
@@ -234,6 +718,7 @@ void aircraft_geometry_destroy(AircraftGeometry* geometry) {
         free(geometry->components);
     }
     
+    triangle_mesh_destroy(geometry->mesh);
     free(geometry);
 }
 
@@ -261,7 +746,9 @@ int aircraft_geometry_add_component(AircraftGeometry* geometry,
     
     geometry->components = new_components;
     geometry->components[geometry->component_count] = *component;
+    aircraft_component_update_transform(&geometry->components[geometry->component_count]);
     geometry->component_count++;
+    geometry->version++;
     
     return 1;
 }
@@ -279,6 +766,34 @@ int aircraft_geometry_set_antenna_position(AircraftGeometry* geometry,
     }
     
     geometry->antenna_position = *position;
+    geometry->antennas[0] = *position;
+    geometry->version++;
+    return 1;
+}
+
+/**
+ * @brief 添加一个天线 (主天线之外)
+ * @param geometry 几何模型
+ * @param position 天线位置
+ * @return 成功返回1，失败返回0
+ */
+int aircraft_geometry_add_antenna(AircraftGeometry* geometry, const Vector3D* position) {
+    if (!geometry || !position) {
+        return 0;
+    }
+    
+    if (geometry->antenna_count < 1) {
+        geometry->antennas[0] = geometry->antenna_position;
+        geometry->antenna_count = 1;
+    }
+    
+    if (geometry->antenna_count >= AIRCRAFT_MAX_ANTENNAS) {
+        error_set(ERROR_PARAMETER, "天线数量超过上限", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+    
+    geometry->antennas[geometry->antenna_count++] = *position;
+    geometry->version++;
     return 1;
 }
 
@@ -294,46 +809,101 @@ int aircraft_geometry_update_transform(AircraftGeometry* geometry,
         return 0;
     }
     
-    // 为每个部件应用姿态变换
+    RotationMatrix local_to_world = rotation_matrix_create_from_euler(
+        attitude->pitch, attitude->roll, attitude->yaw
+    );
+    
+    // 为每个部件应用姿态变换 (姿态不是几何内容，不改变版本号)
     for (int i = 0; i < geometry->component_count; i++) {
         AircraftComponent* component = &geometry->components[i];
         
-        // 更新部件的旋转角度
+        // 更新部件的旋转角度，姿态未变化时保留已有缓存
         component->rotation.x = attitude->pitch;
         component->rotation.y = attitude->roll;
         component->rotation.z = attitude->yaw;
+        if (!aircraft_component_transform_is_current(component)) {
+            aircraft_component_set_transform(component, &local_to_world);
+        }
     }
     
     return 1;
 }
 
 /**
- * @brief 可见性分析
- * @param geometry 飞机几何模型
+ * @brief 由可见性和遮挡结果填充分析结果
+ * @param visibility 卫星可见性 (可见)
+ * @param obstruction 遮挡计算结果
+ * @param params 计算参数
+ * @param analysis 分析结果
+ */
+static void visibility_fill_analysis(const SatelliteVisibility* visibility,
+                                     const ObstructionResult* obstruction,
+                                     const ObstructionParams* params,
+                                     VisibilityAnalysis* analysis) {
+    analysis->visibility = *visibility;
+    analysis->obstruction = *obstruction;
+    
+    // 计算有效高度角和方位角
+    if (obstruction->is_obstructed) {
+        analysis->effective_elevation = visibility->elevation - obstruction->obstruction_angle;
+        analysis->effective_azimuth = visibility->azimuth;
+        analysis->is_usable = (analysis->effective_elevation > params->min_obstruction_angle);
+    } else {
+        analysis->effective_elevation = visibility->elevation;
+        analysis->effective_azimuth = visibility->azimuth;
+        analysis->is_usable = 1;
+    }
+}
+
+/**
+ * @brief 已知卫星可见性时，计算指定天线的遮挡并填充分析结果
+ * @param transformed 变换几何模型
+ * @param antenna_pos 天线位置
+ * @param visibility 卫星可见性 (须可见)
+ * @param satellite_pos 卫星位置
+ * @param params 计算参数
+ * @param analysis 分析结果
+ * @return 成功返回1，失败返回0
+ */
+static int analyze_from_antenna(const TransformedGeometry* transformed,
+                                Vector3D antenna_pos,
+                                const SatelliteVisibility* visibility,
+                                const SatellitePosition* satellite_pos,
+                                const ObstructionParams* params,
+                                VisibilityAnalysis* analysis) {
+    // 计算遮挡
+    ObstructionResult obstruction;
+    if (!obstruction_calculate_from(transformed, antenna_pos, satellite_pos, params, &obstruction)) {
+        return 0;
+    }
+    
+    visibility_fill_analysis(visibility, &obstruction, params, analysis);
+    return 1;
+}
+
+/**
+ * @brief 对已变换的几何模型进行可见性分析 (接收机坐标系由调用方预先构建)
+ * @param transformed 变换几何模型
+ * @param frame 飞机位置的接收机坐标系 (同一时刻的所有卫星共用)
  * @param satellite 卫星数据
- * @param aircraft_state 飞机状态
  * @param params 计算参数
+ * @param coherence 时间相干缓存 (可为NULL，此时每次完整求交)
  * @param analysis 分析结果
  * @return 成功返回1，失败返回0
  */
-int visibility_analyze(const AircraftGeometry* geometry,
-                      const Satellite* satellite,
-                      const AircraftState* aircraft_state,
-                      const ObstructionParams* params,
-                      VisibilityAnalysis* analysis) {
-    if (!geometry || !satellite || !aircraft_state || !params || !analysis) {
+int visibility_analyze_frame(const TransformedGeometry* transformed,
+                             const ReceiverFrame* frame,
+                             const Satellite* satellite,
+                             const ObstructionParams* params,
+                             ObstructionCoherenceCache* coherence,
+                             VisibilityAnalysis* analysis) {
+    if (!transformed || !frame || !satellite || !params || !analysis) {
         return 0;
     }
     
     // 首先计算卫星可见性
     SatelliteVisibility visibility;
-    int result = satellite_visibility_calculate(satellite, 
-                                               aircraft_state->position.latitude,
-                                               aircraft_state->position.longitude,
-                                               aircraft_state->position.altitude,
-                                               &visibility);
-    
-    if (!result) {
+    if (!receiver_frame_visibility(frame, satellite, &visibility)) {
         return 0;
     }
     
@@ -345,33 +915,85 @@ int visibility_analyze(const AircraftGeometry* geometry,
         return 1;
     }
     
-    // 创建卫星位置结构
-    SatellitePosition sat_pos = satellite->pos;
+    if (coherence) {
+        ObstructionResult obstruction;
+        if (!obstruction_coherence_calculate(coherence, transformed, satellite, params, &obstruction)) {
+            return 0;
+        }
+        visibility_fill_analysis(&visibility, &obstruction, params, analysis);
+        return 1;
+    }
     
-    // 计算遮挡
-    ObstructionResult obstruction;
-    result = obstruction_calculate(geometry, &sat_pos, aircraft_state, params, &obstruction);
+    return analyze_from_antenna(transformed, transformed->antenna_position, &visibility,
+                                &satellite->pos, params, analysis);
+}
+
+/**
+ * @brief 对已变换的几何模型进行可见性分析
+ * @param transformed 变换几何模型 (须已按aircraft_state的姿态更新)
+ * @param satellite 卫星数据
+ * @param aircraft_state 飞机状态
+ * @param params 计算参数
+ * @param analysis 分析结果
+ * @return 成功返回1，失败返回0
+ */
+int visibility_analyze_transformed(const TransformedGeometry* transformed,
+                                   const Satellite* satellite,
+                                   const AircraftState* aircraft_state,
+                                   const ObstructionParams* params,
+                                   VisibilityAnalysis* analysis) {
+    if (!transformed || !satellite || !aircraft_state || !params || !analysis) {
+        return 0;
+    }
     
-    if (!result) {
+    ReceiverFrame frame;
+    if (!receiver_frame_init(&frame, aircraft_state->position.latitude,
+                             aircraft_state->position.longitude,
+                             aircraft_state->position.altitude)) {
         return 0;
     }
     
-    // 填充分析结果
-    analysis->visibility = visibility;
-    analysis->obstruction = obstruction;
+    return visibility_analyze_frame(transformed, &frame, satellite, params, NULL, analysis);
+}
+
+/**
+ * @brief 可见性分析
+ * @param geometry 飞机几何模型
+ * @param satellite 卫星数据
+ * @param aircraft_state 飞机状态
+ * @param params 计算参数
+ * @param analysis 分析结果
+ * @return 成功返回1，失败返回0
+ */
+int visibility_analyze(const AircraftGeometry* geometry,
+                      const Satellite* satellite,
+                      const AircraftState* aircraft_state,
+                      const ObstructionParams* params,
+                      VisibilityAnalysis* analysis) {
+    if (!geometry || !satellite || !aircraft_state || !params || !analysis) {
+        return 0;
+    }
     
-    // 计算有效高度角和方位角
-    if (obstruction.is_obstructed) {
-        analysis->effective_elevation = visibility.elevation - obstruction.obstruction_angle;
-        analysis->effective_azimuth = visibility.azimuth;
-        analysis->is_usable = (analysis->effective_elevation > params->min_obstruction_angle);
-    } else {
-        analysis->effective_elevation = visibility.elevation;
-        analysis->effective_azimuth = visibility.azimuth;
-        analysis->is_usable = 1;
+    AircraftComponent stack_components[OBSTRUCTION_STACK_COMPONENTS];
+    AircraftComponent* storage = stack_components;
+    int capacity = OBSTRUCTION_STACK_COMPONENTS;
+    if (geometry->component_count > OBSTRUCTION_STACK_COMPONENTS) {
+        capacity = geometry->component_count;
+        storage = (AircraftComponent*)malloc(sizeof(AircraftComponent) * capacity);
+        if (!storage) {
+            return 0;
+        }
     }
     
-    return 1;
+    TransformedGeometry transformed;
+    int result = transformed_geometry_init(&transformed, storage, capacity) &&
+                 transformed_geometry_update(&transformed, geometry, &aircraft_state->attitude) &&
+                 visibility_analyze_transformed(&transformed, satellite, aircraft_state, params, analysis);
+    
+    if (storage != stack_components) {
+        free(storage);
+    }
+    return result;
 }
 
 /**
@@ -399,53 +1021,268 @@ int batch_obstruction_calculate(const AircraftGeometry* geometry,
     result->obstructed_satellites = 0;
     result->usable_satellites = 0;
     
-    // 分配分析结果数组
+    int satellite_count = satellite_data->satellite_count;
+    if (satellite_count <= 0) {
+        return 1;
+    }
+    
+    // 分配分析结果数组及射线包的输入输出
+    result->analyses = (VisibilityAnalysis*)malloc(sizeof(VisibilityAnalysis) * satellite_count);
+    SatellitePosition* positions = (SatellitePosition*)malloc(sizeof(SatellitePosition) * satellite_count);
+    ObstructionResult* obstructions = (ObstructionResult*)malloc(sizeof(ObstructionResult) * satellite_count);
+    int* visible_index = (int*)malloc(sizeof(int) * satellite_count);
+    RayPacket* packet = ray_packet_create(satellite_count);
+    
+    // 同一时刻所有卫星共享姿态，几何变换只做一次
+    TransformedGeometry* transformed = transformed_geometry_create(geometry->component_count);
+    ReceiverFrame frame;
+    int ready = result->analyses && positions && obstructions && visible_index && packet && transformed &&
+                transformed_geometry_update(transformed, geometry, &aircraft_state->attitude) &&
+                receiver_frame_init(&frame, aircraft_state->position.latitude,
+                                    aircraft_state->position.longitude,
+                                    aircraft_state->position.altitude);
+    
+    clock_t start_time = clock();
+    
+    // 第一遍：逐颗计算可见性，收集可见卫星
+    int visible_count = 0;
+    for (int i = 0; ready && i < satellite_count; i++) {
+        const Satellite* satellite = &satellite_data->satellites[i];
+        
+        if (!satellite->is_valid) {
+            continue;
+        }
+        
+        VisibilityAnalysis* analysis = &result->analyses[result->analysis_count];
+        SatelliteVisibility visibility;
+        if (!receiver_frame_visibility(&frame, satellite, &visibility)) {
+            continue;
+        }
+        
+        memset(analysis, 0, sizeof(VisibilityAnalysis));
+        analysis->visibility = visibility;
+        analysis->is_usable = 0;
+        if (visibility.is_visible) {
+            positions[visible_count] = satellite->pos;
+            visible_index[visible_count] = result->analysis_count;
+            visible_count++;
+        }
+        result->analysis_count++;
+    }
+    
+    // 第二遍：所有可见卫星的视线共享天线原点，打包后一次求交
+    ready = ready && obstruction_calculate_packet(transformed, positions, visible_count, params,
+                                                  packet, obstructions);
+    
+    for (int v = 0; ready && v < visible_count; v++) {
+        VisibilityAnalysis* analysis = &result->analyses[visible_index[v]];
+        SatelliteVisibility visibility = analysis->visibility;
+        visibility_fill_analysis(&visibility, &obstructions[v], params, analysis);
+    }
+    
+    // 统计结果
+    for (int i = 0; ready && i < result->analysis_count; i++) {
+        const VisibilityAnalysis* analysis = &result->analyses[i];
+        
+        if (analysis->visibility.is_visible) {
+            result->visible_satellites++;
+        }
+        
+        if (analysis->obstruction.is_obstructed) {
+            result->obstructed_satellites++;
+        }
+        
+        if (analysis->is_usable) {
+            result->usable_satellites++;
+        }
+    }
+    
+    clock_t end_time = clock();
+    result->total_calculation_time = (double)(end_time - start_time) / CLOCKS_PER_SEC;
+    
+    transformed_geometry_destroy(transformed);
+    ray_packet_destroy(packet);
+    free(visible_index);
+    free(obstructions);
+    free(positions);
+    
+    if (!ready) {
+        free(result->analyses);
+        memset(result, 0, sizeof(BatchObstructionResult));
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief 比较同一颗卫星在两个天线上的分析结果
+ * @param candidate 候选天线的分析结果
+ * @param best 当前最佳天线的分析结果
+ * @return 候选更优返回1，否则返回0 (相同时保留下标较小的天线)
+ */
+static int antenna_analysis_better(const VisibilityAnalysis* candidate, const VisibilityAnalysis* best) {
+    if (!candidate->is_usable) {
+        return 0;
+    }
+    if (!best->is_usable) {
+        return 1;
+    }
+    
+    // 信号损失越小越好，其次有效高度角越高越好
+    if (candidate->obstruction.signal_loss != best->obstruction.signal_loss) {
+        return candidate->obstruction.signal_loss < best->obstruction.signal_loss;
+    }
+    return candidate->effective_elevation > best->effective_elevation;
+}
+
+/**
+ * @brief 多天线批量遮挡计算 (所有天线共享一次几何变换和BVH)
+ * @param geometry 飞机几何模型 (antennas中的全部天线参与计算)
+ * @param satellite_data 卫星数据
+ * @param aircraft_state 飞机状态
+ * @param params 计算参数
+ * @param result 计算结果 (用multi_antenna_result_free释放)
+ * @return 成功返回1，失败返回0
+ */
+int batch_obstruction_calculate_multi(const AircraftGeometry* geometry,
+                                      const SatelliteData* satellite_data,
+                                      const AircraftState* aircraft_state,
+                                      const ObstructionParams* params,
+                                      MultiAntennaObstructionResult* result) {
+    if (!geometry || !satellite_data || !aircraft_state || !params || !result) {
+        return 0;
+    }
+    
+    // 初始化结果
+    memset(result, 0, sizeof(MultiAntennaObstructionResult));
+    result->calculation_time = time(NULL);
+    result->antenna_count = geometry->antenna_count > 0 ? geometry->antenna_count : 1;
+    
+    int antenna_count = result->antenna_count;
+    int satellite_count = satellite_data->satellite_count;
+    if (satellite_count <= 0) {
+        return 1;
+    }
+    
     result->analyses = (VisibilityAnalysis*)malloc(
-        sizeof(VisibilityAnalysis) * satellite_data->satellite_count
+        sizeof(VisibilityAnalysis) * satellite_count * antenna_count
     );
+    result->best_antenna = (int*)malloc(sizeof(int) * satellite_count);
+    
+    if (!result->analyses || !result->best_antenna) {
+        multi_antenna_result_free(result);
+        return 0;
+    }
     
-    if (!result->analyses) {
+    // 与单天线批量计算相同：几何变换只做一次，部件较多时构建BVH，所有天线复用
+    TransformedGeometry* transformed = transformed_geometry_create(geometry->component_count);
+    GeometryBvh* bvh = NULL;
+    if (transformed && geometry->component_count >= OBSTRUCTION_BVH_MIN_COMPONENTS) {
+        bvh = geometry_bvh_create(geometry->components, geometry->component_count);
+        transformed_geometry_set_bvh(transformed, bvh);
+    }
+    ReceiverFrame frame;
+    if (!transformed || !transformed_geometry_update(transformed, geometry, &aircraft_state->attitude) ||
+        !receiver_frame_init(&frame, aircraft_state->position.latitude,
+                             aircraft_state->position.longitude,
+                             aircraft_state->position.altitude)) {
+        transformed_geometry_destroy(transformed);
+        geometry_bvh_destroy(bvh);
+        multi_antenna_result_free(result);
         return 0;
     }
     
     clock_t start_time = clock();
     
-    // 对每颗卫星进行分析
-    for (int i = 0; i < satellite_data->satellite_count; i++) {
+    int complete = 1;
+    for (int i = 0; complete && i < satellite_count; i++) {
         const Satellite* satellite = &satellite_data->satellites[i];
         
         if (!satellite->is_valid) {
             continue;
         }
         
-        VisibilityAnalysis analysis;
-        int analysis_result = visibility_analyze(geometry, satellite, aircraft_state, params, &analysis);
+        // 卫星可见性与天线无关，每颗卫星只算一次
+        SatelliteVisibility visibility;
+        if (!receiver_frame_visibility(&frame, satellite, &visibility)) {
+            continue;
+        }
         
-        if (analysis_result) {
-            result->analyses[result->analysis_count] = analysis;
-            result->analysis_count++;
-            
-            // 统计结果
-            if (analysis.visibility.is_visible) {
-                result->visible_satellites++;
+        VisibilityAnalysis* row = &result->analyses[result->analysis_count * antenna_count];
+        int best = -1;
+        
+        for (int a = 0; a < antenna_count; a++) {
+            VisibilityAnalysis* analysis = &row[a];
+            if (!visibility.is_visible) {
+                memset(analysis, 0, sizeof(VisibilityAnalysis));
+                analysis->visibility = visibility;
+                analysis->is_usable = 0;
+            } else if (!analyze_from_antenna(transformed, transformed->antennas[a], &visibility,
+                                             &satellite->pos, params, analysis)) {
+                complete = 0;
+                break;
             }
             
-            if (analysis.obstruction.is_obstructed) {
-                result->obstructed_satellites++;
+            if (analysis->is_usable && (best < 0 || antenna_analysis_better(analysis, &row[best]))) {
+                best = a;
             }
-            
-            if (analysis.is_usable) {
-                result->usable_satellites++;
+        }
+        
+        if (!complete) {
+            break;
+        }
+        
+        // 统计结果
+        if (visibility.is_visible) {
+            result->visible_satellites++;
+        }
+        for (int a = 0; a < antenna_count; a++) {
+            if (row[a].obstruction.is_obstructed) {
+                result->obstructed_satellites[a]++;
+            }
+            if (row[a].is_usable) {
+                result->usable_satellites[a]++;
             }
         }
+        if (best >= 0) {
+            result->combined_usable_satellites++;
+        }
+        
+        result->best_antenna[result->analysis_count] = best;
+        result->analysis_count++;
     }
     
     clock_t end_time = clock();
     result->total_calculation_time = (double)(end_time - start_time) / CLOCKS_PER_SEC;
     
+    transformed_geometry_destroy(transformed);
+    geometry_bvh_destroy(bvh);
+    
+    // 任一天线求交失败则整体失败，不返回缺行的结果
+    if (!complete) {
+        multi_antenna_result_free(result);
+        memset(result, 0, sizeof(MultiAntennaObstructionResult));
+        return 0;
+    }
     return 1;
 }
 
+/**
+ * @brief 释放多天线批量计算结果
+ * @param result 计算结果
+ */
+void multi_antenna_result_free(MultiAntennaObstructionResult* result) {
+    if (!result) {
+        return;
+    }
+    
+    free(result->analyses);
+    free(result->best_antenna);
+    result->analyses = NULL;
+    result->best_antenna = NULL;
+    result->analysis_count = 0;
+}
+
 /**
  * @brief 初始化遮挡计算参数
  * @param params 参数结构
@@ -3,6 +3,7 @@
 
 #include "../satellite/satellite.h"
 #include "../aircraft/aircraft.h"
+#include <stdint.h>
 
 /* 飞机几何模型类型 */
 typedef enum {
@@ -40,17 +41,146 @@ typedef struct {
     Vector3D size;                  /* 部件尺寸 (长宽高) */
     Vector3D rotation;              /* 部件旋转 (俯仰,横滚,偏航) */
     int is_obstructing;             /* 是否产生遮挡 */
+    
+    /* 变换缓存 (由aircraft_component_update_transform维护，rotation变化后自动失效) */
+    RotationMatrix local_to_world;  /* 部件局部 -> 机体坐标旋转 */
+    RotationMatrix world_to_local;  /* 机体坐标 -> 部件局部旋转 (转置) */
+    Vector3D cached_rotation;       /* 缓存矩阵对应的欧拉角 */
+    int transform_cached;           /* 缓存是否已建立 */
 } AircraftComponent;
 
+/* 轴对齐包围盒 */
+typedef struct {
+    Vector3D min;                  /* 最小角点 */
+    Vector3D max;                  /* 最大角点 */
+} BoundingBox;
+
+/* 三角网格参数 */
+#define TRIANGLE_PACKET_LANES 4         /* 每个三角形包的三角形数 (一条AVX2指令处理4个double) */
+#define TRIANGLE_MESH_CHUNK_PACKETS 8   /* 每个包围盒分块包含的三角形包数 */
+
+/* 4个三角形的SoA打包，按32字节对齐 (顶点0和两条边预先展开，求交时无需再做减法)
+ * 不足4个时用退化三角形 (边为零) 填充 */
+typedef struct {
+    double v0x[TRIANGLE_PACKET_LANES], v0y[TRIANGLE_PACKET_LANES], v0z[TRIANGLE_PACKET_LANES];
+    double e1x[TRIANGLE_PACKET_LANES], e1y[TRIANGLE_PACKET_LANES], e1z[TRIANGLE_PACKET_LANES];
+    double e2x[TRIANGLE_PACKET_LANES], e2y[TRIANGLE_PACKET_LANES], e2z[TRIANGLE_PACKET_LANES];
+} TrianglePacket;
+
+/* 三角网格飞机模型 (机体坐标系，单位米)
+ * 三角形按质心Morton码排序后打包，相邻分块在空间上聚集，分块包围盒可有效剔除 */
+typedef struct {
+    TrianglePacket* packets;       /* 三角形包数组 (对齐分配) */
+    int packet_count;              /* 三角形包数量 */
+    AircraftPart* part_types;      /* 每个槽位的部件类型 (包下标*4+通道) */
+    int triangle_count;            /* 三角形数量 */
+    BoundingBox* chunk_bounds;     /* 分块包围盒 */
+    int chunk_count;               /* 分块数量 */
+    BoundingBox bounds;            /* 整体包围盒 */
+} TriangleMesh;
+
+/* 单架飞机最多安装的GNSS天线数 */
+#define AIRCRAFT_MAX_ANTENNAS 4
+
 /* 飞机几何模型 */
 typedef struct {
     AircraftModelType model_type;   /* 飞机类型 */
     AircraftComponent* components;  /* 部件数组 */
     int component_count;           /* 部件数量 */
-    Vector3D antenna_position;      /* 天线位置 (相对于飞机中心) */
+    Vector3D antenna_position;      /* 天线位置 (相对于飞机中心，即antennas[0]) */
+    Vector3D antennas[AIRCRAFT_MAX_ANTENNAS]; /* 全部天线位置 */
+    int antenna_count;             /* 天线数量 (至少为1) */
     double scale_factor;           /* 缩放因子 */
+    TriangleMesh* mesh;            /* 三角网格模型 (可选，随几何模型一起释放) */
+    unsigned int version;          /* 几何版本号，部件/天线/网格经接口修改时递增 */
 } AircraftGeometry;
 
+/* 遮挡掩码参数 (机体坐标系方位角0~359°，高度角-90~90°，1°分辨率) */
+#define OBSTRUCTION_MASK_AZIMUTH_CELLS 360
+#define OBSTRUCTION_MASK_ELEVATION_CELLS 181
+#define OBSTRUCTION_MASK_RESOLUTION 1.0
+
+/* 遮挡掩码单元 */
+typedef struct {
+    unsigned char blocked;         /* 是否被遮挡 */
+    unsigned char part_type;       /* 遮挡部件 (AircraftPart) */
+    float distance;                /* 天线到遮挡面的距离 (米) */
+    float signal_loss;             /* 信号损失 (dB) */
+} ObstructionMaskCell;
+
+/* 遮挡掩码文件中同一高度角行内连续被遮挡、遮挡部件相同的一段单元 */
+typedef struct {
+    uint16_t start;                /* 起始方位角单元 */
+    uint16_t length;               /* 单元数 */
+    uint32_t part_type;            /* 遮挡部件 (AircraftPart) */
+    uint32_t value_index;          /* 首个单元在values中的下标 */
+} ObstructionMaskRun;
+
+/* 天线遮挡掩码
+ * 在机体坐标系中按方位/高度角栅格对部件和三角网格预先射线求交，查询时把视线旋转到机体坐标系后直接查表。
+ * 部件和网格同属一个刚体，俯仰、横滚和航向都只是视线的旋转，同一机型的掩码对任意姿态通用。
+ * 掩码可保存为文件，同一机型的大量回放直接映射文件，不再做任何射线求交 */
+typedef struct {
+    ObstructionMaskCell* cells;    /* [高度角][方位角]，从文件映射时为NULL */
+    const AircraftGeometry* geometry; /* 构建所用的几何模型 */
+    unsigned int geometry_version; /* 构建时的几何版本号 */
+    Vector3D antenna_position;     /* 构建时的天线位置 */
+    unsigned long long fingerprint; /* 几何指纹 (部件、天线和网格内容)，用于校验掩码文件 */
+    int valid;                     /* 是否已构建 */
+    int blocked_cells;             /* 被遮挡的单元数 */
+    double build_time;             /* 构建耗时 (秒) */
+
+    /* 文件映射 (只记录被遮挡的单元，按行游程编码，查询直接读映射内存) */
+    void* mapping;                 /* 映射的文件内容 */
+    size_t mapping_size;           /* 映射长度 */
+    const uint32_t* row_offsets;   /* 每行在runs中的起始下标 [高度角行数+1] */
+    const ObstructionMaskRun* runs; /* 游程表 */
+    const float* values;           /* 每个被遮挡单元的 (距离, 信号损失) */
+} ObstructionMask;
+
+/* BVH节点 */
+typedef struct {
+    BoundingBox bounds;            /* 节点包围盒 */
+    int first;                     /* 叶节点: indices中的起始位置；内部节点: 左子节点下标 (右子节点紧随其后) */
+    int count;                     /* 叶节点部件数量，0表示内部节点 */
+} BvhNode;
+
+/* 批量计算时部件数达到该值才构建BVH，少量部件线性遍历更快 */
+#define OBSTRUCTION_BVH_MIN_COMPONENTS 8
+
+/* 部件层次包围盒 (只收录产生遮挡的部件)
+ * 树结构按构建时的部件位置确定，姿态变化后用geometry_bvh_refit更新包围盒 */
+typedef struct {
+    BvhNode* nodes;                /* 节点数组，根节点为0 */
+    int node_count;                /* 节点数量 */
+    int* indices;                  /* 叶节点引用的部件下标 */
+    int index_count;               /* 收录的部件数量 */
+    int component_count;           /* 构建时的部件总数 */
+} GeometryBvh;
+
+/* 按姿态变换后的几何模型
+ * 同一时刻的所有卫星共享一个姿态，每个时间步变换一次后可对任意数量的卫星射线复用。
+ * 部件的朝向和位置一起旋转到世界坐标系；网格留在机体坐标系，射线方向反向旋转后求交。
+ * 天线位置保持机体坐标系，对部件求交时把射线原点随机体旋转。
+ * 部件存储由调用方提供 (栈、内存池或transformed_geometry_create分配)，计算过程不再申请堆内存 */
+typedef struct {
+    AircraftModelType model_type;   /* 飞机类型 */
+    AircraftComponent* components;  /* 变换后的部件数组 (调用方存储) */
+    int component_count;           /* 部件数量 */
+    int capacity;                  /* 存储容量 (部件数) */
+    Vector3D antenna_position;      /* 天线位置 (相对于飞机中心) */
+    Vector3D antennas[AIRCRAFT_MAX_ANTENNAS]; /* 全部天线位置 */
+    int antenna_count;             /* 天线数量 */
+    int owns_storage;              /* 存储是否由本结构释放 */
+    GeometryBvh* bvh;              /* 可选的部件BVH (调用方所有)，更新时随姿态重新拟合 */
+    const TriangleMesh* mesh;       /* 三角网格模型 (借用几何模型的网格) */
+    RotationMatrix body_to_world;   /* 机体 (部件和网格) 随姿态整体旋转 */
+    RotationMatrix world_to_body;   /* 射线变换到机体坐标系 */
+    ObstructionMask* mask;          /* 可选的遮挡掩码 (调用方所有)，更新时按需重建 */
+    const AircraftGeometry* geometry; /* 最近一次更新所用的几何模型 */
+    unsigned int geometry_version; /* 更新时的几何版本号 */
+} TransformedGeometry;
+
 /* 遮挡体 */
 typedef struct {
     Vector3D center;               /* 中心点 */
@@ -66,6 +196,26 @@ typedef struct {
     double length;                 /* 长度 */
 } Ray;
 
+/* 共享原点的射线包 (SoA布局，供SIMD平板法一次测试多条射线)
+ * 同一姿态下天线指向所有卫星的射线原点相同，部件局部坐标系中的原点只需变换一次 */
+#define RAY_PACKET_LANES 4              /* 每次内核调用处理的射线数 */
+
+typedef struct {
+    Vector3D origin;               /* 公共原点 */
+    int count;                     /* 射线数量 */
+    int capacity;                  /* 列长度 (按RAY_PACKET_LANES对齐) */
+    double* block;                 /* 所有列共用的对齐内存 */
+
+    /* 输入列 */
+    double* dx, *dy, *dz;          /* 单位方向 */
+    double* length;                /* 射线长度 (米) */
+
+    /* 输出列 (ray_packet_intersect_*写入) */
+    double* distance;              /* 最近遮挡距离 (米)，未遮挡时为射线长度 */
+    int* part_type;                /* 遮挡部件 (AircraftPart) */
+    int* blocked;                  /* 是否被遮挡 */
+} RayPacket;
+
 /* 遮挡计算结果 */
 typedef struct {
     int is_obstructed;             /* 是否被遮挡 */
@@ -95,6 +245,53 @@ typedef struct {
     int consider_diffraction;       /* 是否考虑衍射效应 */
 } ObstructionParams;
 
+/* 时间相干缓存参数 */
+#define OBSTRUCTION_COHERENCE_MAX_PRN 64  /* 每个系统的最大PRN号 */
+#define OBSTRUCTION_COHERENCE_SLOTS (SATELLITE_SYSTEM_GALILEO * OBSTRUCTION_COHERENCE_MAX_PRN)
+#define OBSTRUCTION_COHERENCE_DEFAULT_TOLERANCE 0.5  /* 默认角度容差 (度) */
+#define OBSTRUCTION_COHERENCE_MARGIN_CAP 4.0         /* 余量上限 (容差的倍数) */
+
+/* 部件/网格分块的外接球 (求余量时先用它剔除远离视线的包围盒) */
+typedef struct {
+    Vector3D center;               /* 球心相对天线的位置 (米) */
+    double radius;                 /* 外接球半径 (米) */
+    double reach;                  /* 天线到包围盒最远点距离的上界 (米) */
+} CoherenceBound;
+
+/* 单颗卫星的缓存项 */
+typedef struct {
+    int valid;                     /* 是否有效 */
+    Vector3D body_direction;       /* 上次完整计算的机体坐标系视线 */
+    double margin;                 /* 部件和网格轮廓余量 (弧度)：机体坐标系视线变化小于该值时结果不变 */
+    ObstructionResult result;      /* 上次完整计算的结果 */
+} ObstructionCoherenceEntry;
+
+/* 缓存统计 */
+typedef struct {
+    long long queries;             /* 查询次数 */
+    long long reused;              /* 复用缓存结果的次数 */
+    long long computed;            /* 完整射线求交的次数 */
+} ObstructionCoherenceStats;
+
+/* 遮挡结果时间相干缓存 (按系统+PRN索引)
+ * 相邻时间步卫星视线和姿态变化很小。完整求交时记录视线到各部件轮廓的角度余量：
+ * 未遮挡时为射线到部件的最小距离除以部件最远点距离，被遮挡时为射线穿过部件的最小深度除以同一距离。
+ * 之后视线在机体坐标系中的变化小于容差、且变化量小于余量时，遮挡状态和遮挡部件不可能改变，
+ * 直接复用上次结果；每步只有靠近阴影边界的卫星需要重新求交 */
+typedef struct {
+    double tolerance;              /* 机体坐标系视线变化容差 (弧度) */
+    double margin_cap;             /* 余量上限 (弧度)，超过上限的包围盒不必精确计算 */
+    const AircraftGeometry* geometry; /* 余量对应的几何模型 */
+    unsigned int geometry_version; /* 余量对应的几何版本号 */
+    Vector3D antenna_position;     /* 余量对应的天线位置 */
+    double min_obstruction_angle;  /* 缓存结果对应的最小遮挡角度 */
+    int prepared;                  /* 缓存是否与几何模型一致 */
+    CoherenceBound* bounds;        /* 部件外接球 (与部件一一对应)，其后为网格分块外接球 (机体坐标系) */
+    int bound_capacity;            /* bounds容量 */
+    ObstructionCoherenceEntry entries[OBSTRUCTION_COHERENCE_SLOTS];
+    ObstructionCoherenceStats stats;
+} ObstructionCoherenceCache;
+
 /* 批量遮挡计算结果 */
 typedef struct {
     VisibilityAnalysis* analyses;   /* 分析结果数组 */
@@ -106,6 +303,75 @@ typedef struct {
     int usable_satellites;          /* 可用卫星数量 */
 } BatchObstructionResult;
 
+/* 多天线批量遮挡计算结果
+ * 所有(天线, 卫星)组合共享一次几何变换和同一套加速结构，卫星可见性每颗卫星只算一次 */
+typedef struct {
+    VisibilityAnalysis* analyses;   /* 分析结果数组 [卫星][天线]，下标为 卫星序号*antenna_count + 天线 */
+    int* best_antenna;             /* 每颗卫星的最佳天线下标，没有可用天线时为-1 */
+    int analysis_count;            /* 分析的卫星数量 */
+    int antenna_count;             /* 天线数量 */
+    time_t calculation_time;        /* 计算时间 */
+    double total_calculation_time;  /* 总计算时间 (秒) */
+    int visible_satellites;        /* 可见卫星数量 */
+    int obstructed_satellites[AIRCRAFT_MAX_ANTENNAS]; /* 每个天线被遮挡的卫星数量 */
+    int usable_satellites[AIRCRAFT_MAX_ANTENNAS];     /* 每个天线可用的卫星数量 */
+    int combined_usable_satellites; /* 至少一个天线可用的卫星数量 (最佳天线视图) */
+} MultiAntennaObstructionResult;
+
+/* 轨迹遮挡分析 */
+#define TRAJECTORY_ANALYSIS_MIN_USABLE 4  /* 默认的定位所需最少可用卫星数 */
+
+/* 逐步逐星状态位 */
+#define TRAJECTORY_SAT_VISIBLE 0x01       /* 卫星在地平线以上 */
+#define TRAJECTORY_SAT_OBSTRUCTED 0x02    /* 被机体遮挡 */
+#define TRAJECTORY_SAT_USABLE 0x04        /* 可用 */
+
+/* 轨迹分析配置 */
+typedef struct {
+    int thread_count;              /* 工作线程数，<=0时使用全部在线CPU核心 */
+    int propagate_ephemeris;       /* 1: 按每个轨迹点时刻传播星历；0: 使用卫星数据中的当前位置 */
+    int min_usable_satellites;     /* 某一步判定为可用所需的最少可用卫星数 */
+    double coherence_tolerance;    /* 时间相干缓存的角度容差 (度)，<=0时每步完整求交 */
+    ObstructionMask* mask;         /* 可选的共享遮挡掩码 (如从文件加载)，precision>=1时查表代替全部求交 */
+} TrajectoryAnalysisConfig;
+
+/* 单个时间步的结果 */
+typedef struct {
+    time_t timestamp;              /* 时间戳 */
+    int visible_satellites;        /* 可见卫星数量 */
+    int obstructed_satellites;     /* 被遮挡卫星数量 */
+    int usable_satellites;         /* 可用卫星数量 */
+    int available;                 /* 可用卫星数是否达到min_usable_satellites */
+} TrajectoryStepResult;
+
+/* 单颗卫星在整条轨迹上的统计 */
+typedef struct {
+    int prn;                       /* 卫星PRN号 */
+    SatelliteSystem system;        /* 卫星系统 */
+    double visible_time;           /* 可见时长 (秒) */
+    double obstructed_time;        /* 被遮挡时长 (秒) */
+    double usable_time;            /* 可用时长 (秒) */
+} TrajectorySatelliteStats;
+
+/* 轨迹遮挡分析结果
+ * 结果表在启动工作线程前一次性分配，各线程只写入自己领取的时间步，汇总在线程结束后进行 */
+typedef struct {
+    TrajectoryStepResult* steps;   /* 逐步结果 [步] */
+    unsigned char* satellite_states; /* 逐步逐星状态位 [步][卫星]，卫星顺序与卫星数据一致 */
+    int step_count;                /* 时间步数量 (轨迹点数量) */
+    TrajectorySatelliteStats* satellites; /* 逐星统计 */
+    int satellite_count;           /* 卫星数量 */
+    double total_time;             /* 轨迹总时长 (秒) */
+    double available_time;         /* 可用时长 (秒) */
+    double availability_percentage; /* 可用时间百分比 */
+    double longest_outage;         /* 最长连续不可用时长 (秒) */
+    time_t longest_outage_start;   /* 最长不可用时段的起始时间 */
+    int threads_used;              /* 实际使用的线程数 */
+    double elapsed_ms;             /* 总耗时 (毫秒) */
+    long long coherence_reused;    /* 相干缓存复用的遮挡结果数 */
+    long long coherence_computed;  /* 完整射线求交的遮挡结果数 (启用相干缓存时统计) */
+} TrajectoryAnalysisResult;
+
 /* 函数声明 */
 AircraftGeometry* aircraft_geometry_create(AircraftModelType model_type);
 void aircraft_geometry_destroy(AircraftGeometry* geometry);
@@ -113,10 +379,54 @@ int aircraft_geometry_add_component(AircraftGeometry* geometry,
                                    const AircraftComponent* component);
 int aircraft_geometry_set_antenna_position(AircraftGeometry* geometry, 
                                          const Vector3D* position);
+int aircraft_geometry_add_antenna(AircraftGeometry* geometry, const Vector3D* position);
 
 int aircraft_geometry_update_transform(AircraftGeometry* geometry, 
                                      const AircraftAttitude* attitude);
 
+int transformed_geometry_init(TransformedGeometry* transformed,
+                              AircraftComponent* storage, int capacity);
+TransformedGeometry* transformed_geometry_create(int capacity);
+void transformed_geometry_destroy(TransformedGeometry* transformed);
+int transformed_geometry_update(TransformedGeometry* transformed,
+                                const AircraftGeometry* geometry,
+                                const AircraftAttitude* attitude);
+int transformed_geometry_set_bvh(TransformedGeometry* transformed, GeometryBvh* bvh);
+int transformed_geometry_set_mask(TransformedGeometry* transformed, ObstructionMask* mask);
+
+ObstructionMask* obstruction_mask_create(void);
+void obstruction_mask_destroy(ObstructionMask* mask);
+int obstruction_mask_build(ObstructionMask* mask, const AircraftGeometry* geometry);
+int obstruction_mask_is_current(const ObstructionMask* mask, const AircraftGeometry* geometry);
+int obstruction_mask_update(ObstructionMask* mask, const AircraftGeometry* geometry);
+int obstruction_mask_cell_index(const Vector3D* body_direction);
+int obstruction_mask_lookup(const ObstructionMask* mask, const Vector3D* body_direction,
+                            ObstructionMaskCell* cell);
+unsigned long long obstruction_mask_fingerprint(const AircraftGeometry* geometry);
+int obstruction_mask_save(const ObstructionMask* mask, const char* filename);
+int obstruction_mask_load(ObstructionMask* mask, const char* filename, const AircraftGeometry* geometry);
+int obstruction_mask_load_cached(ObstructionMask* mask, const AircraftGeometry* geometry,
+                                 const char* filename);
+
+GeometryBvh* geometry_bvh_create(const AircraftComponent* components, int component_count);
+void geometry_bvh_destroy(GeometryBvh* bvh);
+int geometry_bvh_refit(GeometryBvh* bvh, const AircraftComponent* components, int component_count);
+int geometry_bvh_intersect_any(const GeometryBvh* bvh, const AircraftComponent* components,
+                               const Ray* ray);
+int geometry_bvh_intersect_closest(const GeometryBvh* bvh, const AircraftComponent* components,
+                                   const Ray* ray, Vector3D* intersection, double* distance,
+                                   int* component_index);
+
+RayPacket* ray_packet_create(int capacity);
+void ray_packet_destroy(RayPacket* packet);
+void ray_packet_reset(RayPacket* packet, const Vector3D* origin);
+int ray_packet_add(RayPacket* packet, const Vector3D* direction, double length);
+int ray_packet_fill_hemisphere(RayPacket* packet, const Vector3D* origin, double resolution);
+int ray_packet_intersect_components(RayPacket* packet, const AircraftComponent* components,
+                                    int component_count);
+int ray_packet_intersect_transformed(RayPacket* packet, const TransformedGeometry* transformed);
+const char* ray_packet_kernel_name(void);
+
 Vector3D vector3d_create(double x, double y, double z);
 Vector3D vector3d_add(const Vector3D* v1, const Vector3D* v2);
 Vector3D vector3d_subtract(const Vector3D* v1, const Vector3D* v2);
@@ -129,30 +439,112 @@ Vector3D vector3d_rotate(const Vector3D* v, const RotationMatrix* matrix);
 
 RotationMatrix rotation_matrix_create_from_euler(double pitch, double roll, double yaw);
 RotationMatrix rotation_matrix_multiply(const RotationMatrix* m1, const RotationMatrix* m2);
+RotationMatrix rotation_matrix_transpose(const RotationMatrix* matrix);
+
+void aircraft_component_set_transform(AircraftComponent* component, const RotationMatrix* local_to_world);
+void aircraft_component_update_transform(AircraftComponent* component);
+int aircraft_component_transform_is_current(const AircraftComponent* component);
 
+int ray_aabb_intersection(const BoundingBox* bounds, const Vector3D* origin,
+                          const Vector3D* inv_direction, double max_distance, double* t_near);
 int ray_box_intersection(const Ray* ray, const ObstructionBody* box, 
                          Vector3D* intersection, double* distance);
 int ray_component_intersection(const Ray* ray, const AircraftComponent* component,
                                Vector3D* intersection, double* distance);
 
+TriangleMesh* triangle_mesh_create(const Vector3D* vertices, int vertex_count,
+                                   const int* indices, const AircraftPart* part_types,
+                                   int triangle_count);
+TriangleMesh* triangle_mesh_load_obj(const char* filename);
+TriangleMesh* triangle_mesh_load_stl(const char* filename);
+TriangleMesh* triangle_mesh_load(const char* filename);
+void triangle_mesh_destroy(TriangleMesh* mesh);
+int triangle_mesh_intersect_closest(const TriangleMesh* mesh, const Ray* ray,
+                                    double* distance, AircraftPart* part_type);
+int triangle_mesh_intersect_any(const TriangleMesh* mesh, const Ray* ray);
+const char* triangle_mesh_kernel_name(void);
+int aircraft_geometry_set_mesh(AircraftGeometry* geometry, TriangleMesh* mesh);
+AircraftPart aircraft_part_from_name(const char* name);
+
 int obstruction_calculate(const AircraftGeometry* geometry,
                          const SatellitePosition* satellite_pos,
                          const AircraftState* aircraft_state,
                          const ObstructionParams* params,
                          ObstructionResult* result);
 
+int obstruction_calculate_transformed(const TransformedGeometry* transformed,
+                                     const SatellitePosition* satellite_pos,
+                                     const ObstructionParams* params,
+                                     ObstructionResult* result);
+
+int obstruction_calculate_antenna(const TransformedGeometry* transformed,
+                                  int antenna_index,
+                                  const SatellitePosition* satellite_pos,
+                                  const ObstructionParams* params,
+                                  ObstructionResult* result);
+
+int obstruction_calculate_packet(const TransformedGeometry* transformed,
+                                 const SatellitePosition* satellite_positions, int count,
+                                 const ObstructionParams* params,
+                                 RayPacket* packet, ObstructionResult* results);
+
+int obstruction_ray_blocked(const TransformedGeometry* transformed,
+                            const SatellitePosition* satellite_pos);
+
 int visibility_analyze(const AircraftGeometry* geometry,
                       const Satellite* satellite,
                       const AircraftState* aircraft_state,
                       const ObstructionParams* params,
                       VisibilityAnalysis* analysis);
 
+int visibility_analyze_transformed(const TransformedGeometry* transformed,
+                                   const Satellite* satellite,
+                                   const AircraftState* aircraft_state,
+                                   const ObstructionParams* params,
+                                   VisibilityAnalysis* analysis);
+
+int visibility_analyze_frame(const TransformedGeometry* transformed,
+                             const ReceiverFrame* frame,
+                             const Satellite* satellite,
+                             const ObstructionParams* params,
+                             ObstructionCoherenceCache* coherence,
+                             VisibilityAnalysis* analysis);
+
+ObstructionCoherenceCache* obstruction_coherence_create(double tolerance);
+void obstruction_coherence_destroy(ObstructionCoherenceCache* cache);
+void obstruction_coherence_clear(ObstructionCoherenceCache* cache);
+int obstruction_coherence_calculate(ObstructionCoherenceCache* cache,
+                                    const TransformedGeometry* transformed,
+                                    const Satellite* satellite,
+                                    const ObstructionParams* params,
+                                    ObstructionResult* result);
+void obstruction_coherence_get_stats(const ObstructionCoherenceCache* cache,
+                                     ObstructionCoherenceStats* stats);
+
 int batch_obstruction_calculate(const AircraftGeometry* geometry,
                                const SatelliteData* satellite_data,
                                const AircraftState* aircraft_state,
                                const ObstructionParams* params,
                                BatchObstructionResult* result);
 
+int batch_obstruction_calculate_multi(const AircraftGeometry* geometry,
+                                      const SatelliteData* satellite_data,
+                                      const AircraftState* aircraft_state,
+                                      const ObstructionParams* params,
+                                      MultiAntennaObstructionResult* result);
+void multi_antenna_result_free(MultiAntennaObstructionResult* result);
+
+void trajectory_analysis_config_default(TrajectoryAnalysisConfig* config);
+int trajectory_obstruction_analyze(const AircraftGeometry* geometry,
+                                   const SatelliteData* satellite_data,
+                                   const FlightTrajectory* trajectory,
+                                   const ObstructionParams* params,
+                                   const TrajectoryAnalysisConfig* config,
+                                   TrajectoryAnalysisResult* result);
+void trajectory_analysis_result_free(TrajectoryAnalysisResult* result);
+
+double obstruction_signal_loss(double obstruction_distance, AircraftPart part_type);
+
 int obstruction_params_init(ObstructionParams* params);
 int obstruction_params_validate(const ObstructionParams* params);
 
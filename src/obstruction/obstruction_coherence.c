@@ -0,0 +1,407 @@
+#include "obstruction.h"
+#include "../utils/utils.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define COHERENCE_PARALLEL_EPSILON 1e-10  /* 与ray_box_intersection一致的平行判定阈值 */
+
+/* 按系统+PRN定位缓存项，超出范围返回-1 (不缓存) */
+static int coherence_slot(SatelliteSystem system, int prn) {
+    if (system < SATELLITE_SYSTEM_BEIDOU || system > SATELLITE_SYSTEM_GALILEO) return -1;
+    if (prn < 1 || prn > OBSTRUCTION_COHERENCE_MAX_PRN) return -1;
+    return ((int)system - 1) * OBSTRUCTION_COHERENCE_MAX_PRN + (prn - 1);
+}
+
+/* 两个单位向量的夹角 (弧度)；小角度时比acos(点积)精确 */
+static double coherence_angle(const Vector3D* a, const Vector3D* b) {
+    Vector3D diff = vector3d_subtract(a, b);
+    double half_chord = vector3d_length(&diff) / 2.0;
+    return 2.0 * asin(half_chord < 1.0 ? half_chord : 1.0);
+}
+
+/**
+ * @brief 射线 (半直线) 与轴对齐盒的带符号间隙
+ * @param origin 射线原点 (盒中心为原点的局部坐标)
+ * @param direction 单位方向 (局部坐标)
+ * @param half 盒的半尺寸
+ * @return 为正时是射线到盒的切比雪夫距离 (不大于欧氏距离)；不为正时射线穿过盒，
+ *         其相反数是盒各边同时收缩后射线仍能穿过的最大收缩量
+ * @note 盒各边扩张ε后各轴平板区间随ε线性变化，射线命中当且仅当任意两轴区间
+ *       (及t>=0) 两两相交，每个条件都是ε的一次不等式，临界ε取其最大值
+ */
+static double coherence_box_gap(const double origin[3], const double direction[3], const double half[3]) {
+    double gap = -INFINITY;
+    double a[3], u[3];
+    int moving[3];
+
+    for (int i = 0; i < 3; i++) {
+        a[i] = fabs(direction[i]);
+        moving[i] = a[i] > COHERENCE_PARALLEL_EPSILON;
+        if (!moving[i]) {
+            // 平行轴：原点须在扩张后的平板内
+            gap = fmax(gap, fabs(origin[i]) - half[i]);
+            continue;
+        }
+
+        // u为原点沿前进方向的坐标；离开平板的时刻须不早于t=0
+        u[i] = direction[i] > 0.0 ? origin[i] : -origin[i];
+        gap = fmax(gap, u[i] - half[i]);
+    }
+
+    // 进入i轴平板不晚于离开k轴平板
+    for (int i = 0; i < 3; i++) {
+        if (!moving[i]) continue;
+        for (int k = 0; k < 3; k++) {
+            if (k == i || !moving[k]) continue;
+            double eps = -(a[i] * (half[k] - u[k]) + a[k] * (half[i] + u[i])) / (a[i] + a[k]);
+            gap = fmax(gap, eps);
+        }
+    }
+
+    return gap;
+}
+
+/* 由相对天线的包围盒中心和半尺寸建立外接球 */
+static void coherence_bound_init(const Vector3D* center, const Vector3D* half, CoherenceBound* bound) {
+    bound->center = *center;
+    bound->radius = vector3d_length(half);
+    bound->reach = vector3d_length(center) + bound->radius;
+}
+
+/**
+ * @brief 外接球能否证明包围盒的余量不低于上限 (此时无需精确计算)
+ * @note 切比雪夫距离不小于欧氏距离的1/sqrt(3)，欧氏距离不小于球心到射线的距离减去半径
+ */
+static int coherence_bound_beyond_cap(const CoherenceBound* bound, const Vector3D* direction, double cap) {
+    double t = vector3d_dot(&bound->center, direction);
+    double center_sq = vector3d_dot(&bound->center, &bound->center);
+    double distance = sqrt(t > 0.0 ? fmax(center_sq - t * t, 0.0) : center_sq);
+    return (distance - bound->radius) / sqrt(3.0) >= cap * bound->reach;
+}
+
+/**
+ * @brief 几何模型、天线或参数变化时重建外接球并清空缓存项
+ * @param cache 缓存
+ * @param transformed 变换几何模型
+ * @param params 计算参数
+ * @return 成功返回1，失败返回0
+ */
+static int coherence_prepare(ObstructionCoherenceCache* cache, const TransformedGeometry* transformed,
+                             const ObstructionParams* params) {
+    const Vector3D* antenna = &transformed->antenna_position;
+    if (cache->prepared &&
+        cache->geometry == transformed->geometry &&
+        cache->geometry_version == transformed->geometry_version &&
+        cache->antenna_position.x == antenna->x &&
+        cache->antenna_position.y == antenna->y &&
+        cache->antenna_position.z == antenna->z &&
+        cache->min_obstruction_angle == params->min_obstruction_angle) {
+        return 1;
+    }
+
+    int chunk_count = transformed->mesh ? transformed->mesh->chunk_count : 0;
+    int count = transformed->component_count + chunk_count;
+    if (count > cache->bound_capacity) {
+        CoherenceBound* bounds = (CoherenceBound*)realloc(cache->bounds, sizeof(CoherenceBound) * count);
+        if (!bounds) {
+            error_set(ERROR_MEMORY, "相干缓存内存分配失败", __func__, __FILE__, __LINE__);
+            return 0;
+        }
+        cache->bounds = bounds;
+        cache->bound_capacity = count;
+    }
+
+    // 部件与网格同属刚体，在机体坐标系中与机体轴对齐且位置固定，外接球与姿态无关
+    for (int i = 0; i < transformed->component_count; i++) {
+        const AircraftComponent* component = &transformed->geometry->components[i];
+        Vector3D center = vector3d_subtract(&component->position, antenna);
+        Vector3D half = vector3d_multiply(&component->size, 0.5);
+        coherence_bound_init(&center, &half, &cache->bounds[i]);
+    }
+
+    // 网格随机体整体旋转，分块外接球固定在机体坐标系中
+    for (int k = 0; k < chunk_count; k++) {
+        const BoundingBox* box = &transformed->mesh->chunk_bounds[k];
+        Vector3D center = vector3d_add(&box->min, &box->max);
+        Vector3D half = vector3d_subtract(&box->max, &box->min);
+        center = vector3d_multiply(&center, 0.5);
+        center = vector3d_subtract(&center, antenna);
+        half = vector3d_multiply(&half, 0.5);
+        coherence_bound_init(&center, &half, &cache->bounds[transformed->component_count + k]);
+    }
+
+    cache->geometry = transformed->geometry;
+    cache->geometry_version = transformed->geometry_version;
+    cache->antenna_position = *antenna;
+    cache->min_obstruction_angle = params->min_obstruction_angle;
+    cache->prepared = 1;
+    memset(cache->entries, 0, sizeof(cache->entries));
+    return 1;
+}
+
+/**
+ * @brief 部件轮廓余量
+ * @param cache 缓存
+ * @param transformed 变换几何模型
+ * @param body_direction 机体坐标系视线 (单位向量)
+ * @param result 该视线的完整计算结果
+ * @return 余量 (弧度，不超过margin_cap)，无法保证结果不变时返回0
+ * @note 机体坐标系中部件固定，视线变化δ时命中只可能发生在t<=reach处，射线上各点移动不超过reach*δ。
+ *       该值小于间隙时未遮挡的部件不会被命中，小于穿透深度时遮挡部件仍被命中
+ */
+static double coherence_component_margin(const ObstructionCoherenceCache* cache,
+                                         const TransformedGeometry* transformed,
+                                         const Vector3D* body_direction, const ObstructionResult* result) {
+    int hit = result->is_obstructed || result->obstruction_distance > 0.0;
+    double margin = cache->margin_cap;
+    int blockers = 0;
+
+    for (int i = 0; i < transformed->component_count; i++) {
+        const AircraftComponent* component = &transformed->components[i];
+        const CoherenceBound* bound = &cache->bounds[i];
+        if (!component->is_obstructing || coherence_bound_beyond_cap(bound, body_direction, margin)) {
+            continue;
+        }
+
+        double origin[3] = {-bound->center.x, -bound->center.y, -bound->center.z};
+        double dir[3] = {body_direction->x, body_direction->y, body_direction->z};
+        double half[3] = {component->size.x / 2.0, component->size.y / 2.0, component->size.z / 2.0};
+
+        double gap = coherence_box_gap(origin, dir, half);
+        if (gap <= 0.0) {
+            // 只允许唯一的遮挡部件，且须与完整计算的结果一致
+            if (!hit || ++blockers > 1 || component->part_type != result->obstruction_part) {
+                return 0.0;
+            }
+            gap = -gap;
+        }
+
+        margin = fmin(margin, gap / bound->reach);
+    }
+
+    return hit && blockers == 0 ? 0.0 : margin;
+}
+
+/**
+ * @brief 视线穿过分块包围盒时，改用分块内各三角形包围盒求间隙
+ * @param mesh 三角网格
+ * @param chunk 分块下标
+ * @param antenna 天线位置 (机体坐标系)
+ * @param direction 机体坐标系视线
+ * @return 最小间隙，视线穿过任一三角形包围盒时不为正
+ * @note Morton排序的分块可能跨越相距较远的部位，分块包围盒常把天线包含在内
+ */
+static double coherence_chunk_triangle_gap(const TriangleMesh* mesh, int chunk, const Vector3D* antenna,
+                                           const double direction[3]) {
+    double gap = INFINITY;
+    int first = chunk * TRIANGLE_MESH_CHUNK_PACKETS;
+    int last = first + TRIANGLE_MESH_CHUNK_PACKETS;
+    if (last > mesh->packet_count) last = mesh->packet_count;
+
+    for (int p = first; p < last; p++) {
+        const TrianglePacket* packet = &mesh->packets[p];
+        for (int lane = 0; lane < TRIANGLE_PACKET_LANES; lane++) {
+            if (p * TRIANGLE_PACKET_LANES + lane >= mesh->triangle_count) {
+                return gap;  /* 只有最后一个包有填充槽位 */
+            }
+
+            double v0[3] = {packet->v0x[lane], packet->v0y[lane], packet->v0z[lane]};
+            double e1[3] = {packet->e1x[lane], packet->e1y[lane], packet->e1z[lane]};
+            double e2[3] = {packet->e2x[lane], packet->e2y[lane], packet->e2z[lane]};
+            const double a[3] = {antenna->x, antenna->y, antenna->z};
+            double origin[3], half[3];
+            for (int i = 0; i < 3; i++) {
+                double low = v0[i] + fmin(0.0, fmin(e1[i], e2[i]));
+                double high = v0[i] + fmax(0.0, fmax(e1[i], e2[i]));
+                origin[i] = a[i] - (low + high) / 2.0;
+                half[i] = (high - low) / 2.0;
+            }
+
+            gap = fmin(gap, coherence_box_gap(origin, direction, half));
+            if (gap <= 0.0) {
+                return gap;
+            }
+        }
+    }
+
+    return gap;
+}
+
+/**
+ * @brief 网格轮廓余量：机体坐标系视线到各分块 (必要时到分块内各三角形) 包围盒的间隙
+ * @return 余量 (弧度)，视线穿过任一三角形包围盒时返回0
+ */
+static double coherence_mesh_margin(const ObstructionCoherenceCache* cache,
+                                    const TransformedGeometry* transformed, const Vector3D* body_direction) {
+    const TriangleMesh* mesh = transformed->mesh;
+    const CoherenceBound* bounds = &cache->bounds[transformed->component_count];
+    double dir[3] = {body_direction->x, body_direction->y, body_direction->z};
+    double margin = cache->margin_cap;
+
+    for (int k = 0; k < mesh->chunk_count; k++) {
+        const CoherenceBound* bound = &bounds[k];
+        if (coherence_bound_beyond_cap(bound, body_direction, margin)) {
+            continue;
+        }
+
+        const BoundingBox* box = &mesh->chunk_bounds[k];
+        double origin[3] = {-bound->center.x, -bound->center.y, -bound->center.z};
+        double half[3] = {(box->max.x - box->min.x) / 2.0,
+                          (box->max.y - box->min.y) / 2.0,
+                          (box->max.z - box->min.z) / 2.0};
+
+        double gap = coherence_box_gap(origin, dir, half);
+        if (gap <= 0.0) {
+            gap = coherence_chunk_triangle_gap(mesh, k, &transformed->antenna_position, dir);
+            if (gap <= 0.0) {
+                return 0.0;
+            }
+        }
+        margin = fmin(margin, gap / bound->reach);
+    }
+
+    return margin;
+}
+
+/**
+ * @brief 创建遮挡结果时间相干缓存
+ * @param tolerance 机体坐标系视线变化容差 (度)，<=0时使用OBSTRUCTION_COHERENCE_DEFAULT_TOLERANCE
+ * @return 创建的缓存
+ */
+ObstructionCoherenceCache* obstruction_coherence_create(double tolerance) {
+    ObstructionCoherenceCache* cache = (ObstructionCoherenceCache*)malloc(sizeof(ObstructionCoherenceCache));
+    if (!cache) {
+        error_set(ERROR_MEMORY, "相干缓存内存分配失败", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+    memset(cache, 0, sizeof(ObstructionCoherenceCache));
+
+    if (tolerance <= 0.0) {
+        tolerance = OBSTRUCTION_COHERENCE_DEFAULT_TOLERANCE;
+    }
+    cache->tolerance = tolerance * M_PI / 180.0;
+    cache->margin_cap = cache->tolerance * OBSTRUCTION_COHERENCE_MARGIN_CAP;
+    return cache;
+}
+
+/**
+ * @brief 销毁遮挡结果时间相干缓存
+ * @param cache 缓存
+ */
+void obstruction_coherence_destroy(ObstructionCoherenceCache* cache) {
+    if (!cache) {
+        return;
+    }
+
+    free(cache->bounds);
+    free(cache);
+}
+
+/**
+ * @brief 清空缓存项 (统计保留)
+ * @param cache 缓存
+ * @note 时间不连续 (如跳到另一段轨迹) 时调用；几何模型变化会自动失效，无需调用
+ */
+void obstruction_coherence_clear(ObstructionCoherenceCache* cache) {
+    if (!cache) {
+        return;
+    }
+
+    memset(cache->entries, 0, sizeof(cache->entries));
+}
+
+/**
+ * @brief 计算主天线对单颗卫星的遮挡，视线和姿态变化足够小时复用上次结果
+ * @param cache 缓存
+ * @param transformed 变换几何模型 (须已按当前姿态更新)
+ * @param satellite 卫星数据 (按系统和PRN索引缓存)
+ * @param params 计算参数
+ * @param result 计算结果
+ * @return 成功返回1，失败返回0
+ * @note 复用时遮挡状态和遮挡部件与完整计算一致，遮挡距离和信号损失取上次完整计算的值，
+ *       交点沿新视线重新定位。缓存项只在完整计算时更新，变化量始终相对上次完整计算累计
+ */
+int obstruction_coherence_calculate(ObstructionCoherenceCache* cache,
+                                    const TransformedGeometry* transformed,
+                                    const Satellite* satellite,
+                                    const ObstructionParams* params,
+                                    ObstructionResult* result) {
+    if (!cache || !transformed || !satellite || !params || !result) {
+        return 0;
+    }
+
+    cache->stats.queries++;
+
+    // 掩码查表本身已是O(1)，不经过缓存
+    const ObstructionMask* mask = transformed->mask;
+    int slot = coherence_slot(satellite->system, satellite->prn);
+    if (slot < 0 || (mask && mask->valid && params->precision >= OBSTRUCTION_MASK_RESOLUTION)) {
+        cache->stats.computed++;
+        return obstruction_calculate_transformed(transformed, &satellite->pos, params, result);
+    }
+
+    if (!coherence_prepare(cache, transformed, params)) {
+        return 0;
+    }
+
+    // 与create_satellite_ray相同的视线
+    const Vector3D* antenna = &transformed->antenna_position;
+    Vector3D satellite_vector = vector3d_create(satellite->pos.x, satellite->pos.y, satellite->pos.z);
+    Vector3D line_of_sight = vector3d_subtract(&satellite_vector, antenna);
+    double ray_length = vector3d_length(&line_of_sight);
+    if (ray_length <= 0.0) {
+        cache->stats.computed++;
+        return obstruction_calculate_transformed(transformed, &satellite->pos, params, result);
+    }
+
+    Vector3D direction = vector3d_multiply(&line_of_sight, 1.0 / ray_length);
+    Vector3D body_direction = vector3d_rotate(&direction, &transformed->world_to_body);
+
+    ObstructionCoherenceEntry* entry = &cache->entries[slot];
+    if (entry->valid) {
+        double body_change = coherence_angle(&body_direction, &entry->body_direction);
+        if (body_change < cache->tolerance && body_change < entry->margin) {
+            *result = entry->result;
+            if (result->obstruction_distance > 0.0) {
+                Vector3D offset = vector3d_multiply(&direction, result->obstruction_distance);
+                result->intersection_point = vector3d_add(antenna, &offset);
+            }
+            cache->stats.reused++;
+            return 1;
+        }
+    }
+
+    cache->stats.computed++;
+    if (!obstruction_calculate_transformed(transformed, &satellite->pos, params, result)) {
+        entry->valid = 0;
+        return 0;
+    }
+
+    entry->valid = 1;
+    entry->body_direction = body_direction;
+    entry->margin = coherence_component_margin(cache, transformed, &body_direction, result);
+    if (transformed->mesh) {
+        entry->margin = fmin(entry->margin, coherence_mesh_margin(cache, transformed, &body_direction));
+    }
+    entry->result = *result;
+    return 1;
+}
+
+/**
+ * @brief 获取缓存统计
+ * @param cache 缓存
+ * @param stats 统计 (输出)
+ */
+void obstruction_coherence_get_stats(const ObstructionCoherenceCache* cache,
+                                     ObstructionCoherenceStats* stats) {
+    if (!cache || !stats) {
+        return;
+    }
+
+    *stats = cache->stats;
+}
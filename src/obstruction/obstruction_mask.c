@@ -0,0 +1,645 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L  /* mmap/fstat */
+#endif
+
+#include "obstruction.h"
+#include "../utils/utils.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define OBSTRUCTION_MASK_CELL_COUNT (OBSTRUCTION_MASK_AZIMUTH_CELLS * OBSTRUCTION_MASK_ELEVATION_CELLS)
+/* 栅格射线长度，远大于机体尺寸即可 */
+#define OBSTRUCTION_MASK_RAY_LENGTH 1.0e6
+
+/* 掩码文件格式:
+ *   文件头 (MaskFileHeader)
+ *   行索引 uint32_t[高度角行数+1]，每行游程在游程表中的起始下标
+ *   游程表 ObstructionMaskRun[]，行内按方位角升序
+ *   数值表 float[被遮挡单元数][2]，(距离, 信号损失)
+ * 未被遮挡的单元不占空间；映射后直接在文件内容上查询 */
+#define MASK_FILE_MAGIC "BDOBMASK"
+#define MASK_FILE_VERSION 3          /* 3: 部件随机体刚性旋转，与三角网格一起栅格化 */
+#define MASK_FILE_ENDIAN_MARK 0x01020304u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_mark;
+    uint32_t azimuth_cells;
+    uint32_t elevation_cells;
+    uint32_t run_count;
+    uint32_t blocked_cells;
+    double resolution;
+    double antenna[3];            /* 构建时的天线位置 */
+    uint64_t fingerprint;         /* 几何指纹 */
+    uint64_t checksum;            /* 行索引、游程表和数值表的FNV-1a校验和 */
+} MaskFileHeader;
+
+_Static_assert(sizeof(MaskFileHeader) % 8 == 0, "掩码文件头未对齐");
+_Static_assert(sizeof(ObstructionMaskRun) == 12, "掩码游程布局与文件格式不一致");
+
+#define FNV_OFFSET_BASIS 1469598103934665603ULL
+#define FNV_PRIME 1099511628211ULL
+
+static uint64_t fnv1a_update(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/* 只读映射整个文件；Windows下读入堆内存 */
+static void* map_file(const char* filename, size_t* length) {
+#ifdef _WIN32
+    long size = file_size(filename);
+    if (size <= 0) return NULL;
+
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) return NULL;
+
+    void* buffer = malloc((size_t)size);
+    if (buffer != NULL && fread(buffer, 1, (size_t)size, file) != (size_t)size) {
+        free(buffer);
+        buffer = NULL;
+    }
+    fclose(file);
+
+    *length = (size_t)size;
+    return buffer;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    void* mapped = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return NULL;
+
+    *length = (size_t)st.st_size;
+    return mapped;
+#endif
+}
+
+static void unmap_file(void* mapping, size_t length) {
+#ifdef _WIN32
+    (void)length;
+    free(mapping);
+#else
+    munmap(mapping, length);
+#endif
+}
+
+/* 解除文件映射，掩码回到未构建状态 */
+static void mask_release_mapping(ObstructionMask* mask) {
+    if (!mask->mapping) {
+        return;
+    }
+
+    unmap_file(mask->mapping, mask->mapping_size);
+    mask->mapping = NULL;
+    mask->mapping_size = 0;
+    mask->row_offsets = NULL;
+    mask->runs = NULL;
+    mask->values = NULL;
+    mask->valid = 0;
+}
+
+/**
+ * @brief 创建遮挡掩码 (未构建)
+ * @return 创建的遮挡掩码
+ */
+ObstructionMask* obstruction_mask_create(void) {
+    ObstructionMask* mask = (ObstructionMask*)malloc(sizeof(ObstructionMask));
+    if (!mask) {
+        return NULL;
+    }
+    memset(mask, 0, sizeof(ObstructionMask));
+
+    mask->cells = (ObstructionMaskCell*)malloc(sizeof(ObstructionMaskCell) * OBSTRUCTION_MASK_CELL_COUNT);
+    if (!mask->cells) {
+        free(mask);
+        error_set(ERROR_MEMORY, "遮挡掩码内存分配失败", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+
+    return mask;
+}
+
+/**
+ * @brief 销毁遮挡掩码
+ * @param mask 遮挡掩码
+ */
+void obstruction_mask_destroy(ObstructionMask* mask) {
+    if (!mask) {
+        return;
+    }
+
+    mask_release_mapping(mask);
+    free(mask->cells);
+    free(mask);
+}
+
+/**
+ * @brief 计算几何模型指纹 (部件、天线位置和网格内容)
+ * @param geometry 几何模型
+ * @return 64位FNV-1a哈希，内容相同的几何模型指纹相同
+ * @note 掩码文件按指纹匹配机型，与几何模型的地址和版本号无关；部件的rotation只记录姿态，
+ *       部件在机体坐标系中与机体轴对齐，不参与指纹
+ */
+unsigned long long obstruction_mask_fingerprint(const AircraftGeometry* geometry) {
+    if (!geometry) {
+        return 0;
+    }
+
+    // 逐字段哈希，避开结构体填充和变换缓存
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = fnv1a_update(hash, &geometry->antenna_position, sizeof(Vector3D));
+    for (int i = 0; i < geometry->component_count; i++) {
+        const AircraftComponent* component = &geometry->components[i];
+        int32_t part = (int32_t)component->part_type;
+        int32_t obstructing = (int32_t)component->is_obstructing;
+        hash = fnv1a_update(hash, &part, sizeof(part));
+        hash = fnv1a_update(hash, &obstructing, sizeof(obstructing));
+        hash = fnv1a_update(hash, &component->position, sizeof(Vector3D));
+        hash = fnv1a_update(hash, &component->size, sizeof(Vector3D));
+    }
+
+    const TriangleMesh* mesh = geometry->mesh;
+    if (mesh) {
+        int32_t triangles = mesh->triangle_count;
+        hash = fnv1a_update(hash, &triangles, sizeof(triangles));
+        hash = fnv1a_update(hash, mesh->packets, sizeof(TrianglePacket) * mesh->packet_count);
+        for (int i = 0; i < mesh->packet_count * TRIANGLE_PACKET_LANES; i++) {
+            int32_t part = (int32_t)mesh->part_types[i];
+            hash = fnv1a_update(hash, &part, sizeof(part));
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * @brief 沿机体坐标系方向求部件和网格的最近遮挡
+ * @param body 零姿态下的变换几何模型 (部件处于机体坐标系)
+ * @param bvh 部件BVH (可为NULL)
+ * @param ray 机体坐标系射线
+ * @param cell 掩码单元 (输出)
+ */
+static void mask_rasterize_cell(const TransformedGeometry* body, const GeometryBvh* bvh,
+                                const Ray* ray, ObstructionMaskCell* cell) {
+    double closest = ray->length;
+    int found = 0;
+    AircraftPart part = AIRCRAFT_PART_FUSELAGE;
+
+    int index;
+    double distance;
+    if (bvh && geometry_bvh_intersect_closest(bvh, body->components, ray, NULL, &distance, &index)) {
+        closest = distance;
+        part = body->components[index].part_type;
+        found = 1;
+    }
+
+    AircraftPart mesh_part;
+    if (body->mesh && triangle_mesh_intersect_closest(body->mesh, ray, &distance, &mesh_part) &&
+        distance < closest) {
+        closest = distance;
+        part = mesh_part;
+        found = 1;
+    }
+
+    memset(cell, 0, sizeof(ObstructionMaskCell));
+    if (found) {
+        cell->blocked = 1;
+        cell->part_type = (unsigned char)part;
+        cell->distance = (float)closest;
+        cell->signal_loss = (float)obstruction_signal_loss(closest, part);
+    }
+}
+
+/**
+ * @brief 在机体坐标系中栅格化遮挡掩码 (无条件重建)
+ * @param mask 遮挡掩码
+ * @param geometry 几何模型 (部件和三角网格都参与，天线位置取自几何模型)
+ * @return 成功返回1，失败返回0
+ * @note 机体坐标系即零姿态：部件按零姿态变换后与机体轴对齐，和网格一样随机体刚性旋转
+ */
+int obstruction_mask_build(ObstructionMask* mask, const AircraftGeometry* geometry) {
+    if (!mask || !geometry) {
+        return 0;
+    }
+
+    // 从文件映射的掩码改为内存栅格
+    mask_release_mapping(mask);
+    if (!mask->cells) {
+        mask->cells = (ObstructionMaskCell*)malloc(sizeof(ObstructionMaskCell) * OBSTRUCTION_MASK_CELL_COUNT);
+        if (!mask->cells) {
+            error_set(ERROR_MEMORY, "遮挡掩码内存分配失败", __func__, __FILE__, __LINE__);
+            return 0;
+        }
+    }
+
+    clock_t start_time = clock();
+
+    // 零姿态变换得到机体坐标系中的部件，部件较多时与批量计算一样构建BVH
+    TransformedGeometry* body = transformed_geometry_create(geometry->component_count);
+    AircraftAttitude level;
+    memset(&level, 0, sizeof(AircraftAttitude));
+    if (!body || !transformed_geometry_update(body, geometry, &level)) {
+        transformed_geometry_destroy(body);
+        return 0;
+    }
+
+    GeometryBvh* bvh = NULL;
+    if (body->component_count > 0) {
+        bvh = geometry_bvh_create(body->components, body->component_count);
+        if (!bvh) {
+            transformed_geometry_destroy(body);
+            return 0;
+        }
+    }
+
+    Ray ray;
+    ray.origin = geometry->antenna_position;
+    ray.length = OBSTRUCTION_MASK_RAY_LENGTH;
+    mask->blocked_cells = 0;
+
+    // 单元中心位于整度数
+    for (int e = 0; e < OBSTRUCTION_MASK_ELEVATION_CELLS; e++) {
+        double elevation = (e - 90) * OBSTRUCTION_MASK_RESOLUTION * M_PI / 180.0;
+        double cos_el = cos(elevation);
+        double sin_el = sin(elevation);
+
+        for (int a = 0; a < OBSTRUCTION_MASK_AZIMUTH_CELLS; a++) {
+            double azimuth = a * OBSTRUCTION_MASK_RESOLUTION * M_PI / 180.0;
+            ray.direction = vector3d_create(cos_el * cos(azimuth), cos_el * sin(azimuth), sin_el);
+
+            ObstructionMaskCell* cell = &mask->cells[e * OBSTRUCTION_MASK_AZIMUTH_CELLS + a];
+            mask_rasterize_cell(body, bvh, &ray, cell);
+            mask->blocked_cells += cell->blocked;
+        }
+    }
+
+    geometry_bvh_destroy(bvh);
+    transformed_geometry_destroy(body);
+
+    mask->geometry = geometry;
+    mask->geometry_version = geometry->version;
+    mask->antenna_position = geometry->antenna_position;
+    mask->fingerprint = obstruction_mask_fingerprint(geometry);
+    mask->valid = 1;
+    mask->build_time = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+
+    LOG_INFO_FMT("遮挡掩码构建完成: %d/%d个单元被遮挡, 耗时%.3f秒",
+                 mask->blocked_cells, OBSTRUCTION_MASK_CELL_COUNT, mask->build_time);
+    return 1;
+}
+
+/**
+ * @brief 检查掩码是否与几何模型一致
+ * @param mask 遮挡掩码
+ * @param geometry 几何模型
+ * @return 一致返回1，需要重建返回0
+ */
+int obstruction_mask_is_current(const ObstructionMask* mask, const AircraftGeometry* geometry) {
+    if (!mask || !geometry || !mask->valid) {
+        return 0;
+    }
+
+    return mask->geometry == geometry &&
+           mask->geometry_version == geometry->version &&
+           mask->antenna_position.x == geometry->antenna_position.x &&
+           mask->antenna_position.y == geometry->antenna_position.y &&
+           mask->antenna_position.z == geometry->antenna_position.z;
+}
+
+/**
+ * @brief 几何模型或天线位置变化时重建掩码
+ * @param mask 遮挡掩码
+ * @param geometry 几何模型
+ * @return 成功返回1，失败返回0
+ */
+int obstruction_mask_update(ObstructionMask* mask, const AircraftGeometry* geometry) {
+    if (obstruction_mask_is_current(mask, geometry)) {
+        return 1;
+    }
+
+    return obstruction_mask_build(mask, geometry);
+}
+
+/**
+ * @brief 机体坐标系方向对应的掩码单元下标
+ * @param body_direction 机体坐标系中天线指向卫星的方向 (无需归一化)
+ * @return 单元下标 (高度角行 * 方位角列数 + 方位角列)
+ */
+int obstruction_mask_cell_index(const Vector3D* body_direction) {
+    double horizontal = sqrt(body_direction->x * body_direction->x + body_direction->y * body_direction->y);
+    double azimuth = math_atan2(body_direction->y, body_direction->x) * 180.0 / M_PI;
+    double elevation = math_atan2(body_direction->z, horizontal) * 180.0 / M_PI;
+
+    // 四舍五入到最近的单元中心
+    int a = (int)floor(azimuth / OBSTRUCTION_MASK_RESOLUTION + 0.5);
+    int e = (int)floor(elevation / OBSTRUCTION_MASK_RESOLUTION + 0.5) + 90;
+    a %= OBSTRUCTION_MASK_AZIMUTH_CELLS;
+    if (a < 0) a += OBSTRUCTION_MASK_AZIMUTH_CELLS;
+    if (e < 0) e = 0;
+    if (e >= OBSTRUCTION_MASK_ELEVATION_CELLS) e = OBSTRUCTION_MASK_ELEVATION_CELLS - 1;
+
+    return e * OBSTRUCTION_MASK_AZIMUTH_CELLS + a;
+}
+
+/**
+ * @brief 读取指定单元 (内存栅格或映射文件)
+ * @param mask 遮挡掩码 (已构建或已加载)
+ * @param index 单元下标
+ * @param cell 掩码单元 (输出)
+ */
+static void mask_read_cell(const ObstructionMask* mask, int index, ObstructionMaskCell* cell) {
+    if (mask->cells) {
+        *cell = mask->cells[index];
+        return;
+    }
+
+    memset(cell, 0, sizeof(ObstructionMaskCell));
+    int e = index / OBSTRUCTION_MASK_AZIMUTH_CELLS;
+    int a = index % OBSTRUCTION_MASK_AZIMUTH_CELLS;
+
+    // 行内二分查找起点不大于a的最后一个游程
+    uint32_t low = mask->row_offsets[e];
+    uint32_t high = mask->row_offsets[e + 1];
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (mask->runs[mid].start <= a) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == mask->row_offsets[e]) {
+        return;
+    }
+
+    const ObstructionMaskRun* run = &mask->runs[low - 1];
+    if (a >= run->start + run->length) {
+        return;
+    }
+
+    const float* value = &mask->values[2 * (run->value_index + (uint32_t)(a - run->start))];
+    cell->blocked = 1;
+    cell->part_type = (unsigned char)run->part_type;
+    cell->distance = value[0];
+    cell->signal_loss = value[1];
+}
+
+/**
+ * @brief 按机体坐标系方向查询掩码单元
+ * @param mask 遮挡掩码
+ * @param body_direction 机体坐标系中天线指向卫星的方向 (无需归一化)
+ * @param cell 掩码单元 (输出)
+ * @return 成功返回1，掩码未构建返回0
+ */
+int obstruction_mask_lookup(const ObstructionMask* mask, const Vector3D* body_direction,
+                            ObstructionMaskCell* cell) {
+    if (!mask || !mask->valid || !body_direction || !cell) {
+        return 0;
+    }
+
+    mask_read_cell(mask, obstruction_mask_cell_index(body_direction), cell);
+    return 1;
+}
+
+/* =================== 掩码文件 =================== */
+
+/**
+ * @brief 把掩码保存为文件 (只记录被遮挡的单元)
+ * @param mask 遮挡掩码 (已构建或已加载)
+ * @param filename 文件名
+ * @return 成功返回1，失败返回0
+ */
+int obstruction_mask_save(const ObstructionMask* mask, const char* filename) {
+    if (!mask || !mask->valid || !filename) {
+        return 0;
+    }
+
+    // 先统计游程数，再一次性生成行索引、游程表和数值表
+    uint32_t* row_offsets = (uint32_t*)malloc(sizeof(uint32_t) * (OBSTRUCTION_MASK_ELEVATION_CELLS + 1));
+    ObstructionMaskRun* runs = (ObstructionMaskRun*)malloc(sizeof(ObstructionMaskRun) * OBSTRUCTION_MASK_CELL_COUNT);
+    float* values = (float*)malloc(sizeof(float) * 2 * OBSTRUCTION_MASK_CELL_COUNT);
+    if (!row_offsets || !runs || !values) {
+        free(row_offsets);
+        free(runs);
+        free(values);
+        error_set(ERROR_MEMORY, "遮挡掩码文件缓冲区分配失败", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    uint32_t run_count = 0, value_count = 0;
+    for (int e = 0; e < OBSTRUCTION_MASK_ELEVATION_CELLS; e++) {
+        row_offsets[e] = run_count;
+        ObstructionMaskRun* current = NULL;
+        for (int a = 0; a < OBSTRUCTION_MASK_AZIMUTH_CELLS; a++) {
+            ObstructionMaskCell cell;
+            mask_read_cell(mask, e * OBSTRUCTION_MASK_AZIMUTH_CELLS + a, &cell);
+            if (!cell.blocked) {
+                current = NULL;
+                continue;
+            }
+
+            if (!current || current->part_type != cell.part_type) {
+                current = &runs[run_count++];
+                memset(current, 0, sizeof(ObstructionMaskRun));
+                current->start = (uint16_t)a;
+                current->part_type = cell.part_type;
+                current->value_index = value_count;
+            }
+            current->length++;
+            values[2 * value_count] = cell.distance;
+            values[2 * value_count + 1] = cell.signal_loss;
+            value_count++;
+        }
+    }
+    row_offsets[OBSTRUCTION_MASK_ELEVATION_CELLS] = run_count;
+
+    MaskFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MASK_FILE_MAGIC, sizeof(header.magic));
+    header.version = MASK_FILE_VERSION;
+    header.endian_mark = MASK_FILE_ENDIAN_MARK;
+    header.azimuth_cells = OBSTRUCTION_MASK_AZIMUTH_CELLS;
+    header.elevation_cells = OBSTRUCTION_MASK_ELEVATION_CELLS;
+    header.run_count = run_count;
+    header.blocked_cells = value_count;
+    header.resolution = OBSTRUCTION_MASK_RESOLUTION;
+    header.antenna[0] = mask->antenna_position.x;
+    header.antenna[1] = mask->antenna_position.y;
+    header.antenna[2] = mask->antenna_position.z;
+    header.fingerprint = mask->fingerprint;
+
+    size_t offsets_size = sizeof(uint32_t) * (OBSTRUCTION_MASK_ELEVATION_CELLS + 1);
+    size_t runs_size = sizeof(ObstructionMaskRun) * run_count;
+    size_t values_size = sizeof(float) * 2 * value_count;
+    uint64_t checksum = fnv1a_update(FNV_OFFSET_BASIS, row_offsets, offsets_size);
+    checksum = fnv1a_update(checksum, runs, runs_size);
+    header.checksum = fnv1a_update(checksum, values, values_size);
+
+    /* 先写临时文件再重命名，避免并发回放读到半个文件 */
+    char temp_name[1024];
+    snprintf(temp_name, sizeof(temp_name), "%s.tmp", filename);
+
+    int ok = 0;
+    FILE* file = fopen(temp_name, "wb");
+    if (file) {
+        ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(row_offsets, offsets_size, 1, file) == 1 &&
+             (runs_size == 0 || fwrite(runs, runs_size, 1, file) == 1) &&
+             (values_size == 0 || fwrite(values, values_size, 1, file) == 1);
+        ok = (fclose(file) == 0) && ok;
+    }
+
+    free(row_offsets);
+    free(runs);
+    free(values);
+
+    if (!ok || rename(temp_name, filename) != 0) {
+        remove(temp_name);
+        error_set(ERROR_FILE, "写入遮挡掩码文件失败", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    LOG_INFO_FMT("遮挡掩码已保存: %s, %u个游程, %u个被遮挡单元, %zu字节", filename, run_count, value_count,
+                 sizeof(header) + offsets_size + runs_size + values_size);
+    return 1;
+}
+
+/**
+ * @brief 映射掩码文件并绑定到几何模型 (零拷贝，查询直接读文件内容)
+ * @param mask 遮挡掩码 (原有内容被替换)
+ * @param filename 文件名
+ * @param geometry 几何模型，指纹和天线位置须与文件一致
+ * @return 成功返回1，文件无效或机型不匹配返回0 (掩码保持未构建)
+ */
+int obstruction_mask_load(ObstructionMask* mask, const char* filename, const AircraftGeometry* geometry) {
+    if (!mask || !filename || !geometry) {
+        return 0;
+    }
+
+    size_t length = 0;
+    void* mapping = map_file(filename, &length);
+    if (!mapping) {
+        error_set(ERROR_FILE, "无法打开遮挡掩码文件", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    const MaskFileHeader* header = (const MaskFileHeader*)mapping;
+    const uint32_t* row_offsets = (const uint32_t*)((const char*)mapping + sizeof(MaskFileHeader));
+    const ObstructionMaskRun* runs = (const ObstructionMaskRun*)(row_offsets + OBSTRUCTION_MASK_ELEVATION_CELLS + 1);
+    size_t runs_offset = (size_t)((const char*)runs - (const char*)mapping);
+
+    int valid = length >= runs_offset &&
+                memcmp(header->magic, MASK_FILE_MAGIC, sizeof(header->magic)) == 0 &&
+                header->version == MASK_FILE_VERSION &&
+                header->endian_mark == MASK_FILE_ENDIAN_MARK &&
+                header->azimuth_cells == OBSTRUCTION_MASK_AZIMUTH_CELLS &&
+                header->elevation_cells == OBSTRUCTION_MASK_ELEVATION_CELLS &&
+                header->resolution == OBSTRUCTION_MASK_RESOLUTION &&
+                length == runs_offset + sizeof(ObstructionMaskRun) * header->run_count +
+                          sizeof(float) * 2 * header->blocked_cells &&
+                fnv1a_update(FNV_OFFSET_BASIS, row_offsets, length - sizeof(MaskFileHeader)) == header->checksum;
+
+    // 索引越界的文件即使校验和正确也拒绝，查询时不再检查
+    const float* values = (const float*)(runs + (valid ? header->run_count : 0));
+    for (int e = 0; valid && e < OBSTRUCTION_MASK_ELEVATION_CELLS; e++) {
+        valid = row_offsets[e] <= row_offsets[e + 1];
+    }
+    valid = valid && row_offsets[OBSTRUCTION_MASK_ELEVATION_CELLS] == header->run_count;
+    for (uint32_t i = 0; valid && i < header->run_count; i++) {
+        valid = runs[i].start + runs[i].length <= OBSTRUCTION_MASK_AZIMUTH_CELLS &&
+                runs[i].value_index + runs[i].length <= header->blocked_cells;
+    }
+
+    if (!valid) {
+        unmap_file(mapping, length);
+        error_set(ERROR_PARSE, "遮挡掩码文件格式无效或已损坏", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    Vector3D antenna = vector3d_create(header->antenna[0], header->antenna[1], header->antenna[2]);
+    unsigned long long fingerprint = obstruction_mask_fingerprint(geometry);
+    if (header->fingerprint != fingerprint ||
+        antenna.x != geometry->antenna_position.x ||
+        antenna.y != geometry->antenna_position.y ||
+        antenna.z != geometry->antenna_position.z) {
+        unmap_file(mapping, length);
+        error_set(ERROR_PARAMETER, "遮挡掩码文件与几何模型不匹配", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    // 映射后不再需要内存栅格
+    mask_release_mapping(mask);
+    free(mask->cells);
+    mask->cells = NULL;
+
+    mask->mapping = mapping;
+    mask->mapping_size = length;
+    mask->row_offsets = row_offsets;
+    mask->runs = runs;
+    mask->values = values;
+    mask->geometry = geometry;
+    mask->geometry_version = geometry->version;
+    mask->antenna_position = antenna;
+    mask->fingerprint = fingerprint;
+    mask->blocked_cells = (int)header->blocked_cells;
+    mask->build_time = 0.0;
+    mask->valid = 1;
+    return 1;
+}
+
+/**
+ * @brief 优先映射已有的掩码文件，文件缺失或机型不匹配时重新构建并保存
+ * @param mask 遮挡掩码
+ * @param geometry 几何模型
+ * @param filename 掩码文件名
+ * @return 成功返回1，失败返回0
+ * @note 同一机型的批量回放只有第一次需要射线求交；保存失败不影响本次使用
+ */
+int obstruction_mask_load_cached(ObstructionMask* mask, const AircraftGeometry* geometry,
+                                 const char* filename) {
+    if (!mask || !geometry || !filename) {
+        return 0;
+    }
+
+    if (file_exists(filename) && obstruction_mask_load(mask, filename, geometry)) {
+        LOG_INFO_FMT("从文件加载遮挡掩码: %s, %d个单元被遮挡", filename, mask->blocked_cells);
+        return 1;
+    }
+    error_clear();
+
+    if (!obstruction_mask_build(mask, geometry)) {
+        return 0;
+    }
+
+    if (!obstruction_mask_save(mask, filename)) {
+        LOG_WARNING("遮挡掩码文件写入失败，下次将重新构建");
+    }
+    return 1;
+}
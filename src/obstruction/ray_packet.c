@@ -0,0 +1,419 @@
+#include "obstruction.h"
+#include "../utils/utils.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define PACKET_ALIGNMENT 32              /* AVX2寄存器宽度 (字节) */
+#define PACKET_PARALLEL_EPSILON 1e-10    /* 与ray_box_intersection一致的平行判定阈值 */
+#define PACKET_SWEEP_LENGTH 1.0e6        /* 天空扫描射线长度，远大于机体尺寸即可 */
+
+/* 部件在射线包公共原点下的局部参数 (每个部件计算一次，所有射线共用) */
+typedef struct {
+    double r[3][3];                      /* 机体 -> 部件局部旋转 */
+    double origin[3];                    /* 公共原点在部件局部坐标系中的位置 */
+    double half[3];                      /* 半尺寸 */
+    int part_type;
+} PacketBox;
+
+static void packet_box_prepare(const RayPacket* packet, const AircraftComponent* component, PacketBox* box) {
+    // 优先使用缓存的变换，缓存缺失或过期时临时计算 (与ray_component_intersection相同)
+    RotationMatrix world_to_local = component->world_to_local;
+    if (!aircraft_component_transform_is_current(component)) {
+        RotationMatrix local_to_world = rotation_matrix_create_from_euler(
+            component->rotation.x, component->rotation.y, component->rotation.z
+        );
+        world_to_local = rotation_matrix_transpose(&local_to_world);
+    }
+
+    Vector3D offset = vector3d_subtract(&packet->origin, &component->position);
+    Vector3D local_origin = vector3d_rotate(&offset, &world_to_local);
+
+    memcpy(box->r, world_to_local.m, sizeof(box->r));
+    box->origin[0] = local_origin.x;
+    box->origin[1] = local_origin.y;
+    box->origin[2] = local_origin.z;
+    box->half[0] = component->size.x / 2.0;
+    box->half[1] = component->size.y / 2.0;
+    box->half[2] = component->size.z / 2.0;
+    box->part_type = component->part_type;
+}
+
+/* 记录比当前最近遮挡更近的命中 */
+static inline void packet_record_hit(RayPacket* packet, int i, double t, int part_type) {
+    packet->distance[i] = t;
+    packet->part_type[i] = part_type;
+    packet->blocked[i] = 1;
+}
+
+/* =================== 平板法内核 =================== */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PACKET_HAVE_VECTOR_KERNEL 1
+
+/* 与aircraft_model.c相同的做法：同一内核分别按AVX2和基线SSE2编译，运行时选择 */
+typedef double PacketVec __attribute__((vector_size(32)));
+typedef long long PacketMask __attribute__((vector_size(32)));
+
+#define PACKET_LOAD(field, i) (*(const PacketVec*)&packet->field[i])
+#define packet_select(mask, a, b) \
+    ((PacketVec)(((mask) & (PacketMask)(a)) | (~(mask) & (PacketMask)(b))))
+
+/* 单轴平板：与ray_box_intersection逐项对应 (除法而非倒数乘法，结果逐位一致) */
+static inline __attribute__((always_inline)) void packet_slab(const PacketVec* d, double origin, double half,
+                                                              PacketVec* t_min, PacketVec* t_max) {
+    PacketVec abs_d = packet_select(*d < 0.0, -*d, *d);
+    PacketMask parallel = abs_d <= PACKET_PARALLEL_EPSILON;
+    PacketVec t1 = (-half - origin) / *d;
+    PacketVec t2 = (half - origin) / *d;
+    PacketMask swap = t1 > t2;
+    PacketVec near = packet_select(swap, t2, t1);
+    PacketVec far = packet_select(swap, t1, t2);
+
+    // 平行于该轴：原点在平板内不受约束，在平板外必然不相交
+    int outside = origin < -half || origin > half;
+    PacketVec inf = {INFINITY, INFINITY, INFINITY, INFINITY};
+    near = packet_select(parallel, outside ? inf : -inf, near);
+    far = packet_select(parallel, outside ? -inf : inf, far);
+
+    *t_min = packet_select(near > *t_min, near, *t_min);
+    *t_max = packet_select(far < *t_max, far, *t_max);
+}
+
+static inline __attribute__((always_inline)) void packet_box_kernel(RayPacket* packet, const PacketBox* box) {
+    for (int i = 0; i < packet->count; i += RAY_PACKET_LANES) {
+        PacketVec dx = PACKET_LOAD(dx, i), dy = PACKET_LOAD(dy, i), dz = PACKET_LOAD(dz, i);
+
+        // 方向旋转到部件局部坐标系 (原点已在box中预先变换)
+        PacketVec lx = box->r[0][0] * dx + box->r[0][1] * dy + box->r[0][2] * dz;
+        PacketVec ly = box->r[1][0] * dx + box->r[1][1] * dy + box->r[1][2] * dz;
+        PacketVec lz = box->r[2][0] * dx + box->r[2][1] * dy + box->r[2][2] * dz;
+
+        PacketVec t_min = {0.0, 0.0, 0.0, 0.0};
+        PacketVec t_max = PACKET_LOAD(length, i);
+        packet_slab(&lx, box->origin[0], box->half[0], &t_min, &t_max);
+        packet_slab(&ly, box->origin[1], box->half[1], &t_min, &t_max);
+        packet_slab(&lz, box->origin[2], box->half[2], &t_min, &t_max);
+
+        // 只保留比已有遮挡更近的命中 (相同距离保留先出现的部件)
+        PacketMask hit = (t_min <= t_max) & (t_min < PACKET_LOAD(distance, i));
+        for (int lane = 0; lane < RAY_PACKET_LANES; lane++) {
+            if (hit[lane] && i + lane < packet->count) {
+                packet_record_hit(packet, i + lane, t_min[lane], box->part_type);
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void packet_box_avx2(RayPacket* packet, const PacketBox* box) {
+    packet_box_kernel(packet, box);
+}
+
+static void packet_box_sse2(RayPacket* packet, const PacketBox* box) {
+    packet_box_kernel(packet, box);
+}
+#endif /* 向量化内核 */
+
+/* 标量回退 (非GCC/x86平台)：逐条射线调用ray_box_intersection */
+static void packet_box_scalar(RayPacket* packet, const PacketBox* box) {
+    ObstructionBody body;
+    memset(&body, 0, sizeof(body));
+    body.size = vector3d_create(box->half[0] * 2.0, box->half[1] * 2.0, box->half[2] * 2.0);
+
+    Ray local_ray;
+    local_ray.origin = vector3d_create(box->origin[0], box->origin[1], box->origin[2]);
+
+    for (int i = 0; i < packet->count; i++) {
+        double dx = packet->dx[i], dy = packet->dy[i], dz = packet->dz[i];
+        local_ray.direction = vector3d_create(box->r[0][0] * dx + box->r[0][1] * dy + box->r[0][2] * dz,
+                                              box->r[1][0] * dx + box->r[1][1] * dy + box->r[1][2] * dz,
+                                              box->r[2][0] * dx + box->r[2][1] * dy + box->r[2][2] * dz);
+        local_ray.length = packet->length[i];
+
+        double t;
+        if (ray_box_intersection(&local_ray, &body, NULL, &t) && t < packet->distance[i]) {
+            packet_record_hit(packet, i, t, box->part_type);
+        }
+    }
+}
+
+/* 按CPU能力选择内核，结果在首次调用时确定 */
+typedef enum {
+    PACKET_KERNEL_UNSELECTED = 0,
+    PACKET_KERNEL_SCALAR,
+    PACKET_KERNEL_SSE2,
+    PACKET_KERNEL_AVX2
+} PacketKernel;
+
+static PacketKernel packet_kernel_select(void) {
+    static PacketKernel selected = PACKET_KERNEL_UNSELECTED;
+
+    if (selected == PACKET_KERNEL_UNSELECTED) {
+#ifdef PACKET_HAVE_VECTOR_KERNEL
+        __builtin_cpu_init();
+        selected = __builtin_cpu_supports("avx2") ? PACKET_KERNEL_AVX2 : PACKET_KERNEL_SSE2;
+#else
+        selected = PACKET_KERNEL_SCALAR;
+#endif
+    }
+
+    return selected;
+}
+
+/**
+ * @brief 当前使用的射线包内核名称
+ * @return "AVX2"、"SSE2"或"SCALAR"
+ */
+const char* ray_packet_kernel_name(void) {
+    switch (packet_kernel_select()) {
+        case PACKET_KERNEL_AVX2: return "AVX2";
+        case PACKET_KERNEL_SSE2: return "SSE2";
+        default: return "SCALAR";
+    }
+}
+
+/* =================== 射线包管理 =================== */
+
+/**
+ * @brief 创建射线包
+ * @param capacity 最大射线数量
+ * @return 创建的射线包
+ */
+RayPacket* ray_packet_create(int capacity) {
+    if (capacity <= 0) {
+        return NULL;
+    }
+
+    RayPacket* packet = (RayPacket*)malloc(sizeof(RayPacket));
+    if (!packet) {
+        return NULL;
+    }
+    memset(packet, 0, sizeof(RayPacket));
+
+    // 5个double列 + 2个int列共用一块对齐内存，列长度按通道数补齐
+    int columns = (capacity + RAY_PACKET_LANES - 1) / RAY_PACKET_LANES * RAY_PACKET_LANES;
+    size_t double_size = sizeof(double) * columns;
+    size_t int_size = sizeof(int) * columns;
+    size_t block_size = double_size * 5 + int_size * 2;
+    block_size = (block_size + PACKET_ALIGNMENT - 1) / PACKET_ALIGNMENT * PACKET_ALIGNMENT;
+
+    packet->block = (double*)aligned_alloc(PACKET_ALIGNMENT, block_size);
+    if (!packet->block) {
+        free(packet);
+        error_set(ERROR_MEMORY, "射线包内存分配失败", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+    memset(packet->block, 0, block_size);
+
+    packet->capacity = columns;
+    packet->dx = packet->block;
+    packet->dy = packet->dx + columns;
+    packet->dz = packet->dy + columns;
+    packet->length = packet->dz + columns;
+    packet->distance = packet->length + columns;
+    packet->part_type = (int*)(packet->distance + columns);
+    packet->blocked = packet->part_type + columns;
+
+    return packet;
+}
+
+/**
+ * @brief 销毁射线包
+ * @param packet 射线包
+ */
+void ray_packet_destroy(RayPacket* packet) {
+    if (!packet) {
+        return;
+    }
+
+    free(packet->block);  /* aligned_alloc分配的内存 */
+    free(packet);
+}
+
+/**
+ * @brief 清空射线包并设置公共原点
+ * @param packet 射线包
+ * @param origin 公共原点 (天线位置)
+ */
+void ray_packet_reset(RayPacket* packet, const Vector3D* origin) {
+    if (!packet || !origin) {
+        return;
+    }
+
+    packet->origin = *origin;
+    packet->count = 0;
+}
+
+/**
+ * @brief 添加一条射线
+ * @param packet 射线包
+ * @param direction 方向 (无需归一化)
+ * @param length 射线长度 (米)
+ * @return 成功返回1，射线包已满或方向为零返回0
+ */
+int ray_packet_add(RayPacket* packet, const Vector3D* direction, double length) {
+    if (!packet || !direction || packet->count >= packet->capacity) {
+        return 0;
+    }
+
+    double norm = vector3d_length(direction);
+    if (norm <= 0.0) {
+        return 0;
+    }
+
+    int i = packet->count++;
+    packet->dx[i] = direction->x / norm;
+    packet->dy[i] = direction->y / norm;
+    packet->dz[i] = direction->z / norm;
+    packet->length[i] = length;
+    return 1;
+}
+
+/**
+ * @brief 用上半球的方位/高度角网格填充射线包 (天空图扫描)
+ * @param packet 射线包
+ * @param origin 公共原点 (天线位置)
+ * @param resolution 网格间距 (度)，方位角0~360°(不含)，高度角0~90°
+ * @return 填充的射线数量，容量不足或参数无效返回0
+ * @note 射线顺序为高度角优先：第k行(高度角k*resolution)的第j条射线方位角为j*resolution
+ */
+int ray_packet_fill_hemisphere(RayPacket* packet, const Vector3D* origin, double resolution) {
+    if (!packet || !origin || resolution <= 0.0 || resolution > 90.0) {
+        return 0;
+    }
+
+    int azimuth_steps = (int)ceil(360.0 / resolution - 1e-9);
+    int elevation_steps = (int)floor(90.0 / resolution + 1e-9) + 1;
+    if ((long long)azimuth_steps * elevation_steps > packet->capacity) {
+        error_set(ERROR_PARAMETER, "射线包容量不足", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    ray_packet_reset(packet, origin);
+    for (int e = 0; e < elevation_steps; e++) {
+        double elevation = e * resolution * M_PI / 180.0;
+        double cos_el = cos(elevation), sin_el = sin(elevation);
+        for (int a = 0; a < azimuth_steps; a++) {
+            double azimuth = a * resolution * M_PI / 180.0;
+            Vector3D direction = vector3d_create(cos_el * cos(azimuth), cos_el * sin(azimuth), sin_el);
+            ray_packet_add(packet, &direction, PACKET_SWEEP_LENGTH);
+        }
+    }
+
+    return packet->count;
+}
+
+/* =================== 求交 =================== */
+
+/* 输出列初始化为未遮挡，补齐通道的射线长度为0，不会命中 */
+static void packet_clear_hits(RayPacket* packet) {
+    int padded = (packet->count + RAY_PACKET_LANES - 1) / RAY_PACKET_LANES * RAY_PACKET_LANES;
+    for (int i = packet->count; i < padded; i++) {
+        packet->dx[i] = 0.0;
+        packet->dy[i] = 0.0;
+        packet->dz[i] = 1.0;
+        packet->length[i] = 0.0;
+    }
+    for (int i = 0; i < padded; i++) {
+        packet->distance[i] = packet->length[i];
+        packet->part_type[i] = AIRCRAFT_PART_FUSELAGE;
+        packet->blocked[i] = 0;
+    }
+}
+
+static void packet_intersect_box(RayPacket* packet, const PacketBox* box) {
+    switch (packet_kernel_select()) {
+#ifdef PACKET_HAVE_VECTOR_KERNEL
+        case PACKET_KERNEL_AVX2:
+            packet_box_avx2(packet, box);
+            break;
+        case PACKET_KERNEL_SSE2:
+            packet_box_sse2(packet, box);
+            break;
+#endif
+        default:
+            packet_box_scalar(packet, box);
+            break;
+    }
+}
+
+static int packet_count_blocked(const RayPacket* packet) {
+    int blocked = 0;
+    for (int i = 0; i < packet->count; i++) {
+        blocked += packet->blocked[i];
+    }
+    return blocked;
+}
+
+/**
+ * @brief 射线包与部件求交，每条射线保留最近的遮挡
+ * @param packet 射线包 (输出列被覆盖)
+ * @param components 部件数组 (与射线同一坐标系)
+ * @param component_count 部件数量
+ * @return 被遮挡的射线数量
+ */
+int ray_packet_intersect_components(RayPacket* packet, const AircraftComponent* components,
+                                    int component_count) {
+    if (!packet || (component_count > 0 && !components)) {
+        return 0;
+    }
+
+    packet_clear_hits(packet);
+
+    // 部件在外层：局部原点和旋转每个部件只准备一次
+    for (int c = 0; c < component_count; c++) {
+        if (!components[c].is_obstructing) {
+            continue;
+        }
+
+        PacketBox box;
+        packet_box_prepare(packet, &components[c], &box);
+        packet_intersect_box(packet, &box);
+    }
+
+    return packet_count_blocked(packet);
+}
+
+/**
+ * @brief 射线包与变换几何模型求交 (部件 + 三角网格)
+ * @param packet 射线包，原点为机体坐标系中的天线位置，方向在世界坐标系中
+ * @param transformed 变换几何模型
+ * @return 被遮挡的射线数量
+ * @note 部件逐个用SIMD平板法测试整个射线包，不经过BVH；三角网格逐条射线求交
+ */
+int ray_packet_intersect_transformed(RayPacket* packet, const TransformedGeometry* transformed) {
+    if (!packet || !transformed) {
+        return 0;
+    }
+
+    // 部件随机体旋转到世界坐标系，公共原点 (机体坐标系中的天线) 随之旋转后求交
+    Vector3D body_origin = packet->origin;
+    packet->origin = vector3d_rotate(&body_origin, &transformed->body_to_world);
+    ray_packet_intersect_components(packet, transformed->components, transformed->component_count);
+    packet->origin = body_origin;
+
+    // 三角网格留在机体坐标系，射线方向变换到机体坐标系 (与单条射线的处理一致)
+    if (transformed->mesh) {
+        Ray body_ray;
+        body_ray.origin = packet->origin;
+        for (int i = 0; i < packet->count; i++) {
+            Vector3D direction = vector3d_create(packet->dx[i], packet->dy[i], packet->dz[i]);
+            body_ray.direction = vector3d_rotate(&direction, &transformed->world_to_body);
+            body_ray.length = packet->length[i];
+
+            double distance;
+            AircraftPart part;
+            if (triangle_mesh_intersect_closest(transformed->mesh, &body_ray, &distance, &part) &&
+                (!packet->blocked[i] || distance < packet->distance[i])) {
+                packet_record_hit(packet, i, distance, part);
+            }
+        }
+    }
+
+    return packet_count_blocked(packet);
+}
@@ -0,0 +1,451 @@
+#define _POSIX_C_SOURCE 200809L  /* sysconf */
+#include "obstruction.h"
+#include "../utils/utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/* 工作线程每次领取的时间步数 (过小加锁频繁，过大负载不均) */
+#define TRAJECTORY_ANALYSIS_CHUNK 64
+
+/* 工作线程共享的任务队列 (按块领取时间步) */
+typedef struct {
+    const AircraftGeometry* geometry;
+    const SatelliteData* satellite_data;
+    const FlightTrajectory* trajectory;
+    const ObstructionParams* params;
+    const TrajectoryAnalysisConfig* config;
+    TrajectoryAnalysisResult* result;
+    int next_step;
+    int completed_steps;
+    int failed;
+    ErrorInfo error;                 /* 第一个出错的工作线程收集到的错误 */
+    pthread_mutex_t mutex;
+} TrajectoryAnalysisQueue;
+
+/* 每个工作线程独占的计算状态 (变换几何、BVH和星历批量结构都会被写入，不能共享) */
+typedef struct {
+    AircraftComponent* storage;
+    TransformedGeometry transformed;
+    GeometryBvh* bvh;
+    SatelliteEphemerisBatch* batch;  /* 传播星历时使用 */
+    Satellite* satellites;           /* 传播星历时的卫星副本 */
+    ObstructionCoherenceCache* coherence; /* 时间相干缓存 (coherence_tolerance>0时) */
+} TrajectoryWorker;
+
+/* 墙钟时间 (毫秒)；clock()统计的是进程CPU时间，不适用于多线程计时 */
+static double wall_time_ms(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/**
+ * @brief 初始化轨迹分析配置为默认值
+ * @param config 配置
+ */
+void trajectory_analysis_config_default(TrajectoryAnalysisConfig* config) {
+    if (!config) {
+        return;
+    }
+
+    memset(config, 0, sizeof(TrajectoryAnalysisConfig));
+    config->thread_count = 0;
+    config->propagate_ephemeris = 1;
+    config->min_usable_satellites = TRAJECTORY_ANALYSIS_MIN_USABLE;
+    config->coherence_tolerance = OBSTRUCTION_COHERENCE_DEFAULT_TOLERANCE;
+}
+
+static void trajectory_worker_release(TrajectoryWorker* worker) {
+    geometry_bvh_destroy(worker->bvh);
+    satellite_ephemeris_batch_destroy(worker->batch);
+    obstruction_coherence_destroy(worker->coherence);
+    free(worker->storage);
+    free(worker->satellites);
+    memset(worker, 0, sizeof(TrajectoryWorker));
+}
+
+static int trajectory_worker_init(TrajectoryAnalysisQueue* queue, TrajectoryWorker* worker) {
+    const AircraftGeometry* geometry = queue->geometry;
+    const SatelliteData* data = queue->satellite_data;
+    memset(worker, 0, sizeof(TrajectoryWorker));
+
+    int capacity = geometry->component_count;
+    if (capacity > 0) {
+        worker->storage = (AircraftComponent*)malloc(sizeof(AircraftComponent) * capacity);
+        if (!worker->storage) {
+            return 0;
+        }
+    }
+    transformed_geometry_init(&worker->transformed, worker->storage, capacity);
+
+    // 与批量计算一致：部件较多时构建BVH，每个时间步只重新拟合包围盒
+    if (geometry->component_count >= OBSTRUCTION_BVH_MIN_COMPONENTS) {
+        worker->bvh = geometry_bvh_create(geometry->components, geometry->component_count);
+        if (!worker->bvh) {
+            trajectory_worker_release(worker);
+            return 0;
+        }
+        transformed_geometry_set_bvh(&worker->transformed, worker->bvh);
+    }
+
+    if (queue->config->mask) {
+        transformed_geometry_set_mask(&worker->transformed, queue->config->mask);
+    }
+
+    if (queue->config->propagate_ephemeris && data->satellite_count > 0) {
+        worker->satellites = (Satellite*)malloc(sizeof(Satellite) * data->satellite_count);
+        worker->batch = satellite_ephemeris_batch_create(data);
+        if (!worker->satellites || !worker->batch) {
+            trajectory_worker_release(worker);
+            return 0;
+        }
+        memcpy(worker->satellites, data->satellites, sizeof(Satellite) * data->satellite_count);
+    }
+
+    if (queue->config->coherence_tolerance > 0.0) {
+        worker->coherence = obstruction_coherence_create(queue->config->coherence_tolerance);
+        if (!worker->coherence) {
+            trajectory_worker_release(worker);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief 分析单个时间步，写入结果表中对应的行
+ * @return 成功返回1，失败返回0
+ */
+static int trajectory_analyze_step(TrajectoryAnalysisQueue* queue, TrajectoryWorker* worker, int step) {
+    const TrajectoryPoint* point = &queue->trajectory->points[step];
+    const AircraftState* state = &point->state;
+    TrajectoryAnalysisResult* result = queue->result;
+    int satellite_count = result->satellite_count;
+
+    TrajectoryStepResult* row = &result->steps[step];
+    unsigned char* states = &result->satellite_states[(size_t)step * satellite_count];
+    memset(row, 0, sizeof(TrajectoryStepResult));
+    memset(states, 0, satellite_count);
+    row->timestamp = point->timestamp;
+
+    if (!transformed_geometry_update(&worker->transformed, queue->geometry, &state->attitude)) {
+        return 0;
+    }
+
+    // 整个星座一次传播到当前时刻，写回本线程的卫星副本
+    const Satellite* satellites = queue->satellite_data->satellites;
+    if (worker->batch) {
+        SatelliteEphemerisBatch* batch = worker->batch;
+        satellite_ephemeris_batch_propagate(batch, (double)point->timestamp);
+        for (int i = 0; i < batch->count; i++) {
+            SatellitePosition* pos = &worker->satellites[batch->data_index[i]].pos;
+            pos->x = batch->x[i];
+            pos->y = batch->y[i];
+            pos->z = batch->z[i];
+            pos->vx = batch->vx[i];
+            pos->vy = batch->vy[i];
+            pos->vz = batch->vz[i];
+        }
+        satellites = worker->satellites;
+    }
+
+    // 同一时刻所有卫星共用接收机坐标系
+    ReceiverFrame frame;
+    if (!receiver_frame_init(&frame, state->position.latitude, state->position.longitude,
+                             state->position.altitude)) {
+        return 0;
+    }
+
+    for (int i = 0; i < satellite_count; i++) {
+        if (!satellites[i].is_valid) {
+            continue;
+        }
+
+        VisibilityAnalysis analysis;
+        if (!visibility_analyze_frame(&worker->transformed, &frame, &satellites[i],
+                                      queue->params, worker->coherence, &analysis)) {
+            return 0;
+        }
+
+        if (analysis.visibility.is_visible) {
+            states[i] |= TRAJECTORY_SAT_VISIBLE;
+            row->visible_satellites++;
+        }
+        if (analysis.obstruction.is_obstructed) {
+            states[i] |= TRAJECTORY_SAT_OBSTRUCTED;
+            row->obstructed_satellites++;
+        }
+        if (analysis.is_usable) {
+            states[i] |= TRAJECTORY_SAT_USABLE;
+            row->usable_satellites++;
+        }
+    }
+
+    row->available = row->usable_satellites >= queue->config->min_usable_satellites;
+    return 1;
+}
+
+static void trajectory_analysis_worker_run(TrajectoryAnalysisQueue* queue) {
+    int step_count = queue->result->step_count;
+
+    TrajectoryWorker worker;
+    if (!trajectory_worker_init(queue, &worker)) {
+        // 剩余时间步由其他线程领取
+        return;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&queue->mutex);
+        int first = -1;
+        if (!queue->failed && queue->next_step < step_count) {
+            first = queue->next_step;
+            queue->next_step += TRAJECTORY_ANALYSIS_CHUNK;
+        }
+        pthread_mutex_unlock(&queue->mutex);
+
+        if (first < 0) break;
+
+        int last = first + TRAJECTORY_ANALYSIS_CHUNK;
+        if (last > step_count) last = step_count;
+
+        // 每块从空缓存开始，结果与块的领取顺序和线程数无关
+        obstruction_coherence_clear(worker.coherence);
+
+        int ok = 1;
+        for (int step = first; step < last && ok; step++) {
+            ok = trajectory_analyze_step(queue, &worker, step);
+        }
+
+        pthread_mutex_lock(&queue->mutex);
+        if (ok) {
+            queue->completed_steps += last - first;
+        } else {
+            queue->failed = 1;
+        }
+        pthread_mutex_unlock(&queue->mutex);
+    }
+
+    if (worker.coherence) {
+        pthread_mutex_lock(&queue->mutex);
+        queue->result->coherence_reused += worker.coherence->stats.reused;
+        queue->result->coherence_computed += worker.coherence->stats.computed;
+        pthread_mutex_unlock(&queue->mutex);
+    }
+
+    trajectory_worker_release(&worker);
+}
+
+static void* trajectory_analysis_worker(void* arg) {
+    TrajectoryAnalysisQueue* queue = (TrajectoryAnalysisQueue*)arg;
+
+    /* 全局错误不是线程安全的: 先收集到线程私有位置，汇合后由调用线程设置 */
+    ErrorInfo error;
+    error_capture_begin(&error);
+    trajectory_analysis_worker_run(queue);
+    error_capture_end();
+
+    if (error.code != ERROR_NONE) {
+        pthread_mutex_lock(&queue->mutex);
+        if (queue->error.code == ERROR_NONE) {
+            queue->error = error;
+        }
+        pthread_mutex_unlock(&queue->mutex);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 时间步的持续时长：到下一轨迹点的间隔，最后一步沿用前一间隔
+ */
+static double trajectory_step_duration(const FlightTrajectory* trajectory, int step) {
+    int count = trajectory->point_count;
+    if (count < 2) {
+        return 0.0;
+    }
+
+    int next = step + 1 < count ? step + 1 : step;
+    int prev = next - 1;
+    double duration = difftime(trajectory->points[next].timestamp, trajectory->points[prev].timestamp);
+    return duration > 0.0 ? duration : 0.0;
+}
+
+/* 线程全部结束后单线程汇总，结果与线程数和调度顺序无关 */
+static void trajectory_analysis_summarize(const FlightTrajectory* trajectory,
+                                          TrajectoryAnalysisResult* result) {
+    double current_outage = 0.0;
+    time_t current_outage_start = 0;
+    int available_steps = 0;
+
+    for (int step = 0; step < result->step_count; step++) {
+        const TrajectoryStepResult* row = &result->steps[step];
+        const unsigned char* states = &result->satellite_states[(size_t)step * result->satellite_count];
+        double duration = trajectory_step_duration(trajectory, step);
+
+        result->total_time += duration;
+        if (row->available) {
+            result->available_time += duration;
+            available_steps++;
+            current_outage = 0.0;
+        } else {
+            if (current_outage == 0.0) {
+                current_outage_start = row->timestamp;
+            }
+            current_outage += duration;
+            if (current_outage > result->longest_outage) {
+                result->longest_outage = current_outage;
+                result->longest_outage_start = current_outage_start;
+            }
+        }
+
+        for (int i = 0; i < result->satellite_count; i++) {
+            TrajectorySatelliteStats* stats = &result->satellites[i];
+            if (states[i] & TRAJECTORY_SAT_VISIBLE) stats->visible_time += duration;
+            if (states[i] & TRAJECTORY_SAT_OBSTRUCTED) stats->obstructed_time += duration;
+            if (states[i] & TRAJECTORY_SAT_USABLE) stats->usable_time += duration;
+        }
+    }
+
+    // 只有一个轨迹点时没有时长，按步数计算
+    if (result->total_time > 0.0) {
+        result->availability_percentage = result->available_time / result->total_time * 100.0;
+    } else if (result->step_count > 0) {
+        result->availability_percentage = 100.0 * available_steps / result->step_count;
+    }
+}
+
+/**
+ * @brief 对整条飞行轨迹做遮挡分析 (时间步分配到多个工作线程)
+ * @param geometry 飞机几何模型
+ * @param satellite_data 卫星数据 (传播星历时须包含轨道参数)
+ * @param trajectory 飞行轨迹，每个轨迹点为一个时间步
+ * @param params 计算参数
+ * @param config 分析配置，NULL使用默认配置
+ * @param result 分析结果 (用trajectory_analysis_result_free释放)
+ * @return 成功返回1，失败返回0
+ */
+int trajectory_obstruction_analyze(const AircraftGeometry* geometry,
+                                   const SatelliteData* satellite_data,
+                                   const FlightTrajectory* trajectory,
+                                   const ObstructionParams* params,
+                                   const TrajectoryAnalysisConfig* config,
+                                   TrajectoryAnalysisResult* result) {
+    if (!geometry || !satellite_data || !trajectory || !params || !result) {
+        return 0;
+    }
+
+    TrajectoryAnalysisConfig default_config;
+    if (!config) {
+        trajectory_analysis_config_default(&default_config);
+        config = &default_config;
+    }
+
+    // 共享掩码只在主线程构建，工作线程只读查表
+    if (config->mask && !obstruction_mask_update(config->mask, geometry)) {
+        return 0;
+    }
+
+    memset(result, 0, sizeof(TrajectoryAnalysisResult));
+    double start = wall_time_ms();
+
+    int step_count = trajectory->point_count;
+    int satellite_count = satellite_data->satellite_count;
+    result->step_count = step_count;
+    result->satellite_count = satellite_count;
+
+    // 结果表一次性分配，工作线程只写入各自时间步的行
+    result->steps = (TrajectoryStepResult*)calloc(step_count > 0 ? step_count : 1, sizeof(TrajectoryStepResult));
+    result->satellite_states = (unsigned char*)calloc((size_t)(step_count > 0 ? step_count : 1) *
+                                                      (satellite_count > 0 ? satellite_count : 1), 1);
+    result->satellites = (TrajectorySatelliteStats*)calloc(satellite_count > 0 ? satellite_count : 1,
+                                                           sizeof(TrajectorySatelliteStats));
+    if (!result->steps || !result->satellite_states || !result->satellites) {
+        trajectory_analysis_result_free(result);
+        error_set(ERROR_MEMORY, "轨迹分析结果表内存分配失败", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    for (int i = 0; i < satellite_count; i++) {
+        result->satellites[i].prn = satellite_data->satellites[i].prn;
+        result->satellites[i].system = satellite_data->satellites[i].system;
+    }
+
+    TrajectoryAnalysisQueue queue;
+    queue.geometry = geometry;
+    queue.satellite_data = satellite_data;
+    queue.trajectory = trajectory;
+    queue.params = params;
+    queue.config = config;
+    queue.result = result;
+    queue.next_step = 0;
+    queue.completed_steps = 0;
+    queue.failed = 0;
+    memset(&queue.error, 0, sizeof(queue.error));
+    queue.error.code = ERROR_NONE;
+    pthread_mutex_init(&queue.mutex, NULL);
+
+    int thread_count = config->thread_count;
+    if (thread_count <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = cores > 0 ? (int)cores : 1;
+    }
+    int chunks = (step_count + TRAJECTORY_ANALYSIS_CHUNK - 1) / TRAJECTORY_ANALYSIS_CHUNK;
+    if (thread_count > chunks) thread_count = chunks;
+
+    /* 线程创建失败时由已有线程 (或当前线程) 继续领取剩余时间步 */
+    pthread_t* threads = thread_count > 0 ? (pthread_t*)calloc(thread_count, sizeof(pthread_t)) : NULL;
+    int started = 0;
+    for (int i = 0; threads != NULL && i < thread_count; i++) {
+        if (pthread_create(&threads[i], NULL, trajectory_analysis_worker, &queue) != 0) break;
+        started++;
+    }
+    if (started == 0) {
+        trajectory_analysis_worker(&queue);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&queue.mutex);
+
+    if (queue.failed || queue.completed_steps < step_count) {
+        trajectory_analysis_result_free(result);
+        if (queue.error.code != ERROR_NONE) {
+            error_set_info(&queue.error);
+        } else {
+            error_set(ERROR_CALCULATION, "轨迹遮挡分析失败", __func__, __FILE__, __LINE__);
+        }
+        return 0;
+    }
+
+    result->threads_used = started > 0 ? started : 1;
+    trajectory_analysis_summarize(trajectory, result);
+    result->elapsed_ms = wall_time_ms() - start;
+
+    LOG_INFO_FMT("轨迹遮挡分析完成: %d个时间步 x %d颗卫星, %d个线程, 可用率%.2f%%, 最长中断%.0f秒, 耗时%.1f ms, "
+                 "相干缓存复用%lld次/求交%lld次",
+                 step_count, satellite_count, result->threads_used, result->availability_percentage,
+                 result->longest_outage, result->elapsed_ms, result->coherence_reused,
+                 result->coherence_computed);
+    return 1;
+}
+
+/**
+ * @brief 释放轨迹分析结果
+ * @param result 分析结果
+ */
+void trajectory_analysis_result_free(TrajectoryAnalysisResult* result) {
+    if (!result) {
+        return;
+    }
+
+    free(result->steps);
+    free(result->satellite_states);
+    free(result->satellites);
+    result->steps = NULL;
+    result->satellite_states = NULL;
+    result->satellites = NULL;
+}
@@ -0,0 +1,339 @@
+#include "satellite.h"
+#include "../utils/utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* 批量传播常数 */
+#define BATCH_TWO_PI (2 * 3.1415926535898)   /* 与satellite.c中的GPS_PI保持一致 */
+#define BATCH_ALIGNMENT 32                   /* AVX2寄存器宽度 (字节) */
+#define KEPLER_FIXED_ITERATIONS 3            /* 固定牛顿迭代次数 (e<0.1时误差<1e-15弧度) */
+
+/* =================== 向量化内核 =================== */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_HAVE_VECTOR_KERNEL 1
+
+/* GCC向量扩展: 同一内核在AVX2下编译为ymm指令，在基线下编译为两组SSE2指令 */
+typedef double BatchVec __attribute__((vector_size(32)));
+typedef long long BatchMask __attribute__((vector_size(32)));
+
+/* Cody-Waite分段的pi/2 (每段33位，保证q*PIO2_n精确) */
+#define PIO2_1 1.57079632673412561417e+00
+#define PIO2_2 6.07710050630396597660e-11
+#define PIO2_3 2.02226624871116645580e-21
+#define ROUND_MAGIC 6755399441055744.0       /* 1.5 * 2^52，加减后即四舍五入到整数 */
+
+/* 按掩码逐元素选择 */
+#define batch_select(mask, a, b) \
+    ((BatchVec)(((mask) & (BatchMask)(a)) | (~(mask) & (BatchMask)(b))))
+
+/* 无分支正余弦: 按象限归约到[-pi/4, pi/4]后用cephes多项式求值
+ * (向量以指针传入，避免32字节向量按值传递的ABI告警) */
+static inline __attribute__((always_inline)) void batch_sincos(const BatchVec* angle, BatchVec* s, BatchVec* c) {
+    BatchVec x = *angle;
+    BatchVec q = (x * (2.0 / M_PI) + ROUND_MAGIC) - ROUND_MAGIC;
+    BatchVec r = ((x - q * PIO2_1) - q * PIO2_2) - q * PIO2_3;
+    BatchVec z = r * r;
+
+    BatchVec ps = ((((( 1.58962301576546568060e-10 * z
+                      - 2.50507477628578072866e-8) * z
+                      + 2.75573136213857245213e-6) * z
+                      - 1.98412698295895385996e-4) * z
+                      + 8.33333333332211858878e-3) * z
+                      - 1.66666666666666307295e-1);
+    BatchVec pc = (((((-1.13585365213876817300e-11 * z
+                      + 2.08757008419747316778e-9) * z
+                      - 2.75573141792967388112e-7) * z
+                      + 2.48015872888517045348e-5) * z
+                      - 1.38888888888730564116e-3) * z
+                      + 4.16666666666665929218e-2);
+    BatchVec sin_r = r + r * z * ps;
+    BatchVec cos_r = 1.0 - 0.5 * z + z * z * pc;
+
+    /* 象限: 奇数象限交换正余弦，第2、3象限正弦取反，第1、2象限余弦取反 */
+    BatchMask quadrant = __builtin_convertvector(q, BatchMask);
+    BatchMask odd = (quadrant & 1) != 0;
+    BatchMask flip_sin = (quadrant & 2) != 0;
+    BatchMask flip_cos = ((quadrant + 1) & 2) != 0;
+
+    BatchVec sv = batch_select(odd, cos_r, sin_r);
+    BatchVec cv = batch_select(odd, sin_r, cos_r);
+    *s = batch_select(flip_sin, -sv, sv);
+    *c = batch_select(flip_cos, -cv, cv);
+}
+
+#define BATCH_LOAD(field, i) (*(const BatchVec*)&batch->field[i])
+#define BATCH_STORE(field, i, v) (*(BatchVec*)&batch->field[i] = (v))
+
+/* 传播4颗卫星，与satellite_ephemeris_propagate的公式逐项对应 */
+static inline __attribute__((always_inline)) void batch_kernel(SatelliteEphemerisBatch* batch, int i, double time) {
+    BatchVec dt = time - BATCH_LOAD(ref_time, i);
+
+    /* 平近点角归一化到 [0, 2π] */
+    BatchVec M = BATCH_LOAD(m0, i) + BATCH_LOAD(n, i) * dt;
+    BatchVec turns = (M * (1.0 / BATCH_TWO_PI) + ROUND_MAGIC) - ROUND_MAGIC;
+    M = M - turns * BATCH_TWO_PI;
+    M = batch_select(M < 0.0, M + BATCH_TWO_PI, M);
+
+    /* 固定迭代次数的开普勒方程求解 (无数据相关分支) */
+    BatchVec e = BATCH_LOAD(e, i);
+    BatchVec E = M;
+    BatchVec sin_E, cos_E;
+    for (int k = 0; k < KEPLER_FIXED_ITERATIONS; k++) {
+        batch_sincos(&E, &sin_E, &cos_E);
+        E = E - (E - e * sin_E - M) / (1.0 - e * cos_E);
+    }
+    batch_sincos(&E, &sin_E, &cos_E);
+    BatchVec one_minus_ecos = 1.0 - e * cos_E;
+
+    /* 真近点角和轨道半径 */
+    BatchVec sin_nu = BATCH_LOAD(sqrt_1me2, i) * sin_E / one_minus_ecos;
+    BatchVec cos_nu = (cos_E - e) / one_minus_ecos;
+    BatchVec r = BATCH_LOAD(a, i) * one_minus_ecos;
+
+    BatchVec sin_w = BATCH_LOAD(sin_omega, i);
+    BatchVec cos_w = BATCH_LOAD(cos_omega, i);
+    BatchVec sin_phi = sin_nu * cos_w + cos_nu * sin_w;
+    BatchVec cos_phi = cos_nu * cos_w - sin_nu * sin_w;
+    BatchVec sin_2phi = 2.0 * sin_phi * cos_phi;
+    BatchVec cos_2phi = cos_phi * cos_phi - sin_phi * sin_phi;
+
+    /* 调和改正项 */
+    BatchVec delta_u = BATCH_LOAD(cus, i) * sin_2phi + BATCH_LOAD(cuc, i) * cos_2phi;
+    BatchVec delta_r = BATCH_LOAD(crs, i) * sin_2phi + BATCH_LOAD(crc, i) * cos_2phi;
+    BatchVec delta_i = BATCH_LOAD(cis, i) * sin_2phi + BATCH_LOAD(cic, i) * cos_2phi;
+
+    BatchVec sin_du, cos_du;
+    batch_sincos(&delta_u, &sin_du, &cos_du);
+    BatchVec sin_u = sin_phi * cos_du + cos_phi * sin_du;
+    BatchVec cos_u = cos_phi * cos_du - sin_phi * sin_du;
+    BatchVec r_corrected = r + delta_r;
+
+    BatchVec inclination = BATCH_LOAD(i0, i) + BATCH_LOAD(i_dot, i) * dt + delta_i;
+    BatchVec sin_i, cos_i;
+    batch_sincos(&inclination, &sin_i, &cos_i);
+
+    BatchVec lambda = BATCH_LOAD(lambda0, i) + BATCH_LOAD(lambda_rate, i) * dt;
+    BatchVec sin_l, cos_l;
+    batch_sincos(&lambda, &sin_l, &cos_l);
+
+    /* ECEF坐标和速度 */
+    BATCH_STORE(x, i, r_corrected * (cos_u * cos_l - sin_u * cos_i * sin_l));
+    BATCH_STORE(y, i, r_corrected * (cos_u * sin_l + sin_u * cos_i * cos_l));
+    BATCH_STORE(z, i, r_corrected * sin_u * sin_i);
+
+    BatchVec v = BATCH_LOAD(speed, i);
+    BATCH_STORE(vx, i, -v * sin_u * cos_l - v * cos_u * cos_i * sin_l);
+    BATCH_STORE(vy, i, -v * sin_u * sin_l + v * cos_u * cos_i * cos_l);
+    BATCH_STORE(vz, i, v * cos_u * sin_i);
+}
+
+__attribute__((target("avx2")))
+static void batch_propagate_avx2(SatelliteEphemerisBatch* batch, double time) {
+    for (int i = 0; i < batch->capacity; i += SATELLITE_BATCH_LANES) {
+        batch_kernel(batch, i, time);
+    }
+}
+
+static void batch_propagate_sse2(SatelliteEphemerisBatch* batch, double time) {
+    for (int i = 0; i < batch->capacity; i += SATELLITE_BATCH_LANES) {
+        batch_kernel(batch, i, time);
+    }
+}
+#endif /* 向量化内核 */
+
+/* 标量回退: 逐颗调用预计算星历的传播函数 */
+static void batch_propagate_scalar(SatelliteEphemerisBatch* batch, double time, int only_flagged) {
+    for (int i = 0; i < batch->count; i++) {
+        if (only_flagged && !batch->needs_scalar[i]) continue;
+
+        SatellitePosition pos;
+        satellite_ephemeris_propagate(&batch->ephemerides[i], time, &pos);
+        batch->x[i] = pos.x;
+        batch->y[i] = pos.y;
+        batch->z[i] = pos.z;
+        batch->vx[i] = pos.vx;
+        batch->vy[i] = pos.vy;
+        batch->vz[i] = pos.vz;
+    }
+}
+
+/* =================== 批量星历管理 =================== */
+
+static double* batch_field(double* block, int capacity, int index) {
+    return block + (size_t)capacity * index;
+}
+
+/* 把预计算星历写入SoA的第i列 */
+static void batch_set_lane(SatelliteEphemerisBatch* batch, int i, const SatelliteEphemeris* eph) {
+    batch->ref_time[i] = eph->ref_time;
+    batch->a[i] = eph->a;
+    batch->n[i] = eph->n;
+    batch->e[i] = eph->e;
+    batch->sqrt_1me2[i] = eph->sqrt_1me2;
+    batch->m0[i] = eph->m0;
+    batch->sin_omega[i] = eph->sin_omega;
+    batch->cos_omega[i] = eph->cos_omega;
+    batch->i0[i] = eph->i0;
+    batch->i_dot[i] = eph->i_dot;
+    batch->cuc[i] = eph->cuc;
+    batch->cus[i] = eph->cus;
+    batch->crc[i] = eph->crc;
+    batch->crs[i] = eph->crs;
+    batch->cic[i] = eph->cic;
+    batch->cis[i] = eph->cis;
+    batch->lambda0[i] = eph->lambda0;
+    batch->lambda_rate[i] = eph->lambda_rate;
+    batch->speed[i] = eph->speed;
+}
+
+SatelliteEphemerisBatch* satellite_ephemeris_batch_create(const SatelliteData* data) {
+    if (data == NULL || data->satellite_count <= 0) return NULL;
+
+    SatelliteEphemerisBatch* batch = (SatelliteEphemerisBatch*)safe_calloc(1, sizeof(SatelliteEphemerisBatch));
+    if (batch == NULL) return NULL;
+
+    int capacity = (data->satellite_count + SATELLITE_BATCH_LANES - 1) / SATELLITE_BATCH_LANES * SATELLITE_BATCH_LANES;
+
+    batch->ephemerides = (SatelliteEphemeris*)safe_calloc(capacity, sizeof(SatelliteEphemeris));
+    batch->data_index = (int*)safe_calloc(capacity, sizeof(int));
+    batch->needs_scalar = (int*)safe_calloc(capacity, sizeof(int));
+
+    /* 19个输入列 + 6个输出列，一次对齐分配 */
+    size_t block_size = (size_t)capacity * 25 * sizeof(double);
+    batch->block = aligned_alloc(BATCH_ALIGNMENT, block_size);
+
+    if (batch->ephemerides == NULL || batch->data_index == NULL ||
+        batch->needs_scalar == NULL || batch->block == NULL) {
+        error_set(ERROR_MEMORY, "批量星历内存分配失败", __func__, __FILE__, __LINE__);
+        satellite_ephemeris_batch_destroy(batch);
+        return NULL;
+    }
+    memset(batch->block, 0, block_size);
+
+    double** columns[] = {
+        &batch->ref_time, &batch->a, &batch->n, &batch->e, &batch->sqrt_1me2,
+        &batch->m0, &batch->sin_omega, &batch->cos_omega, &batch->i0, &batch->i_dot,
+        &batch->cuc, &batch->cus, &batch->crc, &batch->crs, &batch->cic, &batch->cis,
+        &batch->lambda0, &batch->lambda_rate, &batch->speed,
+        &batch->x, &batch->y, &batch->z, &batch->vx, &batch->vy, &batch->vz
+    };
+    for (int k = 0; k < 25; k++) {
+        *columns[k] = batch_field(batch->block, capacity, k);
+    }
+
+    /* 预计算每颗有效卫星的星历 */
+    for (int i = 0; i < data->satellite_count; i++) {
+        const Satellite* sat = &data->satellites[i];
+        if (!sat->is_valid) continue;
+
+        SatelliteEphemeris* eph = &batch->ephemerides[batch->count];
+        if (!satellite_ephemeris_prepare(sat, eph)) continue;
+
+        batch->data_index[batch->count] = i;
+        batch->needs_scalar[batch->count] = (eph->e >= SATELLITE_BATCH_MAX_ECCENTRICITY);
+        batch_set_lane(batch, batch->count, eph);
+        batch->count++;
+    }
+
+    if (batch->count == 0) {
+        satellite_ephemeris_batch_destroy(batch);
+        return NULL;
+    }
+
+    /* 填充列用第一颗卫星的参数，避免对未初始化数据求值 */
+    batch->capacity = (batch->count + SATELLITE_BATCH_LANES - 1) / SATELLITE_BATCH_LANES * SATELLITE_BATCH_LANES;
+    for (int i = batch->count; i < batch->capacity; i++) {
+        batch_set_lane(batch, i, &batch->ephemerides[0]);
+    }
+
+    return batch;
+}
+
+void satellite_ephemeris_batch_destroy(SatelliteEphemerisBatch* batch) {
+    if (batch == NULL) return;
+
+    safe_free((void**)&batch->ephemerides);
+    safe_free((void**)&batch->data_index);
+    safe_free((void**)&batch->needs_scalar);
+    if (batch->block != NULL) {
+        free(batch->block);  /* aligned_alloc分配的内存 */
+    }
+
+    safe_free((void**)&batch);
+}
+
+/* 按CPU能力选择内核，结果在首次调用时确定 */
+typedef enum {
+    BATCH_KERNEL_UNSELECTED = 0,
+    BATCH_KERNEL_SCALAR,
+    BATCH_KERNEL_SSE2,
+    BATCH_KERNEL_AVX2
+} BatchKernel;
+
+static BatchKernel batch_kernel_select(void) {
+    static BatchKernel selected = BATCH_KERNEL_UNSELECTED;
+
+    if (selected == BATCH_KERNEL_UNSELECTED) {
+#ifdef BATCH_HAVE_VECTOR_KERNEL
+        __builtin_cpu_init();
+        selected = __builtin_cpu_supports("avx2") ? BATCH_KERNEL_AVX2 : BATCH_KERNEL_SSE2;
+#else
+        selected = BATCH_KERNEL_SCALAR;
+#endif
+    }
+
+    return selected;
+}
+
+int satellite_ephemeris_batch_propagate(SatelliteEphemerisBatch* batch, double time) {
+    if (batch == NULL || batch->count <= 0) return 0;
+
+    switch (batch_kernel_select()) {
+#ifdef BATCH_HAVE_VECTOR_KERNEL
+        case BATCH_KERNEL_AVX2:
+            batch_propagate_avx2(batch, time);
+            batch_propagate_scalar(batch, time, 1);
+            break;
+        case BATCH_KERNEL_SSE2:
+            batch_propagate_sse2(batch, time);
+            batch_propagate_scalar(batch, time, 1);
+            break;
+#endif
+        default:
+            batch_propagate_scalar(batch, time, 0);
+            break;
+    }
+
+    return batch->count;
+}
+
+const char* satellite_ephemeris_batch_kernel_name(void) {
+    switch (batch_kernel_select()) {
+        case BATCH_KERNEL_AVX2: return "AVX2";
+        case BATCH_KERNEL_SSE2: return "SSE2";
+        default: return "SCALAR";
+    }
+}
+
+/* 把整个星座传播到指定时刻并写回卫星位置。batch须由同一data创建，可在多个历元间复用；
+ * valid_time是星历参考时刻 (batch的ref_time由它而来)，因此保持不变 */
+int satellite_data_propagate_batch(SatelliteData* data, SatelliteEphemerisBatch* batch, time_t time) {
+    if (data == NULL || batch == NULL || !time_is_valid(time)) return 0;
+
+    int count = satellite_ephemeris_batch_propagate(batch, (double)time);
+
+    for (int i = 0; i < batch->count; i++) {
+        SatellitePosition* pos = &data->satellites[batch->data_index[i]].pos;
+        pos->x = batch->x[i];
+        pos->y = batch->y[i];
+        pos->z = batch->z[i];
+        pos->vx = batch->vx[i];
+        pos->vy = batch->vy[i];
+        pos->vz = batch->vz[i];
+    }
+
+    return count;
+}
@@ -0,0 +1,279 @@
+#include "satellite.h"
+#include "../utils/utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* 插值缓存常数 */
+#define EPHEMERIS_CACHE_COMPONENTS 6         /* x, y, z, vx, vy, vz */
+#define EPHEMERIS_CACHE_MAX_SEGMENTS 16      /* 单个窗口最多细分的子段数 */
+
+/* =================== 切比雪夫拟合 =================== */
+
+/* 在[start, start+length]上以切比雪夫节点拟合6个分量，coef按分量连续存放 */
+static int chebyshev_fit(const SatelliteEphemeris* ephemeris, double start, double length,
+                         int degree, double* coef) {
+    int nodes = degree + 1;
+    double values[EPHEMERIS_CACHE_MAX_DEGREE + 1][EPHEMERIS_CACHE_COMPONENTS];
+
+    for (int k = 0; k < nodes; k++) {
+        double x = cos(M_PI * (k + 0.5) / nodes);
+        SatellitePosition pos;
+        if (!satellite_ephemeris_propagate(ephemeris, start + (x + 1.0) * 0.5 * length, &pos)) {
+            return 0;
+        }
+        values[k][0] = pos.x;
+        values[k][1] = pos.y;
+        values[k][2] = pos.z;
+        values[k][3] = pos.vx;
+        values[k][4] = pos.vy;
+        values[k][5] = pos.vz;
+    }
+
+    for (int c = 0; c < EPHEMERIS_CACHE_COMPONENTS; c++) {
+        for (int j = 0; j < nodes; j++) {
+            double sum = 0.0;
+            for (int k = 0; k < nodes; k++) {
+                sum += values[k][c] * cos(M_PI * j * (k + 0.5) / nodes);
+            }
+            coef[c * nodes + j] = 2.0 * sum / nodes;
+        }
+    }
+
+    return 1;
+}
+
+/* Clenshaw递推求值，x ∈ [-1, 1] */
+static double chebyshev_eval(const double* coef, int degree, double x) {
+    double b1 = 0.0, b2 = 0.0;
+    for (int j = degree; j >= 1; j--) {
+        double b0 = 2.0 * x * b1 - b2 + coef[j];
+        b2 = b1;
+        b1 = b0;
+    }
+    return x * b1 - b2 + 0.5 * coef[0];
+}
+
+static void chebyshev_eval_position(const double* coef, int degree, double x, SatellitePosition* position) {
+    int nodes = degree + 1;
+    position->x = chebyshev_eval(coef + 0 * nodes, degree, x);
+    position->y = chebyshev_eval(coef + 1 * nodes, degree, x);
+    position->z = chebyshev_eval(coef + 2 * nodes, degree, x);
+    position->vx = chebyshev_eval(coef + 3 * nodes, degree, x);
+    position->vy = chebyshev_eval(coef + 4 * nodes, degree, x);
+    position->vz = chebyshev_eval(coef + 5 * nodes, degree, x);
+}
+
+/* 在拟合节点之间的极值点(含端点)处与直接解比较位置误差 */
+static int chebyshev_verify(const SatelliteEphemeris* ephemeris, double start, double length,
+                            int degree, const double* coef, double tolerance) {
+    int nodes = degree + 1;
+
+    for (int k = 0; k <= nodes; k++) {
+        double x = cos(M_PI * k / nodes);
+        SatellitePosition direct, fitted;
+        if (!satellite_ephemeris_propagate(ephemeris, start + (x + 1.0) * 0.5 * length, &direct)) {
+            return 0;
+        }
+        chebyshev_eval_position(coef, degree, x, &fitted);
+
+        double dx = fitted.x - direct.x;
+        double dy = fitted.y - direct.y;
+        double dz = fitted.z - direct.z;
+        if (sqrt(dx * dx + dy * dy + dz * dz) > tolerance) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* =================== 缓存表 =================== */
+
+static unsigned int cache_hash(int prn, SatelliteSystem system, double ref_time, long long window) {
+    unsigned long long h = 1469598103934665603ULL;
+    unsigned long long parts[4];
+    parts[0] = (unsigned long long)prn;
+    parts[1] = (unsigned long long)system;
+    memcpy(&parts[2], &ref_time, sizeof(double));
+    parts[3] = (unsigned long long)window;
+
+    for (int i = 0; i < 4; i++) {
+        h ^= parts[i];
+        h *= 1099511628211ULL;
+        h ^= h >> 29;
+    }
+    return (unsigned int)h;
+}
+
+void ephemeris_cache_config_default(EphemerisCacheConfig* config) {
+    if (config == NULL) return;
+
+    config->window_seconds = 900.0;
+    config->degree = 10;
+    config->tolerance = 1e-3;
+    config->max_windows = 4096;
+}
+
+EphemerisCache* ephemeris_cache_create(const EphemerisCacheConfig* config) {
+    EphemerisCacheConfig cfg;
+    if (config != NULL) {
+        cfg = *config;
+    } else {
+        ephemeris_cache_config_default(&cfg);
+    }
+
+    if (cfg.window_seconds <= 0.0 || cfg.degree < 1 || cfg.degree > EPHEMERIS_CACHE_MAX_DEGREE ||
+        cfg.tolerance <= 0.0 || cfg.max_windows <= 0) {
+        error_set(ERROR_PARAMETER, "无效的星历缓存配置", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+
+    EphemerisCache* cache = (EphemerisCache*)safe_calloc(1, sizeof(EphemerisCache));
+    if (cache == NULL) return NULL;
+
+    /* 开放寻址表，负载因子不超过1/2 */
+    int capacity = 16;
+    while (capacity < cfg.max_windows * 2) capacity <<= 1;
+
+    cache->windows = (EphemerisCacheWindow*)safe_calloc(capacity, sizeof(EphemerisCacheWindow));
+    if (cache->windows == NULL) {
+        safe_free((void**)&cache);
+        return NULL;
+    }
+
+    cache->config = cfg;
+    cache->capacity = capacity;
+    return cache;
+}
+
+void ephemeris_cache_clear(EphemerisCache* cache) {
+    if (cache == NULL) return;
+
+    for (int i = 0; i < cache->capacity; i++) {
+        if (cache->windows[i].coefficients != NULL) {
+            safe_free((void**)&cache->windows[i].coefficients);
+        }
+    }
+    memset(cache->windows, 0, (size_t)cache->capacity * sizeof(EphemerisCacheWindow));
+    cache->window_count = 0;
+}
+
+void ephemeris_cache_destroy(EphemerisCache* cache) {
+    if (cache == NULL) return;
+
+    ephemeris_cache_clear(cache);
+    safe_free((void**)&cache->windows);
+    safe_free((void**)&cache);
+}
+
+/* 拟合一个窗口，误差超限时逐级对半细分；全部失败则标记为直接求解 */
+static void cache_window_build(EphemerisCache* cache, const SatelliteEphemeris* ephemeris,
+                               EphemerisCacheWindow* window) {
+    int degree = cache->config.degree;
+    size_t per_segment = (size_t)EPHEMERIS_CACHE_COMPONENTS * (degree + 1);
+
+    for (int segments = 1; segments <= EPHEMERIS_CACHE_MAX_SEGMENTS; segments *= 2) {
+        double* coef = (double*)safe_malloc(per_segment * segments * sizeof(double));
+        if (coef == NULL) break;
+
+        double length = cache->config.window_seconds / segments;
+        int ok = 1;
+        for (int s = 0; s < segments && ok; s++) {
+            double start = window->start + s * length;
+            double* seg_coef = coef + per_segment * s;
+            ok = chebyshev_fit(ephemeris, start, length, degree, seg_coef) &&
+                 chebyshev_verify(ephemeris, start, length, degree, seg_coef, cache->config.tolerance);
+        }
+
+        cache->stats.fits++;
+        if (ok) {
+            window->segments = segments;
+            window->coefficients = coef;
+            return;
+        }
+
+        safe_free((void**)&coef);
+        cache->stats.splits++;
+    }
+
+    window->segments = 0;
+    window->coefficients = NULL;
+}
+
+static EphemerisCacheWindow* cache_window_lookup(EphemerisCache* cache, const SatelliteEphemeris* ephemeris,
+                                                 long long index) {
+    unsigned int mask = (unsigned int)cache->capacity - 1;
+    unsigned int slot = cache_hash(ephemeris->prn, ephemeris->system, ephemeris->ref_time, index) & mask;
+
+    while (cache->windows[slot].in_use) {
+        EphemerisCacheWindow* window = &cache->windows[slot];
+        if (window->prn == ephemeris->prn && window->system == ephemeris->system &&
+            window->ref_time == ephemeris->ref_time && window->index == index) {
+            cache->stats.hits++;
+            return window;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    /* 缓存已满时整体清空，避免维护淘汰链表 */
+    if (cache->window_count >= cache->config.max_windows) {
+        ephemeris_cache_clear(cache);
+        slot = cache_hash(ephemeris->prn, ephemeris->system, ephemeris->ref_time, index) & mask;
+    }
+
+    EphemerisCacheWindow* window = &cache->windows[slot];
+    window->in_use = 1;
+    window->prn = ephemeris->prn;
+    window->system = ephemeris->system;
+    window->ref_time = ephemeris->ref_time;
+    window->index = index;
+    window->start = (double)index * cache->config.window_seconds;
+    cache->window_count++;
+
+    cache_window_build(cache, ephemeris, window);
+    return window;
+}
+
+int ephemeris_cache_propagate(EphemerisCache* cache, const SatelliteEphemeris* ephemeris,
+                              double time, SatellitePosition* position) {
+    if (cache == NULL || ephemeris == NULL || position == NULL) return 0;
+
+    cache->stats.queries++;
+
+    long long index = (long long)floor(time / cache->config.window_seconds);
+    EphemerisCacheWindow* window = cache_window_lookup(cache, ephemeris, index);
+
+    if (window->segments == 0) {
+        cache->stats.direct++;
+        return satellite_ephemeris_propagate(ephemeris, time, position);
+    }
+
+    double length = cache->config.window_seconds / window->segments;
+    double offset = (time - window->start) / length;
+    int segment = (int)offset;
+    if (segment < 0) segment = 0;
+    if (segment >= window->segments) segment = window->segments - 1;
+
+    double x = 2.0 * (offset - segment) - 1.0;
+    size_t per_segment = (size_t)EPHEMERIS_CACHE_COMPONENTS * (cache->config.degree + 1);
+    chebyshev_eval_position(window->coefficients + per_segment * segment, cache->config.degree, x, position);
+
+    return 1;
+}
+
+int ephemeris_cache_position(EphemerisCache* cache, const Satellite* satellite,
+                             double time, SatellitePosition* position) {
+    if (cache == NULL || satellite == NULL || position == NULL) return 0;
+
+    SatelliteEphemeris ephemeris;
+    if (!satellite_ephemeris_prepare(satellite, &ephemeris)) return 0;
+
+    return ephemeris_cache_propagate(cache, &ephemeris, time, position);
+}
+
+void ephemeris_cache_get_stats(const EphemerisCache* cache, EphemerisCacheStats* stats) {
+    if (cache == NULL || stats == NULL) return;
+    *stats = cache->stats;
+}
@@ -0,0 +1,277 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L  /* mmap/fstat */
+#endif
+
+#include "satellite.h"
+#include "../utils/utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* 快照文件格式:
+ *   文件头 (EphemerisSnapshotHeader)
+ *   槽位表 uint32_t[EPHEMERIS_STORE_SLOTS]，每个槽位的星历组数
+ *   星历记录 Satellite[]，按槽位顺序连续存放，槽内按时间升序
+ * 记录按本机结构体布局原样写入，布局不一致的快照会被拒绝并重新生成 */
+#define SNAPSHOT_MAGIC "BDEPHSNP"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_ENDIAN_MARK 0x01020304u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_mark;
+    uint32_t record_size;      /* sizeof(Satellite) */
+    uint32_t slot_count;       /* EPHEMERIS_STORE_SLOTS */
+    uint32_t record_count;
+    uint32_t reserved;
+    uint64_t source_hash;      /* 源RINEX文件内容哈希 */
+    uint64_t checksum;         /* 槽位表和记录的FNV-1a校验和 */
+} EphemerisSnapshotHeader;
+
+/* 记录区须按8字节对齐，映射后才能直接当作Satellite数组访问 */
+_Static_assert((sizeof(EphemerisSnapshotHeader) + EPHEMERIS_STORE_SLOTS * sizeof(uint32_t)) % 8 == 0,
+               "快照记录区未对齐");
+
+/* =================== 哈希 =================== */
+
+#define FNV_OFFSET_BASIS 1469598103934665603ULL
+#define FNV_PRIME 1099511628211ULL
+
+static uint64_t fnv1a_update(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/* =================== 文件映射 =================== */
+
+/* 只读映射整个文件；Windows下读入堆内存 */
+static void* map_file(const char* filename, size_t* length) {
+#ifdef _WIN32
+    long size = file_size(filename);
+    if (size <= 0) return NULL;
+
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) return NULL;
+
+    void* buffer = safe_malloc((size_t)size);
+    if (buffer != NULL && fread(buffer, 1, (size_t)size, file) != (size_t)size) {
+        safe_free(&buffer);
+    }
+    fclose(file);
+
+    *length = (size_t)size;
+    return buffer;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    void* mapped = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return NULL;
+
+    *length = (size_t)st.st_size;
+    return mapped;
+#endif
+}
+
+static void unmap_file(void* mapping, size_t length) {
+#ifdef _WIN32
+    (void)length;
+    safe_free(&mapping);
+#else
+    munmap(mapping, length);
+#endif
+}
+
+void ephemeris_snapshot_release(EphemerisStore* store) {
+    if (store == NULL || store->mapping == NULL) return;
+
+    unmap_file(store->mapping, store->mapping_size);
+    store->mapping = NULL;
+    store->mapping_size = 0;
+}
+
+int ephemeris_snapshot_hash_file(const char* filename, unsigned long long* hash) {
+    if (filename == NULL || hash == NULL) return 0;
+
+    size_t length = 0;
+    void* mapping = map_file(filename, &length);
+    if (mapping == NULL) {
+        error_set(ERROR_FILE, "无法读取源文件", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    *hash = fnv1a_update(FNV_OFFSET_BASIS, mapping, length);
+    unmap_file(mapping, length);
+    return 1;
+}
+
+/* =================== 写入 =================== */
+
+int ephemeris_snapshot_write(const EphemerisStore* store, const char* filename,
+                             unsigned long long source_hash) {
+    if (store == NULL || filename == NULL) return 0;
+
+    EphemerisSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.endian_mark = SNAPSHOT_ENDIAN_MARK;
+    header.record_size = (uint32_t)sizeof(Satellite);
+    header.slot_count = EPHEMERIS_STORE_SLOTS;
+    header.record_count = (uint32_t)store->record_count;
+    header.source_hash = source_hash;
+
+    uint32_t counts[EPHEMERIS_STORE_SLOTS];
+    for (int i = 0; i < EPHEMERIS_STORE_SLOTS; i++) {
+        counts[i] = (uint32_t)store->slots[i].count;
+    }
+
+    uint64_t checksum = fnv1a_update(FNV_OFFSET_BASIS, counts, sizeof(counts));
+    for (int i = 0; i < EPHEMERIS_STORE_SLOTS; i++) {
+        const EphemerisSlot* slot = &store->slots[i];
+        if (slot->count > 0) {
+            checksum = fnv1a_update(checksum, slot->records, (size_t)slot->count * sizeof(Satellite));
+        }
+    }
+    header.checksum = checksum;
+
+    /* 先写临时文件再重命名，避免并发启动读到半个快照 */
+    char temp_name[1024];
+    snprintf(temp_name, sizeof(temp_name), "%s.tmp", filename);
+
+    FILE* file = fopen(temp_name, "wb");
+    if (file == NULL) {
+        error_set(ERROR_FILE, "无法创建星历快照文件", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(counts, sizeof(counts), 1, file) == 1;
+    for (int i = 0; ok && i < EPHEMERIS_STORE_SLOTS; i++) {
+        const EphemerisSlot* slot = &store->slots[i];
+        if (slot->count > 0) {
+            ok = fwrite(slot->records, sizeof(Satellite), (size_t)slot->count, file) == (size_t)slot->count;
+        }
+    }
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || rename(temp_name, filename) != 0) {
+        remove(temp_name);
+        error_set(ERROR_FILE, "写入星历快照失败", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    return 1;
+}
+
+/* =================== 零拷贝加载 =================== */
+
+int ephemeris_snapshot_load(EphemerisStore* store, const char* filename,
+                            unsigned long long* source_hash) {
+    if (store == NULL || filename == NULL) return 0;
+
+    size_t length = 0;
+    void* mapping = map_file(filename, &length);
+    if (mapping == NULL) {
+        error_set(ERROR_FILE, "无法打开星历快照文件", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    const EphemerisSnapshotHeader* header = (const EphemerisSnapshotHeader*)mapping;
+    const uint32_t* counts = (const uint32_t*)((const char*)mapping + sizeof(EphemerisSnapshotHeader));
+    const Satellite* records = (const Satellite*)(counts + EPHEMERIS_STORE_SLOTS);
+    size_t records_offset = (size_t)((const char*)records - (const char*)mapping);
+
+    int valid = length >= records_offset &&
+                memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) == 0 &&
+                header->version == SNAPSHOT_VERSION &&
+                header->endian_mark == SNAPSHOT_ENDIAN_MARK &&
+                header->record_size == sizeof(Satellite) &&
+                header->slot_count == EPHEMERIS_STORE_SLOTS &&
+                length == records_offset + (size_t)header->record_count * sizeof(Satellite);
+
+    if (valid) {
+        uint64_t total = 0;
+        for (int i = 0; i < EPHEMERIS_STORE_SLOTS; i++) total += counts[i];
+        valid = (total == header->record_count) &&
+                fnv1a_update(FNV_OFFSET_BASIS, counts, (size_t)length - sizeof(EphemerisSnapshotHeader)) == header->checksum;
+    }
+
+    if (!valid) {
+        unmap_file(mapping, length);
+        error_set(ERROR_PARSE, "星历快照格式无效或已损坏", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    /* 槽位直接指向映射内存 (capacity为0表示借用，修改时再复制) */
+    ephemeris_store_clear(store);
+    const Satellite* cursor = records;
+    for (int i = 0; i < EPHEMERIS_STORE_SLOTS; i++) {
+        EphemerisSlot* slot = &store->slots[i];
+        slot->count = (int)counts[i];
+        slot->records = slot->count > 0 ? (Satellite*)cursor : NULL;
+        slot->capacity = 0;
+        cursor += counts[i];
+
+        if (slot->count > 0) store->satellite_count++;
+    }
+    store->record_count = (int)header->record_count;
+    store->mapping = mapping;
+    store->mapping_size = length;
+
+    if (source_hash != NULL) *source_hash = header->source_hash;
+    return 1;
+}
+
+/* =================== 带缓存的加载 =================== */
+
+int ephemeris_store_load_cached(EphemerisStore* store, const char* rinex_filename,
+                                const char* snapshot_filename) {
+    if (store == NULL || rinex_filename == NULL || snapshot_filename == NULL) return 0;
+
+    unsigned long long source_hash;
+    if (!ephemeris_snapshot_hash_file(rinex_filename, &source_hash)) return 0;
+
+    /* 源文件未变化时直接映射快照 */
+    unsigned long long snapshot_hash;
+    if (file_exists(snapshot_filename) &&
+        ephemeris_snapshot_load(store, snapshot_filename, &snapshot_hash)) {
+        if (snapshot_hash == source_hash) {
+            LOG_INFO_FMT("从快照加载星历: %d组, %d颗卫星", store->record_count, store->satellite_count);
+            return 1;
+        }
+        ephemeris_store_clear(store);
+    }
+    error_clear();
+
+    /* 重新解析RINEX并生成快照；快照写入失败不影响本次加载 */
+    ephemeris_store_clear(store);
+    if (!ephemeris_store_load_rinex(store, rinex_filename, NULL)) return 0;
+
+    if (!ephemeris_snapshot_write(store, snapshot_filename, source_hash)) {
+        LOG_WARNING("星历快照写入失败，下次启动将重新解析RINEX");
+    }
+
+    LOG_INFO_FMT("解析RINEX星历: %d组, %d颗卫星", store->record_count, store->satellite_count);
+    return 1;
+}
@@ -0,0 +1,203 @@
+#include "satellite.h"
+#include "../utils/utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* =================== 槽位索引 =================== */
+
+/* (系统, PRN) -> 槽位下标，超出范围返回-1 */
+static int store_slot_index(SatelliteSystem system, int prn) {
+    if (system < SATELLITE_SYSTEM_BEIDOU || system > SATELLITE_SYSTEM_GALILEO) return -1;
+    if (prn < 1 || prn > EPHEMERIS_STORE_MAX_PRN) return -1;
+
+    return ((int)system - 1) * EPHEMERIS_STORE_MAX_PRN + (prn - 1);
+}
+
+/* 返回第一个valid_time >= time的下标 */
+static int slot_lower_bound(const EphemerisSlot* slot, time_t time) {
+    int low = 0;
+    int high = slot->count;
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (slot->records[mid].valid_time < time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/* =================== 星历库管理 =================== */
+
+EphemerisStore* ephemeris_store_create(void) {
+    EphemerisStore* store = (EphemerisStore*)safe_calloc(1, sizeof(EphemerisStore));
+    if (store == NULL) {
+        error_set(ERROR_MEMORY, "星历库内存分配失败", __func__, __FILE__, __LINE__);
+        return NULL;
+    }
+    return store;
+}
+
+void ephemeris_store_clear(EphemerisStore* store) {
+    if (store == NULL) return;
+
+    for (int i = 0; i < EPHEMERIS_STORE_SLOTS; i++) {
+        EphemerisSlot* slot = &store->slots[i];
+        if (slot->capacity > 0 && slot->records != NULL) {
+            safe_free((void**)&slot->records);
+        }
+        slot->records = NULL;
+        slot->count = 0;
+        slot->capacity = 0;
+    }
+
+    ephemeris_snapshot_release(store);
+    store->record_count = 0;
+    store->satellite_count = 0;
+    store->version++;
+}
+
+void ephemeris_store_destroy(EphemerisStore* store) {
+    if (store == NULL) return;
+
+    ephemeris_store_clear(store);
+    safe_free((void**)&store);
+}
+
+/* 借用的槽位 (capacity为0) 在首次修改时复制为自有内存 */
+static int slot_reserve(EphemerisSlot* slot, int needed) {
+    if (needed <= slot->capacity) return 1;
+
+    int capacity = slot->capacity > 0 ? slot->capacity * 2 : 8;
+    while (capacity < needed) capacity *= 2;
+
+    Satellite* records = (Satellite*)safe_malloc((size_t)capacity * sizeof(Satellite));
+    if (records == NULL) {
+        error_set(ERROR_MEMORY, "星历库扩容失败", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+    if (slot->count > 0) {
+        memcpy(records, slot->records, (size_t)slot->count * sizeof(Satellite));
+    }
+    if (slot->capacity > 0) {
+        safe_free((void**)&slot->records);
+    }
+
+    slot->records = records;
+    slot->capacity = capacity;
+    return 1;
+}
+
+int ephemeris_store_add(EphemerisStore* store, const Satellite* satellite) {
+    if (store == NULL || satellite == NULL) return 0;
+
+    int index = store_slot_index(satellite->system, satellite->prn);
+    if (index < 0) {
+        error_set(ERROR_PARAMETER, "无效的卫星系统或PRN号", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    EphemerisSlot* slot = &store->slots[index];
+
+    /* 广播星历基本按时间顺序到达，优先追加到末尾 */
+    int pos = (slot->count == 0 || slot->records[slot->count - 1].valid_time < satellite->valid_time)
+              ? slot->count
+              : slot_lower_bound(slot, satellite->valid_time);
+
+    /* 相同参考时间视为同一组星历，直接覆盖 */
+    if (pos < slot->count && slot->records[pos].valid_time == satellite->valid_time) {
+        if (!slot_reserve(slot, slot->count)) return 0;
+        slot->records[pos] = *satellite;
+        store->version++;
+        return 1;
+    }
+
+    if (!slot_reserve(slot, slot->count + 1)) return 0;
+
+    if (pos < slot->count) {
+        memmove(&slot->records[pos + 1], &slot->records[pos],
+                (size_t)(slot->count - pos) * sizeof(Satellite));
+    }
+    slot->records[pos] = *satellite;
+    if (slot->count == 0) store->satellite_count++;
+    slot->count++;
+    store->record_count++;
+    store->version++;
+
+    return 1;
+}
+
+const Satellite* ephemeris_store_find(const EphemerisStore* store, SatelliteSystem system,
+                                      int prn, time_t time) {
+    if (store == NULL) return NULL;
+
+    int index = store_slot_index(system, prn);
+    if (index < 0) return NULL;
+
+    const EphemerisSlot* slot = &store->slots[index];
+    if (slot->count == 0) return NULL;
+
+    /* 优先取参考时间不晚于查询时刻的最新一组；
+     * 之后的一组仅在拟合区间内且更接近时才使用 */
+    int pos = slot_lower_bound(slot, time);
+    if (pos == slot->count) return &slot->records[pos - 1];
+    if (pos == 0) return &slot->records[0];
+
+    const Satellite* after = &slot->records[pos];
+    const Satellite* before = &slot->records[pos - 1];
+    if (after->valid_time == time) return after;
+    if (after->valid_time - time <= EPHEMERIS_STORE_FIT_HALF &&
+        (after->valid_time - time) < (time - before->valid_time)) {
+        return after;
+    }
+    return before;
+}
+
+int ephemeris_store_count(const EphemerisStore* store, SatelliteSystem system, int prn) {
+    if (store == NULL) return 0;
+
+    int index = store_slot_index(system, prn);
+    return index < 0 ? 0 : store->slots[index].count;
+}
+
+int ephemeris_store_select(const EphemerisStore* store, SatelliteSystem system, time_t time,
+                           SatelliteData* data) {
+    if (store == NULL || data == NULL) return 0;
+
+    data->satellite_count = 0;
+    data->reference_time = time;
+    data->version++;
+
+    for (int s = SATELLITE_SYSTEM_BEIDOU; s <= SATELLITE_SYSTEM_GALILEO; s++) {
+        if (system != 0 && s != (int)system) continue;
+
+        for (int prn = 1; prn <= EPHEMERIS_STORE_MAX_PRN; prn++) {
+            const Satellite* best = ephemeris_store_find(store, (SatelliteSystem)s, prn, time);
+            if (best == NULL) continue;
+
+            if (data->satellite_count >= data->max_satellites) {
+                error_set(ERROR_MEMORY, "卫星数据已满", __func__, __FILE__, __LINE__);
+                return data->satellite_count;
+            }
+            data->satellites[data->satellite_count++] = *best;
+        }
+    }
+
+    return data->satellite_count;
+}
+
+/* =================== RINEX导入 =================== */
+
+static int store_rinex_record(const Satellite* satellite, void* user_data) {
+    ephemeris_store_add((EphemerisStore*)user_data, satellite);
+    return 1;
+}
+
+int ephemeris_store_load_rinex(EphemerisStore* store, const char* filename, RinexNavInfo* info) {
+    if (store == NULL || filename == NULL) return 0;
+
+    return rinex_nav_parse_file(filename, store_rinex_record, store, info);
+}
@@ -0,0 +1,182 @@
+#include "satellite.h"
+#include "../utils/utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define RINEX_INGEST_DEFAULT_THREADS 4
+
+/* 工作线程共享的任务队列 (按下标领取文件) */
+typedef struct {
+    const char* const* filenames;
+    int file_count;
+    int next_file;
+    pthread_mutex_t mutex;
+    EphemerisStore** file_stores;    /* 每个文件独立解析的星历库 */
+    RinexIngestFileReport* reports;
+    ErrorInfo* file_errors;          /* 每个文件解析时收集的错误 (全局错误不是线程安全的) */
+} RinexIngestQueue;
+
+/* 墙钟时间 (毫秒)；clock()统计的是进程CPU时间，不适用于多线程计时 */
+static double wall_time_ms(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void ingest_one_file(RinexIngestQueue* queue, int index) {
+    RinexIngestFileReport* report = &queue->reports[index];
+    double start = wall_time_ms();
+
+    ErrorInfo* error = &queue->file_errors[index];
+    error_capture_begin(error);
+
+    EphemerisStore* store = ephemeris_store_create();
+    RinexNavInfo info;
+    memset(&info, 0, sizeof(info));
+
+    report->success = store != NULL && ephemeris_store_load_rinex(store, queue->filenames[index], &info);
+    report->records = info.records;
+    report->skipped = info.skipped;
+    report->errors = info.errors;
+    error_capture_end();
+
+    if (!report->success) {
+        /* 解析函数未给出原因时按文件状态补充 */
+        if (error->code == ERROR_NONE) {
+            error->code = ERROR_PARSE;
+            snprintf(error->message, sizeof(error->message), "%s",
+                     file_exists(queue->filenames[index]) ? "不是有效的RINEX 3导航文件" : "无法打开文件");
+        }
+        snprintf(report->error_message, sizeof(report->error_message), "%.*s",
+                 (int)sizeof(report->error_message) - 1, error->message);
+    }
+
+    queue->file_stores[index] = store;
+    report->elapsed_ms = wall_time_ms() - start;
+}
+
+static void* ingest_worker(void* arg) {
+    RinexIngestQueue* queue = (RinexIngestQueue*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&queue->mutex);
+        int index = queue->next_file < queue->file_count ? queue->next_file++ : -1;
+        pthread_mutex_unlock(&queue->mutex);
+
+        if (index < 0) break;
+        ingest_one_file(queue, index);
+    }
+
+    return NULL;
+}
+
+/* 按输入顺序合并，(系统, PRN, 参考时间)相同的星历只保留一组 */
+static void merge_file_store(EphemerisStore* target, const EphemerisStore* source,
+                             RinexIngestFileReport* report) {
+    for (int i = 0; i < EPHEMERIS_STORE_SLOTS; i++) {
+        const EphemerisSlot* slot = &source->slots[i];
+        for (int k = 0; k < slot->count; k++) {
+            int before = target->record_count;
+            if (!ephemeris_store_add(target, &slot->records[k])) continue;
+
+            if (target->record_count == before) {
+                report->duplicates++;
+            } else {
+                report->merged++;
+            }
+        }
+    }
+}
+
+int rinex_ingest_files(EphemerisStore* store, const char* const* filenames, int file_count,
+                       int thread_count, RinexIngestReport* report) {
+    if (store == NULL || filenames == NULL || file_count <= 0 || report == NULL) return 0;
+
+    memset(report, 0, sizeof(RinexIngestReport));
+    double start = wall_time_ms();
+
+    report->files = (RinexIngestFileReport*)safe_calloc(file_count, sizeof(RinexIngestFileReport));
+    EphemerisStore** file_stores = (EphemerisStore**)safe_calloc(file_count, sizeof(EphemerisStore*));
+    ErrorInfo* file_errors = (ErrorInfo*)safe_calloc(file_count, sizeof(ErrorInfo));
+    if (report->files == NULL || file_stores == NULL || file_errors == NULL) {
+        safe_free((void**)&report->files);
+        safe_free((void**)&file_stores);
+        safe_free((void**)&file_errors);
+        error_set(ERROR_MEMORY, "导入任务内存分配失败", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+    report->file_count = file_count;
+
+    for (int i = 0; i < file_count; i++) {
+        strncpy(report->files[i].filename, filenames[i], sizeof(report->files[i].filename) - 1);
+    }
+
+    RinexIngestQueue queue;
+    queue.filenames = filenames;
+    queue.file_count = file_count;
+    queue.next_file = 0;
+    queue.file_stores = file_stores;
+    queue.reports = report->files;
+    queue.file_errors = file_errors;
+    pthread_mutex_init(&queue.mutex, NULL);
+
+    if (thread_count <= 0) thread_count = RINEX_INGEST_DEFAULT_THREADS;
+    if (thread_count > file_count) thread_count = file_count;
+
+    /* 线程创建失败时由已有线程 (或当前线程) 继续领取剩余文件 */
+    pthread_t* threads = (pthread_t*)safe_calloc(thread_count, sizeof(pthread_t));
+    int started = 0;
+    for (int i = 0; threads != NULL && i < thread_count; i++) {
+        if (pthread_create(&threads[i], NULL, ingest_worker, &queue) != 0) break;
+        started++;
+    }
+    if (started == 0) {
+        ingest_worker(&queue);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    safe_free((void**)&threads);
+    pthread_mutex_destroy(&queue.mutex);
+
+    report->threads_used = started > 0 ? started : 1;
+
+    /* 单线程合并保证结果与文件顺序有关而与调度无关 */
+    const ErrorInfo* first_error = NULL;
+    for (int i = 0; i < file_count; i++) {
+        RinexIngestFileReport* file_report = &report->files[i];
+        if (file_report->success) {
+            merge_file_store(store, file_stores[i], file_report);
+            report->records += file_report->records;
+            report->merged += file_report->merged;
+            report->duplicates += file_report->duplicates;
+        } else {
+            report->files_failed++;
+            if (first_error == NULL) first_error = &file_errors[i];
+        }
+        ephemeris_store_destroy(file_stores[i]);
+    }
+    safe_free((void**)&file_stores);
+
+    /* 工作线程已全部汇合，在调用线程上报告第一个失败文件的错误 */
+    error_set_info(first_error);
+    safe_free((void**)&file_errors);
+
+    report->elapsed_ms = wall_time_ms() - start;
+
+    LOG_INFO_FMT("RINEX批量导入完成: %d个文件(失败%d), %d条星历, 去重%d条, 耗时%.1f ms",
+                 report->file_count, report->files_failed, report->records,
+                 report->duplicates, report->elapsed_ms);
+
+    return report->files_failed < report->file_count;
+}
+
+void rinex_ingest_report_free(RinexIngestReport* report) {
+    if (report == NULL) return;
+
+    safe_free((void**)&report->files);
+    report->file_count = 0;
+}
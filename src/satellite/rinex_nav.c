@@ -0,0 +1,403 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L  /* mmap/fstat */
+#endif
+
+#include "satellite.h"
+#include "../utils/utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* 时间系统常数 */
+#define SECONDS_PER_WEEK 604800.0
+#define GPS_EPOCH_UNIX 315964800.0    /* 1980-01-06 00:00:00 UTC */
+#define BDS_EPOCH_UNIX 1136073600.0   /* 2006-01-01 00:00:00 UTC */
+#define GPS_UTC_LEAP_SECONDS 18.0     /* GPST - UTC */
+#define BDS_UTC_LEAP_SECONDS 4.0      /* BDT - UTC */
+
+/* RINEX 3导航文件布局 */
+#define RINEX_NAV_FIELD_WIDTH 19
+#define RINEX_NAV_ORBIT_LINES 7       /* 开普勒星历的广播轨道行数 */
+
+/* =================== 定宽字段解析 =================== */
+
+static const double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static double scale_by_power_of_ten(double value, int exponent) {
+    while (exponent > 22) {
+        value *= 1e22;
+        exponent -= 22;
+    }
+    while (exponent < -22) {
+        value /= 1e22;
+        exponent += 22;
+    }
+    return exponent >= 0 ? value * POWERS_OF_TEN[exponent] : value / POWERS_OF_TEN[-exponent];
+}
+
+/* 解析Fortran风格浮点数 (支持D/E指数)，空白字段返回0 */
+static double parse_fortran_double(const char* field, int width) {
+    const char* p = field;
+    const char* end = field + width;
+    int negative = 0;
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+
+    while (p < end && *p == ' ') p++;
+    if (p >= end) return 0.0;
+
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        p++;
+    }
+
+    /* 尾数: 最多保留19位有效数字，其余只计入指数 */
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (unsigned long long)(*p - '0');
+            if (mantissa != 0) digits++;
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (unsigned long long)(*p - '0');
+                if (mantissa != 0) digits++;
+                exponent--;
+            }
+        }
+    }
+
+    if (p < end && (*p == 'D' || *p == 'd' || *p == 'E' || *p == 'e')) {
+        int exp_negative = 0;
+        int exp_value = 0;
+        p++;
+        if (p < end && (*p == '-' || *p == '+')) {
+            exp_negative = (*p == '-');
+            p++;
+        }
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            exp_value = exp_value * 10 + (*p - '0');
+        }
+        exponent += exp_negative ? -exp_value : exp_value;
+    }
+
+    double value = scale_by_power_of_ten((double)mantissa, exponent);
+    return negative ? -value : value;
+}
+
+/* 解析定宽整数字段 */
+static int parse_fixed_int(const char* field, int width) {
+    int value = 0;
+    int negative = 0;
+    const char* end = field + width;
+
+    while (field < end && *field == ' ') field++;
+    if (field < end && *field == '-') {
+        negative = 1;
+        field++;
+    }
+    for (; field < end && *field >= '0' && *field <= '9'; field++) {
+        value = value * 10 + (*field - '0');
+    }
+    return negative ? -value : value;
+}
+
+/* 公历日期转Unix时间 (不依赖时区设置) */
+static double civil_to_unix(int year, int month, int day, int hour, int minute, double second) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yoe = year - era * 400;
+    int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    long long days = (long long)era * 146097 + doe - 719468;
+    return (double)days * 86400.0 + hour * 3600.0 + minute * 60.0 + second;
+}
+
+/* =================== 记录解析 =================== */
+
+/* 行视图 (不含换行符) */
+typedef struct {
+    const char* text;
+    int length;
+} RinexLine;
+
+static const char* next_line(const char* cursor, const char* end, RinexLine* line) {
+    const char* newline = memchr(cursor, '\n', (size_t)(end - cursor));
+    const char* line_end = newline != NULL ? newline : end;
+
+    line->text = cursor;
+    line->length = (int)(line_end - cursor);
+    if (line->length > 0 && line->text[line->length - 1] == '\r') line->length--;
+
+    return newline != NULL ? newline + 1 : end;
+}
+
+/* 取从first列开始的第index个19字符字段，行过短时视为空白 */
+static double line_field(const RinexLine* line, int first, int index) {
+    int offset = first + index * RINEX_NAV_FIELD_WIDTH;
+    if (offset >= line->length) return 0.0;
+
+    int width = line->length - offset;
+    if (width > RINEX_NAV_FIELD_WIDTH) width = RINEX_NAV_FIELD_WIDTH;
+    return parse_fortran_double(line->text + offset, width);
+}
+
+/* 广播轨道行: 4个空格后接4个字段 */
+static double orbit_field(const RinexLine* line, int index) {
+    return line_field(line, 4, index);
+}
+
+static SatelliteSystem system_from_code(char code) {
+    switch (code) {
+        case 'C': return SATELLITE_SYSTEM_BEIDOU;
+        case 'G': return SATELLITE_SYSTEM_GPS;
+        case 'E': return SATELLITE_SYSTEM_GALILEO;
+        default: return 0;  /* GLONASS/SBAS为状态向量星历，QZSS/NavIC无对应系统 */
+    }
+}
+
+/* 由系统周和周内秒得到Unix时间 */
+static double system_time_to_unix(SatelliteSystem system, double week, double seconds) {
+    if (system == SATELLITE_SYSTEM_BEIDOU) {
+        return BDS_EPOCH_UNIX + week * SECONDS_PER_WEEK + seconds - BDS_UTC_LEAP_SECONDS;
+    }
+    /* GPS和Galileo周计数均以GPS起点为准 */
+    return GPS_EPOCH_UNIX + week * SECONDS_PER_WEEK + seconds - GPS_UTC_LEAP_SECONDS;
+}
+
+/* 解析一条开普勒星历记录 (记录头行 + 7行广播轨道) */
+static int parse_kepler_record(const RinexLine* lines, int line_count, Satellite* sat) {
+    const RinexLine* head = &lines[0];
+    if (head->length < 23 + RINEX_NAV_FIELD_WIDTH || line_count < RINEX_NAV_ORBIT_LINES + 1) {
+        return 0;
+    }
+
+    memset(sat, 0, sizeof(Satellite));
+    sat->system = system_from_code(head->text[0]);
+    sat->prn = parse_fixed_int(head->text + 1, 2);
+
+    /* 时钟参考时间 (系统时，按日历给出) */
+    int year = parse_fixed_int(head->text + 4, 4);
+    int month = parse_fixed_int(head->text + 9, 2);
+    int day = parse_fixed_int(head->text + 12, 2);
+    int hour = parse_fixed_int(head->text + 15, 2);
+    int minute = parse_fixed_int(head->text + 18, 2);
+    int second = parse_fixed_int(head->text + 21, 2);
+    double leap = (sat->system == SATELLITE_SYSTEM_BEIDOU) ? BDS_UTC_LEAP_SECONDS : GPS_UTC_LEAP_SECONDS;
+    sat->clock.t_oc = civil_to_unix(year, month, day, hour, minute, second) - leap;
+
+    sat->clock.a0 = line_field(head, 23, 0);
+    sat->clock.a1 = line_field(head, 23, 1);
+    sat->clock.a2 = line_field(head, 23, 2);
+
+    SatelliteOrbit* orbit = &sat->orbit;
+    orbit->crs = orbit_field(&lines[1], 1);
+    orbit->delta_n = orbit_field(&lines[1], 2);
+    orbit->m0 = orbit_field(&lines[1], 3);
+
+    orbit->cuc = orbit_field(&lines[2], 0);
+    orbit->e = orbit_field(&lines[2], 1);
+    orbit->cus = orbit_field(&lines[2], 2);
+    orbit->sqrt_a = orbit_field(&lines[2], 3);
+
+    orbit->toe = orbit_field(&lines[3], 0);
+    orbit->cic = orbit_field(&lines[3], 1);
+    orbit->omega0 = orbit_field(&lines[3], 2);
+    orbit->cis = orbit_field(&lines[3], 3);
+
+    orbit->i0 = orbit_field(&lines[4], 0);
+    orbit->crc = orbit_field(&lines[4], 1);
+    orbit->omega = orbit_field(&lines[4], 2);
+    orbit->omega_dot = orbit_field(&lines[4], 3);
+
+    orbit->i_dot = orbit_field(&lines[5], 0);
+    double week = orbit_field(&lines[5], 2);
+
+    /* 星历参考时刻 (平近点角m0对应的时刻) */
+    sat->valid_time = (time_t)llround(system_time_to_unix(sat->system, week, orbit->toe));
+    sat->is_valid = validate_prn(sat->prn) && orbit->sqrt_a > 0.0 &&
+                    orbit->e >= 0.0 && orbit->e < 1.0;
+
+    return sat->is_valid;
+}
+
+static int parse_nav_header(const char** cursor, const char* end, RinexNavInfo* info) {
+    RinexLine line;
+
+    while (*cursor < end) {
+        *cursor = next_line(*cursor, end, &line);
+        if (line.length < 61) continue;
+
+        const char* label = line.text + 60;
+        int label_length = line.length - 60;
+
+        if (label_length >= 20 && strncmp(label, "RINEX VERSION / TYPE", 20) == 0) {
+            info->version = parse_fortran_double(line.text, 9);
+            info->file_type = line.text[20];
+            info->system_code = line.text[40];
+        } else if (label_length >= 13 && strncmp(label, "END OF HEADER", 13) == 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int rinex_nav_parse_buffer(const char* buffer, size_t length,
+                           RinexNavRecordHandler handler, void* user_data,
+                           RinexNavInfo* info) {
+    if (buffer == NULL || handler == NULL) return 0;
+
+    RinexNavInfo local_info;
+    if (info == NULL) info = &local_info;
+    memset(info, 0, sizeof(RinexNavInfo));
+
+    const char* cursor = buffer;
+    const char* end = buffer + length;
+
+    if (!parse_nav_header(&cursor, end, info)) {
+        error_set(ERROR_PARSE, "RINEX导航文件缺少文件头", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+    if (info->version < 3.0 || info->version >= 4.0 || info->file_type != 'N') {
+        error_set(ERROR_PARSE, "仅支持RINEX 3.x导航文件", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    RinexLine lines[RINEX_NAV_ORBIT_LINES + 1];
+    RinexLine line;
+    int pending = 0;  /* line中是否已读入下一条记录的首行 */
+
+    while (pending || cursor < end) {
+        if (!pending) cursor = next_line(cursor, end, &line);
+        pending = 0;
+
+        /* 记录头行以系统标识开头，续行以4个空格开头 */
+        if (line.length == 0 || line.text[0] == ' ') continue;
+
+        int line_count = 0;
+        lines[line_count++] = line;
+        while (cursor < end) {
+            cursor = next_line(cursor, end, &line);
+            if (line.length < 4 || strncmp(line.text, "    ", 4) != 0) {
+                pending = 1;
+                break;
+            }
+            if (line_count < RINEX_NAV_ORBIT_LINES + 1) lines[line_count++] = line;
+        }
+
+        if (system_from_code(lines[0].text[0]) == 0) {
+            info->skipped++;
+            continue;
+        }
+
+        Satellite sat;
+        if (!parse_kepler_record(lines, line_count, &sat)) {
+            info->errors++;
+            continue;
+        }
+
+        info->records++;
+        if (!handler(&sat, user_data)) break;
+    }
+
+    return 1;
+}
+
+/* =================== 文件映射 =================== */
+
+int rinex_nav_parse_file(const char* filename, RinexNavRecordHandler handler,
+                         void* user_data, RinexNavInfo* info) {
+    if (filename == NULL || handler == NULL) return 0;
+
+#ifdef _WIN32
+    /* Windows下整体读入内存 */
+    long size = file_size(filename);
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL || size < 0) {
+        if (file != NULL) fclose(file);
+        error_set(ERROR_FILE, "无法打开RINEX导航文件", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    char* buffer = (char*)safe_malloc((size_t)size + 1);
+    if (buffer == NULL) {
+        fclose(file);
+        return 0;
+    }
+    size_t length = fread(buffer, 1, (size_t)size, file);
+    fclose(file);
+
+    int result = rinex_nav_parse_buffer(buffer, length, handler, user_data, info);
+    safe_free((void**)&buffer);
+    return result;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        error_set(ERROR_FILE, "无法打开RINEX导航文件", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        error_set(ERROR_FILE, "RINEX导航文件为空", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    size_t length = (size_t)st.st_size;
+    void* mapped = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        error_set(ERROR_FILE, "RINEX导航文件映射失败", __func__, __FILE__, __LINE__);
+        return 0;
+    }
+
+    /* 顺序扫描，提示内核预读 */
+    posix_madvise(mapped, length, POSIX_MADV_SEQUENTIAL);
+
+    int result = rinex_nav_parse_buffer((const char*)mapped, length, handler, user_data, info);
+    munmap(mapped, length);
+    return result;
+#endif
+}
+
+/* =================== SatelliteData加载 =================== */
+
+/* 文件中同一颗卫星的多组星历全部进入星历库，再按查询时刻为每颗卫星选择一组 */
+int rinex_nav_load(const char* filename, SatelliteSystem system, time_t time, SatelliteData* data) {
+    if (filename == NULL || data == NULL) return 0;
+
+    EphemerisStore* store = ephemeris_store_create();
+    if (store == NULL) return 0;
+
+    RinexNavInfo info;
+    if (!ephemeris_store_load_rinex(store, filename, &info)) {
+        ephemeris_store_destroy(store);
+        return 0;
+    }
+
+    ephemeris_store_select(store, system, time, data);
+    ephemeris_store_destroy(store);
+
+    LOG_INFO_FMT("RINEX导航文件解析完成: %d条星历, %d颗%s卫星, 跳过%d条, 错误%d条",
+                 info.records, data->satellite_count, satellite_system_to_string(system),
+                 info.skipped, info.errors);
+
+    return data->satellite_count;
+}
@@ -30,6 +30,7 @@ SatelliteData* satellite_data_create(int max_satellites) {
     data->satellite_count = 0;
     data->max_satellites = max_satellites;
     data->reference_time = time(NULL);
+    data->version = 0;
     
     return data;
 }
@@ -63,6 +64,7 @@ int satellite_data_add(SatelliteData* data, const Satellite* satellite) {
         if (data->satellites[i].prn == satellite->prn) {
             /* 更新现有卫星数据 */
             memcpy(&data->satellites[i], satellite, sizeof(Satellite));
+            data->version++;
             return 1;
         }
     }
@@ -70,6 +72,7 @@ int satellite_data_add(SatelliteData* data, const Satellite* satellite) {
     /* 添加新卫星 */
     memcpy(&data->satellites[data->satellite_count], satellite, sizeof(Satellite));
     data->satellite_count++;
+    data->version++;
     
     return 1;
 }
@@ -88,95 +91,222 @@ Satellite* satellite_data_find(SatelliteData* data, int prn) {
 
 /* =================== 卫星位置计算 =================== */
 
-/* 解开普勒方程 */
-static double solve_kepler_equation(double M, double e, double tolerance) {
-    double E = M;  /* 初始猜测 */
+/* 解开普勒方程 (E0为初始猜测，iterations返回牛顿迭代次数，可为NULL) */
+static double solve_kepler_equation(double M, double e, double E0, double tolerance, int* iterations) {
+    double E = E0;
     double delta_E;
+    int i;
     
-    for (int i = 0; i < 50; i++) {  /* 最多迭代50次 */
+    for (i = 0; i < 50; i++) {  /* 最多迭代50次 */
         delta_E = (E - e * sin(E) - M) / (1 - e * cos(E));
         E = E - delta_E;
         
         if (fabs(delta_E) < tolerance) {
-            return E;
+            i++;
+            break;
         }
     }
     
+    if (iterations != NULL) *iterations = i;
     return E;  /* 返回最佳估计 */
 }
 
-/* 计算卫星位置 */
-int satellite_position_calculate(Satellite* satellite, time_t time) {
-    if (satellite == NULL || !time_is_valid(time)) return 0;
+/* =================== 预计算星历 =================== */
+
+int satellite_ephemeris_prepare(const Satellite* satellite, SatelliteEphemeris* ephemeris) {
+    if (satellite == NULL || ephemeris == NULL) return 0;
     
-    /* 计算时间差 */
-    double dt = difftime(time, satellite->valid_time);
-    if (dt < 0) dt = 0;  /* 不能使用未来的数据 */
+    const SatelliteOrbit* orbit = &satellite->orbit;
+    if (orbit->sqrt_a <= 0.0 || orbit->e < 0.0 || orbit->e >= 1.0) {
+        error_set(ERROR_PARAMETER, "无效的轨道参数", __func__, __FILE__, __LINE__);
+        return 0;
+    }
     
-    /* 获取轨道参数 */
-    SatelliteOrbit* orbit = &satellite->orbit;
+    double sqrt_a3 = orbit->sqrt_a * orbit->sqrt_a * orbit->sqrt_a;
+    
+    ephemeris->prn = satellite->prn;
+    ephemeris->system = satellite->system;
+    ephemeris->ref_time = (double)satellite->valid_time;
+    
+    /* 轨道形状 */
+    ephemeris->a = orbit->sqrt_a * orbit->sqrt_a;
+    ephemeris->n = sqrt(EARTH_MU) / sqrt_a3 + orbit->delta_n;
+    ephemeris->e = orbit->e;
+    ephemeris->sqrt_1me2 = sqrt(1.0 - orbit->e * orbit->e);
+    ephemeris->m0 = orbit->m0;
+    ephemeris->sin_omega = sin(orbit->omega);
+    ephemeris->cos_omega = cos(orbit->omega);
+    
+    /* 轨道倾角 */
+    ephemeris->i0 = orbit->i0;
+    ephemeris->i_dot = orbit->i_dot;
+    ephemeris->sin_i0 = sin(orbit->i0);
+    ephemeris->cos_i0 = cos(orbit->i0);
+    ephemeris->const_inclination = (orbit->i_dot == 0.0 && orbit->cic == 0.0 && orbit->cis == 0.0);
+    
+    /* 调和改正项 */
+    ephemeris->cuc = orbit->cuc;
+    ephemeris->cus = orbit->cus;
+    ephemeris->crc = orbit->crc;
+    ephemeris->crs = orbit->crs;
+    ephemeris->cic = orbit->cic;
+    ephemeris->cis = orbit->cis;
+    
+    /* 升交点赤经 */
+    ephemeris->lambda0 = orbit->omega0 - EARTH_OMEGA * orbit->toe;
+    ephemeris->lambda_rate = orbit->omega_dot - EARTH_OMEGA;
+    
+    /* 速度 (简化版本) */
+    ephemeris->speed = sqrt(EARTH_MU / sqrt_a3);
     
-    /* 计算平近点角 */
-    double n = sqrt(EARTH_MU) / (orbit->sqrt_a * orbit->sqrt_a * orbit->sqrt_a) + orbit->delta_n;
-    double M = orbit->m0 + n * dt;
+    return 1;
+}
+
+/* 计算相对参考时间的传播时长和归一化到 [0, 2π] 的平近点角。
+ * dt带符号: 星历在toe前后的拟合区间内均有效，ref_time为绝对时间，跨周无需回绕 */
+static double ephemeris_mean_anomaly(const SatelliteEphemeris* ephemeris, double time, double* dt) {
+    *dt = time - ephemeris->ref_time;
     
-    /* 归一化平近点角到 [0, 2π] */
-    M = fmod(M, 2 * GPS_PI);
+    double M = fmod(ephemeris->m0 + ephemeris->n * *dt, 2 * GPS_PI);
     if (M < 0) M += 2 * GPS_PI;
+    return M;
+}
+
+/* 由偏近点角计算位置和速度 */
+static void ephemeris_position_from_anomaly(const SatelliteEphemeris* ephemeris, double dt,
+                                            double sin_E, double cos_E,
+                                            SatellitePosition* position) {
+    double one_minus_ecos = 1.0 - ephemeris->e * cos_E;
     
-    /* 解开普勒方程得到偏近点角 */
-    double E = solve_kepler_equation(M, orbit->e, 1e-12);
-    
-    /* 计算真近点角 */
-    double nu = 2 * atan2(sqrt(1 + orbit->e) * sin(E / 2), 
-                          sqrt(1 - orbit->e) * cos(E / 2));
-    
-    /* 计算轨道半径 */
-    double r = orbit->sqrt_a * orbit->sqrt_a * (1 - orbit->e * cos(E));
-    
-    /* 计算轨道平面内的位置 */
-    /* double x_orbital = r * cos(nu); */
-    /* double y_orbital = r * sin(nu); */
+    /* 真近点角 (由偏近点角直接求正余弦，无需atan2) */
+    double sin_nu = ephemeris->sqrt_1me2 * sin_E / one_minus_ecos;
+    double cos_nu = (cos_E - ephemeris->e) / one_minus_ecos;
     
-    /* 计算经度修正 */
-    /* double omega = orbit->omega + orbit->omega_dot * dt; */
+    /* 轨道半径 */
+    double r = ephemeris->a * one_minus_ecos;
     
-    /* 计算纬度修正 */
-    double phi = nu + orbit->omega;
+    /* 纬度幅角 phi = nu + omega */
+    double sin_phi = sin_nu * ephemeris->cos_omega + cos_nu * ephemeris->sin_omega;
+    double cos_phi = cos_nu * ephemeris->cos_omega - sin_nu * ephemeris->sin_omega;
+    double sin_2phi = 2.0 * sin_phi * cos_phi;
+    double cos_2phi = cos_phi * cos_phi - sin_phi * sin_phi;
     
     /* 应用调和改正项 */
-    double delta_u = orbit->cus * sin(2 * phi) + orbit->cuc * cos(2 * phi);
-    double delta_r = orbit->crs * sin(2 * phi) + orbit->crc * cos(2 * phi);
-    double delta_i = orbit->cis * sin(2 * phi) + orbit->cic * cos(2 * phi);
-    
-    /* 修正后的轨道参数 */
-    double u = phi + delta_u;
+    double delta_u = ephemeris->cus * sin_2phi + ephemeris->cuc * cos_2phi;
+    double delta_r = ephemeris->crs * sin_2phi + ephemeris->crc * cos_2phi;
+    
+    double sin_u = sin_phi;
+    double cos_u = cos_phi;
+    if (delta_u != 0.0) {
+        double sin_du = sin(delta_u);
+        double cos_du = cos(delta_u);
+        sin_u = sin_phi * cos_du + cos_phi * sin_du;
+        cos_u = cos_phi * cos_du - sin_phi * sin_du;
+    }
     double r_corrected = r + delta_r;
-    double i_corrected = orbit->i0 + orbit->i_dot * dt + delta_i;
+    
+    double sin_i = ephemeris->sin_i0;
+    double cos_i = ephemeris->cos_i0;
+    if (!ephemeris->const_inclination) {
+        double delta_i = ephemeris->cis * sin_2phi + ephemeris->cic * cos_2phi;
+        double i_corrected = ephemeris->i0 + ephemeris->i_dot * dt + delta_i;
+        sin_i = sin(i_corrected);
+        cos_i = cos(i_corrected);
+    }
     
     /* 计算升交点赤经 */
-    double lambda = orbit->omega0 + (orbit->omega_dot - EARTH_OMEGA) * dt - EARTH_OMEGA * orbit->toe;
+    double lambda = ephemeris->lambda0 + ephemeris->lambda_rate * dt;
+    double sin_l = sin(lambda);
+    double cos_l = cos(lambda);
     
     /* TODO: 实现相对论效应修正 */
     /* 计算ECEF坐标 */
-    double x = r_corrected * (cos(u) * cos(lambda) - sin(u) * cos(i_corrected) * sin(lambda));
-    double y = r_corrected * (cos(u) * sin(lambda) + sin(u) * cos(i_corrected) * cos(lambda));
-    double z = r_corrected * sin(u) * sin(i_corrected);
+    position->x = r_corrected * (cos_u * cos_l - sin_u * cos_i * sin_l);
+    position->y = r_corrected * (cos_u * sin_l + sin_u * cos_i * cos_l);
+    position->z = r_corrected * sin_u * sin_i;
     
     /* 计算速度 (简化版本) */
-    double v = sqrt(EARTH_MU / (orbit->sqrt_a * orbit->sqrt_a * orbit->sqrt_a));
-    double vx = -v * sin(u) * cos(lambda) - v * cos(u) * cos(i_corrected) * sin(lambda);
-    double vy = -v * sin(u) * sin(lambda) + v * cos(u) * cos(i_corrected) * cos(lambda);
-    double vz = v * cos(u) * sin(i_corrected);
-    
-    /* 存储结果 */
-    satellite->pos.x = x;
-    satellite->pos.y = y;
-    satellite->pos.z = z;
-    satellite->pos.vx = vx;
-    satellite->pos.vy = vy;
-    satellite->pos.vz = vz;
-    satellite->valid_time = time;
+    double v = ephemeris->speed;
+    position->vx = -v * sin_u * cos_l - v * cos_u * cos_i * sin_l;
+    position->vy = -v * sin_u * sin_l + v * cos_u * cos_i * cos_l;
+    position->vz = v * cos_u * sin_i;
+}
+
+int satellite_ephemeris_propagate(const SatelliteEphemeris* ephemeris, double time,
+                                  SatellitePosition* position) {
+    if (ephemeris == NULL || position == NULL) return 0;
+    
+    double dt;
+    double M = ephemeris_mean_anomaly(ephemeris, time, &dt);
+    
+    /* 解开普勒方程得到偏近点角 */
+    double E = solve_kepler_equation(M, ephemeris->e, M, 1e-12, NULL);
+    ephemeris_position_from_anomaly(ephemeris, dt, sin(E), cos(E), position);
+    
+    return 1;
+}
+
+/* =================== 顺序传播器 =================== */
+
+int satellite_propagator_init(SatellitePropagator* propagator, const Satellite* satellite) {
+    if (propagator == NULL || satellite == NULL) return 0;
+    
+    memset(propagator, 0, sizeof(SatellitePropagator));
+    return satellite_ephemeris_prepare(satellite, &propagator->ephemeris);
+}
+
+void satellite_propagator_reset(SatellitePropagator* propagator) {
+    if (propagator == NULL) return;
+    
+    propagator->has_state = 0;
+    propagator->solves = 0;
+    propagator->iterations = 0;
+    propagator->last_iterations = 0;
+}
+
+int satellite_propagator_step(SatellitePropagator* propagator, double time, SatellitePosition* position) {
+    if (propagator == NULL || position == NULL) return 0;
+    
+    const SatelliteEphemeris* eph = &propagator->ephemeris;
+    double dt;
+    double M = ephemeris_mean_anomaly(eph, time, &dt);
+    
+    /* 热启动: 在上一历元处对E(M)做二阶泰勒外推。
+     * E - M = e*sin(E) 与M的周期无关，因此无需处理2π回绕 */
+    double E0 = M;
+    if (propagator->has_state) {
+        double dM = eph->n * (dt - propagator->last_dt);
+        double g = 1.0 / (1.0 - eph->e * propagator->last_cos_E);   /* dE/dM */
+        double g2 = -eph->e * propagator->last_sin_E * g * g * g;   /* d2E/dM2 */
+        E0 = M + eph->e * propagator->last_sin_E + dM * (g - 1.0) + 0.5 * dM * dM * g2;
+    }
+    
+    int iterations;
+    double E = solve_kepler_equation(M, eph->e, E0, 1e-12, &iterations);
+    double sin_E = sin(E);
+    double cos_E = cos(E);
+    ephemeris_position_from_anomaly(eph, dt, sin_E, cos_E, position);
+    
+    propagator->has_state = 1;
+    propagator->last_dt = dt;
+    propagator->last_sin_E = sin_E;
+    propagator->last_cos_E = cos_E;
+    propagator->last_iterations = iterations;
+    propagator->solves++;
+    propagator->iterations += iterations;
+    
+    return 1;
+}
+
+/* 计算卫星位置 (valid_time是星历参考时刻，保持不变，重复调用结果一致) */
+int satellite_position_calculate(Satellite* satellite, time_t time) {
+    if (satellite == NULL || !time_is_valid(time)) return 0;
+    
+    SatelliteEphemeris ephemeris;
+    if (!satellite_ephemeris_prepare(satellite, &ephemeris)) return 0;
+    
+    if (!satellite_ephemeris_propagate(&ephemeris, (double)time, &satellite->pos)) return 0;
+    
     satellite->is_valid = 1;
     
     return 1;
@@ -184,76 +314,221 @@ int satellite_position_calculate(Satellite* satellite, time_t time) {
 
 /* =================== 卫星可见性计算 =================== */
 
-int satellite_visibility_calculate(const Satellite* satellite, 
-                                   double lat, double lon, double alt,
-                                   SatelliteVisibility* visibility) {
-    if (satellite == NULL || visibility == NULL || 
-        !validate_latitude(lat) || !validate_longitude(lon) || !validate_altitude(alt)) {
+/* 自由空间路径损耗中与距离无关的部分: 20*log10(f) - 147.55 */
+#define PATH_LOSS_CONSTANT (20 * log10(1575.42e6) - 147.55)
+#define ELEVATION_MASK_DEGREES 5.0   /* 截止高度角 */
+
+int receiver_frame_init(ReceiverFrame* frame, double lat, double lon, double alt) {
+    if (frame == NULL || !validate_latitude(lat) || !validate_longitude(lon) || !validate_altitude(alt)) {
         return 0;
     }
     
-    if (!satellite->is_valid) {
-        visibility->is_visible = 0;
-        visibility->is_obstructed = 1;
-        return 0;
-    }
+    frame->latitude = lat;
+    frame->longitude = lon;
+    frame->altitude = alt;
     
-    /* 计算接收机位置 */
+    /* 接收机ECEF原点 */
     GeodeticCoordinate receiver_pos = {lat, lon, alt};
     EcefCoordinate receiver_ecef = geodetic_to_ecef(&receiver_pos);
+    frame->origin_x = receiver_ecef.x;
+    frame->origin_y = receiver_ecef.y;
+    frame->origin_z = receiver_ecef.z;
+    
+    /* ECEF到北-东-天坐标系的旋转矩阵 */
+    double lat_rad = degrees_to_radians(lat);
+    double lon_rad = degrees_to_radians(lon);
+    double cos_lat = cos(lat_rad);
+    double sin_lat = sin(lat_rad);
+    double cos_lon = cos(lon_rad);
+    double sin_lon = sin(lon_rad);
+    
+    frame->rotation[0][0] = -sin_lat * cos_lon;
+    frame->rotation[0][1] = -sin_lat * sin_lon;
+    frame->rotation[0][2] = cos_lat;
+    frame->rotation[1][0] = -sin_lon;
+    frame->rotation[1][1] = cos_lon;
+    frame->rotation[1][2] = 0.0;
+    frame->rotation[2][0] = cos_lat * cos_lon;
+    frame->rotation[2][1] = cos_lat * sin_lon;
+    frame->rotation[2][2] = sin_lat;
     
-    /* 计算卫星到接收机的向量 */
-    double dx = satellite->pos.x - receiver_ecef.x;
-    double dy = satellite->pos.y - receiver_ecef.y;
-    double dz = satellite->pos.z - receiver_ecef.z;
-    
-    /* 计算距离 */
-    visibility->distance = sqrt(dx * dx + dy * dy + dz * dz);
-    
-    /* 计算高度角和方位角 */
-    double receiver_lat_rad = degrees_to_radians(lat);
-    double receiver_lon_rad = degrees_to_radians(lon);
-    
-    /* 转换到接收机坐标系 */
-    double cos_lat = cos(receiver_lat_rad);
-    double sin_lat = sin(receiver_lat_rad);
-    double cos_lon = cos(receiver_lon_rad);
-    double sin_lon = sin(receiver_lon_rad);
-    
-    /* 接收机坐标系中的卫星位置 */
-    double x_local = -sin_lat * cos_lon * dx - sin_lat * sin_lon * dy + cos_lat * dz;
-    double y_local = -sin_lon * dx + cos_lon * dy;
-    double z_local = cos_lat * cos_lon * dx + cos_lat * sin_lon * dy + sin_lat * dz;
-    
-    /* 计算高度角 */
-    double elevation_rad = atan2(z_local, sqrt(x_local * x_local + y_local * y_local));
-    visibility->elevation = radians_to_degrees(elevation_rad);
-    
-    /* 计算方位角 */
-    double azimuth_rad = atan2(y_local, x_local);
-    visibility->azimuth = radians_to_degrees(azimuth_rad);
-    if (visibility->azimuth < 0) {
-        visibility->azimuth += 360.0;
+    return 1;
+}
+
+/* 由北-东-天分量计算高度角、方位角、距离和信号强度 */
+static void local_to_visibility(double north, double east, double up,
+                                double* elevation, double* azimuth, double* distance,
+                                double* signal_strength, int* is_visible) {
+    double horizontal = sqrt(north * north + east * east);
+    
+    *distance = sqrt(horizontal * horizontal + up * up);
+    *elevation = radians_to_degrees(math_atan2(up, horizontal));
+    *azimuth = radians_to_degrees(math_atan2(east, north));
+    if (*azimuth < 0) {
+        *azimuth += 360.0;
     }
     
-    /* 判断可见性 */
-    visibility->is_visible = (visibility->elevation > 5.0);  /* 5度截止角 */
-    visibility->is_obstructed = 0;  /* 简化版本，不考虑遮挡 */
+    *is_visible = (*elevation > ELEVATION_MASK_DEGREES);
     
-    /* 计算信号强度 (简化模型) */
-    if (visibility->is_visible) {
-        /* 自由空间路径损耗 */
-        double path_loss = 20 * log10(visibility->distance) + 20 * log10(1575.42e6) - 147.55;
-        visibility->signal_strength = -130.0 - path_loss;  /* 典型GPS信号强度 */
+    /* 信号强度 (简化模型，自由空间路径损耗) */
+    if (*is_visible) {
+        double path_loss = 20 * math_log10(*distance) + PATH_LOSS_CONSTANT;
+        *signal_strength = -130.0 - path_loss;  /* 典型GPS信号强度 */
     } else {
-        visibility->signal_strength = -200.0;  /* 不可见 */
+        *signal_strength = -200.0;  /* 不可见 */
     }
+}
+
+int receiver_frame_visibility(const ReceiverFrame* frame, const Satellite* satellite,
+                              SatelliteVisibility* visibility) {
+    if (frame == NULL || satellite == NULL || visibility == NULL) return 0;
+    
+    if (!satellite->is_valid) {
+        visibility->is_visible = 0;
+        visibility->is_obstructed = 1;
+        return 0;
+    }
+    
+    /* 卫星到接收机的向量，旋转到接收机坐标系 */
+    double dx = satellite->pos.x - frame->origin_x;
+    double dy = satellite->pos.y - frame->origin_y;
+    double dz = satellite->pos.z - frame->origin_z;
+    double north = frame->rotation[0][0] * dx + frame->rotation[0][1] * dy + frame->rotation[0][2] * dz;
+    double east = frame->rotation[1][0] * dx + frame->rotation[1][1] * dy;
+    double up = frame->rotation[2][0] * dx + frame->rotation[2][1] * dy + frame->rotation[2][2] * dz;
     
+    local_to_visibility(north, east, up, &visibility->elevation, &visibility->azimuth,
+                        &visibility->distance, &visibility->signal_strength, &visibility->is_visible);
+    visibility->is_obstructed = 0;  /* 简化版本，不考虑遮挡 */
     visibility->prn = satellite->prn;
     
     return 1;
 }
 
+int satellite_visibility_calculate(const Satellite* satellite, 
+                                   double lat, double lon, double alt,
+                                   SatelliteVisibility* visibility) {
+    if (satellite == NULL || visibility == NULL) return 0;
+    
+    ReceiverFrame frame;
+    if (!receiver_frame_init(&frame, lat, lon, alt)) return 0;
+    
+    return receiver_frame_visibility(&frame, satellite, visibility);
+}
+
+/* =================== 批量可见性 =================== */
+
+SatelliteVisibilityBatch* satellite_visibility_batch_create(int capacity) {
+    if (capacity <= 0) return NULL;
+    
+    SatelliteVisibilityBatch* batch = (SatelliteVisibilityBatch*)safe_calloc(1, sizeof(SatelliteVisibilityBatch));
+    if (batch == NULL) return NULL;
+    
+    batch->prn = (int*)safe_calloc(capacity, sizeof(int));
+    batch->is_visible = (int*)safe_calloc(capacity, sizeof(int));
+    batch->x = (double*)safe_calloc(capacity, sizeof(double));
+    batch->y = (double*)safe_calloc(capacity, sizeof(double));
+    batch->z = (double*)safe_calloc(capacity, sizeof(double));
+    batch->north = (double*)safe_calloc(capacity, sizeof(double));
+    batch->east = (double*)safe_calloc(capacity, sizeof(double));
+    batch->up = (double*)safe_calloc(capacity, sizeof(double));
+    batch->elevation = (double*)safe_calloc(capacity, sizeof(double));
+    batch->azimuth = (double*)safe_calloc(capacity, sizeof(double));
+    batch->distance = (double*)safe_calloc(capacity, sizeof(double));
+    batch->signal_strength = (double*)safe_calloc(capacity, sizeof(double));
+    
+    if (batch->prn == NULL || batch->is_visible == NULL ||
+        batch->x == NULL || batch->y == NULL || batch->z == NULL || batch->north == NULL ||
+        batch->east == NULL || batch->up == NULL || batch->elevation == NULL ||
+        batch->azimuth == NULL || batch->distance == NULL || batch->signal_strength == NULL) {
+        satellite_visibility_batch_destroy(batch);
+        return NULL;
+    }
+    
+    batch->capacity = capacity;
+    return batch;
+}
+
+void satellite_visibility_batch_destroy(SatelliteVisibilityBatch* batch) {
+    if (batch == NULL) return;
+    
+    safe_free((void**)&batch->prn);
+    safe_free((void**)&batch->is_visible);
+    safe_free((void**)&batch->x);
+    safe_free((void**)&batch->y);
+    safe_free((void**)&batch->z);
+    safe_free((void**)&batch->north);
+    safe_free((void**)&batch->east);
+    safe_free((void**)&batch->up);
+    safe_free((void**)&batch->elevation);
+    safe_free((void**)&batch->azimuth);
+    safe_free((void**)&batch->distance);
+    safe_free((void**)&batch->signal_strength);
+    safe_free((void**)&batch);
+}
+
+/* x/y/z为输入ECEF位置，不得与batch的north/east/up列重叠 */
+int receiver_frame_visibility_positions(const ReceiverFrame* frame,
+                                        const double* x, const double* y, const double* z,
+                                        int count, SatelliteVisibilityBatch* batch) {
+    if (frame == NULL || x == NULL || y == NULL || z == NULL || batch == NULL) return 0;
+    if (count > batch->capacity) count = batch->capacity;
+    
+    const double r00 = frame->rotation[0][0], r01 = frame->rotation[0][1], r02 = frame->rotation[0][2];
+    const double r10 = frame->rotation[1][0], r11 = frame->rotation[1][1];
+    const double r20 = frame->rotation[2][0], r21 = frame->rotation[2][1], r22 = frame->rotation[2][2];
+    
+    const double ox = frame->origin_x, oy = frame->origin_y, oz = frame->origin_z;
+    
+    /* 输入列与输出列互不重叠 (调用约定)，restrict让编译器无需别名检查即可向量化 */
+    const double* restrict in_x = x;
+    const double* restrict in_y = y;
+    const double* restrict in_z = z;
+    double* restrict north = batch->north;
+    double* restrict east = batch->east;
+    double* restrict up = batch->up;
+    
+    /* 第一遍: 纯乘加的坐标旋转，可被编译器向量化 */
+    for (int i = 0; i < count; i++) {
+        double dx = in_x[i] - ox;
+        double dy = in_y[i] - oy;
+        double dz = in_z[i] - oz;
+        north[i] = r00 * dx + r01 * dy + r02 * dz;
+        east[i] = r10 * dx + r11 * dy;
+        up[i] = r20 * dx + r21 * dy + r22 * dz;
+    }
+    
+    /* 第二遍: 角度、距离和信号强度 */
+    for (int i = 0; i < count; i++) {
+        local_to_visibility(batch->north[i], batch->east[i], batch->up[i],
+                            &batch->elevation[i], &batch->azimuth[i], &batch->distance[i],
+                            &batch->signal_strength[i], &batch->is_visible[i]);
+    }
+    
+    batch->count = count;
+    return count;
+}
+
+int receiver_frame_visibility_batch(const ReceiverFrame* frame, const SatelliteData* data,
+                                    SatelliteVisibilityBatch* batch) {
+    if (frame == NULL || data == NULL || batch == NULL) return 0;
+    
+    /* 只收集有效卫星的位置 */
+    int count = 0;
+    for (int i = 0; i < data->satellite_count && count < batch->capacity; i++) {
+        const Satellite* sat = &data->satellites[i];
+        if (!sat->is_valid) continue;
+        
+        batch->prn[count] = sat->prn;
+        batch->x[count] = sat->pos.x;
+        batch->y[count] = sat->pos.y;
+        batch->z[count] = sat->pos.z;
+        count++;
+    }
+    
+    return receiver_frame_visibility_positions(frame, batch->x, batch->y, batch->z, count, batch);
+}
+
 /* =================== RINEX文件处理 =================== */
 
 int rinex_header_parse(const char* filename, RinexHeader* header) {
@@ -324,6 +599,7 @@ int rinex_data_parse(const char* filename, SatelliteData* data) {
     
     /* 清空现有数据 */
     data->satellite_count = 0;
+    data->version++;
     
     while (fgets(line, sizeof(line), file)) {
         line_number++;
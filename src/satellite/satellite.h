@@ -1,6 +1,7 @@
 #ifndef SATELLITE_H
 #define SATELLITE_H
 
+#include <stddef.h>
 #include <time.h>
 
 /* 卫星系统类型 */
@@ -60,6 +61,103 @@ typedef struct {
     int is_valid;        /* 是否有效 */
 } Satellite;
 
+/* 预计算星历 (每颗卫星每个星历历元构建一次，缓存与时间无关的项) */
+typedef struct {
+    int prn;             /* 卫星PRN号 */
+    SatelliteSystem system; /* 卫星系统 */
+    double ref_time;     /* 传播参考时间 (秒，对应平近点角m0) */
+    double a;            /* 轨道长半轴 (米) */
+    double n;            /* 修正后的平均运动角速度 (弧度/秒) */
+    double e;            /* 离心率 */
+    double sqrt_1me2;    /* sqrt(1-e^2) */
+    double m0;           /* 平近点角 (弧度) */
+    double sin_omega;    /* 近地点幅角正弦 */
+    double cos_omega;    /* 近地点幅角余弦 */
+    double i0;           /* 轨道倾角 (弧度) */
+    double i_dot;        /* 轨道倾角变化率 (弧度/秒) */
+    double sin_i0;       /* 轨道倾角正弦 */
+    double cos_i0;       /* 轨道倾角余弦 */
+    int const_inclination; /* 倾角是否与时间和纬度无关 */
+    double cuc, cus;     /* 纬度调和改正项 */
+    double crc, crs;     /* 轨道半径调和改正项 */
+    double cic, cis;     /* 轨道倾角调和改正项 */
+    double lambda0;      /* omega0 - EARTH_OMEGA * toe */
+    double lambda_rate;  /* omega_dot - EARTH_OMEGA */
+    double speed;        /* 速度幅值 (米/秒，简化模型) */
+} SatelliteEphemeris;
+
+/* 顺序传播器 (按时间步进时以上一历元的偏近点角热启动开普勒求解) */
+typedef struct {
+    SatelliteEphemeris ephemeris; /* 预计算星历 */
+    int has_state;              /* 是否已有上一历元状态 */
+    double last_dt;             /* 上一历元相对参考时间的秒数 */
+    double last_sin_E;          /* 上一历元偏近点角正弦 */
+    double last_cos_E;          /* 上一历元偏近点角余弦 */
+    int last_iterations;        /* 上一次求解的牛顿迭代次数 */
+    long long solves;           /* 累计求解次数 */
+    long long iterations;       /* 累计牛顿迭代次数 */
+} SatellitePropagator;
+
+/* 批量星历 (SoA布局，供SIMD内核一次传播整个星座) */
+#define SATELLITE_BATCH_LANES 4                  /* 每次内核调用处理的卫星数 */
+#define SATELLITE_BATCH_MAX_ECCENTRICITY 0.1     /* 固定迭代开普勒求解的离心率上限 */
+
+typedef struct {
+    int count;                  /* 有效卫星数量 */
+    int capacity;               /* 列长度 (按SATELLITE_BATCH_LANES对齐) */
+    SatelliteEphemeris* ephemerides; /* 逐颗预计算星历 (标量回退使用) */
+    int* data_index;            /* 在SatelliteData中的下标 */
+    int* needs_scalar;          /* 离心率超限，需走标量路径 */
+    double* block;              /* 所有列共用的对齐内存 */
+
+    /* 输入列 */
+    double* ref_time, *a, *n, *e, *sqrt_1me2, *m0;
+    double* sin_omega, *cos_omega, *i0, *i_dot;
+    double* cuc, *cus, *crc, *crs, *cic, *cis;
+    double* lambda0, *lambda_rate, *speed;
+
+    /* 输出列 (ECEF，米和米/秒) */
+    double* x, *y, *z;
+    double* vx, *vy, *vz;
+} SatelliteEphemerisBatch;
+
+/* 星历插值缓存 (按PRN和时间窗口拟合切比雪夫多项式) */
+#define EPHEMERIS_CACHE_MAX_DEGREE 20
+
+typedef struct {
+    double window_seconds;      /* 拟合窗口长度 (秒) */
+    int degree;                 /* 多项式阶数 */
+    double tolerance;           /* 位置误差上限 (米) */
+    int max_windows;            /* 最大缓存窗口数 */
+} EphemerisCacheConfig;
+
+typedef struct {
+    int in_use;                 /* 槽位是否占用 */
+    int prn;                    /* 卫星PRN号 */
+    SatelliteSystem system;     /* 卫星系统 */
+    double ref_time;            /* 星历参考时间 (区分不同星历) */
+    long long index;            /* 窗口序号 (time / window_seconds) */
+    double start;               /* 窗口起始时间 (秒) */
+    int segments;               /* 子段数，0表示无法满足误差而直接求解 */
+    double* coefficients;       /* 系数 [段][分量][阶] */
+} EphemerisCacheWindow;
+
+typedef struct {
+    long long queries;          /* 查询次数 */
+    long long hits;             /* 命中已有窗口次数 */
+    long long fits;             /* 拟合次数 */
+    long long splits;           /* 因误差超限细分的次数 */
+    long long direct;           /* 回退直接求解次数 */
+} EphemerisCacheStats;
+
+typedef struct {
+    EphemerisCacheConfig config;
+    EphemerisCacheWindow* windows; /* 开放寻址哈希表 */
+    int capacity;               /* 表容量 (2的幂) */
+    int window_count;           /* 已缓存窗口数 */
+    EphemerisCacheStats stats;
+} EphemerisCache;
+
 /* 卫星可见性状态 */
 typedef struct {
     int prn;             /* 卫星PRN号 */
@@ -71,12 +169,42 @@ typedef struct {
     int is_obstructed;  /* 是否被遮挡 */
 } SatelliteVisibility;
 
+/* 接收机坐标系 (每个接收机位置构建一次，供整个星座共用) */
+typedef struct {
+    double latitude;           /* 纬度 (度) */
+    double longitude;          /* 经度 (度) */
+    double altitude;           /* 高度 (米) */
+    double origin_x;           /* 接收机ECEF坐标 (米) */
+    double origin_y;
+    double origin_z;
+    double rotation[3][3];     /* ECEF到北-东-天的旋转矩阵 */
+} ReceiverFrame;
+
+/* 批量可见性结果 (SoA布局) */
+typedef struct {
+    int count;                 /* 结果数量 */
+    int capacity;              /* 容量 */
+    int* prn;                  /* 卫星PRN号 */
+    int* is_visible;           /* 是否可见 */
+    double* x;                 /* 输入的卫星ECEF位置 (米) */
+    double* y;
+    double* z;
+    double* north;             /* 接收机坐标系分量 (米) */
+    double* east;
+    double* up;
+    double* elevation;         /* 高度角 (度) */
+    double* azimuth;           /* 方位角 (度) */
+    double* distance;          /* 距离 (米) */
+    double* signal_strength;   /* 信号强度 (dBHz) */
+} SatelliteVisibilityBatch;
+
 /* 卫星数据管理 */
 typedef struct {
     Satellite* satellites;      /* 卫星数组 */
     int satellite_count;        /* 卫星数量 */
     int max_satellites;        /* 最大卫星数量 */
     time_t reference_time;      /* 参考时间 */
+    unsigned int version;       /* 星历版本号，卫星数据经接口修改时递增 */
 } SatelliteData;
 
 /* RINEX文件头信息 */
@@ -92,6 +220,63 @@ typedef struct {
     int prn_list[64];         /* PRN列表 */
 } RinexHeader;
 
+/* RINEX 3导航文件信息 */
+typedef struct {
+    double version;            /* RINEX版本 */
+    char file_type;            /* 文件类型 ('N') */
+    char system_code;          /* 文件卫星系统 ('M'为混合) */
+    int records;               /* 成功解析的星历记录数 */
+    int skipped;               /* 跳过的记录数 (非开普勒星历系统) */
+    int errors;                /* 格式错误的记录数 */
+} RinexNavInfo;
+
+/* 星历记录回调，返回0停止解析 */
+typedef int (*RinexNavRecordHandler)(const Satellite* satellite, void* user_data);
+
+/* 多历元星历库 (按(系统, PRN)直接映射，每颗卫星保存按时间排序的多组星历) */
+#define EPHEMERIS_STORE_MAX_PRN 64
+#define EPHEMERIS_STORE_SLOTS (SATELLITE_SYSTEM_GALILEO * EPHEMERIS_STORE_MAX_PRN)
+#define EPHEMERIS_STORE_FIT_HALF 7200  /* 星历拟合区间半宽(秒)，toe±2小时 */
+
+typedef struct {
+    Satellite* records;        /* 按valid_time(星历参考时刻)升序排列 */
+    int count;                 /* 星历组数 */
+    int capacity;              /* 容量，0表示借用外部内存 */
+} EphemerisSlot;
+
+typedef struct {
+    EphemerisSlot slots[EPHEMERIS_STORE_SLOTS];
+    int record_count;          /* 星历总组数 */
+    int satellite_count;       /* 有星历的卫星数 */
+    unsigned long long version; /* 内容版本，每次修改递增 */
+    void* mapping;             /* 快照映射内存 (借用槽位指向此处) */
+    size_t mapping_size;       /* 映射长度 */
+} EphemerisStore;
+
+/* RINEX批量导入报告 */
+typedef struct {
+    char filename[512];        /* 文件名 */
+    int success;               /* 是否解析成功 */
+    int records;               /* 解析出的星历数 */
+    int skipped;               /* 跳过的记录数 */
+    int errors;                /* 格式错误的记录数 */
+    int merged;                /* 合并入库的新星历数 */
+    int duplicates;            /* 与已有星历重复的数量 */
+    double elapsed_ms;         /* 解析耗时 (毫秒) */
+    char error_message[128];   /* 失败原因 */
+} RinexIngestFileReport;
+
+typedef struct {
+    int file_count;            /* 文件数 */
+    int files_failed;          /* 失败文件数 */
+    int threads_used;          /* 实际使用的线程数 */
+    int records;               /* 解析出的星历总数 */
+    int merged;                /* 合并入库的新星历数 */
+    int duplicates;            /* 去重数量 */
+    double elapsed_ms;         /* 总耗时 (毫秒) */
+    RinexIngestFileReport* files; /* 逐文件报告 */
+} RinexIngestReport;
+
 /* 函数声明 */
 SatelliteData* satellite_data_create(int max_satellites);
 void satellite_data_destroy(SatelliteData* data);
@@ -99,14 +284,80 @@ int satellite_data_add(SatelliteData* data, const Satellite* satellite);
 Satellite* satellite_data_find(SatelliteData* data, int prn);
 
 int satellite_position_calculate(Satellite* satellite, time_t time);
+
+int satellite_ephemeris_prepare(const Satellite* satellite, SatelliteEphemeris* ephemeris);
+int satellite_ephemeris_propagate(const SatelliteEphemeris* ephemeris, double time,
+                                  SatellitePosition* position);
+
+int satellite_propagator_init(SatellitePropagator* propagator, const Satellite* satellite);
+void satellite_propagator_reset(SatellitePropagator* propagator);
+int satellite_propagator_step(SatellitePropagator* propagator, double time, SatellitePosition* position);
+
+SatelliteEphemerisBatch* satellite_ephemeris_batch_create(const SatelliteData* data);
+void satellite_ephemeris_batch_destroy(SatelliteEphemerisBatch* batch);
+int satellite_ephemeris_batch_propagate(SatelliteEphemerisBatch* batch, double time);
+const char* satellite_ephemeris_batch_kernel_name(void);
+int satellite_data_propagate_batch(SatelliteData* data, SatelliteEphemerisBatch* batch, time_t time);
+
+void ephemeris_cache_config_default(EphemerisCacheConfig* config);
+EphemerisCache* ephemeris_cache_create(const EphemerisCacheConfig* config);
+void ephemeris_cache_destroy(EphemerisCache* cache);
+void ephemeris_cache_clear(EphemerisCache* cache);
+int ephemeris_cache_propagate(EphemerisCache* cache, const SatelliteEphemeris* ephemeris,
+                              double time, SatellitePosition* position);
+int ephemeris_cache_position(EphemerisCache* cache, const Satellite* satellite,
+                             double time, SatellitePosition* position);
+void ephemeris_cache_get_stats(const EphemerisCache* cache, EphemerisCacheStats* stats);
 int satellite_visibility_calculate(const Satellite* satellite, 
                                    double lat, double lon, double alt,
                                    SatelliteVisibility* visibility);
 
+int receiver_frame_init(ReceiverFrame* frame, double lat, double lon, double alt);
+int receiver_frame_visibility(const ReceiverFrame* frame, const Satellite* satellite,
+                              SatelliteVisibility* visibility);
+SatelliteVisibilityBatch* satellite_visibility_batch_create(int capacity);
+void satellite_visibility_batch_destroy(SatelliteVisibilityBatch* batch);
+int receiver_frame_visibility_positions(const ReceiverFrame* frame,
+                                        const double* x, const double* y, const double* z,
+                                        int count, SatelliteVisibilityBatch* batch);
+int receiver_frame_visibility_batch(const ReceiverFrame* frame, const SatelliteData* data,
+                                    SatelliteVisibilityBatch* batch);
+
 int rinex_header_parse(const char* filename, RinexHeader* header);
 int rinex_data_parse(const char* filename, SatelliteData* data);
 int rinex_write_example(const char* filename);
 
+int rinex_nav_parse_buffer(const char* buffer, size_t length,
+                           RinexNavRecordHandler handler, void* user_data,
+                           RinexNavInfo* info);
+int rinex_nav_parse_file(const char* filename, RinexNavRecordHandler handler,
+                         void* user_data, RinexNavInfo* info);
+int rinex_nav_load(const char* filename, SatelliteSystem system, time_t time, SatelliteData* data);
+
+EphemerisStore* ephemeris_store_create(void);
+void ephemeris_store_destroy(EphemerisStore* store);
+void ephemeris_store_clear(EphemerisStore* store);
+int ephemeris_store_add(EphemerisStore* store, const Satellite* satellite);
+const Satellite* ephemeris_store_find(const EphemerisStore* store, SatelliteSystem system,
+                                      int prn, time_t time);
+int ephemeris_store_count(const EphemerisStore* store, SatelliteSystem system, int prn);
+int ephemeris_store_select(const EphemerisStore* store, SatelliteSystem system, time_t time,
+                           SatelliteData* data);
+int ephemeris_store_load_rinex(EphemerisStore* store, const char* filename, RinexNavInfo* info);
+
+int rinex_ingest_files(EphemerisStore* store, const char* const* filenames, int file_count,
+                       int thread_count, RinexIngestReport* report);
+void rinex_ingest_report_free(RinexIngestReport* report);
+
+int ephemeris_snapshot_write(const EphemerisStore* store, const char* filename,
+                             unsigned long long source_hash);
+int ephemeris_snapshot_load(EphemerisStore* store, const char* filename,
+                            unsigned long long* source_hash);
+void ephemeris_snapshot_release(EphemerisStore* store);
+int ephemeris_snapshot_hash_file(const char* filename, unsigned long long* hash);
+int ephemeris_store_load_cached(EphemerisStore* store, const char* rinex_filename,
+                                const char* snapshot_filename);
+
 int satellite_data_validate(const SatelliteData* data);
 const char* satellite_system_to_string(SatelliteSystem system);
 
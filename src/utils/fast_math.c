@@ -0,0 +1,105 @@
+#include "utils.h"
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+/* 严格C11模式下math.h不提供这些常数 */
+#ifndef M_SQRT2
+#define M_SQRT2 1.41421356237309504880
+#endif
+#ifndef M_LN2
+#define M_LN2 0.69314718055994530942
+#endif
+#ifndef M_LOG10E
+#define M_LOG10E 0.43429448190325182765
+#endif
+
+/* 快速数学函数开关 (默认关闭，使用libm) */
+static int g_fast_math_enabled = 0;
+
+void fast_math_set_enabled(int enabled) {
+    g_fast_math_enabled = enabled ? 1 : 0;
+}
+
+int fast_math_is_enabled(void) {
+    return g_fast_math_enabled;
+}
+
+/* =================== 多项式近似 =================== */
+
+/* atan(z), z ∈ [0, 1]: Abramowitz & Stegun 4.4.49，|误差| ≤ 1.2e-5弧度 (系数截断后实测) */
+static double atan_unit(double z) {
+    double z2 = z * z;
+    return z * (0.9998660 + z2 * (-0.3302995 + z2 * (0.1801410 + z2 * (-0.0851330 + z2 * 0.0208351))));
+}
+
+double fast_atan2(double y, double x) {
+    double ax = fabs(x);
+    double ay = fabs(y);
+
+    if (ax == 0.0 && ay == 0.0) return atan2(y, x);  /* 保持libm对±0的约定 */
+    if (isnan(x) || isnan(y) || isinf(ax) || isinf(ay)) return atan2(y, x);
+
+    /* 归约到[0, 1]后按象限还原 */
+    double angle = (ay <= ax) ? atan_unit(ay / ax) : (M_PI / 2) - atan_unit(ax / ay);
+    if (x < 0.0) angle = M_PI - angle;
+    return (y < 0.0) ? -angle : angle;
+}
+
+double fast_acos(double x) {
+    if (!(x >= -1.0 && x <= 1.0)) return acos(x);
+
+    /* acos(|x|) = sqrt(1-|x|) * P(|x|): Abramowitz & Stegun 4.4.46，|误差| ≤ 2e-8弧度 */
+    double ax = fabs(x);
+    double p = -0.0012624911;
+    p = p * ax + 0.0066700901;
+    p = p * ax - 0.0170881256;
+    p = p * ax + 0.0308918810;
+    p = p * ax - 0.0501743046;
+    p = p * ax + 0.0889789874;
+    p = p * ax - 0.2145988016;
+    p = p * ax + 1.5707963050;
+
+    double angle = sqrt(1.0 - ax) * p;
+    return (x < 0.0) ? M_PI - angle : angle;
+}
+
+double fast_log10(double x) {
+    if (!(x > 0.0) || isinf(x)) return log10(x);
+
+    /* 拆分 x = m * 2^e，m ∈ [sqrt(0.5), sqrt(2)) */
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int exponent = (int)((bits >> 52) & 0x7FF);
+    if (exponent == 0) return log10(x);  /* 非规格化数 */
+
+    exponent -= 1023;
+    bits = (bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+    double m;
+    memcpy(&m, &bits, sizeof(m));
+    if (m > M_SQRT2) {
+        m *= 0.5;
+        exponent++;
+    }
+
+    /* ln(m) = 2*atanh(t)，t = (m-1)/(m+1)，|t| ≤ 0.172，截断误差 < 3e-8 */
+    double t = (m - 1.0) / (m + 1.0);
+    double t2 = t * t;
+    double ln_m = 2.0 * t * (1.0 + t2 * (1.0 / 3.0 + t2 * (1.0 / 5.0 + t2 * (1.0 / 7.0))));
+
+    return (exponent * M_LN2 + ln_m) * M_LOG10E;
+}
+
+/* =================== 可切换版本 =================== */
+
+double math_atan2(double y, double x) {
+    return g_fast_math_enabled ? fast_atan2(y, x) : atan2(y, x);
+}
+
+double math_acos(double x) {
+    return g_fast_math_enabled ? fast_acos(x) : acos(x);
+}
+
+double math_log10(double x) {
+    return g_fast_math_enabled ? fast_log10(x) : log10(x);
+}
@@ -1,3 +1,6 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L  /* strdup */
+#endif
 #include "utils.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -566,27 +569,54 @@ void safe_free(void** ptr) {
 
 static ErrorInfo last_error = {0};
 
+/* 当前线程的错误收集位置 (工作线程设置后，error_set不再写入全局错误) */
+static _Thread_local ErrorInfo* error_sink = NULL;
+
 void error_set(ErrorCode code, const char* message, const char* function, 
                const char* file, int line) {
-    last_error.code = code;
-    last_error.timestamp = time(NULL);
+    ErrorInfo* error = error_sink ? error_sink : &last_error;
+    error->code = code;
+    error->timestamp = time(NULL);
     
     if (message != NULL) {
-        strncpy(last_error.message, message, sizeof(last_error.message) - 1);
-        last_error.message[sizeof(last_error.message) - 1] = '\0';
+        strncpy(error->message, message, sizeof(error->message) - 1);
+        error->message[sizeof(error->message) - 1] = '\0';
     }
     
     if (function != NULL) {
-        strncpy(last_error.function, function, sizeof(last_error.function) - 1);
-        last_error.function[sizeof(last_error.function) - 1] = '\0';
+        strncpy(error->function, function, sizeof(error->function) - 1);
+        error->function[sizeof(error->function) - 1] = '\0';
     }
     
     if (file != NULL) {
-        strncpy(last_error.file, file, sizeof(last_error.file) - 1);
-        last_error.file[sizeof(last_error.file) - 1] = '\0';
+        strncpy(error->file, file, sizeof(error->file) - 1);
+        error->file[sizeof(error->file) - 1] = '\0';
     }
     
-    last_error.line = line;
+    error->line = line;
+}
+
+/**
+ * @brief 把当前线程之后的error_set写入sink而不是全局错误
+ * @param sink 线程私有的错误信息 (清零后使用)，NULL恢复写入全局错误
+ * @note 全局错误不是线程安全的；工作线程收集各自的错误，由调用线程在汇合后统一设置
+ */
+void error_capture_begin(ErrorInfo* sink) {
+    if (sink != NULL) {
+        memset(sink, 0, sizeof(ErrorInfo));
+        sink->code = ERROR_NONE;
+    }
+    error_sink = sink;
+}
+
+void error_capture_end(void) {
+    error_sink = NULL;
+}
+
+/* 在调用线程上把收集到的错误设为全局错误 */
+void error_set_info(const ErrorInfo* error) {
+    if (error == NULL || error->code == ERROR_NONE) return;
+    error_set(error->code, error->message, error->function, error->file, error->line);
 }
 
 ErrorInfo* error_get_last() {
@@ -26,6 +26,19 @@ double interpolate_linear(double x1, double y1, double x2, double y2, double x);
 double interpolate_cubic(double x0, double y0, double x1, double y1, 
                        double x2, double y2, double x3, double y3, double x);
 
+/* 快速数学函数 (多项式近似，用于可见性和遮挡计算的内层循环)
+ * 误差上限: atan2 1.2e-5弧度，acos 2e-8弧度，log10 1e-7 (0.01°和0.01dB精度要求以内) */
+void fast_math_set_enabled(int enabled);
+int fast_math_is_enabled(void);
+double fast_atan2(double y, double x);
+double fast_acos(double x);
+double fast_log10(double x);
+
+/* 按运行时开关选择快速近似或libm */
+double math_atan2(double y, double x);
+double math_acos(double x);
+double math_log10(double x);
+
 /* 时间工具函数 */
 time_t time_parse_iso8601(const char* iso_string);
 int time_format_iso8601(time_t time, char* buffer, int buffer_size);
@@ -108,6 +121,9 @@ void error_set(ErrorCode code, const char* message, const char* function,
                const char* file, int line);
 ErrorInfo* error_get_last();
 void error_clear();
+void error_capture_begin(ErrorInfo* sink);
+void error_capture_end(void);
+void error_set_info(const ErrorInfo* error);
 const char* error_to_string(ErrorCode code);
 
 /* 日志工具 */
@@ -0,0 +1,250 @@
+#include "http_server.h"
+#include "../utils/utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* =================== 分析结果缓存 =================== */
+
+#define FNV_OFFSET_BASIS 1469598103934665603ULL
+#define FNV_PRIME 1099511628211ULL
+
+static unsigned long long fnv1a_update(unsigned long long hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/* 键的哈希 (逐字段，不含结构体填充)，保证非0以区分空项 */
+static unsigned long long analysis_key_hash(const AnalysisCacheKey* key) {
+    unsigned long long hash = FNV_OFFSET_BASIS;
+    hash = fnv1a_update(hash, &key->ephemeris_version, sizeof(key->ephemeris_version));
+    hash = fnv1a_update(hash, &key->trajectory_id, sizeof(key->trajectory_id));
+    hash = fnv1a_update(hash, &key->trajectory_version, sizeof(key->trajectory_version));
+    hash = fnv1a_update(hash, &key->geometry_version, sizeof(key->geometry_version));
+    hash = fnv1a_update(hash, &key->fixed_positions_hash, sizeof(key->fixed_positions_hash));
+    hash = fnv1a_update(hash, &key->params_hash, sizeof(key->params_hash));
+    return hash ? hash : 1;
+}
+
+static int analysis_key_equal(const AnalysisCacheKey* a, const AnalysisCacheKey* b) {
+    return a->ephemeris_version == b->ephemeris_version &&
+           a->trajectory_id == b->trajectory_id &&
+           a->trajectory_version == b->trajectory_version &&
+           a->geometry_version == b->geometry_version &&
+           a->fixed_positions_hash == b->fixed_positions_hash &&
+           a->params_hash == b->params_hash;
+}
+
+static AnalysisCacheEntry* analysis_cache_set(AnalysisCache* cache, unsigned long long hash) {
+    return &cache->entries[(hash % ANALYSIS_CACHE_SETS) * ANALYSIS_CACHE_WAYS];
+}
+
+AnalysisCache* analysis_cache_create(void) {
+    AnalysisCache* cache = (AnalysisCache*)safe_calloc(1, sizeof(AnalysisCache));
+    if (cache == NULL) return NULL;
+
+    pthread_mutex_init(&cache->mutex, NULL);
+    return cache;
+}
+
+void analysis_cache_destroy(AnalysisCache* cache) {
+    if (cache == NULL) return;
+
+    analysis_cache_clear(cache);
+    pthread_mutex_destroy(&cache->mutex);
+    safe_free((void**)&cache);
+}
+
+/**
+ * @brief 清空缓存 (统计保留)
+ * @param cache 缓存
+ * @note 更换服务器数据对象时调用：新对象的版本号可能与旧对象相同
+ */
+void analysis_cache_clear(AnalysisCache* cache) {
+    if (cache == NULL) return;
+
+    pthread_mutex_lock(&cache->mutex);
+    for (int i = 0; i < ANALYSIS_CACHE_SETS * ANALYSIS_CACHE_WAYS; i++) {
+        AnalysisCacheEntry* entry = &cache->entries[i];
+        analysis_cache_blob_release(entry->blob);
+        memset(entry, 0, sizeof(AnalysisCacheEntry));
+    }
+    cache->stats.entries = 0;
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+/**
+ * @brief 把响应数据复制为引用计数的结果JSON (分析结果唯一的一次复制)
+ * @param data 响应数据
+ * @return 引用计数为1的结果，内存不足返回NULL
+ */
+AnalysisCacheBlob* analysis_cache_blob_create(const ResponseBuffer* data) {
+    if (data == NULL) return NULL;
+
+    AnalysisCacheBlob* blob = (AnalysisCacheBlob*)safe_malloc(sizeof(AnalysisCacheBlob) + data->length + 1);
+    if (blob == NULL) return NULL;
+
+    atomic_init(&blob->refcount, 1);
+    blob->length = data->length;
+    response_buffer_copy(data, blob->json, data->length + 1);
+    return blob;
+}
+
+static void analysis_cache_blob_retain(AnalysisCacheBlob* blob) {
+    atomic_fetch_add_explicit(&blob->refcount, 1, memory_order_relaxed);
+}
+
+/* 释放一个引用，最后一个引用释放内存 (参数为void*，可直接作为响应块的release) */
+void analysis_cache_blob_release(void* blob) {
+    AnalysisCacheBlob* shared = (AnalysisCacheBlob*)blob;
+    if (shared == NULL) return;
+
+    if (atomic_fetch_sub_explicit(&shared->refcount, 1, memory_order_acq_rel) == 1) {
+        safe_free((void**)&shared);
+    }
+}
+
+/**
+ * @brief 把结果作为响应数据的一块，不复制
+ * @param buffer 响应数据
+ * @param blob 结果，成功后调用方的引用转交给缓冲区
+ * @return 成功返回1，失败返回0 (引用仍归调用方)
+ */
+int analysis_cache_blob_attach(ResponseBuffer* buffer, AnalysisCacheBlob* blob) {
+    if (blob == NULL) return 0;
+    return response_buffer_attach_shared(buffer, blob->json, blob->length, analysis_cache_blob_release, blob);
+}
+
+/* 没有可用星历的卫星在分析中直接使用当前位置，而位置更新不递增卫星数据版本，
+ * 因此把这些卫星的位置纳入缓存键 (判定条件与satellite_ephemeris_batch_create一致) */
+static unsigned long long analysis_fixed_positions_hash(const SatelliteData* satellite_data) {
+    unsigned long long hash = FNV_OFFSET_BASIS;
+    if (satellite_data == NULL) return hash;
+
+    for (int i = 0; i < satellite_data->satellite_count; i++) {
+        const Satellite* sat = &satellite_data->satellites[i];
+        SatelliteEphemeris ephemeris;
+        if (sat->is_valid && satellite_ephemeris_prepare(sat, &ephemeris)) continue;
+
+        hash = fnv1a_update(hash, &i, sizeof(i));
+        hash = fnv1a_update(hash, &sat->is_valid, sizeof(sat->is_valid));
+        hash = fnv1a_update(hash, &sat->pos, sizeof(sat->pos));
+    }
+    return hash;
+}
+
+/**
+ * @brief 生成缓存键
+ * @param key 缓存键 (输出)
+ * @param satellite_data 卫星数据
+ * @param trajectory 轨迹
+ * @param geometry 飞机几何模型
+ * @param params 影响结果的请求参数 (调用方应先清零结构体，填充字节参与哈希)
+ * @param params_size 参数大小
+ */
+void analysis_cache_key_init(AnalysisCacheKey* key, const SatelliteData* satellite_data,
+                             const FlightTrajectory* trajectory, const AircraftGeometry* geometry,
+                             const void* params, size_t params_size) {
+    if (key == NULL) return;
+
+    memset(key, 0, sizeof(AnalysisCacheKey));
+    key->ephemeris_version = satellite_data ? satellite_data->version : 0;
+    key->trajectory_id = trajectory ? trajectory->trajectory_id : 0;
+    key->trajectory_version = trajectory ? trajectory->version : 0;
+    key->geometry_version = geometry ? geometry->version : 0;
+    key->fixed_positions_hash = analysis_fixed_positions_hash(satellite_data);
+    key->params_hash = params ? fnv1a_update(FNV_OFFSET_BASIS, params, params_size) : FNV_OFFSET_BASIS;
+}
+
+/**
+ * @brief 查找缓存结果
+ * @param cache 缓存
+ * @param key 缓存键
+ * @return 结果的一个新引用 (调用方用analysis_cache_blob_release释放或转交给响应)，未命中返回NULL
+ */
+AnalysisCacheBlob* analysis_cache_get(AnalysisCache* cache, const AnalysisCacheKey* key) {
+    if (cache == NULL || key == NULL) return NULL;
+
+    unsigned long long hash = analysis_key_hash(key);
+    AnalysisCacheBlob* blob = NULL;
+
+    pthread_mutex_lock(&cache->mutex);
+    AnalysisCacheEntry* set = analysis_cache_set(cache, hash);
+    for (int way = 0; way < ANALYSIS_CACHE_WAYS; way++) {
+        AnalysisCacheEntry* entry = &set[way];
+        if (entry->hash == hash && analysis_key_equal(&entry->key, key)) {
+            entry->last_used = ++cache->clock;
+            blob = entry->blob;
+            analysis_cache_blob_retain(blob);
+            break;
+        }
+    }
+    if (blob) {
+        cache->stats.hits++;
+    } else {
+        cache->stats.misses++;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    return blob;
+}
+
+/**
+ * @brief 保存结果，同组已满时替换最久未使用的项
+ * @param cache 缓存
+ * @param key 缓存键
+ * @param blob 结果 (缓存另外持有一个引用，不复制；调用方的引用不变)
+ * @return 成功返回1，失败返回0
+ */
+int analysis_cache_put(AnalysisCache* cache, const AnalysisCacheKey* key, AnalysisCacheBlob* blob) {
+    if (cache == NULL || key == NULL || blob == NULL) return 0;
+
+    analysis_cache_blob_retain(blob);
+    unsigned long long hash = analysis_key_hash(key);
+
+    pthread_mutex_lock(&cache->mutex);
+    AnalysisCacheEntry* set = analysis_cache_set(cache, hash);
+    AnalysisCacheEntry* target = &set[0];
+    for (int way = 0; way < ANALYSIS_CACHE_WAYS; way++) {
+        AnalysisCacheEntry* entry = &set[way];
+        if (entry->hash == hash && analysis_key_equal(&entry->key, key)) {
+            /* 并发请求已写入同一结果 */
+            target = entry;
+            break;
+        }
+        if (entry->hash == 0) {
+            if (target->hash != 0) target = entry;
+        } else if (target->hash != 0 && entry->last_used < target->last_used) {
+            target = entry;
+        }
+    }
+
+    if (target->hash == 0) {
+        cache->stats.entries++;
+    } else if (!analysis_key_equal(&target->key, key)) {
+        cache->stats.evictions++;
+    }
+    AnalysisCacheBlob* replaced = target->blob;
+    target->key = *key;
+    target->hash = hash;
+    target->blob = blob;
+    target->last_used = ++cache->clock;
+    pthread_mutex_unlock(&cache->mutex);
+
+    /* 被替换的结果可能仍在发送，只释放缓存的引用 */
+    analysis_cache_blob_release(replaced);
+    return 1;
+}
+
+void analysis_cache_get_stats(AnalysisCache* cache, AnalysisCacheStats* stats) {
+    if (stats == NULL) return;
+    memset(stats, 0, sizeof(AnalysisCacheStats));
+    if (cache == NULL) return;
+
+    pthread_mutex_lock(&cache->mutex);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->mutex);
+}
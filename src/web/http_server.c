@@ -1,9 +1,14 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L  /* strncasecmp */
+#endif
+
 #include "http_server.h"
 #include "websocket.h"
 #include "../utils/utils.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <time.h>
 
 #ifdef _WIN32
@@ -13,9 +18,13 @@
 #else
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <errno.h>
 #include <signal.h>
@@ -28,6 +37,7 @@ HttpServer* http_server_create(const HttpServerConfig* config) {
     
     HttpServer* server = (HttpServer*)safe_malloc(sizeof(HttpServer));
     if (server == NULL) return NULL;
+    memset(server, 0, sizeof(HttpServer));
     
     /* 复制配置 */
     memcpy(&server->config, config, sizeof(HttpServerConfig));
@@ -36,6 +46,7 @@ HttpServer* http_server_create(const HttpServerConfig* config) {
     memset(&server->status, 0, sizeof(SystemStatus));
     server->status.is_running = 0;
     server->status.start_time = time(NULL);
+    pthread_mutex_init(&server->status_mutex, NULL);
     
     /* 初始化数据指针 */
     server->satellite_data = NULL;
@@ -50,6 +61,14 @@ HttpServer* http_server_create(const HttpServerConfig* config) {
     server->websocket_server = NULL;
     server->enable_websocket = 0;
     
+    /* 分析结果缓存 */
+    server->analysis_cache = analysis_cache_create();
+    if (server->analysis_cache == NULL) {
+        pthread_mutex_destroy(&server->status_mutex);
+        safe_free((void**)&server);
+        return NULL;
+    }
+    
     return server;
 }
 
@@ -75,6 +94,9 @@ void http_server_destroy(HttpServer* server) {
         safe_free((void**)&server->config.static_dir);
     }
     
+    analysis_cache_destroy(server->analysis_cache);
+    pthread_mutex_destroy(&server->status_mutex);
+    
     /* 释放服务器结构 */
     safe_free((void**)&server);
 }
@@ -93,220 +115,876 @@ static void signal_handler(int signum) {
     exit(0);
 }
 
-/* 服务器线程函数 */
-static void* server_thread_function(void* arg) {
-    HttpServer* server = (HttpServer*)arg;
+/* =================== 连接与事件循环 =================== */
+
+/* 请求/错误计数 (多个I/O线程共享) */
+static void server_count_request(HttpServer* server, int is_error) {
+    pthread_mutex_lock(&server->status_mutex);
+    if (is_error) {
+        server->status.error_count++;
+    } else {
+        server->status.request_count++;
+    }
+    server->status.stats.total_requests++;
+    pthread_mutex_unlock(&server->status_mutex);
+}
+
+static void server_count_bytes(HttpServer* server, long received, long sent) {
+    pthread_mutex_lock(&server->status_mutex);
+    server->status.stats.total_bytes_received += received;
+    server->status.stats.total_bytes_sent += sent;
+    pthread_mutex_unlock(&server->status_mutex);
+}
+
+/* 占用一个连接名额，已达max_connections时返回0 */
+static int server_acquire_connection(HttpServer* server) {
+    int acquired = 0;
+    pthread_mutex_lock(&server->status_mutex);
+    if (server->connection_count < server->config.max_connections) {
+        server->connection_count++;
+        server->status.active_connections = server->connection_count;
+        server->status.stats.active_connections = server->connection_count;
+        acquired = 1;
+    }
+    pthread_mutex_unlock(&server->status_mutex);
+    return acquired;
+}
+
+static void server_release_connection(HttpServer* server) {
+    pthread_mutex_lock(&server->status_mutex);
+    server->connection_count--;
+    server->status.active_connections = server->connection_count;
+    server->status.stats.active_connections = server->connection_count;
+    pthread_mutex_unlock(&server->status_mutex);
+}
+
+static int set_nonblocking(int fd, int nonblocking) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return 0;
+    flags = nonblocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(fd, F_SETFL, flags) == 0;
+}
+
+static HttpConnection* connection_create(HttpIoThread* io, int fd, const struct sockaddr_in* addr) {
+    HttpConnection* conn = (HttpConnection*)safe_malloc(sizeof(HttpConnection));
+    if (conn == NULL) return NULL;
+    memset(conn, 0, sizeof(HttpConnection));
+    
+    conn->fd = fd;
+    conn->state = HTTP_CONN_READING;
+    conn->keep_alive = 1;
+    conn->io = io;
+    conn->last_active = time(NULL);
+    inet_ntop(AF_INET, &addr->sin_addr, conn->client_ip, sizeof(conn->client_ip));
+    conn->client_port = ntohs(addr->sin_port);
+    
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = conn;
+    if (epoll_ctl(io->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        safe_free((void**)&conn);
+        return NULL;
+    }
+    
+    /* 加入本线程的连接链表 */
+    conn->next = io->connections;
+    if (io->connections) io->connections->prev = conn;
+    io->connections = conn;
+    
+    return conn;
+}
+
+/* 关闭连接并释放名额；已移交的套接字 (fd<0) 不关闭 */
+static void connection_close(HttpConnection* conn) {
+    HttpIoThread* io = conn->io;
     
-    logger_info(__func__, __FILE__, __LINE__, "HTTP服务器线程开始运行");
+    if (conn->fd >= 0) {
+        epoll_ctl(io->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+        close(conn->fd);
+        conn->fd = -1;
+    }
+    conn->state = HTTP_CONN_CLOSED;
     
-    while (server->is_running) {
-        /* 接受客户端连接 */
+    if (conn->prev) conn->prev->next = conn->next;
+    else io->connections = conn->next;
+    if (conn->next) conn->next->prev = conn->prev;
+    
+    server_release_connection(io->server);
+    
+    http_request_reset(&conn->request);
+    http_response_reset(&conn->response);
+    if (conn->in) safe_free((void**)&conn->in);
+    response_buffer_reset(&conn->out);
+    safe_free((void**)&conn);
+}
+
+/* 追加待发送数据 */
+static int connection_queue(HttpConnection* conn, const char* data, size_t length) {
+    return response_buffer_append(&conn->out, data, length);
+}
+
+/* 追加一个纯文本响应，Connection头取决于连接是否保持；503附带Retry-After提示客户端稍后重试 */
+static int connection_queue_text(HttpConnection* conn, int status_code, const char* reason, const char* text) {
+    char response[512];
+    int written = snprintf(response, sizeof(response),
+                           "HTTP/1.1 %d %s\r\n"
+                           "Content-Type: text/plain\r\n"
+                           "Connection: %s\r\n"
+                           "%s"
+                           "Content-Length: %zu\r\n"
+                           "\r\n"
+                           "%s",
+                           status_code, reason, conn->keep_alive ? "keep-alive" : "close",
+                           status_code == 503 ? "Retry-After: 1\r\n" : "", strlen(text), text);
+    if (written < 0 || written >= (int)sizeof(response)) return 0;
+    return connection_queue(conn, response, (size_t)written);
+}
+
+/**
+ * @brief 判断接收缓冲区中的请求是否完整
+ * @param conn 连接
+ * @param status_code 请求无效时的HTTP状态码 (输出)
+ * @return 完整返回1 (request_length为请求总长度)，需要继续读取返回0，请求无效返回-1
+ */
+static int connection_frame_request(HttpConnection* conn, int* status_code) {
+    if (conn->request_length > 0) {
+        return conn->in_length >= conn->request_length;
+    }
+    if (conn->in_length == 0) {
+        return 0;
+    }
+    
+    conn->in[conn->in_length] = '\0';
+    const char* header_end = strstr(conn->in, "\r\n\r\n");
+    if (header_end == NULL) {
+        if (conn->in_length > HTTP_MAX_HEADER_SIZE) {
+            *status_code = 431;
+            return -1;
+        }
+        return 0;
+    }
+    
+    size_t header_length = (size_t)(header_end - conn->in) + 4;
+    if (header_length > HTTP_MAX_HEADER_SIZE) {
+        *status_code = 431;
+        return -1;
+    }
+    
+    /* 按Content-Length确定请求体长度；不支持分块传输 */
+    long content_length = 0;
+    const char* line = strstr(conn->in, "\r\n");
+    while (line != NULL && line < header_end) {
+        line += 2;
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            char* end = NULL;
+            content_length = strtol(line + 15, &end, 10);
+            if (end == line + 15 || content_length < 0) {
+                *status_code = 400;
+                return -1;
+            }
+        } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+            *status_code = 411;
+            return -1;
+        }
+        line = strstr(line, "\r\n");
+    }
+    
+    if (content_length > (long)(HTTP_MAX_REQUEST_SIZE - header_length)) {
+        *status_code = 413;
+        return -1;
+    }
+    
+    conn->request_length = header_length + (size_t)content_length;
+    return conn->in_length >= conn->request_length;
+}
+
+static void connection_process(HttpConnection* conn);
+
+/* 发送待发送数据 (各块分散写出，不拼接)；全部发送后保持连接则回到读取状态，否则关闭 */
+static void connection_flush(HttpConnection* conn) {
+    long sent_total = 0;
+    
+    while (conn->out.length > 0) {
+        struct iovec iov[RESPONSE_MAX_IOV];
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = iov;
+        message.msg_iovlen = (size_t)response_buffer_iovec(&conn->out, iov, RESPONSE_MAX_IOV);
+        
+        ssize_t sent = sendmsg(conn->fd, &message, MSG_NOSIGNAL);
+        if (sent > 0) {
+            response_buffer_consume(&conn->out, (size_t)sent);
+            sent_total += sent;
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            /* 套接字发送缓冲区已满，等待可写事件 */
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLOUT;
+            event.data.ptr = conn;
+            epoll_ctl(conn->io->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+            server_count_bytes(conn->io->server, 0, sent_total);
+            conn->last_active = time(NULL);
+            return;
+        }
+        
+        char send_error_msg[200];
+        snprintf(send_error_msg, sizeof(send_error_msg), "发送响应失败: %s", strerror(errno));
+        logger_error(__func__, __FILE__, __LINE__, send_error_msg);
+        break;
+    }
+    
+    server_count_bytes(conn->io->server, 0, sent_total);
+    if (conn->out.length > 0 || !conn->keep_alive || !conn->io->server->is_running) {
+        connection_close(conn);
+        return;
+    }
+    
+    /* 响应全部发出，保持连接继续读取下一个请求 */
+    conn->state = HTTP_CONN_READING;
+    conn->last_active = time(NULL);
+    
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = conn;
+    if (epoll_ctl(conn->io->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event) != 0) {
+        connection_close(conn);
+        return;
+    }
+    
+    /* 写响应期间可能已缓冲了后续流水线请求 */
+    connection_process(conn);
+}
+
+/* 开始发送响应 (先直接写，写不完再等待EPOLLOUT) */
+static void connection_start_write(HttpConnection* conn) {
+    conn->state = HTTP_CONN_WRITING;
+    connection_flush(conn);
+}
+
+/* 把套接字移交给WebSocket线程，连接对象不再管理它 */
+static void connection_upgrade_websocket(HttpServer* server, HttpConnection* conn,
+                                         const HttpRequest* request, HttpResponse* response) {
+    if (!websocket_handshake(request, response)) {
+        logger_error(__func__, __FILE__, __LINE__, "WebSocket握手失败");
+        connection_queue_text(conn, 400, "Bad Request", "WebSocket Handshake Failed");
+        server_count_request(server, 1);
+        return;
+    }
+    
+    /* 握手成功，WebSocket线程使用阻塞读写；此后无论成败连接都不再回到事件循环 */
+    epoll_ctl(conn->io->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    set_nonblocking(conn->fd, 0);
+    conn->state = HTTP_CONN_CLOSED;
+    
+    WebSocketConnection* ws_conn = websocket_connection_create(conn->fd, conn->client_ip, conn->client_port);
+    if (ws_conn == NULL) {
+        logger_error(__func__, __FILE__, __LINE__, "创建WebSocket连接失败");
+        return;
+    }
+    ws_conn->state = WS_STATE_OPEN;
+    ws_conn->server = server->websocket_server;
+    
+    /* 添加连接到WebSocket服务器 */
+    if (!websocket_add_connection(server->websocket_server, ws_conn)) {
+        logger_error(__func__, __FILE__, __LINE__, "添加WebSocket连接失败");
+        websocket_connection_destroy(ws_conn);
+        conn->fd = -1;
+        return;
+    }
+    
+    /* 发送握手响应 */
+    send(conn->fd, response->body, response->content_length, MSG_NOSIGNAL);
+    
+    /* 创建连接处理线程 */
+    pthread_t ws_thread;
+    if (pthread_create(&ws_thread, NULL, websocket_connection_thread, ws_conn) != 0) {
+        logger_error(__func__, __FILE__, __LINE__, "创建WebSocket线程失败");
+        websocket_connection_destroy(ws_conn);
+        conn->fd = -1;
+        return;
+    }
+    pthread_detach(ws_thread);
+    
+    char ws_log_msg[200];
+    snprintf(ws_log_msg, sizeof(ws_log_msg), "WebSocket连接建立成功: %s:%d", conn->client_ip, conn->client_port);
+    logger_info(__func__, __FILE__, __LINE__, ws_log_msg);
+    
+    /* 不要关闭客户端套接字，WebSocket线程会处理 */
+    conn->fd = -1;
+}
+
+/**
+ * @brief 把API请求交给工作线程池，连接进入PROCESSING状态直到结果交回
+ * @return 已提交返回1；队列已满或端点限流时已追加503响应，返回0
+ */
+static int connection_submit_api(HttpServer* server, HttpConnection* conn, ApiEndpointType endpoint) {
+    HttpApiJob* job = (HttpApiJob*)safe_malloc(sizeof(HttpApiJob));
+    if (job == NULL) {
+        connection_queue_text(conn, 500, "Internal Server Error", "Internal Server Error");
+        server_count_request(server, 1);
+        return 0;
+    }
+    memset(job, 0, sizeof(HttpApiJob));
+    job->conn = conn;
+    job->io = conn->io;
+    job->endpoint = endpoint;
+    job->keep_alive = conn->keep_alive;
+    
+    /* 请求字段的所有权移交给任务 */
+    job->request = conn->request;
+    memset(&conn->request, 0, sizeof(HttpRequest));
+    
+    if (!http_worker_pool_submit(server->worker_pool, job)) {
+        http_api_job_destroy(job);
+        connection_queue_text(conn, 503, "Service Unavailable", "Service Unavailable");
+        server_count_request(server, 1);
+        return 0;
+    }
+    
+    /* 执行期间不关注套接字事件，后续流水线请求留在接收缓冲区 */
+    epoll_ctl(conn->io->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    conn->pending = job;
+    conn->state = HTTP_CONN_PROCESSING;
+    return 1;
+}
+
+/* 处理一个完整请求，响应追加到连接的发送缓冲区 (复用连接上的请求/响应对象) */
+static void http_server_dispatch(HttpServer* server, HttpConnection* conn, const char* raw_request) {
+    char debug_msg[8300];
+    snprintf(debug_msg, sizeof(debug_msg), "收到请求:\n%s", raw_request);
+    logger_debug(__func__, __FILE__, __LINE__, debug_msg);
+    
+    HttpRequest* request = &conn->request;
+    HttpResponse* response = &conn->response;
+    http_request_reset(request);
+    http_response_reset(response);
+    
+    /* 解析HTTP请求 */
+    if (!http_request_parse(raw_request, request)) {
+        logger_error(__func__, __FILE__, __LINE__, "解析HTTP请求失败");
+        conn->keep_alive = 0;
+        connection_queue_text(conn, 400, "Bad Request", "Bad Request");
+        server_count_request(server, 1);
+        http_request_reset(request);
+        return;
+    }
+    
+    /* 客户端要求关闭、未启用keep-alive或服务器正在停止时，本响应后关闭 */
+    conn->keep_alive = request->keep_alive && server->config.keepalive_timeout > 0 && server->is_running;
+    response->keep_alive = conn->keep_alive;
+    
+    if (request->method == HTTP_GET && strcmp(request->path, "/") == 0) {
+        /* 首页响应 */
+        const char* welcome = "<html><body><h1>北斗导航卫星可见性分析系统</h1>"
+                              "<p>API端点：</p>"
+                              "<ul>"
+                              "<li><a href='/api/status'>/api/status</a> - 系统状态</li>"
+                              "<li><a href='/api/satellite'>/api/satellite</a> - 卫星数据</li>"
+                              "<li><a href='/api/trajectory'>/api/trajectory</a> - 轨迹数据</li>"
+                              "<li><a href='/api/analysis'>/api/analysis</a> - 分析结果</li>"
+                              "</ul></body></html>";
+        char header[256];
+        int header_length = snprintf(header, sizeof(header),
+                                     "HTTP/1.1 200 OK\r\n"
+                                     "Content-Type: text/html\r\n"
+                                     "Connection: %s\r\n"
+                                     "Content-Length: %zu\r\n"
+                                     "\r\n",
+                                     conn->keep_alive ? "keep-alive" : "close", strlen(welcome));
+        connection_queue(conn, header, (size_t)header_length);
+        connection_queue(conn, welcome, strlen(welcome));
+        server_count_request(server, 0);
+    } else if (server->enable_websocket && websocket_validate_handshake(raw_request)) {
+        /* WebSocket握手处理 */
+        conn->keep_alive = 0;
+        connection_upgrade_websocket(server, conn, request, response);
+    } else if (strncmp(request->path, "/api/", 5) == 0 && server->worker_pool &&
+               api_endpoint_from_path(request->path) != 0) {
+        /* API请求在工作线程执行，不阻塞事件循环 */
+        connection_submit_api(server, conn, api_endpoint_from_path(request->path));
+    } else if (strncmp(request->path, "/api/", 5) == 0) {
+        /* API请求处理 */
+        if (api_handle_request(request, response, server)) {
+            /* 序列化响应，响应体的块直接移入发送缓冲区 */
+            response->keep_alive = conn->keep_alive;
+            if (http_response_serialize_chain(response, &conn->out)) {
+                server_count_request(server, 0);
+            } else {
+                logger_error(__func__, __FILE__, __LINE__, "响应序列化失败");
+                connection_queue_text(conn, 500, "Internal Server Error", "Internal Server Error");
+                server_count_request(server, 1);
+            }
+        } else {
+            logger_error(__func__, __FILE__, __LINE__, "API处理失败");
+            connection_queue_text(conn, 500, "Internal Server Error", "API Processing Failed");
+            server_count_request(server, 1);
+        }
+    } else {
+        /* 404 Not Found */
+        connection_queue_text(conn, 404, "Not Found", "Not Found");
+        server_count_request(server, 1);
+    }
+    
+    /* 释放本次请求的字段，对象留给下一个请求 */
+    http_response_reset(response);
+    http_request_reset(request);
+}
+
+/**
+ * @brief 依次处理缓冲区中已完整的请求 (流水线)，响应按请求顺序追加后开始发送
+ * @param conn 连接 (处于读取状态)
+ */
+static void connection_process(HttpConnection* conn) {
+    HttpServer* server = conn->io->server;
+    int status_code = 0;
+    
+    for (;;) {
+        int framed = connection_frame_request(conn, &status_code);
+        if (framed == 0) {
+            break;
+        }
+        if (framed < 0) {
+            char reason[64];
+            snprintf(reason, sizeof(reason), "%s",
+                     status_code == 413 ? "Payload Too Large" :
+                     status_code == 431 ? "Request Header Fields Too Large" :
+                     status_code == 411 ? "Length Required" : "Bad Request");
+            conn->keep_alive = 0;
+            connection_queue_text(conn, status_code, reason, reason);
+            server_count_request(server, 1);
+            break;
+        }
+        
+        /* 临时截断到当前请求末尾，解析后恢复后续请求的首字节 */
+        char next = conn->in[conn->request_length];
+        conn->in[conn->request_length] = '\0';
+        http_server_dispatch(server, conn, conn->in);
+        if (conn->state == HTTP_CONN_CLOSED) {
+            /* 套接字已移交给WebSocket线程 (或移交失败) */
+            connection_close(conn);
+            return;
+        }
+        conn->in[conn->request_length] = next;
+        conn->requests_served++;
+        
+        memmove(conn->in, conn->in + conn->request_length, conn->in_length - conn->request_length);
+        conn->in_length -= conn->request_length;
+        conn->request_length = 0;
+        if (!conn->keep_alive || conn->state == HTTP_CONN_PROCESSING) {
+            /* 工作线程执行期间已排好的响应暂不发送，结果交回后按顺序一起发出 */
+            break;
+        }
+    }
+    
+    if (conn->state == HTTP_CONN_READING && conn->out.length > 0) {
+        connection_start_write(conn);
+    }
+}
+
+/* 可读事件：增量读取，有完整请求后处理 */
+static void connection_on_readable(HttpConnection* conn) {
+    HttpServer* server = conn->io->server;
+    long received_total = 0;
+    int status_code = 0;
+    int framed = connection_frame_request(conn, &status_code);
+    
+    while (framed == 0) {
+        /* 保证至少HTTP_READ_CHUNK的空闲空间 (不超过请求上限)，末尾留一个字节放'\0' */
+        if (conn->in_capacity - conn->in_length < HTTP_READ_CHUNK + 1 &&
+            conn->in_capacity < HTTP_MAX_REQUEST_SIZE + 1) {
+            size_t capacity = conn->in_capacity ? conn->in_capacity * 2 : HTTP_READ_CHUNK + 1;
+            if (capacity > HTTP_MAX_REQUEST_SIZE + 1) capacity = HTTP_MAX_REQUEST_SIZE + 1;
+            char* in = (char*)safe_realloc(conn->in, capacity);
+            if (in == NULL) {
+                connection_close(conn);
+                return;
+            }
+            conn->in = in;
+            conn->in_capacity = capacity;
+        }
+        
+        /* 缓冲区已满仍不完整：前面的流水线请求占满了空间之外的情况已由分帧拒绝 */
+        size_t space = conn->in_capacity - conn->in_length - 1;
+        if (space == 0) {
+            conn->keep_alive = 0;
+            connection_queue_text(conn, 413, "Payload Too Large", "Payload Too Large");
+            server_count_request(server, 1);
+            connection_start_write(conn);
+            return;
+        }
+        
+        ssize_t bytes_read = recv(conn->fd, conn->in + conn->in_length, space, 0);
+        if (bytes_read > 0) {
+            conn->in_length += (size_t)bytes_read;
+            received_total += bytes_read;
+            framed = connection_frame_request(conn, &status_code);
+            continue;
+        }
+        if (bytes_read < 0 && errno == EINTR) continue;
+        if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        
+        /* 对端关闭或读取出错 */
+        if (bytes_read < 0) {
+            char read_error_msg[200];
+            snprintf(read_error_msg, sizeof(read_error_msg), "读取请求失败: %s", strerror(errno));
+            logger_error(__func__, __FILE__, __LINE__, read_error_msg);
+            server_count_request(server, 1);
+        }
+        server_count_bytes(server, received_total, 0);
+        connection_close(conn);
+        return;
+    }
+    
+    server_count_bytes(server, received_total, 0);
+    conn->last_active = time(NULL);
+    if (framed != 0) {
+        connection_process(conn);
+    }
+}
+
+/* 接受所有待处理连接 */
+static void io_accept_connections(HttpIoThread* io) {
+    HttpServer* server = io->server;
+    
+    for (;;) {
         struct sockaddr_in client_addr;
         socklen_t client_len = sizeof(client_addr);
-        
-        int client_socket = accept(server->server_socket, (struct sockaddr*)&client_addr, &client_len);
+        int client_socket = accept(io->listen_fd, (struct sockaddr*)&client_addr, &client_len);
         if (client_socket < 0) {
-            if (errno == EINTR) {
-                continue; /* 被信号中断，继续循环 */
-            }
-            char error_msg[200];
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                char error_msg[200];
                 snprintf(error_msg, sizeof(error_msg), "接受客户端连接失败: %s", strerror(errno));
                 logger_error(__func__, __FILE__, __LINE__, error_msg);
+            }
+            return;
+        }
+        
+        /* 超过连接上限时立即拒绝，不占用事件循环 */
+        if (!server_acquire_connection(server)) {
+            static const char busy[] = "HTTP/1.1 503 Service Unavailable\r\n"
+                                       "Content-Type: text/plain\r\n"
+                                       "Connection: close\r\n"
+                                       "Content-Length: 19\r\n"
+                                       "\r\n"
+                                       "Service Unavailable";
+            send(client_socket, busy, sizeof(busy) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+            close(client_socket);
+            server_count_request(server, 1);
+            logger_warning(__func__, __FILE__, __LINE__, "连接数已达上限，拒绝新连接");
+            continue;
+        }
+        
+        HttpConnection* conn = NULL;
+        if (!set_nonblocking(client_socket, 1) ||
+            (conn = connection_create(io, client_socket, &client_addr)) == NULL) {
+            logger_error(__func__, __FILE__, __LINE__, "创建客户端连接失败");
+            close(client_socket);
+            server_release_connection(server);
             continue;
         }
         
-        /* 处理客户端请求 */
-        char client_ip[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
         char log_msg[200];
-        snprintf(log_msg, sizeof(log_msg), "接受来自 %s:%d 的连接", 
-                 client_ip, ntohs(client_addr.sin_port));
-        logger_info(__func__, __FILE__, __LINE__, log_msg);
+        snprintf(log_msg, sizeof(log_msg), "接受来自 %s:%d 的连接",
+                 conn->client_ip, conn->client_port);
+        logger_debug(__func__, __FILE__, __LINE__, log_msg);
+    }
+}
+
+/* 关闭超时的连接：请求读到一半或响应发不出去超过timeout秒 (防止慢客户端长期占用名额)，
+ * 或者两个请求之间空闲超过keepalive_timeout秒 */
+static void io_sweep_connections(HttpIoThread* io, time_t now) {
+    const HttpServerConfig* config = &io->server->config;
+    
+    HttpConnection* conn = io->connections;
+    while (conn) {
+        HttpConnection* next = conn->next;
+        if (conn->state == HTTP_CONN_PROCESSING) {
+            /* 请求在工作线程执行，超时由线程池排队限制 */
+            conn = next;
+            continue;
+        }
+        int idle = conn->state == HTTP_CONN_READING && conn->in_length == 0 && conn->requests_served > 0;
+        int timeout = idle ? config->keepalive_timeout : config->timeout;
+        if (timeout > 0 && now - conn->last_active >= timeout) {
+            char timeout_msg[200];
+            snprintf(timeout_msg, sizeof(timeout_msg), "连接超时关闭: %s:%d", conn->client_ip, conn->client_port);
+            logger_debug(__func__, __FILE__, __LINE__, timeout_msg);
+            connection_close(conn);
+        }
+        conn = next;
+    }
+}
+
+/**
+ * @brief 工作线程交回已完成的API任务 (可在任意线程调用)
+ * @param job 任务，由连接所属I/O线程发送响应后释放
+ */
+void http_server_complete_job(HttpApiJob* job) {
+    HttpIoThread* io = job->io;
+    server_count_request(io->server, job->failed);
+    
+    pthread_mutex_lock(&io->completed_mutex);
+    job->next = NULL;
+    if (io->completed_tail) io->completed_tail->next = job;
+    else io->completed = job;
+    io->completed_tail = job;
+    pthread_mutex_unlock(&io->completed_mutex);
+    
+    if (io->wake_fd >= 0) {
+        uint64_t one = 1;
+        if (write(io->wake_fd, &one, sizeof(one)) < 0) {
+            logger_warning(__func__, __FILE__, __LINE__, "唤醒I/O线程失败");
+        }
+    }
+}
+
+/* 取走全部已完成任务 */
+static HttpApiJob* io_take_completed(HttpIoThread* io) {
+    pthread_mutex_lock(&io->completed_mutex);
+    HttpApiJob* jobs = io->completed;
+    io->completed = NULL;
+    io->completed_tail = NULL;
+    pthread_mutex_unlock(&io->completed_mutex);
+    return jobs;
+}
+
+static void io_free_completed(HttpIoThread* io) {
+    HttpApiJob* job = io_take_completed(io);
+    while (job) {
+        HttpApiJob* next = job->next;
+        http_api_job_destroy(job);
+        job = next;
+    }
+}
+
+/* 把完成的API响应追加到连接，连接回到事件循环 */
+static void io_finish_completed(HttpIoThread* io) {
+    HttpApiJob* job = io_take_completed(io);
+    
+    while (job) {
+        HttpApiJob* next = job->next;
+        HttpConnection* conn = job->conn;
+        conn->pending = NULL;
+        conn->state = HTTP_CONN_READING;
+        conn->last_active = time(NULL);
         
-        /* 读取请求 */
-        char buffer[8192];
-        ssize_t bytes_read = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
-        if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-            char debug_msg[8300];
-                snprintf(debug_msg, sizeof(debug_msg), "收到请求:\n%s", buffer);
-                logger_debug(__func__, __FILE__, __LINE__, debug_msg);
-            
-            /* 解析HTTP请求 */
-            HttpRequest* request = http_request_create();
-            if (request && http_request_parse(buffer, request)) {
-                /* 创建HTTP响应 */
-                HttpResponse* response = http_response_create();
-                
-                if (response) {
-                    /* 处理OPTIONS预检请求 */
-                    if (request->method == HTTP_GET && strcmp(request->path, "/") == 0) {
-                        /* 首页响应 */
-                        const char* welcome = "HTTP/1.1 200 OK\r\n"
-                                            "Content-Type: text/html\r\n"
-                                            "Connection: close\r\n"
-                                            "\r\n"
-                                            "<html><body><h1>北斗导航卫星可见性分析系统</h1>"
-                                            "<p>API端点：</p>"
-                                            "<ul>"
-                                            "<li><a href='/api/status'>/api/status</a> - 系统状态</li>"
-                                            "<li><a href='/api/satellite'>/api/satellite</a> - 卫星数据</li>"
-                                            "<li><a href='/api/trajectory'>/api/trajectory</a> - 轨迹数据</li>"
-                                            "<li><a href='/api/analysis'>/api/analysis</a> - 分析结果</li>"
-                                            "</ul></body></html>";
-                        
-                        send(client_socket, welcome, strlen(welcome), 0);
-                    } else if (server->enable_websocket && websocket_validate_handshake(buffer)) {
-                        /* WebSocket握手处理 */
-                        if (websocket_handshake(request, response)) {
-                            /* 握手成功，创建WebSocket连接 */
-                            char client_ip[INET_ADDRSTRLEN];
-                            inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
-                            
-                            WebSocketConnection* ws_conn = websocket_connection_create(client_socket, client_ip, ntohs(client_addr.sin_port));
-                            if (ws_conn) {
-                                ws_conn->state = WS_STATE_OPEN;
-                                ws_conn->server = server->websocket_server;
-                                
-                                /* 添加连接到WebSocket服务器 */
-                                if (websocket_add_connection(server->websocket_server, ws_conn)) {
-                                    /* 发送握手响应 */
-                                    send(client_socket, response->body, response->content_length, 0);
-                                    
-                                    /* 创建连接处理线程 */
-                                    pthread_t ws_thread;
-                                    if (pthread_create(&ws_thread, NULL, websocket_connection_thread, ws_conn) == 0) {
-                                        pthread_detach(ws_thread);
-                                        char ws_log_msg[200];
-            snprintf(ws_log_msg, sizeof(ws_log_msg), "WebSocket连接建立成功: %s:%d", client_ip, ntohs(client_addr.sin_port));
-            logger_info(__func__, __FILE__, __LINE__, ws_log_msg);
-                                        
-                                        /* 不要关闭客户端套接字，WebSocket线程会处理 */
-                                        client_socket = -1;
-                                    } else {
-                                        logger_error(__func__, __FILE__, __LINE__, "创建WebSocket线程失败");
-                                        websocket_connection_destroy(ws_conn);
-                                    }
-                                } else {
-                                    logger_error(__func__, __FILE__, __LINE__, "添加WebSocket连接失败");
-                                    websocket_connection_destroy(ws_conn);
-                                }
-                            } else {
-                                logger_error(__func__, __FILE__, __LINE__, "创建WebSocket连接失败");
-                            }
-                        } else {
-                            logger_error(__func__, __FILE__, __LINE__, "WebSocket握手失败");
-                            const char* error_response = "HTTP/1.1 400 Bad Request\r\n"
-                                                        "Content-Type: text/plain\r\n"
-                                                        "Connection: close\r\n"
-                                                        "\r\n"
-                                                        "WebSocket Handshake Failed";
-                            send(client_socket, error_response, strlen(error_response), 0);
-                            server->status.error_count++;
-                        }
-                    } else if (strncmp(request->path, "/api/", 5) == 0) {
-                        /* API请求处理 */
-                        if (api_handle_request(request, response, (const struct HttpServer*)server)) {
-                            /* 序列化响应 */
-                            char response_buffer[16384];
-                            int response_length = http_response_serialize(response, response_buffer, sizeof(response_buffer));
-                            
-                            if (response_length > 0) {
-                                send(client_socket, response_buffer, response_length, 0);
-                                server->status.request_count++;
-                            } else {
-                                logger_error(__func__, __FILE__, __LINE__, "响应序列化失败");
-                                const char* error_response = "HTTP/1.1 500 Internal Server Error\r\n"
-                                                            "Content-Type: text/plain\r\n"
-                                                            "Connection: close\r\n"
-                                                            "\r\n"
-                                                            "Internal Server Error";
-                                send(client_socket, error_response, strlen(error_response), 0);
-                                server->status.error_count++;
-                            }
-                        } else {
-                            logger_error(__func__, __FILE__, __LINE__, "API处理失败");
-                            const char* error_response = "HTTP/1.1 500 Internal Server Error\r\n"
-                                                        "Content-Type: text/plain\r\n"
-                                                        "Connection: close\r\n"
-                                                        "\r\n"
-                                                        "API Processing Failed";
-                            send(client_socket, error_response, strlen(error_response), 0);
-                            server->status.error_count++;
-                        }
-                    } else {
-                        /* 404 Not Found */
-                        const char* not_found = "HTTP/1.1 404 Not Found\r\n"
-                                               "Content-Type: text/plain\r\n"
-                                               "Connection: close\r\n"
-                                               "\r\n"
-                                               "Not Found";
-                        send(client_socket, not_found, strlen(not_found), 0);
-                        server->status.error_count++;
-                    }
-                    
-                    http_response_destroy(response);
-                } else {
-                    logger_error(__func__, __FILE__, __LINE__, "创建HTTP响应失败");
-                    server->status.error_count++;
-                }
-                
-                http_request_destroy(request);
-            } else {
-                logger_error(__func__, __FILE__, __LINE__, "解析HTTP请求失败");
-                server->status.error_count++;
-            }
-        } else if (bytes_read == 0) {
-            logger_info(__func__, __FILE__, __LINE__, "客户端关闭连接");
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.ptr = conn;
+        response_buffer_splice(&conn->out, &job->output);
+        if (conn->out.length == 0 || epoll_ctl(io->epoll_fd, EPOLL_CTL_ADD, conn->fd, &event) != 0) {
+            connection_close(conn);
+        } else if (conn->keep_alive) {
+            /* 继续处理执行期间缓冲的流水线请求，响应按顺序一起发送 */
+            connection_process(conn);
         } else {
-            char read_error_msg[200];
-            snprintf(read_error_msg, sizeof(read_error_msg), "读取请求失败: %s", strerror(errno));
-            logger_error(__func__, __FILE__, __LINE__, read_error_msg);
-            server->status.error_count++;
+            connection_start_write(conn);
         }
         
-        close(client_socket);
+        http_api_job_destroy(job);
+        job = next;
     }
-    
-    logger_info(__func__, __FILE__, __LINE__, "HTTP服务器线程结束");
-    return NULL;
 }
 
-int http_server_start(HttpServer* server) {
-    if (server == NULL) return 0;
+/* I/O线程：epoll事件循环 */
+static void* io_thread_function(void* arg) {
+    HttpIoThread* io = (HttpIoThread*)arg;
+    HttpServer* server = io->server;
+    struct epoll_event events[HTTP_EPOLL_EVENTS];
+    time_t last_sweep = time(NULL);
     
-    /* 创建服务器套接字 */
-    server->server_socket = socket(AF_INET, SOCK_STREAM, 0);
-    if (server->server_socket < 0) {
-  // logger_error(__func__, __FILE__, __LINE__, "创建套接字失败: %s", strerror(errno));
-        return 0;
+    logger_info(__func__, __FILE__, __LINE__, "HTTP服务器I/O线程开始运行");
+    
+    while (server->is_running) {
+        int count = epoll_wait(io->epoll_fd, events, HTTP_EPOLL_EVENTS, HTTP_SWEEP_INTERVAL_MS);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            char error_msg[200];
+            snprintf(error_msg, sizeof(error_msg), "epoll_wait失败: %s", strerror(errno));
+            logger_error(__func__, __FILE__, __LINE__, error_msg);
+            break;
+        }
+        
+        for (int i = 0; i < count; i++) {
+            void* tag = events[i].data.ptr;
+            if (tag == io) {
+                io_accept_connections(io);
+                continue;
+            }
+            if (tag == &io->wake_fd) {
+                uint64_t value;
+                if (read(io->wake_fd, &value, sizeof(value)) < 0) { /* 仅用于唤醒 */ }
+                io_finish_completed(io);
+                continue;
+            }
+            
+            HttpConnection* conn = (HttpConnection*)tag;
+            if (conn->state == HTTP_CONN_READING && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                connection_on_readable(conn);
+            } else if (conn->state == HTTP_CONN_WRITING && (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR))) {
+                connection_flush(conn);
+            }
+        }
+        
+        time_t now = time(NULL);
+        if (now != last_sweep) {
+            io_sweep_connections(io, now);
+            last_sweep = now;
+        }
     }
     
-    /* 设置套接字选项 */
-    const char opt = 1;
-    if (setsockopt(server->server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        // logger_error(__func__, __FILE__, __LINE__, "设置套接字选项失败: %s", strerror(errno));
-        close(server->server_socket);
-        return 0;
+    /* 关闭本线程的所有连接，丢弃已完成但未发送的API响应 */
+    while (io->connections) {
+        connection_close(io->connections);
     }
+    io_free_completed(io);
     
-    /* 绑定地址 */
+    logger_info(__func__, __FILE__, __LINE__, "HTTP服务器I/O线程结束");
+    return NULL;
+}
+
+/* 创建非阻塞监听套接字，reuse_port时多个线程可绑定同一端口由内核分流 */
+static int http_listen_socket(const HttpServer* server, int reuse_port) {
     struct sockaddr_in server_addr;
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = inet_addr(server->config.host);
     server_addr.sin_port = htons(server->config.port);
+    const char* host = strcmp(server->config.host, "localhost") == 0 ? "127.0.0.1" : server->config.host;
+    if (inet_pton(AF_INET, host, &server_addr.sin_addr) != 1) {
+        logger_error(__func__, __FILE__, __LINE__, "无效的监听地址");
+        return -1;
+    }
+    
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    
+    int opt = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        close(fd);
+        return -1;
+    }
+#ifdef SO_REUSEPORT
+    if (reuse_port && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        close(fd);
+        return -1;
+    }
+#else
+    if (reuse_port) {
+        close(fd);
+        return -1;
+    }
+#endif
     
-    if (bind(server->server_socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        // logger_error(__func__, __FILE__, __LINE__, "绑定地址失败: %s", strerror(errno));
+    if (bind(fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0 ||
+        listen(fd, SOMAXCONN) < 0 || !set_nonblocking(fd, 1)) {
+        close(fd);
+        return -1;
+    }
+    
+    return fd;
+}
+
+/* 初始化I/O线程的epoll、唤醒eventfd和监听套接字 */
+static int io_thread_init(HttpServer* server, HttpIoThread* io, int index, int shared_listen_fd) {
+    io->server = server;
+    io->index = index;
+    io->listen_fd = shared_listen_fd;
+    io->epoll_fd = epoll_create1(0);
+    io->wake_fd = eventfd(0, EFD_NONBLOCK);
+    if (io->epoll_fd < 0 || io->wake_fd < 0) return 0;
+    
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = &io->wake_fd;
+    if (epoll_ctl(io->epoll_fd, EPOLL_CTL_ADD, io->wake_fd, &event) != 0) return 0;
+    
+    /* 共享监听套接字时只唤醒一个线程 */
+    event.events = EPOLLIN;
+#ifdef EPOLLEXCLUSIVE
+    if (index > 0 && shared_listen_fd == server->server_socket) event.events |= EPOLLEXCLUSIVE;
+#endif
+    event.data.ptr = io;
+    return epoll_ctl(io->epoll_fd, EPOLL_CTL_ADD, io->listen_fd, &event) == 0;
+}
+
+static void io_threads_release(HttpServer* server) {
+    for (int i = 0; i < server->io_thread_count; i++) {
+        HttpIoThread* io = &server->io_threads[i];
+        if (io->epoll_fd > 0) close(io->epoll_fd);
+        if (io->wake_fd > 0) close(io->wake_fd);
+        if (io->listen_fd >= 0 && io->listen_fd != server->server_socket) close(io->listen_fd);
+        io_free_completed(io);
+        pthread_mutex_destroy(&io->completed_mutex);
+    }
+    if (server->server_socket >= 0) {
         close(server->server_socket);
+        server->server_socket = -1;
+    }
+    safe_free((void**)&server->io_threads);
+    server->io_thread_count = 0;
+}
+
+int http_server_start(HttpServer* server) {
+    if (server == NULL || server->is_running) return 0;
+    
+    int thread_count = server->config.io_threads > 0 ? server->config.io_threads : HTTP_DEFAULT_IO_THREADS;
+    server->io_threads = (HttpIoThread*)safe_malloc(sizeof(HttpIoThread) * thread_count);
+    if (server->io_threads == NULL) return 0;
+    memset(server->io_threads, 0, sizeof(HttpIoThread) * thread_count);
+    for (int i = 0; i < thread_count; i++) {
+        server->io_threads[i].listen_fd = -1;
+        server->io_threads[i].epoll_fd = -1;
+        server->io_threads[i].wake_fd = -1;
+        pthread_mutex_init(&server->io_threads[i].completed_mutex, NULL);
+    }
+    server->io_thread_count = thread_count;
+    
+    /* 优先每个线程一个SO_REUSEPORT监听套接字，不支持时共享一个 */
+    int reuse_port = thread_count > 1;
+    server->server_socket = http_listen_socket(server, reuse_port);
+    if (server->server_socket < 0 && reuse_port) {
+        reuse_port = 0;
+        server->server_socket = http_listen_socket(server, 0);
+    }
+    if (server->server_socket < 0) {
+        char listen_error_msg[200];
+        snprintf(listen_error_msg, sizeof(listen_error_msg), "监听 %s:%d 失败: %s",
+                 server->config.host, server->config.port, strerror(errno));
+        logger_error(__func__, __FILE__, __LINE__, listen_error_msg);
+        io_threads_release(server);
         return 0;
     }
     
-    /* 开始监听 */
-    if (listen(server->server_socket, server->config.max_connections) < 0) {
-        // logger_error(__func__, __FILE__, __LINE__, "监听失败: %s", strerror(errno));
-        close(server->server_socket);
+    for (int i = 0; i < thread_count; i++) {
+        int listen_fd = server->server_socket;
+        if (i > 0 && reuse_port) {
+            listen_fd = http_listen_socket(server, 1);
+            if (listen_fd < 0) listen_fd = server->server_socket;
+        }
+        if (!io_thread_init(server, &server->io_threads[i], i, listen_fd)) {
+            logger_error(__func__, __FILE__, __LINE__, "初始化I/O线程失败");
+            io_threads_release(server);
+            return 0;
+        }
+    }
+    
+    /* API工作线程池 */
+    int worker_count = server->config.api_workers > 0 ? server->config.api_workers : HTTP_DEFAULT_API_WORKERS;
+    int queue_capacity = server->config.api_queue_capacity > 0 ? server->config.api_queue_capacity : HTTP_DEFAULT_API_QUEUE;
+    server->worker_pool = http_worker_pool_create(server, worker_count, queue_capacity, server->config.endpoint_limits);
+    if (server->worker_pool == NULL || !http_worker_pool_start(server->worker_pool)) {
+        logger_error(__func__, __FILE__, __LINE__, "创建API工作线程池失败");
+        http_worker_pool_destroy(server->worker_pool);
+        server->worker_pool = NULL;
+        io_threads_release(server);
         return 0;
     }
     
@@ -315,17 +993,29 @@ int http_server_start(HttpServer* server) {
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
-    /* 创建服务器线程 */
-    if (pthread_create(&server->server_thread, NULL, server_thread_function, server) != 0) {
-        logger_error(__func__, __FILE__, __LINE__, "创建服务器线程失败");
-        close(server->server_socket);
-        return 0;
-    }
-    
+    /* 先置运行标志再启动I/O线程 */
     server->is_running = 1;
     server->status.is_running = 1;
     server->status.start_time = time(NULL);
     
+    int started = 0;
+    for (int i = 0; i < thread_count; i++) {
+        HttpIoThread* io = &server->io_threads[i];
+        if (pthread_create(&io->thread, NULL, io_thread_function, io) == 0) {
+            io->started = 1;
+            started++;
+        }
+    }
+    if (started == 0) {
+        logger_error(__func__, __FILE__, __LINE__, "创建服务器线程失败");
+        server->is_running = 0;
+        server->status.is_running = 0;
+        http_worker_pool_destroy(server->worker_pool);
+        server->worker_pool = NULL;
+        io_threads_release(server);
+        return 0;
+    }
+    
     /* 启动WebSocket服务器 */
     if (server->enable_websocket && server->websocket_server) {
         if (!websocket_server_start(server->websocket_server)) {
@@ -336,8 +1026,8 @@ int http_server_start(HttpServer* server) {
     }
     
     char start_msg[200];
-    snprintf(start_msg, sizeof(start_msg), "HTTP服务器启动成功，监听 %s:%d", 
-             server->config.host, server->config.port);
+    snprintf(start_msg, sizeof(start_msg), "HTTP服务器启动成功，监听 %s:%d, %d个I/O线程, %d个API工作线程, 最多%d个连接",
+             server->config.host, server->config.port, started, worker_count, server->config.max_connections);
     logger_info(__func__, __FILE__, __LINE__, start_msg);
     
     return 1;
@@ -362,18 +1052,30 @@ int http_server_stop(HttpServer* server) {
     server->is_running = 0;
     server->status.is_running = 0;
     
-    /* 关闭服务器套接字，这将导致accept返回错误 */
-    if (server->server_socket >= 0) {
-        close(server->server_socket);
-        server->server_socket = -1;
+    /* 唤醒所有事件循环 */
+    for (int i = 0; i < server->io_thread_count; i++) {
+        uint64_t one = 1;
+        if (write(server->io_threads[i].wake_fd, &one, sizeof(one)) < 0) {
+            logger_warning(__func__, __FILE__, __LINE__, "唤醒I/O线程失败");
+        }
     }
     
-    /* 等待服务器线程结束 */
-    if (pthread_join(server->server_thread, NULL) != 0) {
-        logger_error(__func__, __FILE__, __LINE__, "等待服务器线程结束失败");
-        return 0;
+    /* 等待I/O线程结束 */
+    int result = 1;
+    for (int i = 0; i < server->io_thread_count; i++) {
+        HttpIoThread* io = &server->io_threads[i];
+        if (io->started && pthread_join(io->thread, NULL) != 0) {
+            logger_error(__func__, __FILE__, __LINE__, "等待服务器线程结束失败");
+            result = 0;
+        }
     }
     
+    /* I/O线程结束后不再有任务提交，再等待正在执行的API请求完成；
+     * 结果仍交回各I/O线程的完成队列，随后与I/O线程状态一起释放 */
+    http_worker_pool_destroy(server->worker_pool);
+    server->worker_pool = NULL;
+    io_threads_release(server);
+    
     /* 清理全局服务器实例 */
     if (g_server == server) {
         g_server = NULL;
@@ -381,7 +1083,7 @@ int http_server_stop(HttpServer* server) {
     
     logger_info(__func__, __FILE__, __LINE__, "HTTP服务器停止成功");
     
-    return 1;
+    return result;
 }
 
 int http_server_restart(HttpServer* server) {
@@ -406,6 +1108,9 @@ int http_server_set_data(HttpServer* server,
     server->trajectory = trajectory;
     server->geometry = geometry;
     
+    /* 新数据对象的版本号与旧对象无关，缓存的结果全部作废 */
+    analysis_cache_clear(server->analysis_cache);
+    
     return 1;
 }
 
@@ -439,6 +1144,14 @@ HttpRequest* http_request_create() {
 void http_request_destroy(HttpRequest* request) {
     if (request == NULL) return;
     
+    http_request_reset(request);
+    safe_free((void**)&request);
+}
+
+/* 释放请求的各字段并清零，对象本身可继续用于下一个请求 */
+void http_request_reset(HttpRequest* request) {
+    if (request == NULL) return;
+    
     if (request->path) {
         safe_free((void**)&request->path);
     }
@@ -459,7 +1172,8 @@ void http_request_destroy(HttpRequest* request) {
         safe_free((void**)&request->body);
     }
     
-    safe_free((void**)&request);
+    memset(request, 0, sizeof(HttpRequest));
+    request->method = HTTP_GET;
 }
 
 HttpResponse* http_response_create() {
@@ -475,6 +1189,14 @@ HttpResponse* http_response_create() {
 void http_response_destroy(HttpResponse* response) {
     if (response == NULL) return;
     
+    http_response_reset(response);
+    safe_free((void**)&response);
+}
+
+/* 释放响应的各字段并恢复默认状态，对象本身可继续用于下一个响应 */
+void http_response_reset(HttpResponse* response) {
+    if (response == NULL) return;
+    
     if (response->status_message) {
         safe_free((void**)&response->status_message);
     }
@@ -484,8 +1206,10 @@ void http_response_destroy(HttpResponse* response) {
     if (response->body) {
         safe_free((void**)&response->body);
     }
+    response_buffer_reset(&response->payload);
     
-    safe_free((void**)&response);
+    memset(response, 0, sizeof(HttpResponse));
+    response->status_code = 200;
 }
 
 int http_request_parse(const char* raw_request, HttpRequest* request) {
@@ -535,50 +1259,58 @@ int http_request_parse(const char* raw_request, HttpRequest* request) {
     request->headers = NULL;
     request->header_count = 0;
     
-    /* 解析请求头 */
-    const char* headers_start = strstr(raw_request, "\r\n");
-    if (headers_start) {
-        headers_start += 2; /* 跳过\r\n */
+    /* HTTP/1.1默认保持连接，HTTP/1.0默认关闭 */
+    request->keep_alive = strcmp(version, "HTTP/1.1") == 0;
+    
+    /* 请求头到空行为止，空行之后是请求体 */
+    const char* request_line_end = strstr(raw_request, "\r\n");
+    const char* header_end = strstr(raw_request, "\r\n\r\n");
+    if (request_line_end && header_end) {
+        const char* body_start = header_end + 4;
         
-        /* 查找请求体开始位置 */
-        const char* body_start = strstr(headers_start, "\r\n\r\n");
-        if (body_start) {
-            body_start += 4; /* 跳过\r\n\r\n */
-            
-            /* 如果有请求体，复制请求体 */
-            size_t body_length = strlen(body_start);
-            if (body_length > 0) {
-                request->body = safe_strdup(body_start);
-                request->content_length = body_length;
-            }
+        /* 如果有请求体，复制请求体 */
+        size_t body_length = strlen(body_start);
+        if (body_length > 0) {
+            request->body = safe_strdup(body_start);
+            request->content_length = body_length;
         }
         
-        /* 解析请求头 */
-        char* headers_copy = safe_strdup(headers_start);
-        if (headers_copy) {
-            char* line = strtok(headers_copy, "\r\n");
-            int header_capacity = 16;
-            request->headers = (char**)safe_malloc(header_capacity * sizeof(char*));
+        /* 逐行解析请求头 (不含请求行和请求体) */
+        int header_capacity = 16;
+        request->headers = (char**)safe_malloc(header_capacity * sizeof(char*));
+        const char* line = request_line_end + 2;
+        while (request->headers && line < header_end + 2) {
+            const char* line_end = strstr(line, "\r\n");
+            size_t line_length = (size_t)(line_end - line);
             
-            while (line && strlen(line) > 0) {
-                /* 扩展数组容量 */
-                if (request->header_count >= header_capacity) {
-                    header_capacity *= 2;
-                    request->headers = (char**)safe_realloc(request->headers, header_capacity * sizeof(char*));
-                }
-                
-                /* 复制请求头 */
-                request->headers[request->header_count] = safe_strdup(line);
-                
-                /* 解析Content-Length */
-                if (strstr(line, "Content-Length:")) {
-                    request->content_length = atoi(line + 15);
+            /* 扩展数组容量 */
+            if (request->header_count >= header_capacity) {
+                header_capacity *= 2;
+                request->headers = (char**)safe_realloc(request->headers, header_capacity * sizeof(char*));
+                if (request->headers == NULL) break;
+            }
+            
+            /* 复制请求头 */
+            char* header = (char*)safe_malloc(line_length + 1);
+            if (header == NULL) break;
+            memcpy(header, line, line_length);
+            header[line_length] = '\0';
+            request->headers[request->header_count++] = header;
+            
+            /* 解析Content-Length和Connection (字段名不区分大小写) */
+            if (strncasecmp(header, "Content-Length:", 15) == 0) {
+                request->content_length = atoi(header + 15);
+            } else if (strncasecmp(header, "Connection:", 11) == 0) {
+                const char* value = header + 11;
+                while (*value == ' ') value++;
+                if (strncasecmp(value, "close", 5) == 0) {
+                    request->keep_alive = 0;
+                } else if (strncasecmp(value, "keep-alive", 10) == 0) {
+                    request->keep_alive = 1;
                 }
-                
-                request->header_count++;
-                line = strtok(NULL, "\r\n");
             }
-            safe_free((void**)&headers_copy);
+            
+            line = line_end + 2;
         }
     }
     
@@ -590,74 +1322,87 @@ int http_request_parse(const char* raw_request, HttpRequest* request) {
     return 1;
 }
 
+/* 响应体长度：分块响应体优先于body */
+static size_t http_response_body_length(const HttpResponse* response) {
+    if (response->payload.length > 0) return response->payload.length;
+    return response->body ? (size_t)response->content_length : 0;
+}
+
+/* 状态行和响应头；连接管理头由连接状态决定 */
+static int http_response_write_head(const HttpResponse* response, ResponseBuffer* out, size_t body_length) {
+    const char* status_message = response->status_message ? response->status_message : "OK";
+    return response_buffer_printf(out,
+                                  "HTTP/1.1 %d %s\r\n"
+                                  "%s"
+                                  "Connection: %s\r\n"
+                                  "Content-Length: %zu\r\n"
+                                  "\r\n",
+                                  response->status_code, status_message,
+                                  response->headers ? response->headers : "Content-Type: text/plain\r\n",
+                                  response->keep_alive ? "keep-alive" : "close",
+                                  body_length);
+}
+
 int http_response_serialize(const HttpResponse* response, char* buffer, int buffer_size) {
     if (response == NULL || buffer == NULL || buffer_size <= 0) return 0;
     
     logger_info(__func__, __FILE__, __LINE__, "序列化HTTP响应");
     
-    /* 获取状态消息 */
-    const char* status_message = response->status_message ? response->status_message : "OK";
-    
-    /* 构建响应头 */
-    int written = snprintf(buffer, buffer_size, "HTTP/1.1 %d %s\r\n", 
-                         response->status_code, status_message);
-    
-    if (written >= buffer_size) {
-        logger_error(__func__, __FILE__, __LINE__, "HTTP响应缓冲区不足");
-        return 0;
-    }
+    size_t body_length = http_response_body_length(response);
+    ResponseBuffer head;
+    response_buffer_init(&head);
+    int written = http_response_write_head(response, &head, body_length)
+                  ? response_buffer_copy(&head, buffer, (size_t)buffer_size) : -1;
+    response_buffer_reset(&head);
     
-    /* 添加响应头 */
-    if (response->headers) {
-        written += snprintf(buffer + written, buffer_size - written, "%s", response->headers);
-        if (written >= buffer_size) {
-            logger_error(__func__, __FILE__, __LINE__, "HTTP响应缓冲区不足");
-            return 0;
-        }
-    } else {
-        /* 默认响应头 */
-        written += snprintf(buffer + written, buffer_size - written, 
-                          "Content-Type: text/plain\r\n"
-                          "Connection: close\r\n");
-        if (written >= buffer_size) {
-            logger_error(__func__, __FILE__, __LINE__, "HTTP响应缓冲区不足");
-            return 0;
+    /* 添加响应体 */
+    if (written >= 0 && response->payload.length > 0) {
+        int body_written = response_buffer_copy(&response->payload, buffer + written, (size_t)(buffer_size - written));
+        written = body_written < 0 ? -1 : written + body_written;
+    } else if (written >= 0 && body_length > 0) {
+        if ((size_t)written + body_length < (size_t)buffer_size) {
+            memcpy(buffer + written, response->body, body_length);
+            written += (int)body_length;
+            buffer[written] = '\0';
+        } else {
+            written = -1;
         }
     }
     
-    /* 添加Content-Length */
-    if (response->body) {
-        written += snprintf(buffer + written, buffer_size - written, 
-                          "Content-Length: %d\r\n", response->content_length);
-    } else {
-        written += snprintf(buffer + written, buffer_size - written, 
-                          "Content-Length: 0\r\n");
-    }
-    
-    if (written >= buffer_size) {
+    if (written < 0) {
         logger_error(__func__, __FILE__, __LINE__, "HTTP响应缓冲区不足");
         return 0;
     }
     
-    /* 头部结束 */
-    written += snprintf(buffer + written, buffer_size - written, "\r\n");
-    if (written >= buffer_size) {
-        logger_error(__func__, __FILE__, __LINE__, "HTTP响应缓冲区不足");
-        return 0;
-    }
+    logger_info(__func__, __FILE__, __LINE__, "HTTP响应序列化完成");
     
-    /* 添加响应体 */
-    if (response->body) {
-        written += snprintf(buffer + written, buffer_size - written, "%s", response->body);
-        if (written >= buffer_size) {
-            logger_error(__func__, __FILE__, __LINE__, "HTTP响应缓冲区不足");
+    return written;
+}
+
+/**
+ * @brief 把响应追加到分块缓冲区 (不限大小)
+ * @param response 响应，响应体的块和body内存移交给out，不复制
+ * @param out 发送缓冲区
+ * @return 成功返回1，内存不足返回0
+ */
+int http_response_serialize_chain(HttpResponse* response, ResponseBuffer* out) {
+    if (response == NULL || out == NULL) return 0;
+    
+    size_t body_length = http_response_body_length(response);
+    if (!http_response_write_head(response, out, body_length)) return 0;
+    
+    if (response->payload.length > 0) {
+        response_buffer_splice(out, &response->payload);
+    } else if (body_length > 0) {
+        /* 小响应体复制进响应头所在的块，大响应体 (如静态文件) 整块接管 */
+        if (body_length >= RESPONSE_CHUNK_SIZE / 4 && response_buffer_attach(out, response->body, body_length)) {
+            response->body = NULL;
+        } else if (!response_buffer_append(out, response->body, body_length)) {
             return 0;
         }
     }
     
-    logger_info(__func__, __FILE__, __LINE__, "HTTP响应序列化完成");
-    
-    return written;
+    return 1;
 }
 
 int http_response_set_json(HttpResponse* response, const char* json_data) {
@@ -756,7 +1501,6 @@ int http_response_set_file(HttpResponse* response, const char* filename) {
     char headers[512];
     snprintf(headers, sizeof(headers), 
              "Content-Type: %s\r\n"
-             "Connection: close\r\n"
              "Cache-Control: no-cache\r\n",
              content_type);
     
@@ -772,6 +1516,37 @@ int http_response_set_file(HttpResponse* response, const char* filename) {
 
 /* =================== API处理函数 =================== */
 
+/* API响应状态码对应的原因短语 */
+static const char* api_status_reason(int status_code) {
+    switch (status_code) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 503: return "Service Unavailable";
+        default: return status_code >= 500 ? "Internal Server Error" : status_code >= 400 ? "Bad Request" : "OK";
+    }
+}
+
+/**
+ * @brief 根据请求路径确定API端点
+ * @param path 请求路径
+ * @return API端点，未知路径返回0
+ */
+ApiEndpointType api_endpoint_from_path(const char* path) {
+    if (path == NULL) return 0;
+    
+    if (strncmp(path, "/api/status", 11) == 0) {
+        return API_STATUS;
+    } else if (strncmp(path, "/api/satellite", 14) == 0) {
+        return API_SATELLITE;
+    } else if (strncmp(path, "/api/trajectory", 15) == 0) {
+        return API_TRAJECTORY;
+    } else if (strncmp(path, "/api/analysis", 13) == 0) {
+        return API_ANALYSIS;
+    }
+    return 0;
+}
+
 int api_handle_request(const HttpRequest* request, HttpResponse* response, 
                       const struct HttpServer* server) {
     if (request == NULL || response == NULL || server == NULL) return 0;
@@ -782,17 +1557,8 @@ int api_handle_request(const HttpRequest* request, HttpResponse* response,
     logger_info(__func__, __FILE__, __LINE__, api_msg);
     
     /* 解析API端点 */
-    ApiEndpointType endpoint = API_STATUS; /* 默认端点 */
-    
-    if (strncmp(request->path, "/api/status", 11) == 0) {
-        endpoint = API_STATUS;
-    } else if (strncmp(request->path, "/api/satellite", 14) == 0) {
-        endpoint = API_SATELLITE;
-    } else if (strncmp(request->path, "/api/trajectory", 15) == 0) {
-        endpoint = API_TRAJECTORY;
-    } else if (strncmp(request->path, "/api/analysis", 13) == 0) {
-        endpoint = API_ANALYSIS;
-    } else {
+    ApiEndpointType endpoint = api_endpoint_from_path(request->path);
+    if (endpoint == 0) {
         char api_unknown_msg[300];
             snprintf(api_unknown_msg, sizeof(api_unknown_msg), "未知的API端点: %s", request->path);
             logger_warning(__func__, __FILE__, __LINE__, api_unknown_msg);
@@ -804,6 +1570,7 @@ int api_handle_request(const HttpRequest* request, HttpResponse* response,
     ApiRequestParams params;
     memset(&params, 0, sizeof(ApiRequestParams));
     params.endpoint = endpoint;
+    params.end_point = -1;  /* 未指定时分析到轨迹末尾 (0是合法的空范围上界) */
     
     /* 解析查询参数 */
     if (request->query_string) {
@@ -812,7 +1579,8 @@ int api_handle_request(const HttpRequest* request, HttpResponse* response,
         strncpy(query_copy, request->query_string, sizeof(query_copy) - 1);
         query_copy[sizeof(query_copy) - 1] = '\0';
         
-        char* token = strtok(query_copy, "&");
+        char* save_ptr = NULL;
+        char* token = strtok_r(query_copy, "&", &save_ptr);
         while (token) {
             if (strncmp(token, "start_time=", 11) == 0) {
                 params.start_time = atol(token + 11);
@@ -822,8 +1590,14 @@ int api_handle_request(const HttpRequest* request, HttpResponse* response,
                 params.satellite_prn = atoi(token + 14);
             } else if (strncmp(token, "trajectory_id=", 14) == 0) {
                 params.trajectory_id = atoi(token + 14);
+            } else if (strncmp(token, "max_points=", 11) == 0) {
+                params.max_points = atoi(token + 11);
+            } else if (strncmp(token, "start_point=", 12) == 0) {
+                params.start_point = atoi(token + 12);
+            } else if (strncmp(token, "end_point=", 10) == 0) {
+                params.end_point = atoi(token + 10);
             }
-            token = strtok(NULL, "&");
+            token = strtok_r(NULL, "&", &save_ptr);
         }
     }
     
@@ -854,36 +1628,44 @@ int api_handle_request(const HttpRequest* request, HttpResponse* response,
     }
     
     if (!result) {
-        char api_error_msg[300];
-            snprintf(api_error_msg, sizeof(api_error_msg), "API处理失败: %s", api_response.error);
-            logger_error(__func__, __FILE__, __LINE__, api_error_msg);
+        LOG_ERROR_FMT("API处理失败: %s", api_response.error);
+        response_buffer_reset(&api_response.data);
         http_response_set_error(response, api_response.status_code, api_response.error);
         return 0;
     }
     
-    /* 创建HTTP响应 */
-    char response_json[16384];
-    int written = snprintf(response_json, sizeof(response_json),
+    /* 创建HTTP响应：外层JSON直接写入分块响应体，数据部分的块整体移入，不复制 */
+    ResponseBuffer* body = &response->payload;
+    int written = response_buffer_printf(body,
                           "{\"success\":%d,"
                           "\"message\":\"%s\","
-                          "\"timestamp\":%ld,"
-                          "\"data\":%s}",
+                          "\"timestamp\":%ld,",
                           api_response.success,
                           api_response.message,
-                          api_response.timestamp,
-                          api_response.data ? api_response.data : "null");
+                          api_response.timestamp);
+    if (!api_response.success && api_response.error[0] != '\0') {
+        written = written && response_buffer_printf(body, "\"error\":\"%s\",", api_response.error);
+    }
+    written = written && response_buffer_append_string(body, "\"data\":");
+    if (api_response.data.length > 0) {
+        response_buffer_splice(body, &api_response.data);
+    } else {
+        written = written && response_buffer_append_string(body, "null");
+    }
+    written = written && response_buffer_append_string(body, "}");
     
-    if (written >= sizeof(response_json)) {
-        logger_error(__func__, __FILE__, __LINE__, "响应JSON缓冲区不足");
+    if (!written) {
+        logger_error(__func__, __FILE__, __LINE__, "响应JSON内存分配失败");
+        response_buffer_reset(&api_response.data);
+        response_buffer_reset(body);
         http_response_set_error(response, 500, "内部服务器错误");
         return 0;
     }
     
     /* 设置HTTP响应 */
     response->status_code = api_response.status_code;
-    response->status_message = safe_strdup("OK");
-    response->body = safe_strdup(response_json);
-    response->content_length = strlen(response_json);
+    response->status_message = safe_strdup(api_status_reason(api_response.status_code));
+    response->content_length = (int)body->length;
     
     /* 添加CORS头 */
     response->headers = safe_strdup("Content-Type: application/json\r\n"
@@ -891,11 +1673,6 @@ int api_handle_request(const HttpRequest* request, HttpResponse* response,
                                   "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
                                   "Access-Control-Allow-Headers: Content-Type\r\n");
     
-    /* 清理API响应数据 */
-    if (api_response.data) {
-        safe_free((void**)&api_response.data);
-    }
-    
     logger_info(__func__, __FILE__, __LINE__, "API请求处理完成");
     
     return 1;
@@ -936,9 +1713,15 @@ int api_handle_status(const ApiRequestParams* params, ApiResponseData* response,
     long used_memory = total_memory - available_memory;
     double memory_usage_percent = total_memory > 0 ? (double)used_memory / total_memory * 100.0 : 0.0;
     
+    /* 工作线程池统计 */
+    HttpWorkerPoolStats pool_stats;
+    http_worker_pool_get_stats(server->worker_pool, &pool_stats);
+    double average_wait_ms = pool_stats.completed > 0 ? pool_stats.total_wait_ms / pool_stats.completed : 0.0;
+    AnalysisCacheStats cache_stats;
+    analysis_cache_get_stats(server->analysis_cache, &cache_stats);
+    
     /* 创建状态JSON */
-    char status_json[4096];
-    int written = snprintf(status_json, sizeof(status_json),
+    int written = response_buffer_printf(&response->data,
                           "{\"status\":\"%s\","
                           "\"uptime\":%ld,"
                           "\"memory_usage_mb\":%ld,"
@@ -947,6 +1730,10 @@ int api_handle_status(const ApiRequestParams* params, ApiResponseData* response,
                           "\"request_count\":%d,"
                           "\"error_count\":%d,"
                           "\"is_running\":%d,"
+                          "\"worker_pool\":{\"workers\":%d,\"queue_depth\":%d,\"max_queue_depth\":%d,"
+                          "\"active_workers\":%d,\"completed\":%ld,\"rejected\":%ld,"
+                          "\"avg_wait_ms\":%.3f,\"max_wait_ms\":%.3f},"
+                          "\"analysis_cache\":{\"entries\":%d,\"hits\":%ld,\"misses\":%ld,\"evictions\":%ld},"
                           "\"version\":\"1.0.0\","
                           "\"timestamp\":%ld}",
                           server->status.is_running ? "running" : "stopped",
@@ -957,17 +1744,28 @@ int api_handle_status(const ApiRequestParams* params, ApiResponseData* response,
                           server->status.request_count,
                           server->status.error_count,
                           server->status.is_running,
+                          pool_stats.workers,
+                          pool_stats.queue_depth,
+                          pool_stats.max_queue_depth,
+                          pool_stats.active_workers,
+                          pool_stats.completed,
+                          pool_stats.rejected,
+                          average_wait_ms,
+                          pool_stats.max_wait_ms,
+                          cache_stats.entries,
+                          cache_stats.hits,
+                          cache_stats.misses,
+                          cache_stats.evictions,
                           current_time);
     
-    if (written >= sizeof(status_json)) {
-        logger_error(__func__, __FILE__, __LINE__, "状态JSON缓冲区不足");
+    if (!written) {
+        logger_error(__func__, __FILE__, __LINE__, "状态JSON内存分配失败");
         response->success = 0;
         snprintf(response->error, sizeof(response->error), "内部服务器错误");
         return 0;
     }
     
     /* 设置响应数据 */
-    response->data = safe_strdup(status_json);
     response->status_code = 200;
     snprintf(response->message, sizeof(response->message), "状态查询成功");
     
@@ -997,69 +1795,51 @@ int api_handle_satellite(const ApiRequestParams* params, ApiResponseData* respon
         return 1;
     }
     
-    /* 创建卫星数据JSON */
-    char satellite_json[8192];
-    int written = snprintf(satellite_json, sizeof(satellite_json),
+    /* 创建卫星数据JSON (直接追加到响应数据，卫星数量不受缓冲区限制) */
+    ResponseBuffer* data = &response->data;
+    int written = response_buffer_printf(data,
                           "{\"satellite_count\":%d,"
                           "\"reference_time\":%ld,"
                           "\"satellites\":[",
                           server->satellite_data->satellite_count,
                           server->satellite_data->reference_time);
     
-    if (written >= sizeof(satellite_json)) {
-        logger_error(__func__, __FILE__, __LINE__, "卫星JSON缓冲区不足");
-        response->success = 0;
-        snprintf(response->error, sizeof(response->error), "内部服务器错误");
-        return 0;
-    }
-    
     /* 添加每个卫星的数据 */
-    for (int i = 0; i < server->satellite_data->satellite_count; i++) {
+    for (int i = 0; written && i < server->satellite_data->satellite_count; i++) {
         const Satellite* sat = &server->satellite_data->satellites[i];
         
-        if (i > 0) {
-            written += snprintf(satellite_json + written, sizeof(satellite_json) - written, ",");
-        }
-        
-        written += snprintf(satellite_json + written, sizeof(satellite_json) - written,
-                          "{\"prn\":%d,"
+        written = response_buffer_printf(data,
+                          "%s{\"prn\":%d,"
                           "\"system\":%d,"
                           "\"is_valid\":%d,"
                           "\"position\":{\"x\":%.2f,\"y\":%.2f,\"z\":%.2f},"
                           "\"velocity\":{\"vx\":%.2f,\"vy\":%.2f,\"vz\":%.2f},"
                           "\"valid_time\":%ld}",
+                          i > 0 ? "," : "",
                           sat->prn,
                           sat->system,
                           sat->is_valid,
                           sat->pos.x, sat->pos.y, sat->pos.z,
                           sat->pos.vx, sat->pos.vy, sat->pos.vz,
                           sat->valid_time);
-        
-        if (written >= sizeof(satellite_json)) {
-            logger_error(__func__, __FILE__, __LINE__, "卫星JSON缓冲区不足");
-            response->success = 0;
-            snprintf(response->error, sizeof(response->error), "内部服务器错误");
-            return 0;
-        }
     }
     
     /* 关闭JSON数组 */
-    written += snprintf(satellite_json + written, sizeof(satellite_json) - written, "]}");
+    written = written && response_buffer_append_string(data, "]}");
     
-    if (written >= sizeof(satellite_json)) {
-        logger_error(__func__, __FILE__, __LINE__, "卫星JSON缓冲区不足");
+    if (!written) {
+        logger_error(__func__, __FILE__, __LINE__, "卫星JSON内存分配失败");
+        response_buffer_reset(data);
         response->success = 0;
         snprintf(response->error, sizeof(response->error), "内部服务器错误");
         return 0;
     }
     
     /* 设置响应数据 */
-    response->data = safe_strdup(satellite_json);
     response->status_code = 200;
     snprintf(response->message, sizeof(response->message), "卫星数据查询成功");
     
-    logger_info(__func__, __FILE__, __LINE__, "卫星API处理完成，返回%d颗卫星数据", 
-               server->satellite_data->satellite_count);
+    LOG_INFO_FMT("卫星API处理完成，返回%d颗卫星数据", server->satellite_data->satellite_count);
     
     return 1;
 }
@@ -1085,9 +1865,9 @@ int api_handle_trajectory(const ApiRequestParams* params, ApiResponseData* respo
         return 1;
     }
     
-    /* 创建轨迹数据JSON */
-    char trajectory_json[16384];
-    int written = snprintf(trajectory_json, sizeof(trajectory_json),
+    /* 创建轨迹数据JSON (直接追加到响应数据，完整轨迹也不受缓冲区限制) */
+    ResponseBuffer* data = &response->data;
+    int written = response_buffer_printf(data,
                           "{\"trajectory_id\":%d,"
                           "\"point_count\":%d,"
                           "\"start_time\":%ld,"
@@ -1104,35 +1884,26 @@ int api_handle_trajectory(const ApiRequestParams* params, ApiResponseData* respo
                           server->trajectory->max_altitude,
                           server->trajectory->min_altitude);
     
-    if (written >= sizeof(trajectory_json)) {
-        logger_error(__func__, __FILE__, __LINE__, "轨迹JSON缓冲区不足");
-        response->success = 0;
-        snprintf(response->error, sizeof(response->error), "内部服务器错误");
-        return 0;
-    }
-    
-    /* 添加轨迹点数据 (限制返回数量以避免JSON过大) */
-    int max_points_to_return = server->trajectory->point_count;
-    if (max_points_to_return > 100) {
-        max_points_to_return = 100; /* 最多返回100个点 */
+    /* 默认抽样返回最多100个点，max_points<0时返回全部 */
+    int max_points_to_return = params->max_points > 0 ? params->max_points : 100;
+    if (params->max_points < 0 || max_points_to_return > server->trajectory->point_count) {
+        max_points_to_return = server->trajectory->point_count;
     }
     
-    int step = server->trajectory->point_count / max_points_to_return;
+    int step = max_points_to_return > 0 ? server->trajectory->point_count / max_points_to_return : 1;
     if (step < 1) step = 1;
     
-    for (int i = 0; i < server->trajectory->point_count; i += step) {
+    int points_returned = 0;
+    for (int i = 0; written && i < server->trajectory->point_count; i += step) {
         const TrajectoryPoint* point = &server->trajectory->points[i];
         
-        if (i > 0) {
-            written += snprintf(trajectory_json + written, sizeof(trajectory_json) - written, ",");
-        }
-        
-        written += snprintf(trajectory_json + written, sizeof(trajectory_json) - written,
-                          "{\"timestamp\":%ld,"
+        written = response_buffer_printf(data,
+                          "%s{\"timestamp\":%ld,"
                           "\"position\":{\"latitude\":%.6f,\"longitude\":%.6f,\"altitude\":%.2f},"
                           "\"attitude\":{\"pitch\":%.2f,\"roll\":%.2f,\"yaw\":%.2f},"
                           "\"velocity\":{\"velocity\":%.2f,\"vertical_speed\":%.2f,\"heading\":%.2f},"
                           "\"is_valid\":%d}",
+                          i > 0 ? "," : "",
                           point->timestamp,
                           point->state.position.latitude,
                           point->state.position.longitude,
@@ -1144,99 +1915,215 @@ int api_handle_trajectory(const ApiRequestParams* params, ApiResponseData* respo
                           point->state.velocity.vertical_speed,
                           point->state.velocity.heading,
                           point->state.is_valid);
-        
-        if (written >= sizeof(trajectory_json)) {
-            logger_error(__func__, __FILE__, __LINE__, "轨迹JSON缓冲区不足");
-            response->success = 0;
-            snprintf(response->error, sizeof(response->error), "内部服务器错误");
-            return 0;
-        }
+        points_returned++;
     }
     
     /* 关闭JSON数组 */
-    written += snprintf(trajectory_json + written, sizeof(trajectory_json) - written, "]}");
+    written = written && response_buffer_append_string(data, "]}");
     
-    if (written >= sizeof(trajectory_json)) {
-        logger_error(__func__, __FILE__, __LINE__, "轨迹JSON缓冲区不足");
+    if (!written) {
+        logger_error(__func__, __FILE__, __LINE__, "轨迹JSON内存分配失败");
+        response_buffer_reset(data);
         response->success = 0;
         snprintf(response->error, sizeof(response->error), "内部服务器错误");
         return 0;
     }
     
     /* 设置响应数据 */
-    response->data = safe_strdup(trajectory_json);
     response->status_code = 200;
     snprintf(response->message, sizeof(response->message), "轨迹数据查询成功");
     
-    logger_info(__func__, __FILE__, __LINE__, "轨迹API处理完成，返回%d个轨迹点", 
-               max_points_to_return);
+    LOG_INFO_FMT("轨迹API处理完成，返回%d个轨迹点", points_returned);
     
     return 1;
 }
 
-int api_handle_analysis(const ApiRequestParams* params, ApiResponseData* response,
-                       const struct HttpServer* server) {
-    if (params == NULL || response == NULL || server == NULL) return 0;
+/* 影响分析结果的请求参数 (整体参与缓存键哈希，使用前清零) */
+typedef struct {
+    int first_point;               /* 第一个轨迹点下标 */
+    int last_point;                /* 最后一个轨迹点下标 (含) */
+    ObstructionParams obstruction;
+} AnalysisQuery;
+
+static double wall_time_ms(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/**
+ * @brief 按轨迹点下标范围和时间范围确定要分析的轨迹点
+ * @param reason 范围为空时写入导致为空的边界条件
+ * @param reason_size reason缓冲区大小
+ * @return 范围非空返回1，否则返回0
+ */
+static int analysis_resolve_range(const FlightTrajectory* trajectory, const ApiRequestParams* params,
+                                  int* first_point, int* last_point, char* reason, size_t reason_size) {
+    int first = params->start_point > 0 ? params->start_point : 0;
+    int end = trajectory->point_count;
+    if (params->end_point >= 0 && params->end_point < end) end = params->end_point;
+    
+    if (first >= trajectory->point_count) {
+        snprintf(reason, reason_size, "start_point=%d超出轨迹范围 (共%d个点)",
+                 first, trajectory->point_count);
+        return 0;
+    }
+    if (end <= first) {
+        snprintf(reason, reason_size, "end_point=%d不大于start_point=%d", end, first);
+        return 0;
+    }
+    if (params->start_time > 0 && params->end_time > 0 && params->start_time > params->end_time) {
+        snprintf(reason, reason_size, "start_time=%ld晚于end_time=%ld",
+                 (long)params->start_time, (long)params->end_time);
+        return 0;
+    }
     
-    logger_info(__func__, __FILE__, __LINE__, "处理分析API请求");
+    /* 轨迹点按时间排序 */
+    time_t range_end_time = trajectory->points[end - 1].timestamp;
+    while (first < end && params->start_time > 0 && trajectory->points[first].timestamp < params->start_time) {
+        first++;
+    }
+    if (first == end) {
+        snprintf(reason, reason_size, "start_time=%ld晚于所选范围的最后时刻%ld",
+                 (long)params->start_time, (long)range_end_time);
+        return 0;
+    }
     
-    /* 初始化响应数据 */
-    memset(response, 0, sizeof(ApiResponseData));
-    response->success = 1;
-    response->timestamp = time(NULL);
+    time_t range_start_time = trajectory->points[first].timestamp;
+    while (end > first && params->end_time > 0 && trajectory->points[end - 1].timestamp > params->end_time) {
+        end--;
+    }
+    if (end == first) {
+        snprintf(reason, reason_size, "end_time=%ld早于所选范围的最早时刻%ld",
+                 (long)params->end_time, (long)range_start_time);
+        return 0;
+    }
     
-    /* 检查必要的数据是否可用 */
-    if (server->satellite_data == NULL || server->trajectory == NULL || server->geometry == NULL) {
-        logger_warning(__func__, __FILE__, __LINE__, "分析所需数据不完整");
-        response->success = 0;
-        response->status_code = 404;
-        snprintf(response->message, sizeof(response->message), "分析所需数据不完整");
-        snprintf(response->error, sizeof(response->error), "请确保卫星数据、轨迹数据和飞机几何模型都已加载");
-        return 1;
+    *first_point = first;
+    *last_point = end - 1;
+    return 1;
+}
+
+/**
+ * @brief 对选定的轨迹点逐点做批量遮挡计算，生成分析结果JSON
+ * @param server 服务器 (使用其卫星数据、轨迹和几何模型)
+ * @param query 分析范围和遮挡参数
+ * @param out 结果JSON追加到此缓冲区
+ * @return 成功返回1，失败返回0
+ * @note 卫星按星历传播到每个轨迹点的时刻 (没有星历时使用当前位置)；
+ *       汇总统计覆盖全部选定点，逐星结果为最后一个点的状态
+ */
+static int analysis_run(const struct HttpServer* server, const AnalysisQuery* query, ResponseBuffer* out) {
+    const SatelliteData* satellite_data = server->satellite_data;
+    const FlightTrajectory* trajectory = server->trajectory;
+    double start_ms = wall_time_ms();
+    
+    /* 卫星副本，每个时间步整个星座一次传播到该时刻 */
+    SatelliteData* snapshot = satellite_data_create(satellite_data->satellite_count > 0 ? satellite_data->satellite_count : 1);
+    if (snapshot == NULL) return 0;
+    memcpy(snapshot->satellites, satellite_data->satellites, sizeof(Satellite) * satellite_data->satellite_count);
+    snapshot->satellite_count = satellite_data->satellite_count;
+    SatelliteEphemerisBatch* batch = satellite_ephemeris_batch_create(snapshot);
+    
+    BatchObstructionResult last;
+    memset(&last, 0, sizeof(BatchObstructionResult));
+    int points_analyzed = 0;
+    int available_points = 0;
+    int min_usable = -1;
+    long visible_total = 0;
+    long obstructed_total = 0;
+    long usable_total = 0;
+    double signal_sum = 0.0;
+    long signal_count = 0;
+    int success = 1;
+    
+    for (int p = query->first_point; p <= query->last_point; p++) {
+        const TrajectoryPoint* point = &trajectory->points[p];
+        if (batch) {
+            satellite_data_propagate_batch(snapshot, batch, point->timestamp);
+        }
+        
+        BatchObstructionResult result;
+        if (!batch_obstruction_calculate(server->geometry, snapshot, &point->state, &query->obstruction, &result)) {
+            success = 0;
+            break;
+        }
+        
+        points_analyzed++;
+        visible_total += result.visible_satellites;
+        obstructed_total += result.obstructed_satellites;
+        usable_total += result.usable_satellites;
+        if (result.usable_satellites >= TRAJECTORY_ANALYSIS_MIN_USABLE) available_points++;
+        if (min_usable < 0 || result.usable_satellites < min_usable) min_usable = result.usable_satellites;
+        for (int i = 0; i < result.analysis_count; i++) {
+            if (result.analyses[i].visibility.is_visible) {
+                signal_sum += result.analyses[i].visibility.signal_strength;
+                signal_count++;
+            }
+        }
+        
+        free(last.analyses);
+        last = result;
     }
     
-    /* 创建分析结果JSON (模拟分析结果) */
-    char analysis_json[8192];
-    int written = snprintf(analysis_json, sizeof(analysis_json),
-                          "\"analysis_time\":%ld,"
+    satellite_ephemeris_batch_destroy(batch);
+    satellite_data_destroy(snapshot);
+    if (!success || points_analyzed == 0) {
+        free(last.analyses);
+        return 0;
+    }
+    
+    int written = response_buffer_printf(out,
+                          "{\"analysis_time\":%ld,"
                           "\"satellite_count\":%d,"
                           "\"trajectory_points\":%d,"
+                          "\"trajectory_id\":%d,"
+                          "\"range\":{"
+                          "\"first_point\":%d,"
+                          "\"last_point\":%d,"
+                          "\"points_analyzed\":%d,"
+                          "\"start_time\":%ld,"
+                          "\"end_time\":%ld"
+                          "},"
                           "\"analysis_summary\":{"
                           "\"total_satellites\":%d,"
                           "\"visible_satellites\":%d,"
                           "\"obstructed_satellites\":%d,"
                           "\"usable_satellites\":%d,"
+                          "\"average_visible_satellites\":%.2f,"
+                          "\"average_obstructed_satellites\":%.2f,"
+                          "\"average_usable_satellites\":%.2f,"
+                          "\"min_usable_satellites\":%d,"
+                          "\"availability_percentage\":%.2f,"
                           "\"average_signal_strength\":%.2f,"
                           "\"analysis_duration_ms\":%.2f"
                           "},"
                           "\"results\":[",
-                          time(NULL),
-                          server->satellite_data->satellite_count,
-                          server->trajectory->point_count,
-                          server->satellite_data->satellite_count,
-                          server->satellite_data->satellite_count * 7 / 10,  /* 假设70%可见 */
-                          server->satellite_data->satellite_count * 2 / 10,  /* 假设20%被遮挡 */
-                          server->satellite_data->satellite_count * 5 / 10,  /* 假设50%可用 */
-                          45.5,  /* 平均信号强度 */
-                          125.8  /* 分析耗时 */
-                          );
-    
-    if (written >= sizeof(analysis_json)) {
-        logger_error(__func__, __FILE__, __LINE__, "分析JSON缓冲区不足");
-        response->success = 0;
-        snprintf(response->error, sizeof(response->error), "内部服务器错误");
-        return 0;
-    }
-    
-    /* 添加一些示例分析结果 */
-    int result_count = 5; /* 限制返回结果数量 */
-    for (int i = 0; i < result_count; i++) {
-        if (i > 0) {
-            written += snprintf(analysis_json + written, sizeof(analysis_json) - written, ",");
-        }
-        
-        written += snprintf(analysis_json + written, sizeof(analysis_json) - written,
-                          "{\"satellite_prn\":%d,"
+                          (long)time(NULL),
+                          satellite_data->satellite_count,
+                          trajectory->point_count,
+                          trajectory->trajectory_id,
+                          query->first_point,
+                          query->last_point,
+                          points_analyzed,
+                          (long)trajectory->points[query->first_point].timestamp,
+                          (long)trajectory->points[query->last_point].timestamp,
+                          satellite_data->satellite_count,
+                          last.visible_satellites,
+                          last.obstructed_satellites,
+                          last.usable_satellites,
+                          (double)visible_total / points_analyzed,
+                          (double)obstructed_total / points_analyzed,
+                          (double)usable_total / points_analyzed,
+                          min_usable,
+                          100.0 * available_points / points_analyzed,
+                          signal_count > 0 ? signal_sum / signal_count : 0.0,
+                          wall_time_ms() - start_ms);
+    
+    for (int i = 0; written && i < last.analysis_count; i++) {
+        const VisibilityAnalysis* analysis = &last.analyses[i];
+        written = response_buffer_printf(out,
+                          "%s{\"satellite_prn\":%d,"
                           "\"elevation\":%.2f,"
                           "\"azimuth\":%.2f,"
                           "\"distance\":%.2f,"
@@ -1247,57 +2134,115 @@ int api_handle_analysis(const ApiRequestParams* params, ApiResponseData* respons
                           "\"obstruction_details\":{"
                           "\"is_obstructed\":%d,"
                           "\"obstruction_angle\":%.2f,"
+                          "\"obstruction_part\":\"%s\","
                           "\"signal_loss\":%.2f"
                           "}}",
-                          i + 1,  /* PRN */
-                          15.0 + i * 10.0,  /* 高度角 */
-                          45.0 + i * 30.0,  /* 方位角 */
-                          20000000.0 + i * 1000000.0,  /* 距离 */
-                          i < 3 ? 1 : 0,  /* 是否可见 */
-                          i == 2 ? 1 : 0,  /* 是否被遮挡 */
-                          45.0 + i * 5.0,  /* 信号强度 */
-                          i != 2 ? 1 : 0,  /* 是否可用 */
-                          i == 2 ? 1 : 0,  /* 是否被遮挡 */
-                          i == 2 ? 2.5 : 0.0,  /* 遮挡角度 */
-                          i == 2 ? 15.0 : 0.0  /* 信号损失 */
-                          );
-        
-        if (written >= sizeof(analysis_json)) {
-            logger_error(__func__, __FILE__, __LINE__, "分析JSON缓冲区不足");
-            response->success = 0;
-            snprintf(response->error, sizeof(response->error), "内部服务器错误");
-            return 0;
-        }
+                          i > 0 ? "," : "",
+                          analysis->visibility.prn,
+                          analysis->visibility.elevation,
+                          analysis->visibility.azimuth,
+                          analysis->visibility.distance,
+                          analysis->visibility.is_visible,
+                          analysis->obstruction.is_obstructed,
+                          analysis->visibility.signal_strength,
+                          analysis->is_usable,
+                          analysis->obstruction.is_obstructed,
+                          analysis->obstruction.obstruction_angle,
+                          analysis->obstruction.is_obstructed ?
+                              aircraft_part_to_string(analysis->obstruction.obstruction_part) : "",
+                          analysis->obstruction.signal_loss);
+    }
+    written = written && response_buffer_append_string(out, "]}");
+    free(last.analyses);
+    
+    if (!written) {
+        logger_error(__func__, __FILE__, __LINE__, "分析JSON内存分配失败");
+        return 0;
     }
+    return 1;
+}
+
+int api_handle_analysis(const ApiRequestParams* params, ApiResponseData* response,
+                       const struct HttpServer* server) {
+    if (params == NULL || response == NULL || server == NULL) return 0;
     
-    /* 关闭JSON数组和对象 */
-    written += snprintf(analysis_json + written, sizeof(analysis_json) - written, "]}");
+    logger_info(__func__, __FILE__, __LINE__, "处理分析API请求");
     
-    if (written >= sizeof(analysis_json)) {
-        logger_error(__func__, __FILE__, __LINE__, "分析JSON缓冲区不足");
+    /* 初始化响应数据 */
+    memset(response, 0, sizeof(ApiResponseData));
+    response->success = 1;
+    response->timestamp = time(NULL);
+    
+    /* 检查必要的数据是否可用 */
+    if (server->satellite_data == NULL || server->trajectory == NULL || server->geometry == NULL) {
+        logger_warning(__func__, __FILE__, __LINE__, "分析所需数据不完整");
         response->success = 0;
-        snprintf(response->error, sizeof(response->error), "内部服务器错误");
-        return 0;
+        response->status_code = 404;
+        snprintf(response->message, sizeof(response->message), "分析所需数据不完整");
+        snprintf(response->error, sizeof(response->error), "请确保卫星数据、轨迹数据和飞机几何模型都已加载");
+        return 1;
     }
     
-    /* 创建完整的JSON响应 */
-    char complete_json[16384];
-    int complete_written = snprintf(complete_json, sizeof(complete_json),
-                                  "{%s}", analysis_json);
+    /* 请求本身有误时与数据不可用一样返回成功，由状态码和错误信息告知客户端 */
+    if (params->trajectory_id != 0 && params->trajectory_id != server->trajectory->trajectory_id) {
+        response->success = 0;
+        response->status_code = 404;
+        snprintf(response->message, sizeof(response->message), "未找到轨迹 %d", params->trajectory_id);
+        snprintf(response->error, sizeof(response->error), "当前加载的轨迹为 %d", server->trajectory->trajectory_id);
+        return 1;
+    }
     
-    if (complete_written >= sizeof(complete_json)) {
-        logger_error(__func__, __FILE__, __LINE__, "完整JSON缓冲区不足");
+    AnalysisQuery query;
+    memset(&query, 0, sizeof(AnalysisQuery));
+    obstruction_params_init(&query.obstruction);
+    if (!analysis_resolve_range(server->trajectory, params, &query.first_point, &query.last_point,
+                                response->error, sizeof(response->error))) {
         response->success = 0;
-        snprintf(response->error, sizeof(response->error), "内部服务器错误");
-        return 0;
+        response->status_code = 400;
+        snprintf(response->message, sizeof(response->message), "所选范围内没有轨迹点");
+        return 1;
+    }
+    
+    /* 输入数据和参数都未变化时直接返回缓存的结果 */
+    AnalysisCacheKey key;
+    analysis_cache_key_init(&key, server->satellite_data, server->trajectory, server->geometry,
+                            &query, sizeof(AnalysisQuery));
+    AnalysisCacheBlob* analysis_blob = analysis_cache_get(server->analysis_cache, &key);
+    int cached = analysis_blob != NULL;
+    if (cached) {
+        /* 缓存的结果直接作为响应数据的一块，发送完成后释放引用 */
+        if (!analysis_cache_blob_attach(&response->data, analysis_blob)) {
+            analysis_cache_blob_release(analysis_blob);
+            response->success = 0;
+            response->status_code = 500;
+            snprintf(response->error, sizeof(response->error), "内部服务器错误");
+            return 0;
+        }
+    } else {
+        if (!analysis_run(server, &query, &response->data)) {
+            logger_error(__func__, __FILE__, __LINE__, "可见性分析失败");
+            response_buffer_reset(&response->data);
+            response->success = 0;
+            response->status_code = 500;
+            snprintf(response->error, sizeof(response->error), "内部服务器错误");
+            return 0;
+        }
+        /* 响应数据照常发送，缓存接管复制出的连续结果 */
+        analysis_blob = analysis_cache_blob_create(&response->data);
+        if (analysis_blob) {
+            analysis_cache_put(server->analysis_cache, &key, analysis_blob);
+            analysis_cache_blob_release(analysis_blob);
+        }
     }
     
     /* 设置响应数据 */
-    response->data = safe_strdup(complete_json);
     response->status_code = 200;
-    snprintf(response->message, sizeof(response->message), "可见性分析完成");
+    snprintf(response->message, sizeof(response->message), cached ? "可见性分析完成 (缓存)" : "可见性分析完成");
     
-    logger_info(__func__, __FILE__, __LINE__, "分析API处理完成");
+    char done_msg[200];
+    snprintf(done_msg, sizeof(done_msg), "分析API处理完成，轨迹点 %d-%d%s",
+             query.first_point, query.last_point, cached ? "，命中缓存" : "");
+    logger_info(__func__, __FILE__, __LINE__, done_msg);
     
     return 1;
 }
@@ -1481,6 +2426,11 @@ int http_server_config_init(HttpServerConfig* config) {
     config->max_connections = 10;
     config->timeout = 30;
     config->static_dir = safe_strdup("./static");
+    config->io_threads = HTTP_DEFAULT_IO_THREADS;
+    config->keepalive_timeout = HTTP_DEFAULT_KEEPALIVE_TIMEOUT;
+    config->api_workers = HTTP_DEFAULT_API_WORKERS;
+    config->api_queue_capacity = HTTP_DEFAULT_API_QUEUE;
+    config->endpoint_limits[API_ANALYSIS] = HTTP_DEFAULT_ANALYSIS_LIMIT;
     
     return 1;
 }
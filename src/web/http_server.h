@@ -3,6 +3,7 @@
 
 #include <time.h>
 #include <stddef.h>
+#include <stdatomic.h>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -47,8 +48,31 @@ typedef struct {
     int header_count;
     char* body;
     int content_length;
+    int keep_alive;                /* 响应后保持连接 (HTTP/1.1默认保持，Connection: close除外) */
 } HttpRequest;
 
+/* 分块响应缓冲区：处理函数直接追加，发送时用sendmsg分散写出，不拼接成连续内存 */
+#define RESPONSE_CHUNK_SIZE 16384          /* 新块的最小容量 */
+#define RESPONSE_MAX_IOV 64                /* 每次sendmsg最多的块数 */
+
+typedef struct ResponseChunk {
+    struct ResponseChunk* next;
+    char* data;                    /* 块数据 (指向storage，或接管的外部内存) */
+    size_t offset;                 /* 已发送 (消费) 的字节数 */
+    size_t length;                 /* 已写入的字节数 */
+    size_t capacity;               /* 可写入的容量，接管的外部内存不再追加 */
+    int external;                  /* 1: data为接管的外部内存，随块一起释放 */
+    void (*release)(void* owner);  /* 非NULL时data为共享的只读内存，释放块时改为调用release(owner) */
+    void* owner;
+    char storage[];
+} ResponseChunk;
+
+typedef struct {
+    ResponseChunk* head;
+    ResponseChunk* tail;
+    size_t length;                 /* 未消费的字节总数 */
+} ResponseBuffer;
+
 /* HTTP响应结构 */
 typedef struct {
     int status_code;
@@ -56,6 +80,8 @@ typedef struct {
     char* headers;
     char* body;
     int content_length;
+    int keep_alive;                /* 序列化为Connection: keep-alive，否则为close */
+    ResponseBuffer payload;        /* 分块响应体，非空时代替body */
 } HttpResponse;
 
 /* 前向声明 */
@@ -70,11 +96,128 @@ typedef int (*FileUploadHandler)(const char* filename, const char* data, size_t
 typedef struct {
     int port;
     char* host;
-    int max_connections;
-    int timeout;
+    int max_connections;           /* 同时打开的连接数上限 */
+    int timeout;                   /* 请求读取超时 (秒) */
     char* static_dir;
+    int io_threads;                /* I/O线程数，每个线程一个epoll事件循环 */
+    int keepalive_timeout;         /* 两个请求之间的空闲超时 (秒)，<=0时每个响应后关闭连接 */
+    int api_workers;               /* API工作线程数 */
+    int api_queue_capacity;        /* API请求队列容量，满时直接返回503 */
+    int endpoint_limits[API_ANALYSIS + 1]; /* 各端点排队+执行中的请求上限，<=0不限 (按ApiEndpointType下标) */
 } HttpServerConfig;
 
+/* 连接与事件循环参数 */
+#define HTTP_DEFAULT_IO_THREADS 2
+#define HTTP_DEFAULT_KEEPALIVE_TIMEOUT 5
+#define HTTP_DEFAULT_API_WORKERS 4
+#define HTTP_DEFAULT_API_QUEUE 64
+#define HTTP_DEFAULT_ANALYSIS_LIMIT 2      /* 分析请求耗时长，默认最多2个同时排队或执行 */
+#define HTTP_API_ENDPOINT_COUNT (API_ANALYSIS + 1)
+#define HTTP_READ_CHUNK 8192               /* 每次recv的最小空闲空间 */
+#define HTTP_MAX_HEADER_SIZE 16384         /* 请求行+请求头上限 */
+#define HTTP_MAX_REQUEST_SIZE (1024 * 1024) /* 请求行+请求头+请求体上限 */
+#define HTTP_EPOLL_EVENTS 64               /* 每次epoll_wait处理的事件数 */
+#define HTTP_SWEEP_INTERVAL_MS 1000        /* 超时连接扫描间隔 */
+
+/* 连接状态机 */
+typedef enum {
+    HTTP_CONN_READING = 1,         /* 读取请求，直到请求头和Content-Length指定的请求体完整 */
+    HTTP_CONN_WRITING = 2,         /* 发送响应 (可含多个流水线响应)，期间不再读取新请求 */
+    HTTP_CONN_CLOSED = 3,          /* 已关闭或已移交 (如WebSocket) */
+    HTTP_CONN_PROCESSING = 4       /* API请求在工作线程执行，套接字暂时移出epoll */
+} HttpConnectionState;
+
+struct HttpIoThread;
+struct HttpConnection;
+
+/* 交给工作线程执行的API请求 */
+typedef struct HttpApiJob {
+    struct HttpConnection* conn;   /* 发起请求的连接 (任务完成前不会被释放) */
+    struct HttpIoThread* io;       /* 连接所属I/O线程，结果交回该线程发送 */
+    HttpRequest request;           /* 从连接移交过来的请求 */
+    ApiEndpointType endpoint;
+    int keep_alive;
+    double enqueue_ms;             /* 入队时刻 (毫秒) */
+    ResponseBuffer output;         /* 序列化后的完整响应 */
+    int failed;                    /* 1: 处理失败，output为500响应 */
+    struct HttpApiJob* next;       /* 完成链表 */
+} HttpApiJob;
+
+/* 工作线程池统计 */
+typedef struct {
+    int workers;                   /* 工作线程数 */
+    int queue_depth;               /* 当前排队数 */
+    int max_queue_depth;           /* 历史最大排队数 */
+    int active_workers;            /* 正在执行的线程数 */
+    long submitted;                /* 已入队请求数 */
+    long completed;                /* 已完成请求数 */
+    long rejected;                 /* 因队列满或端点限流被拒绝 (503) 的请求数 */
+    double total_wait_ms;          /* 累计排队时间 */
+    double max_wait_ms;            /* 最长排队时间 */
+    int in_flight[HTTP_API_ENDPOINT_COUNT]; /* 各端点排队+执行中的请求数 */
+} HttpWorkerPoolStats;
+
+/* API工作线程池 (有界环形队列) */
+typedef struct HttpWorkerPool {
+    struct HttpServer* server;
+    pthread_t* threads;
+    int thread_count;
+    int started;                   /* 已启动的线程数 */
+    
+    HttpApiJob** queue;
+    int capacity;
+    int head;
+    int count;
+    int limits[HTTP_API_ENDPOINT_COUNT];
+    int stopping;
+    
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    HttpWorkerPoolStats stats;
+} HttpWorkerPool;
+
+/* 客户端连接 (只由所属I/O线程访问) */
+typedef struct HttpConnection {
+    int fd;
+    HttpConnectionState state;
+    char client_ip[64];
+    int client_port;
+    time_t last_active;            /* 最近一次读写时间，用于超时 */
+    int keep_alive;                /* 0: 当前响应发送完毕后关闭 */
+    int requests_served;           /* 已处理的请求数 */
+    HttpApiJob* pending;           /* 正在工作线程执行的API请求 */
+    
+    HttpRequest request;           /* 每个连接复用的请求/响应对象 */
+    HttpResponse response;
+    
+    char* in;                      /* 接收缓冲区 (末尾预留一个字节放'\0') */
+    size_t in_length;
+    size_t in_capacity;
+    size_t request_length;         /* 当前请求总长度 (头+体)，0表示请求头尚未完整 */
+    
+    ResponseBuffer out;            /* 待发送的响应 (可含多个流水线响应) */
+    
+    struct HttpIoThread* io;
+    struct HttpConnection* prev;
+    struct HttpConnection* next;
+} HttpConnection;
+
+/* I/O线程 (SO_REUSEPORT时每个线程有自己的监听套接字，否则共享一个) */
+typedef struct HttpIoThread {
+    struct HttpServer* server;
+    int index;
+    int epoll_fd;
+    int listen_fd;
+    int wake_fd;                   /* eventfd，停止时唤醒epoll_wait */
+    pthread_t thread;
+    int started;
+    HttpConnection* connections;   /* 本线程的连接链表 */
+    
+    pthread_mutex_t completed_mutex; /* 保护工作线程交回的完成链表 */
+    HttpApiJob* completed;
+    HttpApiJob* completed_tail;
+} HttpIoThread;
+
 /* 服务器统计 */
 typedef struct {
     int total_requests;
@@ -107,28 +250,80 @@ typedef struct {
     time_t end_time;
     int satellite_prn;
     int trajectory_id;
+    int max_points;                /* 轨迹接口返回的最多轨迹点数，<0表示全部 (0使用默认值) */
+    int start_point;               /* 分析的第一个轨迹点下标 */
+    int end_point;                 /* 分析的最后一个轨迹点下标之后一位，<0表示到轨迹末尾 */
 } ApiRequestParams;
 
+/* 分析结果缓存 (组相联，每组ANALYSIS_CACHE_WAYS项，组内LRU替换) */
+#define ANALYSIS_CACHE_SETS 16
+#define ANALYSIS_CACHE_WAYS 4
+
+/* 分析结果缓存键：输入数据版本 + 请求参数哈希 */
+typedef struct {
+    unsigned int ephemeris_version; /* 卫星数据版本 */
+    int trajectory_id;
+    unsigned int trajectory_version;
+    unsigned int geometry_version;
+    unsigned long long fixed_positions_hash; /* 无星历卫星的当前位置哈希 */
+    unsigned long long params_hash; /* 分析范围和遮挡参数的哈希 */
+} AnalysisCacheKey;
+
+/* 引用计数的分析结果JSON：缓存项和正在发送的响应共享同一份内存，命中时不复制 */
+typedef struct {
+    atomic_int refcount;
+    size_t length;
+    char json[];
+} AnalysisCacheBlob;
+
+typedef struct {
+    AnalysisCacheKey key;
+    unsigned long long hash;       /* 键的哈希，0表示空项 */
+    AnalysisCacheBlob* blob;       /* 分析结果JSON (缓存持有一个引用) */
+    unsigned long long last_used;  /* LRU时钟 */
+} AnalysisCacheEntry;
+
+typedef struct {
+    int entries;                   /* 当前缓存项数 */
+    long hits;
+    long misses;
+    long evictions;
+} AnalysisCacheStats;
+
+typedef struct {
+    AnalysisCacheEntry entries[ANALYSIS_CACHE_SETS * ANALYSIS_CACHE_WAYS];
+    unsigned long long clock;
+    AnalysisCacheStats stats;
+    pthread_mutex_t mutex;         /* 多个工作线程并发访问 */
+} AnalysisCache;
+
 /* API响应数据 */
 typedef struct {
     int success;
-    char* message;
-    char* data;
+    char message[256];
+    ResponseBuffer data;           /* 响应数据JSON，处理函数直接追加 */
     int status_code;
     time_t timestamp;
     char error[512];
 } ApiResponseData;
 
 /* HTTP服务器 */
-typedef struct {
+typedef struct HttpServer {
     HttpServerConfig config;
     SystemStatus status;
     SatelliteData* satellite_data;
     FlightTrajectory* trajectory;
     AircraftGeometry* geometry;
-    int server_socket;
-    int is_running;
-    pthread_t server_thread;
+    int server_socket;             /* 第一个监听套接字 */
+    volatile int is_running;
+    
+    /* 事件循环 */
+    HttpIoThread* io_threads;
+    int io_thread_count;
+    int connection_count;          /* 当前打开的连接数，受max_connections限制 */
+    pthread_mutex_t status_mutex;  /* 保护status和connection_count */
+    HttpWorkerPool* worker_pool;   /* API请求工作线程池 */
+    AnalysisCache* analysis_cache; /* /api/analysis结果缓存 */
     
     /* 回调函数 */
     HttpRequestHandler request_handler;
@@ -162,10 +357,14 @@ int http_server_set_handlers(struct HttpServer* server,
 
 HttpRequest* http_request_create();
 void http_request_destroy(HttpRequest* request);
+void http_request_reset(HttpRequest* request);
 HttpResponse* http_response_create();
 void http_response_destroy(HttpResponse* response);
+void http_response_reset(HttpResponse* response);
 int http_request_parse(const char* raw_request, HttpRequest* request);
+ApiEndpointType api_endpoint_from_path(const char* path);
 int http_response_serialize(const HttpResponse* response, char* buffer, int buffer_size);
+int http_response_serialize_chain(HttpResponse* response, ResponseBuffer* out);
 int http_response_set_json(HttpResponse* response, const char* json_data);
 int http_response_set_error(HttpResponse* response, int status_code, const char* message);
 int http_response_set_file(HttpResponse* response, const char* filename);
@@ -186,6 +385,46 @@ int json_serialize_trajectory(const FlightTrajectory* trajectory, char* buffer,
 int json_serialize_analysis(const VisibilityAnalysis* analysis, char* buffer, int buffer_size);
 int json_serialize_status(const SystemStatus* status, char* buffer, int buffer_size);
 
+/* API工作线程池 */
+HttpWorkerPool* http_worker_pool_create(struct HttpServer* server, int thread_count, int capacity,
+                                        const int* endpoint_limits);
+int http_worker_pool_start(HttpWorkerPool* pool);
+void http_worker_pool_destroy(HttpWorkerPool* pool);
+int http_worker_pool_submit(HttpWorkerPool* pool, HttpApiJob* job);
+void http_worker_pool_get_stats(HttpWorkerPool* pool, HttpWorkerPoolStats* stats);
+void http_api_job_destroy(HttpApiJob* job);
+void http_server_complete_job(HttpApiJob* job);
+
+/* 分块响应缓冲区 */
+struct iovec;
+void response_buffer_init(ResponseBuffer* buffer);
+void response_buffer_reset(ResponseBuffer* buffer);
+int response_buffer_append(ResponseBuffer* buffer, const void* data, size_t length);
+int response_buffer_append_string(ResponseBuffer* buffer, const char* text);
+int response_buffer_printf(ResponseBuffer* buffer, const char* format, ...);
+int response_buffer_attach(ResponseBuffer* buffer, char* data, size_t length);
+int response_buffer_attach_shared(ResponseBuffer* buffer, const char* data, size_t length,
+                                  void (*release)(void* owner), void* owner);
+void response_buffer_splice(ResponseBuffer* buffer, ResponseBuffer* source);
+int response_buffer_copy(const ResponseBuffer* buffer, char* out, size_t size);
+char* response_buffer_flatten(const ResponseBuffer* buffer);
+int response_buffer_iovec(const ResponseBuffer* buffer, struct iovec* iov, int max_iov);
+void response_buffer_consume(ResponseBuffer* buffer, size_t length);
+
+/* 分析结果缓存 */
+AnalysisCache* analysis_cache_create(void);
+void analysis_cache_destroy(AnalysisCache* cache);
+void analysis_cache_clear(AnalysisCache* cache);
+void analysis_cache_key_init(AnalysisCacheKey* key, const SatelliteData* satellite_data,
+                             const FlightTrajectory* trajectory, const AircraftGeometry* geometry,
+                             const void* params, size_t params_size);
+AnalysisCacheBlob* analysis_cache_blob_create(const ResponseBuffer* data);
+void analysis_cache_blob_release(void* blob);
+int analysis_cache_blob_attach(ResponseBuffer* buffer, AnalysisCacheBlob* blob);
+AnalysisCacheBlob* analysis_cache_get(AnalysisCache* cache, const AnalysisCacheKey* key);
+int analysis_cache_put(AnalysisCache* cache, const AnalysisCacheKey* key, AnalysisCacheBlob* blob);
+void analysis_cache_get_stats(AnalysisCache* cache, AnalysisCacheStats* stats);
+
 int http_server_config_init(HttpServerConfig* config);
 int http_server_config_validate(const HttpServerConfig* config);
 int system_status_update(SystemStatus* status, const struct HttpServer* server);
@@ -0,0 +1,231 @@
+#include "http_server.h"
+#include "../utils/utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* =================== API工作线程池 =================== */
+
+/* 单调性要求不高，仅用于排队时间统计 */
+static double wall_time_ms(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/**
+ * @brief 创建工作线程池 (线程由http_worker_pool_start启动)
+ * @param server 所属HTTP服务器
+ * @param thread_count 工作线程数
+ * @param capacity 队列容量
+ * @param endpoint_limits 各端点排队+执行中的请求上限 (按ApiEndpointType下标，<=0不限)，NULL不限
+ * @return 线程池，失败返回NULL
+ */
+HttpWorkerPool* http_worker_pool_create(struct HttpServer* server, int thread_count, int capacity,
+                                        const int* endpoint_limits) {
+    if (thread_count <= 0 || capacity <= 0) return NULL;
+
+    HttpWorkerPool* pool = (HttpWorkerPool*)safe_malloc(sizeof(HttpWorkerPool));
+    if (pool == NULL) return NULL;
+    memset(pool, 0, sizeof(HttpWorkerPool));
+
+    pool->server = server;
+    pool->thread_count = thread_count;
+    pool->capacity = capacity;
+    pool->threads = (pthread_t*)safe_malloc(sizeof(pthread_t) * thread_count);
+    pool->queue = (HttpApiJob**)safe_malloc(sizeof(HttpApiJob*) * capacity);
+    if (pool->threads == NULL || pool->queue == NULL) {
+        if (pool->threads) safe_free((void**)&pool->threads);
+        if (pool->queue) safe_free((void**)&pool->queue);
+        safe_free((void**)&pool);
+        return NULL;
+    }
+
+    if (endpoint_limits) {
+        memcpy(pool->limits, endpoint_limits, sizeof(pool->limits));
+    }
+    pool->stats.workers = thread_count;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->not_empty, NULL);
+
+    return pool;
+}
+
+/* 执行API请求并序列化响应；处理失败时生成500响应 */
+static void http_api_job_execute(HttpWorkerPool* pool, HttpApiJob* job) {
+    HttpResponse response;
+    memset(&response, 0, sizeof(HttpResponse));
+    response.status_code = 200;
+
+    int success = api_handle_request(&job->request, &response, pool->server);
+    if (success) {
+        response.keep_alive = job->keep_alive;
+        success = http_response_serialize_chain(&response, &job->output);
+        if (!success) {
+            logger_error(__func__, __FILE__, __LINE__, "响应序列化失败");
+        }
+    } else {
+        logger_error(__func__, __FILE__, __LINE__, "API处理失败");
+    }
+    http_response_reset(&response);
+
+    if (!success) {
+        response_buffer_reset(&job->output);
+        response_buffer_printf(&job->output,
+                               "HTTP/1.1 500 Internal Server Error\r\n"
+                               "Content-Type: text/plain\r\n"
+                               "Connection: %s\r\n"
+                               "Content-Length: 21\r\n"
+                               "\r\n"
+                               "API Processing Failed",
+                               job->keep_alive ? "keep-alive" : "close");
+    }
+    job->failed = !success;
+}
+
+/* 工作线程：取任务、执行、把结果交回连接所属的I/O线程 */
+static void* http_worker_thread(void* arg) {
+    HttpWorkerPool* pool = (HttpWorkerPool*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->mutex);
+        while (pool->count == 0 && !pool->stopping) {
+            pthread_cond_wait(&pool->not_empty, &pool->mutex);
+        }
+        if (pool->stopping) {
+            pthread_mutex_unlock(&pool->mutex);
+            break;
+        }
+
+        HttpApiJob* job = pool->queue[pool->head];
+        pool->head = (pool->head + 1) % pool->capacity;
+        pool->count--;
+
+        double wait_ms = wall_time_ms() - job->enqueue_ms;
+        pool->stats.queue_depth = pool->count;
+        pool->stats.active_workers++;
+        pool->stats.total_wait_ms += wait_ms;
+        if (wait_ms > pool->stats.max_wait_ms) pool->stats.max_wait_ms = wait_ms;
+        pthread_mutex_unlock(&pool->mutex);
+
+        http_api_job_execute(pool, job);
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->stats.active_workers--;
+        pool->stats.completed++;
+        pool->stats.in_flight[job->endpoint]--;
+        pthread_mutex_unlock(&pool->mutex);
+
+        http_server_complete_job(job);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 启动工作线程
+ * @param pool 线程池
+ * @return 至少启动一个线程返回1，否则返回0
+ */
+int http_worker_pool_start(HttpWorkerPool* pool) {
+    if (pool == NULL) return 0;
+
+    for (int i = pool->started; i < pool->thread_count; i++) {
+        if (pthread_create(&pool->threads[i], NULL, http_worker_thread, pool) != 0) {
+            logger_error(__func__, __FILE__, __LINE__, "创建API工作线程失败");
+            break;
+        }
+        pool->started++;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->stats.workers = pool->started;
+    pthread_mutex_unlock(&pool->mutex);
+    return pool->started > 0;
+}
+
+/**
+ * @brief 停止并销毁线程池
+ * @param pool 线程池
+ * @note 正在执行的请求完成后才返回；尚未执行的请求直接丢弃 (其连接随后由I/O线程关闭)
+ */
+void http_worker_pool_destroy(HttpWorkerPool* pool) {
+    if (pool == NULL) return;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->not_empty);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->started; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    while (pool->count > 0) {
+        http_api_job_destroy(pool->queue[pool->head]);
+        pool->head = (pool->head + 1) % pool->capacity;
+        pool->count--;
+    }
+
+    pthread_cond_destroy(&pool->not_empty);
+    pthread_mutex_destroy(&pool->mutex);
+    safe_free((void**)&pool->threads);
+    safe_free((void**)&pool->queue);
+    safe_free((void**)&pool);
+}
+
+/**
+ * @brief 提交API请求
+ * @param pool 线程池
+ * @param job 任务 (接受后由线程池负责，拒绝时仍归调用方)
+ * @return 接受返回1；队列已满、端点达到并发上限或线程池正在停止时返回0，调用方应立即回复503
+ */
+int http_worker_pool_submit(HttpWorkerPool* pool, HttpApiJob* job) {
+    if (pool == NULL || job == NULL || job->endpoint <= 0 || job->endpoint >= HTTP_API_ENDPOINT_COUNT) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    int limit = pool->limits[job->endpoint];
+    if (pool->stopping || pool->count >= pool->capacity ||
+        (limit > 0 && pool->stats.in_flight[job->endpoint] >= limit)) {
+        pool->stats.rejected++;
+        pthread_mutex_unlock(&pool->mutex);
+        return 0;
+    }
+
+    job->enqueue_ms = wall_time_ms();
+    pool->queue[(pool->head + pool->count) % pool->capacity] = job;
+    pool->count++;
+    pool->stats.submitted++;
+    pool->stats.in_flight[job->endpoint]++;
+    pool->stats.queue_depth = pool->count;
+    if (pool->count > pool->stats.max_queue_depth) pool->stats.max_queue_depth = pool->count;
+    pthread_cond_signal(&pool->not_empty);
+    pthread_mutex_unlock(&pool->mutex);
+
+    return 1;
+}
+
+/**
+ * @brief 获取线程池统计快照
+ * @param pool 线程池
+ * @param stats 统计 (输出)
+ */
+void http_worker_pool_get_stats(HttpWorkerPool* pool, HttpWorkerPoolStats* stats) {
+    if (stats == NULL) return;
+    memset(stats, 0, sizeof(HttpWorkerPoolStats));
+    if (pool == NULL) return;
+
+    pthread_mutex_lock(&pool->mutex);
+    *stats = pool->stats;
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void http_api_job_destroy(HttpApiJob* job) {
+    if (job == NULL) return;
+
+    http_request_reset(&job->request);
+    response_buffer_reset(&job->output);
+    safe_free((void**)&job);
+}
@@ -0,0 +1,231 @@
+#include "http_server.h"
+#include "../utils/utils.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+/* =================== 分块响应缓冲区 =================== */
+
+/* 分配一个可写入至少min_capacity字节的块并挂到链尾 */
+static ResponseChunk* response_buffer_grow(ResponseBuffer* buffer, size_t min_capacity) {
+    size_t capacity = min_capacity > RESPONSE_CHUNK_SIZE ? min_capacity : RESPONSE_CHUNK_SIZE;
+    ResponseChunk* chunk = (ResponseChunk*)safe_malloc(sizeof(ResponseChunk) + capacity);
+    if (chunk == NULL) return NULL;
+
+    chunk->next = NULL;
+    chunk->data = chunk->storage;
+    chunk->offset = 0;
+    chunk->length = 0;
+    chunk->capacity = capacity;
+    chunk->external = 0;
+    chunk->release = NULL;
+    chunk->owner = NULL;
+
+    if (buffer->tail) buffer->tail->next = chunk;
+    else buffer->head = chunk;
+    buffer->tail = chunk;
+    return chunk;
+}
+
+static void response_chunk_free(ResponseChunk* chunk) {
+    if (chunk->release) chunk->release(chunk->owner);
+    else if (chunk->external) safe_free((void**)&chunk->data);
+    safe_free((void**)&chunk);
+}
+
+void response_buffer_init(ResponseBuffer* buffer) {
+    if (buffer == NULL) return;
+    memset(buffer, 0, sizeof(ResponseBuffer));
+}
+
+/* 释放所有块，缓冲区回到空状态 */
+void response_buffer_reset(ResponseBuffer* buffer) {
+    if (buffer == NULL) return;
+
+    ResponseChunk* chunk = buffer->head;
+    while (chunk) {
+        ResponseChunk* next = chunk->next;
+        response_chunk_free(chunk);
+        chunk = next;
+    }
+    memset(buffer, 0, sizeof(ResponseBuffer));
+}
+
+/**
+ * @brief 追加数据 (先填满尾块剩余空间，不足时分配新块)
+ * @return 成功返回1，内存不足返回0
+ */
+int response_buffer_append(ResponseBuffer* buffer, const void* data, size_t length) {
+    if (buffer == NULL || (data == NULL && length > 0)) return 0;
+
+    const char* bytes = (const char*)data;
+    ResponseChunk* tail = buffer->tail;
+    if (tail && !tail->external && tail->capacity > tail->length) {
+        size_t space = tail->capacity - tail->length;
+        size_t copied = length < space ? length : space;
+        memcpy(tail->data + tail->length, bytes, copied);
+        tail->length += copied;
+        buffer->length += copied;
+        bytes += copied;
+        length -= copied;
+    }
+
+    if (length > 0) {
+        ResponseChunk* chunk = response_buffer_grow(buffer, length);
+        if (chunk == NULL) return 0;
+        memcpy(chunk->data, bytes, length);
+        chunk->length = length;
+        buffer->length += length;
+    }
+    return 1;
+}
+
+int response_buffer_append_string(ResponseBuffer* buffer, const char* text) {
+    if (text == NULL) return 0;
+    return response_buffer_append(buffer, text, strlen(text));
+}
+
+/**
+ * @brief 格式化后直接写入尾块 (一次格式化的结果不跨块)
+ * @return 成功返回1，格式化失败或内存不足返回0
+ */
+int response_buffer_printf(ResponseBuffer* buffer, const char* format, ...) {
+    if (buffer == NULL || format == NULL) return 0;
+
+    ResponseChunk* tail = buffer->tail;
+    size_t space = tail && !tail->external ? tail->capacity - tail->length : 0;
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(space > 0 ? tail->data + tail->length : NULL, space, format, args);
+    va_end(args);
+    if (written < 0) return 0;
+
+    /* 尾块放不下 (vsnprintf需要额外一个字节放'\0')：在新块中重新格式化 */
+    if ((size_t)written >= space) {
+        tail = response_buffer_grow(buffer, (size_t)written + 1);
+        if (tail == NULL) return 0;
+        va_start(args, format);
+        vsnprintf(tail->data, tail->capacity, format, args);
+        va_end(args);
+    }
+
+    tail->length += (size_t)written;
+    buffer->length += (size_t)written;
+    return 1;
+}
+
+/**
+ * @brief 接管一块堆内存作为独立的块，不复制
+ * @param data safe_malloc分配的内存，成功后由缓冲区释放
+ * @return 成功返回1，失败返回0 (data仍归调用方)
+ */
+int response_buffer_attach(ResponseBuffer* buffer, char* data, size_t length) {
+    return response_buffer_attach_shared(buffer, data, length, NULL, NULL);
+}
+
+/**
+ * @brief 引用共享的只读内存作为独立的块，不复制
+ * @param release 块释放时调用release(owner)，NULL表示data为safe_malloc分配的内存，随块释放
+ * @param owner 传给release的对象 (如引用计数的缓存结果)
+ * @return 成功返回1，失败返回0 (data和owner仍归调用方)
+ */
+int response_buffer_attach_shared(ResponseBuffer* buffer, const char* data, size_t length,
+                                  void (*release)(void* owner), void* owner) {
+    if (buffer == NULL || data == NULL) return 0;
+
+    ResponseChunk* chunk = (ResponseChunk*)safe_malloc(sizeof(ResponseChunk));
+    if (chunk == NULL) return 0;
+
+    chunk->next = NULL;
+    chunk->data = (char*)data;
+    chunk->offset = 0;
+    chunk->length = length;
+    chunk->capacity = length;
+    chunk->external = 1;
+    chunk->release = release;
+    chunk->owner = owner;
+
+    if (buffer->tail) buffer->tail->next = chunk;
+    else buffer->head = chunk;
+    buffer->tail = chunk;
+    buffer->length += length;
+    return 1;
+}
+
+/* 把source的全部块移到buffer末尾，source变为空 */
+void response_buffer_splice(ResponseBuffer* buffer, ResponseBuffer* source) {
+    if (buffer == NULL || source == NULL || source->head == NULL) return;
+
+    if (buffer->tail) buffer->tail->next = source->head;
+    else buffer->head = source->head;
+    buffer->tail = source->tail;
+    buffer->length += source->length;
+    memset(source, 0, sizeof(ResponseBuffer));
+}
+
+/**
+ * @brief 把未消费的数据复制到连续内存并以'\0'结尾
+ * @return 写入的字节数，空间不足返回-1
+ */
+int response_buffer_copy(const ResponseBuffer* buffer, char* out, size_t size) {
+    if (buffer == NULL || out == NULL || buffer->length >= size) return -1;
+
+    size_t written = 0;
+    for (const ResponseChunk* chunk = buffer->head; chunk; chunk = chunk->next) {
+        memcpy(out + written, chunk->data + chunk->offset, chunk->length - chunk->offset);
+        written += chunk->length - chunk->offset;
+    }
+    out[written] = '\0';
+    return (int)written;
+}
+
+/* 复制为以'\0'结尾的字符串 (调用方释放)，用于需要连续内存的场合 */
+char* response_buffer_flatten(const ResponseBuffer* buffer) {
+    if (buffer == NULL) return NULL;
+
+    char* text = (char*)safe_malloc(buffer->length + 1);
+    if (text == NULL) return NULL;
+    response_buffer_copy(buffer, text, buffer->length + 1);
+    return text;
+}
+
+/**
+ * @brief 为sendmsg/writev填充未消费数据的iovec
+ * @return 填充的iovec数量 (最多max_iov个)
+ */
+int response_buffer_iovec(const ResponseBuffer* buffer, struct iovec* iov, int max_iov) {
+    if (buffer == NULL || iov == NULL) return 0;
+
+    int count = 0;
+    for (const ResponseChunk* chunk = buffer->head; chunk && count < max_iov; chunk = chunk->next) {
+        if (chunk->length == chunk->offset) continue;
+        iov[count].iov_base = chunk->data + chunk->offset;
+        iov[count].iov_len = chunk->length - chunk->offset;
+        count++;
+    }
+    return count;
+}
+
+/* 消费 (丢弃) 开头的length字节，释放已全部消费的块 */
+void response_buffer_consume(ResponseBuffer* buffer, size_t length) {
+    if (buffer == NULL) return;
+    if (length > buffer->length) length = buffer->length;
+    buffer->length -= length;
+
+    while (buffer->head) {
+        ResponseChunk* chunk = buffer->head;
+        size_t available = chunk->length - chunk->offset;
+        if (length < available || (length == available && chunk == buffer->tail && !chunk->external)) {
+            /* 尾块留着继续追加 */
+            chunk->offset += length;
+            break;
+        }
+        length -= available;
+        buffer->head = chunk->next;
+        if (buffer->head == NULL) buffer->tail = NULL;
+        response_chunk_free(chunk);
+    }
+}
@@ -11,14 +11,33 @@
 #include "../../src/utils/utils.h"
 #include "../../src/web/http_server.h"
 
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
 /* 前向声明测试函数 */
 void TestSatelliteDataCreate(CuTest* tc);
 void TestSatelliteDataAdd(CuTest* tc);
 void TestSatelliteDataFind(CuTest* tc);
 void TestSatellitePositionCalculate(CuTest* tc);
+void TestSatelliteEphemerisPropagate(CuTest* tc);
+void TestSatelliteEphemerisBeforeToe(CuTest* tc);
+void TestSatelliteEphemerisBatch(CuTest* tc);
+void TestSatellitePropagatorWarmStart(CuTest* tc);
+void TestEphemerisCache(CuTest* tc);
 void TestSatelliteVisibilityCalculate(CuTest* tc);
+void TestReceiverFrameVisibilityBatch(CuTest* tc);
 void TestRinexHeaderParse(CuTest* tc);
 void TestRinexDataParse(CuTest* tc);
+void TestRinexNavParse(CuTest* tc);
+void TestEphemerisStore(CuTest* tc);
+void TestEphemerisSnapshot(CuTest* tc);
+void TestRinexIngestFiles(CuTest* tc);
 
 void TestAircraftTrajectoryCreate(CuTest* tc);
 void TestAircraftTrajectoryAddPoint(CuTest* tc);
@@ -30,10 +49,22 @@ void TestAircraftStateValidate(CuTest* tc);
 void TestObstructionCalculate(CuTest* tc);
 void TestVisibilityAnalyze(CuTest* tc);
 void TestBatchObstructionCalculate(CuTest* tc);
+void TestTransformedGeometryReuse(CuTest* tc);
+void TestMultiAntennaObstruction(CuTest* tc);
+void TestTrajectoryObstructionAnalysis(CuTest* tc);
+void TestTrajectoryAnalysisBeforeToe(CuTest* tc);
+void TestComponentTransformCache(CuTest* tc);
+void TestGeometryBvh(CuTest* tc);
+void TestRayPacket(CuTest* tc);
+void TestObstructionCoherence(CuTest* tc);
+void TestTriangleMeshModel(CuTest* tc);
+void TestObstructionMask(CuTest* tc);
+void TestObstructionMaskFile(CuTest* tc);
 void TestVector3DOperations(CuTest* tc);
 void TestRayBoxIntersection(CuTest* tc);
 
 void TestUtilsMath(CuTest* tc);
+void TestFastMathAccuracy(CuTest* tc);
 void TestUtilsTime(CuTest* tc);
 void TestUtilsCoordinate(CuTest* tc);
 void TestUtilsString(CuTest* tc);
@@ -44,9 +75,14 @@ void TestUtilsLogger(CuTest* tc);
 
 void TestWebServerCreate(CuTest* tc);
 void TestWebServerStart(CuTest* tc);
+void TestHttpServerReactor(CuTest* tc);
+void TestHttpKeepAlive(CuTest* tc);
+void TestHttpWorkerPool(CuTest* tc);
 void TestHttpRequestParse(CuTest* tc);
 void TestHttpResponseSerialize(CuTest* tc);
 void TestApiHandleRequest(CuTest* tc);
+void TestApiAnalysisCache(CuTest* tc);
+void TestResponseBuffer(CuTest* tc);
 void TestJsonSerialize(CuTest* tc);
 
 void TestIntegrationSatelliteAircraft(CuTest* tc);
@@ -64,9 +100,19 @@ CuSuite* CuGetSuite() {
     SUITE_ADD_TEST(suite, TestSatelliteDataAdd);
     SUITE_ADD_TEST(suite, TestSatelliteDataFind);
     SUITE_ADD_TEST(suite, TestSatellitePositionCalculate);
+    SUITE_ADD_TEST(suite, TestSatelliteEphemerisPropagate);
+    SUITE_ADD_TEST(suite, TestSatelliteEphemerisBeforeToe);
+    SUITE_ADD_TEST(suite, TestSatelliteEphemerisBatch);
+    SUITE_ADD_TEST(suite, TestSatellitePropagatorWarmStart);
+    SUITE_ADD_TEST(suite, TestEphemerisCache);
     SUITE_ADD_TEST(suite, TestSatelliteVisibilityCalculate);
+    SUITE_ADD_TEST(suite, TestReceiverFrameVisibilityBatch);
     SUITE_ADD_TEST(suite, TestRinexHeaderParse);
     SUITE_ADD_TEST(suite, TestRinexDataParse);
+    SUITE_ADD_TEST(suite, TestRinexNavParse);
+    SUITE_ADD_TEST(suite, TestEphemerisStore);
+    SUITE_ADD_TEST(suite, TestEphemerisSnapshot);
+    SUITE_ADD_TEST(suite, TestRinexIngestFiles);
     
     /* 飞机模块测试 */
     SUITE_ADD_TEST(suite, TestAircraftTrajectoryCreate);
@@ -80,11 +126,23 @@ CuSuite* CuGetSuite() {
     SUITE_ADD_TEST(suite, TestObstructionCalculate);
     SUITE_ADD_TEST(suite, TestVisibilityAnalyze);
     SUITE_ADD_TEST(suite, TestBatchObstructionCalculate);
+    SUITE_ADD_TEST(suite, TestTransformedGeometryReuse);
+    SUITE_ADD_TEST(suite, TestMultiAntennaObstruction);
+    SUITE_ADD_TEST(suite, TestTrajectoryObstructionAnalysis);
+    SUITE_ADD_TEST(suite, TestTrajectoryAnalysisBeforeToe);
+    SUITE_ADD_TEST(suite, TestComponentTransformCache);
+    SUITE_ADD_TEST(suite, TestGeometryBvh);
+    SUITE_ADD_TEST(suite, TestRayPacket);
+    SUITE_ADD_TEST(suite, TestObstructionCoherence);
+    SUITE_ADD_TEST(suite, TestTriangleMeshModel);
+    SUITE_ADD_TEST(suite, TestObstructionMask);
+    SUITE_ADD_TEST(suite, TestObstructionMaskFile);
     SUITE_ADD_TEST(suite, TestVector3DOperations);
     SUITE_ADD_TEST(suite, TestRayBoxIntersection);
     
     /* 工具模块测试 */
     SUITE_ADD_TEST(suite, TestUtilsMath);
+    SUITE_ADD_TEST(suite, TestFastMathAccuracy);
     SUITE_ADD_TEST(suite, TestUtilsTime);
     SUITE_ADD_TEST(suite, TestUtilsCoordinate);
     SUITE_ADD_TEST(suite, TestUtilsString);
@@ -96,9 +154,14 @@ CuSuite* CuGetSuite() {
     /* Web模块测试 */
     SUITE_ADD_TEST(suite, TestWebServerCreate);
     SUITE_ADD_TEST(suite, TestWebServerStart);
+    SUITE_ADD_TEST(suite, TestHttpServerReactor);
+    SUITE_ADD_TEST(suite, TestHttpKeepAlive);
+    SUITE_ADD_TEST(suite, TestHttpWorkerPool);
     SUITE_ADD_TEST(suite, TestHttpRequestParse);
     SUITE_ADD_TEST(suite, TestHttpResponseSerialize);
     SUITE_ADD_TEST(suite, TestApiHandleRequest);
+    SUITE_ADD_TEST(suite, TestApiAnalysisCache);
+    SUITE_ADD_TEST(suite, TestResponseBuffer);
     SUITE_ADD_TEST(suite, TestJsonSerialize);
     
     /* 集成测试 */
@@ -170,6 +233,264 @@ void TestSatellitePositionCalculate(CuTest* tc) {
     CuAssertIntEquals(tc, 1, sat.is_valid);
 }
 
+void TestSatelliteEphemerisPropagate(CuTest* tc) {
+    Satellite sat = {0};
+    sat.prn = 1;
+    sat.system = SATELLITE_SYSTEM_BEIDOU;
+    sat.is_valid = 1;
+    sat.valid_time = 1700000000;
+    
+    /* 设置基本的轨道参数 */
+    sat.orbit.toe = 1000.0;
+    sat.orbit.sqrt_a = 5153.8;
+    sat.orbit.e = 0.01;
+    sat.orbit.i0 = 0.9;
+    sat.orbit.omega0 = 1.0;
+    sat.orbit.omega = 2.0;
+    sat.orbit.m0 = 0.5;
+    
+    SatelliteEphemeris ephemeris;
+    CuAssertIntEquals(tc, 1, satellite_ephemeris_prepare(&sat, &ephemeris));
+    SatellitePosition pos;
+    CuAssertIntEquals(tc, 1, satellite_ephemeris_propagate(&ephemeris, 1700000600.0, &pos));
+    
+    /* 带全部摄动和调和改正项时，与原逐项公式 (atan2求真近点角、逐项sin/cos) 算出的固定参考值一致 */
+    Satellite perturbed = sat;
+    perturbed.orbit.delta_n = 4.5e-9;
+    perturbed.orbit.omega_dot = -8.0e-9;
+    perturbed.orbit.i_dot = 2.0e-10;
+    perturbed.orbit.cuc = -1.2e-6;
+    perturbed.orbit.cus = 7.5e-6;
+    perturbed.orbit.crc = 230.0;
+    perturbed.orbit.crs = -25.0;
+    perturbed.orbit.cic = 1.1e-7;
+    perturbed.orbit.cis = -6.0e-8;
+    SatelliteEphemeris perturbed_ephemeris;
+    CuAssertIntEquals(tc, 1, satellite_ephemeris_prepare(&perturbed, &perturbed_ephemeris));
+    
+    SatellitePosition reference;
+    CuAssertIntEquals(tc, 1, satellite_ephemeris_propagate(&perturbed_ephemeris, 1700000600.0, &reference));
+    CuAssertDblEquals(tc, -20850188.027099, reference.x, 1e-3);
+    CuAssertDblEquals(tc, -12062953.390614, reference.y, 1e-3);
+    CuAssertDblEquals(tc, 10659787.697945, reference.z, 1e-3);
+    CuAssertIntEquals(tc, 1, satellite_ephemeris_propagate(&perturbed_ephemeris, 1700005400.0, &reference));
+    CuAssertDblEquals(tc, -21124253.082694, reference.x, 1e-3);
+    CuAssertDblEquals(tc, -15615342.720917, reference.y, 1e-3);
+    CuAssertDblEquals(tc, -3413537.138776, reference.z, 1e-3);
+    
+    /* 无调和改正时轨道半径应在近地点和远地点之间 */
+    double a = sat.orbit.sqrt_a * sat.orbit.sqrt_a;
+    double r = sqrt(pos.x * pos.x + pos.y * pos.y + pos.z * pos.z);
+    CuAssertTrue(tc, r >= a * (1 - sat.orbit.e) - 1e-3 && r <= a * (1 + sat.orbit.e) + 1e-3);
+    
+    /* 无效轨道参数 */
+    sat.orbit.sqrt_a = 0.0;
+    CuAssertIntEquals(tc, 0, satellite_ephemeris_prepare(&sat, &ephemeris));
+}
+
+void TestSatelliteEphemerisBeforeToe(CuTest* tc) {
+    SatelliteData* data = satellite_data_create(4);
+    Satellite sat = {0};
+    sat.prn = 1;
+    sat.system = SATELLITE_SYSTEM_GPS;
+    sat.is_valid = 1;
+    sat.valid_time = 1700007200;
+    sat.orbit.toe = 7200.0;
+    sat.orbit.sqrt_a = 5153.8;
+    sat.orbit.e = 0.01;
+    sat.orbit.i0 = 0.95;
+    sat.orbit.omega0 = 1.0;
+    sat.orbit.omega = 2.0;
+    sat.orbit.m0 = 0.5;
+    sat.orbit.omega_dot = -8e-9;
+    satellite_data_add(data, &sat);
+    
+    SatelliteEphemeris ephemeris;
+    CuAssertIntEquals(tc, 1, satellite_ephemeris_prepare(&sat, &ephemeris));
+    
+    /* toe之前的时刻应向后传播，而不是停在toe处的位置 */
+    SatellitePosition at_toe, before_30, before_50;
+    CuAssertIntEquals(tc, 1, satellite_ephemeris_propagate(&ephemeris, 1700007200.0, &at_toe));
+    CuAssertIntEquals(tc, 1, satellite_ephemeris_propagate(&ephemeris, 1700007200.0 - 1800.0, &before_30));
+    CuAssertIntEquals(tc, 1, satellite_ephemeris_propagate(&ephemeris, 1700007200.0 - 3000.0, &before_50));
+    
+    double d30 = sqrt(pow(before_30.x - at_toe.x, 2) + pow(before_30.y - at_toe.y, 2) +
+                      pow(before_30.z - at_toe.z, 2));
+    double d50 = sqrt(pow(before_50.x - at_toe.x, 2) + pow(before_50.y - at_toe.y, 2) +
+                      pow(before_50.z - at_toe.z, 2));
+    CuAssertTrue(tc, d30 > 5.0e6);
+    CuAssertTrue(tc, d50 > d30);
+    
+    /* 反向传播的位置仍应在近地点和远地点之间 */
+    double a = sat.orbit.sqrt_a * sat.orbit.sqrt_a;
+    double r = sqrt(before_50.x * before_50.x + before_50.y * before_50.y + before_50.z * before_50.z);
+    CuAssertTrue(tc, r >= a * (1 - sat.orbit.e) - 1e-3 && r <= a * (1 + sat.orbit.e) + 1e-3);
+    
+    /* 批量内核在toe之前也应与标量结果一致 */
+    SatelliteEphemerisBatch* batch = satellite_ephemeris_batch_create(data);
+    CuAssertPtrNotNull(tc, batch);
+    CuAssertIntEquals(tc, 1, satellite_ephemeris_batch_propagate(batch, 1700007200.0 - 3000.0));
+    CuAssertDblEquals(tc, before_50.x, batch->x[0], 1e-3);
+    CuAssertDblEquals(tc, before_50.y, batch->y[0], 1e-3);
+    CuAssertDblEquals(tc, before_50.z, batch->z[0], 1e-3);
+    
+    satellite_ephemeris_batch_destroy(batch);
+    satellite_data_destroy(data);
+}
+
+void TestSatelliteEphemerisBatch(CuTest* tc) {
+    SatelliteData* data = satellite_data_create(10);
+    
+    /* 7颗卫星 (非SIMD宽度整数倍)，最后一颗离心率超限走标量路径 */
+    for (int i = 0; i < 7; i++) {
+        Satellite sat = {0};
+        sat.prn = i + 1;
+        sat.system = SATELLITE_SYSTEM_BEIDOU;
+        sat.is_valid = 1;
+        sat.valid_time = 1700000000;
+        sat.orbit.toe = 1000.0 * i;
+        sat.orbit.sqrt_a = 5153.8 + 10.0 * i;
+        sat.orbit.e = (i == 6) ? 0.3 : 0.002 + 0.01 * i;
+        sat.orbit.i0 = 0.9 + 0.01 * i;
+        sat.orbit.omega0 = -3.0 + 0.9 * i;
+        sat.orbit.omega = 2.0 - 0.7 * i;
+        sat.orbit.m0 = -3.0 + 1.1 * i;
+        sat.orbit.cus = 1e-5;
+        sat.orbit.crs = 20.0;
+        sat.orbit.cic = 1e-7;
+        sat.orbit.i_dot = 1e-10;
+        satellite_data_add(data, &sat);
+    }
+    
+    SatelliteEphemerisBatch* batch = satellite_ephemeris_batch_create(data);
+    CuAssertPtrNotNull(tc, batch);
+    CuAssertIntEquals(tc, 7, batch->count);
+    CuAssertIntEquals(tc, 7, satellite_ephemeris_batch_propagate(batch, 1700003600.0));
+    
+    /* 批量结果应与逐颗传播一致 */
+    for (int i = 0; i < batch->count; i++) {
+        SatellitePosition pos;
+        satellite_ephemeris_propagate(&batch->ephemerides[i], 1700003600.0, &pos);
+        CuAssertDblEquals(tc, pos.x, batch->x[i], 1e-3);
+        CuAssertDblEquals(tc, pos.y, batch->y[i], 1e-3);
+        CuAssertDblEquals(tc, pos.z, batch->z[i], 1e-3);
+        CuAssertDblEquals(tc, pos.vx, batch->vx[i], 1e-6);
+        CuAssertDblEquals(tc, pos.vz, batch->vz[i], 1e-6);
+    }
+    satellite_ephemeris_batch_destroy(batch);
+    
+    /* 便捷接口写回卫星数组；批量星历跨历元复用，星历参考时刻保持不变 */
+    batch = satellite_ephemeris_batch_create(data);
+    unsigned int version = data->version;
+    time_t epochs[] = {1700003600, 1700007200, 1699998200};
+    for (int k = 0; k < 3; k++) {
+        CuAssertIntEquals(tc, 7, satellite_data_propagate_batch(data, batch, epochs[k]));
+        Satellite direct = data->satellites[2];
+        CuAssertIntEquals(tc, 1, satellite_position_calculate(&direct, epochs[k]));
+        CuAssertDblEquals(tc, direct.pos.x, data->satellites[2].pos.x, 1e-3);
+        CuAssertDblEquals(tc, direct.pos.z, data->satellites[2].pos.z, 1e-3);
+        CuAssertTrue(tc, data->satellites[2].valid_time == 1700000000);
+        CuAssertTrue(tc, direct.valid_time == 1700000000);
+    }
+    CuAssertTrue(tc, data->version == version);
+    CuAssertIntEquals(tc, 0, satellite_data_propagate_batch(data, NULL, 1700003600));
+    satellite_ephemeris_batch_destroy(batch);
+    
+    satellite_data_destroy(data);
+}
+
+void TestSatellitePropagatorWarmStart(CuTest* tc) {
+    Satellite sat = {0};
+    sat.prn = 5;
+    sat.system = SATELLITE_SYSTEM_BEIDOU;
+    sat.is_valid = 1;
+    sat.valid_time = 1700000000;
+    sat.orbit.toe = 1000.0;
+    sat.orbit.sqrt_a = 5153.8;
+    sat.orbit.e = 0.02;
+    sat.orbit.i0 = 0.9;
+    sat.orbit.omega0 = 1.0;
+    sat.orbit.omega = 2.0;
+    sat.orbit.m0 = 6.2;  /* 靠近2π，步进过程中平近点角会回绕 */
+    
+    SatellitePropagator propagator;
+    CuAssertIntEquals(tc, 1, satellite_propagator_init(&propagator, &sat));
+    
+    /* 以1秒步长顺序传播，结果应与冷启动求解一致 */
+    for (int k = 0; k < 600; k++) {
+        double t = 1700000000.0 + k;
+        SatellitePosition warm, cold;
+        CuAssertIntEquals(tc, 1, satellite_propagator_step(&propagator, t, &warm));
+        satellite_ephemeris_propagate(&propagator.ephemeris, t, &cold);
+        CuAssertDblEquals(tc, cold.x, warm.x, 1e-6);
+        CuAssertDblEquals(tc, cold.y, warm.y, 1e-6);
+        CuAssertDblEquals(tc, cold.z, warm.z, 1e-6);
+        if (k > 0) {
+            CuAssertTrue(tc, propagator.last_iterations <= 2);
+        }
+    }
+    CuAssertTrue(tc, propagator.solves == 600);
+    
+    /* 重置后从E=M冷启动 */
+    satellite_propagator_reset(&propagator);
+    CuAssertIntEquals(tc, 0, propagator.has_state);
+    CuAssertTrue(tc, propagator.iterations == 0);
+}
+
+void TestEphemerisCache(CuTest* tc) {
+    Satellite sat = {0};
+    sat.prn = 3;
+    sat.system = SATELLITE_SYSTEM_BEIDOU;
+    sat.is_valid = 1;
+    sat.valid_time = 1699999200;  /* 与900秒窗口边界对齐 */
+    sat.orbit.toe = 1000.0;
+    sat.orbit.sqrt_a = 5153.8;
+    sat.orbit.e = 0.01;
+    sat.orbit.i0 = 0.9;
+    sat.orbit.omega0 = 1.0;
+    sat.orbit.omega = 2.0;
+    sat.orbit.m0 = 0.5;
+    sat.orbit.crs = 20.0;
+    
+    EphemerisCacheConfig config;
+    ephemeris_cache_config_default(&config);
+    config.tolerance = 1e-3;
+    EphemerisCache* cache = ephemeris_cache_create(&config);
+    CuAssertPtrNotNull(tc, cache);
+    
+    SatelliteEphemeris ephemeris;
+    CuAssertIntEquals(tc, 1, satellite_ephemeris_prepare(&sat, &ephemeris));
+    
+    /* 1小时内以0.7秒步长查询，插值结果应在误差上限内 */
+    double max_error = 0.0;
+    int steps = 0;
+    for (double t = 1699999200.0; t < 1700002800.0; t += 0.7, steps++) {
+        SatellitePosition cached, direct;
+        CuAssertIntEquals(tc, 1, ephemeris_cache_propagate(cache, &ephemeris, t, &cached));
+        satellite_ephemeris_propagate(&ephemeris, t, &direct);
+        double dx = cached.x - direct.x;
+        double dy = cached.y - direct.y;
+        double dz = cached.z - direct.z;
+        double error = sqrt(dx * dx + dy * dy + dz * dz);
+        if (error > max_error) max_error = error;
+        CuAssertDblEquals(tc, direct.vx, cached.vx, 1e-3);
+    }
+    CuAssertTrue(tc, max_error <= config.tolerance);
+    
+    /* 大部分查询应命中已拟合窗口 */
+    EphemerisCacheStats stats;
+    ephemeris_cache_get_stats(cache, &stats);
+    CuAssertTrue(tc, stats.queries == steps);
+    CuAssertTrue(tc, stats.hits > stats.queries - 10);
+    CuAssertTrue(tc, stats.direct == 0);
+    
+    /* 无效配置 */
+    config.degree = 0;
+    CuAssertTrue(tc, ephemeris_cache_create(&config) == NULL);
+    
+    ephemeris_cache_destroy(cache);
+}
+
 void TestSatelliteVisibilityCalculate(CuTest* tc) {
     Satellite sat = {0};
     sat.prn = 1;
@@ -191,6 +512,51 @@ void TestSatelliteVisibilityCalculate(CuTest* tc) {
     CuAssertIntEquals(tc, 1, visibility.prn);
 }
 
+void TestReceiverFrameVisibilityBatch(CuTest* tc) {
+    SatelliteData* data = satellite_data_create(10);
+    double positions[4][3] = {
+        {-2.2e7, 1.2e7, 1.5e7},
+        {1000000.0, 2000000.0, 3000000.0},
+        {2.0e7, -1.0e7, 1.0e7},
+        {-1.0e7, 2.2e7, 1.8e7}
+    };
+    for (int i = 0; i < 4; i++) {
+        Satellite sat = {0};
+        sat.prn = i + 1;
+        sat.system = SATELLITE_SYSTEM_BEIDOU;
+        sat.is_valid = (i != 2);  /* 第3颗无效，不参与批量计算 */
+        sat.pos.x = positions[i][0];
+        sat.pos.y = positions[i][1];
+        sat.pos.z = positions[i][2];
+        satellite_data_add(data, &sat);
+    }
+    
+    ReceiverFrame frame;
+    CuAssertIntEquals(tc, 1, receiver_frame_init(&frame, 39.9, 116.4, 100.0));
+    CuAssertIntEquals(tc, 0, receiver_frame_init(&frame, 95.0, 116.4, 100.0));
+    CuAssertIntEquals(tc, 1, receiver_frame_init(&frame, 39.9, 116.4, 100.0));
+    
+    SatelliteVisibilityBatch* batch = satellite_visibility_batch_create(10);
+    CuAssertPtrNotNull(tc, batch);
+    CuAssertIntEquals(tc, 3, receiver_frame_visibility_batch(&frame, data, batch));
+    
+    /* 批量结果应与逐颗计算一致 */
+    for (int i = 0; i < batch->count; i++) {
+        Satellite* sat = satellite_data_find(data, batch->prn[i]);
+        SatelliteVisibility visibility;
+        CuAssertIntEquals(tc, 1, satellite_visibility_calculate(sat, 39.9, 116.4, 100.0, &visibility));
+        CuAssertDblEquals(tc, visibility.elevation, batch->elevation[i], 1e-9);
+        CuAssertDblEquals(tc, visibility.azimuth, batch->azimuth[i], 1e-9);
+        CuAssertDblEquals(tc, visibility.distance, batch->distance[i], 1e-6);
+        CuAssertDblEquals(tc, visibility.signal_strength, batch->signal_strength[i], 1e-9);
+        CuAssertIntEquals(tc, visibility.is_visible, batch->is_visible[i]);
+    }
+    CuAssertIntEquals(tc, 4, batch->prn[2]);
+    
+    satellite_visibility_batch_destroy(batch);
+    satellite_data_destroy(data);
+}
+
 void TestRinexHeaderParse(CuTest* tc) {
     /* 这个测试需要实际的RINEX文件 */
     RinexHeader header;
@@ -212,6 +578,250 @@ void TestRinexDataParse(CuTest* tc) {
     satellite_data_destroy(data);
 }
 
+/* RINEX 3导航文件样例: GPS、GLONASS(跳过)和北斗各一条 */
+static const char* TEST_RINEX_NAV =
+        "     3.04           N: GNSS NAV DATA    M: MIXED            RINEX VERSION / TYPE\n"
+        "                                                            END OF HEADER\n"
+        "G01 2020 01 01 00 00 00-1.234567890123D-04-1.136868377216D-12 0.000000000000D+00\n"
+        "     1.200000000000D+01-1.234375000000D+01 4.123456789012D-09 1.234567890123D+00\n"
+        "    -6.780000000000D-07 8.123456789012D-03 7.890000000000D-06 5.153712345678D+03\n"
+        "     2.592000000000D+05 1.234567890123D-07 2.123456789012D+00-3.456789012345D-08\n"
+        "     9.612345678901D-01 2.345678901234D+02 6.543210987654D-01-8.123456789012D-09\n"
+        "    -1.234567890123D-10 1.000000000000D+00 2.086000000000D+03 0.000000000000D+00\n"
+        "     2.000000000000D+00 0.000000000000D+00 5.122274160385D-09 1.200000000000D+01\n"
+        "     2.520180000000D+05 4.000000000000D+00\n"
+        "R05 2020 01 01 00 15 00 1.000000000000D-05 0.000000000000D+00 0.000000000000D+00\n"
+        "     1.000000000000D+04 1.000000000000D+00 0.000000000000D+00 0.000000000000D+00\n"
+        "     1.000000000000D+04 1.000000000000D+00 0.000000000000D+00 1.000000000000D+00\n"
+        "     1.000000000000D+04 1.000000000000D+00 0.000000000000D+00 0.000000000000D+00\n"
+        "C07 2020 01 01 00 00 00 2.500000000000D-04 1.000000000000D-11 0.000000000000D+00\n"
+        "     1.000000000000D+00 1.002500000000D+02 1.000000000000D-09-2.500000000000D+00\n"
+        "     1.000000000000D-06 4.500000000000D-03 2.000000000000D-06 6.493500000000D+03\n"
+        "     2.592000000000D+05 1.000000000000D-08-1.200000000000D+00 2.000000000000D-08\n"
+        "     9.500000000000D-01 1.505000000000D+02-2.100000000000D+00-7.000000000000D-09\n"
+        "     1.000000000000D-10 0.000000000000D+00 7.300000000000D+02 0.000000000000D+00\n"
+        "     2.000000000000D+00 0.000000000000D+00 1.000000000000D-09 0.000000000000D+00\n"
+        "     2.592000000000D+05 0.000000000000D+00\n";
+
+static int collect_nav_record(const Satellite* satellite, void* user_data) {
+    SatelliteData* data = (SatelliteData*)user_data;
+    data->satellites[data->satellite_count++] = *satellite;
+    return 1;
+}
+
+void TestRinexNavParse(CuTest* tc) {
+    SatelliteData* data = satellite_data_create(10);
+    RinexNavInfo info;
+    
+    int result = rinex_nav_parse_buffer(TEST_RINEX_NAV, strlen(TEST_RINEX_NAV),
+                                        collect_nav_record, data, &info);
+    CuAssertIntEquals(tc, 1, result);
+    CuAssertIntEquals(tc, 2, info.records);
+    CuAssertIntEquals(tc, 1, info.skipped);
+    CuAssertIntEquals(tc, 0, info.errors);
+    CuAssertIntEquals(tc, 2, data->satellite_count);
+    
+    /* GPS记录: D指数字段、负号和时间换算 */
+    Satellite* gps = &data->satellites[0];
+    CuAssertIntEquals(tc, SATELLITE_SYSTEM_GPS, gps->system);
+    CuAssertIntEquals(tc, 1, gps->prn);
+    CuAssertDblEquals(tc, -1.234567890123e-4, gps->clock.a0, 1e-18);
+    CuAssertDblEquals(tc, -12.34375, gps->orbit.crs, 0.0);
+    CuAssertDblEquals(tc, 8.123456789012e-3, gps->orbit.e, 1e-17);
+    CuAssertDblEquals(tc, 5153.712345678, gps->orbit.sqrt_a, 1e-9);
+    CuAssertDblEquals(tc, 259200.0, gps->orbit.toe, 0.0);
+    CuAssertDblEquals(tc, -8.123456789012e-9, gps->orbit.omega_dot, 1e-22);
+    CuAssertTrue(tc, gps->valid_time == (time_t)1577836782);  /* 2020-01-01 00:00:00 GPST */
+    CuAssertIntEquals(tc, 1, gps->is_valid);
+    
+    /* 北斗记录使用BDT周 */
+    Satellite* bds = &data->satellites[1];
+    CuAssertIntEquals(tc, SATELLITE_SYSTEM_BEIDOU, bds->system);
+    CuAssertIntEquals(tc, 7, bds->prn);
+    CuAssertTrue(tc, bds->valid_time == (time_t)1577836796);
+    
+    /* 文件加载: 只保留指定系统，同一卫星的多组星历按查询时刻选择 */
+    char nav_text[8192];
+    snprintf(nav_text, sizeof(nav_text), "%s%s", TEST_RINEX_NAV,
+             "C07 2020 01 01 02 00 00 2.500000000000D-04 1.000000000000D-11 0.000000000000D+00\n"
+             "     1.000000000000D+00 1.002500000000D+02 1.000000000000D-09-2.400000000000D+00\n"
+             "     1.000000000000D-06 4.500000000000D-03 2.000000000000D-06 6.493500000000D+03\n"
+             "     2.664000000000D+05 1.000000000000D-08-1.200000000000D+00 2.000000000000D-08\n"
+             "     9.500000000000D-01 1.505000000000D+02-2.100000000000D+00-7.000000000000D-09\n"
+             "     1.000000000000D-10 0.000000000000D+00 7.300000000000D+02 0.000000000000D+00\n"
+             "     2.000000000000D+00 0.000000000000D+00 1.000000000000D-09 0.000000000000D+00\n"
+             "     2.664000000000D+05 0.000000000000D+00\n");
+    file_write_text("test_rinex_nav.rnx", nav_text);
+    CuAssertIntEquals(tc, 1, rinex_nav_load("test_rinex_nav.rnx", SATELLITE_SYSTEM_BEIDOU,
+                                            1577836796 + 3600, data));
+    CuAssertIntEquals(tc, 7, data->satellites[0].prn);
+    CuAssertTrue(tc, data->satellites[0].valid_time == (time_t)1577836796);
+    CuAssertIntEquals(tc, 1, rinex_nav_load("test_rinex_nav.rnx", SATELLITE_SYSTEM_BEIDOU,
+                                            1577843996 + 60, data));
+    CuAssertTrue(tc, data->satellites[0].valid_time == (time_t)1577843996);
+    CuAssertDblEquals(tc, -2.4, data->satellites[0].orbit.m0, 1e-12);
+    file_delete("test_rinex_nav.rnx");
+    
+    /* 非导航文件 */
+    CuAssertIntEquals(tc, 0, rinex_nav_parse_buffer("     3.04           O\n", 22,
+                                                    collect_nav_record, data, NULL));
+    
+    satellite_data_destroy(data);
+}
+
+void TestEphemerisStore(CuTest* tc) {
+    EphemerisStore* store = ephemeris_store_create();
+    CuAssertPtrNotNull(tc, store);
+    
+    /* 同一颗卫星乱序加入3组星历 (间隔2小时) */
+    time_t epochs[] = {1700007200, 1700000000, 1700014400};
+    for (int i = 0; i < 3; i++) {
+        Satellite sat = {0};
+        sat.prn = 60;  /* 超出GPS范围但属于有效北斗PRN */
+        sat.system = SATELLITE_SYSTEM_BEIDOU;
+        sat.is_valid = 1;
+        sat.valid_time = epochs[i];
+        sat.orbit.sqrt_a = 6493.0;
+        sat.orbit.toe = (double)i;
+        CuAssertIntEquals(tc, 1, ephemeris_store_add(store, &sat));
+    }
+    
+    /* 同一(PRN, 参考时间)重复加入时覆盖 */
+    Satellite dup = {0};
+    dup.prn = 60;
+    dup.system = SATELLITE_SYSTEM_BEIDOU;
+    dup.valid_time = 1700007200;
+    dup.orbit.toe = 99.0;
+    CuAssertIntEquals(tc, 1, ephemeris_store_add(store, &dup));
+    CuAssertIntEquals(tc, 3, ephemeris_store_count(store, SATELLITE_SYSTEM_BEIDOU, 60));
+    CuAssertIntEquals(tc, 3, store->record_count);
+    
+    /* 选择参考时间最近的一组 */
+    const Satellite* best = ephemeris_store_find(store, SATELLITE_SYSTEM_BEIDOU, 60, 1700003000);
+    CuAssertPtrNotNull(tc, best);
+    CuAssertTrue(tc, best->valid_time == 1700000000);
+    best = ephemeris_store_find(store, SATELLITE_SYSTEM_BEIDOU, 60, 1700004000);
+    CuAssertDblEquals(tc, 99.0, best->orbit.toe, 0.0);
+    best = ephemeris_store_find(store, SATELLITE_SYSTEM_BEIDOU, 60, 1800000000);
+    CuAssertTrue(tc, best->valid_time == 1700014400);
+    
+    /* 之后的一组更近但超出拟合区间时，仍取不晚于查询时刻的一组 */
+    Satellite late = {0};
+    late.prn = 60;
+    late.system = SATELLITE_SYSTEM_BEIDOU;
+    late.valid_time = 1700040000;
+    CuAssertIntEquals(tc, 1, ephemeris_store_add(store, &late));
+    best = ephemeris_store_find(store, SATELLITE_SYSTEM_BEIDOU, 60, 1700030000);
+    CuAssertTrue(tc, best->valid_time == 1700014400);
+    best = ephemeris_store_find(store, SATELLITE_SYSTEM_BEIDOU, 60, 1700034000);
+    CuAssertTrue(tc, best->valid_time == 1700040000);
+    
+    /* 不同系统的同号卫星互不影响 */
+    CuAssertPtrEquals(tc, NULL, (void*)ephemeris_store_find(store, SATELLITE_SYSTEM_GPS, 60, 1700000000));
+    
+    /* 导出某一时刻的卫星快照 */
+    SatelliteData* data = satellite_data_create(10);
+    CuAssertIntEquals(tc, 1, ephemeris_store_select(store, 0, 1700014000, data));
+    CuAssertTrue(tc, data->satellites[0].valid_time == 1700014400);
+    satellite_data_destroy(data);
+    
+    ephemeris_store_destroy(store);
+}
+
+void TestEphemerisSnapshot(CuTest* tc) {
+    file_write_text("test_snapshot_nav.rnx", TEST_RINEX_NAV);
+    file_delete("test_snapshot.bin");
+    
+    /* 首次加载解析RINEX并生成快照 */
+    EphemerisStore* parsed = ephemeris_store_create();
+    CuAssertIntEquals(tc, 1, ephemeris_store_load_cached(parsed, "test_snapshot_nav.rnx", "test_snapshot.bin"));
+    CuAssertIntEquals(tc, 2, parsed->record_count);
+    CuAssertPtrEquals(tc, NULL, parsed->mapping);
+    CuAssertIntEquals(tc, 1, file_exists("test_snapshot.bin"));
+    
+    /* 再次加载直接映射快照，内容一致 */
+    EphemerisStore* mapped = ephemeris_store_create();
+    CuAssertIntEquals(tc, 1, ephemeris_store_load_cached(mapped, "test_snapshot_nav.rnx", "test_snapshot.bin"));
+    CuAssertPtrNotNull(tc, mapped->mapping);
+    CuAssertIntEquals(tc, 2, mapped->record_count);
+    const Satellite* a = ephemeris_store_find(parsed, SATELLITE_SYSTEM_GPS, 1, 1577836800);
+    const Satellite* b = ephemeris_store_find(mapped, SATELLITE_SYSTEM_GPS, 1, 1577836800);
+    CuAssertPtrNotNull(tc, b);
+    CuAssertDblEquals(tc, a->orbit.sqrt_a, b->orbit.sqrt_a, 0.0);
+    CuAssertTrue(tc, a->valid_time == b->valid_time);
+    
+    /* 映射的星历库仍可修改 (写时复制到自有内存) */
+    Satellite extra = *b;
+    extra.valid_time += 7200;
+    CuAssertIntEquals(tc, 1, ephemeris_store_add(mapped, &extra));
+    CuAssertIntEquals(tc, 2, ephemeris_store_count(mapped, SATELLITE_SYSTEM_GPS, 1));
+    ephemeris_store_destroy(mapped);
+    
+    /* 损坏的快照被拒绝 */
+    FILE* file = fopen("test_snapshot.bin", "r+b");
+    fseek(file, -8, SEEK_END);
+    fputc(0x5A, file);
+    fclose(file);
+    EphemerisStore* corrupt = ephemeris_store_create();
+    CuAssertIntEquals(tc, 0, ephemeris_snapshot_load(corrupt, "test_snapshot.bin", NULL));
+    
+    /* 源文件变化 (或快照损坏) 时重新解析 */
+    CuAssertIntEquals(tc, 1, ephemeris_store_load_cached(corrupt, "test_snapshot_nav.rnx", "test_snapshot.bin"));
+    CuAssertPtrEquals(tc, NULL, corrupt->mapping);
+    CuAssertIntEquals(tc, 2, corrupt->record_count);
+    
+    ephemeris_store_destroy(corrupt);
+    ephemeris_store_destroy(parsed);
+    file_delete("test_snapshot_nav.rnx");
+    file_delete("test_snapshot.bin");
+}
+
+void TestRinexIngestFiles(CuTest* tc) {
+    /* 两个内容相同的文件和一个不存在的文件 */
+    file_write_text("test_ingest_a.rnx", TEST_RINEX_NAV);
+    file_write_text("test_ingest_b.rnx", TEST_RINEX_NAV);
+    const char* files[] = {"test_ingest_a.rnx", "test_ingest_missing.rnx", "test_ingest_b.rnx"};
+    
+    EphemerisStore* store = ephemeris_store_create();
+    RinexIngestReport report;
+    error_clear();
+    CuAssertIntEquals(tc, 1, rinex_ingest_files(store, files, 3, 2, &report));
+    
+    CuAssertIntEquals(tc, 3, report.file_count);
+    CuAssertIntEquals(tc, 1, report.files_failed);
+    CuAssertIntEquals(tc, 2, report.threads_used);
+    CuAssertIntEquals(tc, 4, report.records);
+    CuAssertIntEquals(tc, 2, report.merged);
+    CuAssertIntEquals(tc, 2, report.duplicates);
+    CuAssertIntEquals(tc, 2, store->record_count);
+    
+    /* 逐文件报告与输入顺序一致 */
+    CuAssertIntEquals(tc, 1, report.files[0].success);
+    CuAssertIntEquals(tc, 2, report.files[0].merged);
+    CuAssertIntEquals(tc, 0, report.files[1].success);
+    CuAssertIntEquals(tc, 2, report.files[2].duplicates);
+    
+    /* 工作线程的错误先各自收集，汇合后在调用线程上报告失败文件的原因 */
+    ErrorInfo* error = error_get_last();
+    CuAssertPtrNotNull(tc, error);
+    CuAssertTrue(tc, report.files[1].error_message[0] != '\0');
+    CuAssertTrue(tc, strncmp(error->message, report.files[1].error_message, sizeof(report.files[1].error_message) - 1) == 0);
+    
+    ErrorInfo captured;
+    error_clear();
+    error_capture_begin(&captured);
+    error_set(ERROR_PARSE, "captured", __func__, __FILE__, __LINE__);
+    error_capture_end();
+    CuAssertPtrEquals(tc, NULL, error_get_last());
+    CuAssertIntEquals(tc, ERROR_PARSE, captured.code);
+    CuAssertStrEquals(tc, "captured", captured.message);
+    
+    rinex_ingest_report_free(&report);
+    ephemeris_store_destroy(store);
+    file_delete("test_ingest_a.rnx");
+    file_delete("test_ingest_b.rnx");
+}
+
 /* 飞机模块测试函数实现 */
 void TestAircraftTrajectoryCreate(CuTest* tc) {
     FlightTrajectory* trajectory = flight_trajectory_create(100);
@@ -457,6 +1067,1191 @@ void TestBatchObstructionCalculate(CuTest* tc) {
     satellite_data_destroy(sat_data);
 }
 
+void TestTransformedGeometryReuse(CuTest* tc) {
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    CuAssertPtrNotNull(tc, geometry);
+    
+    /* 天线正上方的部件 */
+    AircraftComponent component = {0};
+    component.part_type = AIRCRAFT_PART_TAIL;
+    component.position = vector3d_create(0.0, 0.0, 5.0);
+    component.size = vector3d_create(4.0, 4.0, 2.0);
+    component.is_obstructing = 1;
+    aircraft_geometry_add_component(geometry, &component);
+    
+    component.part_type = AIRCRAFT_PART_WING_LEFT;
+    component.position = vector3d_create(0.0, -10.0, 0.0);
+    component.size = vector3d_create(3.0, 15.0, 0.5);
+    aircraft_geometry_add_component(geometry, &component);
+    
+    AircraftState aircraft_state = {0};
+    aircraft_state.position.latitude = 39.9;
+    aircraft_state.position.longitude = 116.4;
+    aircraft_state.position.altitude = 1000.0;
+    aircraft_state.is_valid = 1;
+    
+    ObstructionParams params;
+    obstruction_params_init(&params);
+    
+    /* 调用方提供存储，每个姿态变换一次 */
+    AircraftComponent storage[4];
+    TransformedGeometry transformed;
+    CuAssertIntEquals(tc, 1, transformed_geometry_init(&transformed, storage, 4));
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, geometry, &aircraft_state.attitude));
+    CuAssertIntEquals(tc, 2, transformed.component_count);
+    
+    const double satellites[3][3] = {
+        {0.0, 0.0, 2.0e7},
+        {1.0e7, 2.0e7, 3.0e6},
+        {-2.0e7, 5.0e6, 1.0e7}
+    };
+    for (int i = 0; i < 3; i++) {
+        SatellitePosition sat_pos = {0};
+        sat_pos.x = satellites[i][0];
+        sat_pos.y = satellites[i][1];
+        sat_pos.z = satellites[i][2];
+        
+        /* 与逐颗卫星变换的旧接口结果一致 */
+        ObstructionResult expected, actual;
+        CuAssertIntEquals(tc, 1, obstruction_calculate(geometry, &sat_pos, &aircraft_state, &params, &expected));
+        CuAssertIntEquals(tc, 1, obstruction_calculate_transformed(&transformed, &sat_pos, &params, &actual));
+        CuAssertIntEquals(tc, expected.is_obstructed, actual.is_obstructed);
+        CuAssertDblEquals(tc, expected.obstruction_distance, actual.obstruction_distance, 1e-12);
+        CuAssertDblEquals(tc, expected.obstruction_angle, actual.obstruction_angle, 1e-12);
+        CuAssertIntEquals(tc, expected.obstruction_part, actual.obstruction_part);
+    }
+    
+    /* 正上方卫星的射线穿过尾翼 */
+    SatellitePosition zenith = {0};
+    zenith.z = 2.0e7;
+    ObstructionResult result;
+    obstruction_calculate_transformed(&transformed, &zenith, &params, &result);
+    CuAssertTrue(tc, result.obstruction_distance > 0.0);
+    CuAssertIntEquals(tc, AIRCRAFT_PART_TAIL, result.obstruction_part);
+    
+    /* 存储不足时拒绝更新 */
+    TransformedGeometry small;
+    transformed_geometry_init(&small, storage, 1);
+    CuAssertIntEquals(tc, 0, transformed_geometry_update(&small, geometry, &aircraft_state.attitude));
+    
+    aircraft_geometry_destroy(geometry);
+}
+
+void TestMultiAntennaObstruction(CuTest* tc) {
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    CuAssertPtrNotNull(tc, geometry);
+    CuAssertIntEquals(tc, 1, geometry->antenna_count);
+    
+    /* 主天线+X方向有发动机遮挡，第二个天线在侧面不受影响 */
+    AircraftComponent component = {0};
+    component.part_type = AIRCRAFT_PART_ENGINE;
+    component.position = vector3d_create(6.0, 0.0, 2.0);
+    component.size = vector3d_create(2.0, 4.0, 4.0);
+    component.is_obstructing = 1;
+    aircraft_geometry_add_component(geometry, &component);
+    
+    Vector3D side = vector3d_create(0.0, 10.0, 2.0);
+    CuAssertIntEquals(tc, 1, aircraft_geometry_add_antenna(geometry, &side));
+    Vector3D tail = vector3d_create(-20.0, 0.0, 8.0);
+    CuAssertIntEquals(tc, 1, aircraft_geometry_add_antenna(geometry, &tail));
+    CuAssertIntEquals(tc, 3, geometry->antenna_count);
+    
+    /* 飞机位于(0°, 0°)：第1颗卫星在天顶，第2颗偏北，第3颗在地球背面 */
+    SatelliteData* sat_data = satellite_data_create(8);
+    const double positions[3][3] = {
+        {2.6e7, 0.0, 0.0},
+        {2.0e7, 0.0, 1.0e7},
+        {-2.6e7, 0.0, 0.0}
+    };
+    for (int i = 0; i < 3; i++) {
+        Satellite sat = {0};
+        sat.prn = i + 1;
+        sat.system = SATELLITE_SYSTEM_GPS;
+        sat.is_valid = 1;
+        sat.pos.x = positions[i][0];
+        sat.pos.y = positions[i][1];
+        sat.pos.z = positions[i][2];
+        satellite_data_add(sat_data, &sat);
+    }
+    
+    AircraftState aircraft_state = {0};
+    aircraft_state.is_valid = 1;
+    
+    ObstructionParams params;
+    obstruction_params_init(&params);
+    params.min_obstruction_angle = 0.0;
+    
+    MultiAntennaObstructionResult multi;
+    CuAssertIntEquals(tc, 1, batch_obstruction_calculate_multi(geometry, sat_data, &aircraft_state, &params, &multi));
+    CuAssertIntEquals(tc, 3, multi.antenna_count);
+    CuAssertIntEquals(tc, 3, multi.analysis_count);
+    CuAssertIntEquals(tc, 2, multi.visible_satellites);
+    CuAssertIntEquals(tc, 1, multi.obstructed_satellites[0]);
+    CuAssertIntEquals(tc, 0, multi.obstructed_satellites[1]);
+    CuAssertIntEquals(tc, 0, multi.obstructed_satellites[2]);
+    CuAssertIntEquals(tc, 2, multi.usable_satellites[1]);
+    CuAssertIntEquals(tc, 2, multi.combined_usable_satellites);
+    
+    /* 被遮挡的卫星选择无遮挡的天线；不可见的卫星没有最佳天线 */
+    CuAssertIntEquals(tc, AIRCRAFT_PART_ENGINE, multi.analyses[0].obstruction.obstruction_part);
+    CuAssertTrue(tc, multi.analyses[0].obstruction.signal_loss > 0.0);
+    CuAssertIntEquals(tc, 1, multi.best_antenna[0]);
+    CuAssertIntEquals(tc, 0, multi.best_antenna[1]);
+    CuAssertIntEquals(tc, -1, multi.best_antenna[2]);
+    
+    /* 主天线的结果与单天线批量计算一致 */
+    BatchObstructionResult single = {0};
+    CuAssertIntEquals(tc, 1, batch_obstruction_calculate(geometry, sat_data, &aircraft_state, &params, &single));
+    CuAssertIntEquals(tc, multi.analysis_count, single.analysis_count);
+    CuAssertIntEquals(tc, multi.usable_satellites[0], single.usable_satellites);
+    for (int i = 0; i < single.analysis_count; i++) {
+        const VisibilityAnalysis* primary = &multi.analyses[i * multi.antenna_count];
+        CuAssertIntEquals(tc, single.analyses[i].obstruction.is_obstructed, primary->obstruction.is_obstructed);
+        CuAssertDblEquals(tc, single.analyses[i].obstruction.obstruction_distance,
+                          primary->obstruction.obstruction_distance, 1e-12);
+    }
+    free(single.analyses);
+    
+    /* 按下标单独计算某个天线 */
+    TransformedGeometry* transformed = transformed_geometry_create(geometry->component_count);
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(transformed, geometry, &aircraft_state.attitude));
+    ObstructionResult result;
+    CuAssertIntEquals(tc, 1, obstruction_calculate_antenna(transformed, 1, &sat_data->satellites[0].pos, &params, &result));
+    CuAssertIntEquals(tc, 0, result.is_obstructed);
+    CuAssertIntEquals(tc, 0, obstruction_calculate_antenna(transformed, 3, &sat_data->satellites[0].pos, &params, &result));
+    transformed_geometry_destroy(transformed);
+    
+    CuAssertIntEquals(tc, 1, aircraft_geometry_add_antenna(geometry, &side));
+    CuAssertIntEquals(tc, 0, aircraft_geometry_add_antenna(geometry, &side));
+    
+    multi_antenna_result_free(&multi);
+    CuAssertPtrEquals(tc, NULL, multi.analyses);
+    aircraft_geometry_destroy(geometry);
+    satellite_data_destroy(sat_data);
+}
+
+void TestTrajectoryObstructionAnalysis(CuTest* tc) {
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    AircraftComponent component = {0};
+    component.part_type = AIRCRAFT_PART_TAIL;
+    component.position = vector3d_create(0.0, 0.0, 5.0);
+    component.size = vector3d_create(30.0, 30.0, 2.0);
+    component.is_obstructing = 1;
+    aircraft_geometry_add_component(geometry, &component);
+    
+    SatelliteData* sat_data = satellite_data_create(16);
+    for (int i = 0; i < 12; i++) {
+        Satellite sat = {0};
+        sat.prn = i + 1;
+        sat.system = SATELLITE_SYSTEM_GPS;
+        sat.is_valid = 1;
+        sat.valid_time = 1700000000;
+        sat.orbit.sqrt_a = 5153.8;
+        sat.orbit.e = 0.01;
+        sat.orbit.i0 = 0.96;
+        sat.orbit.omega0 = -3.0 + 0.5 * i;
+        sat.orbit.omega = 0.3 * i;
+        sat.orbit.m0 = -3.0 + 0.55 * i;
+        satellite_data_add(sat_data, &sat);
+    }
+    
+    /* 1Hz轨迹，横滚角往复变化 */
+    const int point_count = 300;
+    FlightTrajectory* trajectory = flight_trajectory_create(point_count);
+    for (int i = 0; i < point_count; i++) {
+        TrajectoryPoint point = {0};
+        point.timestamp = 1700000000 + i;
+        point.state.timestamp = point.timestamp;
+        point.state.position.latitude = 30.0 + i * 0.001;
+        point.state.position.longitude = 110.0;
+        point.state.position.altitude = 10000.0;
+        point.state.attitude.roll = 30.0 * sin(i * 0.05);
+        point.state.attitude.yaw = 45.0;
+        point.state.is_valid = 1;
+        CuAssertIntEquals(tc, 1, flight_trajectory_add_point(trajectory, &point));
+    }
+    
+    ObstructionParams params;
+    obstruction_params_init(&params);
+    params.min_obstruction_angle = 0.0;
+    
+    TrajectoryAnalysisConfig config;
+    trajectory_analysis_config_default(&config);
+    config.thread_count = 1;
+    TrajectoryAnalysisResult serial;
+    CuAssertIntEquals(tc, 1, trajectory_obstruction_analyze(geometry, sat_data, trajectory, &params, &config, &serial));
+    CuAssertIntEquals(tc, point_count, serial.step_count);
+    CuAssertIntEquals(tc, 12, serial.satellite_count);
+    CuAssertIntEquals(tc, 1, serial.threads_used);
+    
+    /* 多线程结果与单线程逐字节一致 */
+    config.thread_count = 4;
+    TrajectoryAnalysisResult parallel;
+    CuAssertIntEquals(tc, 1, trajectory_obstruction_analyze(geometry, sat_data, trajectory, &params, &config, &parallel));
+    CuAssertIntEquals(tc, 4, parallel.threads_used);
+    CuAssertIntEquals(tc, 0, memcmp(serial.steps, parallel.steps, sizeof(TrajectoryStepResult) * point_count));
+    CuAssertIntEquals(tc, 0, memcmp(serial.satellite_states, parallel.satellite_states, (size_t)point_count * 12));
+    CuAssertDblEquals(tc, serial.availability_percentage, parallel.availability_percentage, 0.0);
+    CuAssertDblEquals(tc, serial.longest_outage, parallel.longest_outage, 0.0);
+    CuAssertTrue(tc, serial.coherence_reused > 0);
+    
+    /* 关闭相干缓存后逐步逐星状态不变 */
+    config.coherence_tolerance = 0.0;
+    TrajectoryAnalysisResult exact;
+    CuAssertIntEquals(tc, 1, trajectory_obstruction_analyze(geometry, sat_data, trajectory, &params, &config, &exact));
+    CuAssertTrue(tc, exact.coherence_reused == 0);
+    CuAssertIntEquals(tc, 0, memcmp(exact.satellite_states, parallel.satellite_states, (size_t)point_count * 12));
+    trajectory_analysis_result_free(&exact);
+    config.coherence_tolerance = OBSTRUCTION_COHERENCE_DEFAULT_TOLERANCE;
+    
+    /* 共享掩码只构建一次，各线程查表结果一致。掩码机型：机身下方一块网格 + 中心偏离天线的平板部件；
+     * 部件和网格随机体刚性旋转，横滚轨迹上纯查表的回放须与完整求交逐步逐星一致 */
+    AircraftGeometry* masked_geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    Vector3D vertices[4];
+    vertices[0] = vector3d_create(-1.0, -1.0, -20.0);
+    vertices[1] = vector3d_create(1.0, -1.0, -20.0);
+    vertices[2] = vector3d_create(1.0, 1.0, -20.0);
+    vertices[3] = vector3d_create(-1.0, 1.0, -20.0);
+    int indices[6] = {0, 1, 2, 0, 2, 3};
+    AircraftPart parts[2] = {AIRCRAFT_PART_FUSELAGE, AIRCRAFT_PART_FUSELAGE};
+    CuAssertIntEquals(tc, 1, aircraft_geometry_set_mesh(masked_geometry, triangle_mesh_create(vertices, 4, indices, parts, 2)));
+    component.part_type = AIRCRAFT_PART_TAIL;
+    component.position = vector3d_create(6.0, 6.0, 8.0);
+    component.size = vector3d_create(24.0, 24.0, 1.0);
+    aircraft_geometry_add_component(masked_geometry, &component);
+    
+    config.thread_count = 1;
+    config.coherence_tolerance = 0.0;
+    CuAssertIntEquals(tc, 1, trajectory_obstruction_analyze(masked_geometry, sat_data, trajectory, &params, &config, &exact));
+    config.coherence_tolerance = OBSTRUCTION_COHERENCE_DEFAULT_TOLERANCE;
+    
+    ObstructionMask* mask = obstruction_mask_create();
+    config.mask = mask;
+    TrajectoryAnalysisResult masked_serial, masked_parallel;
+    CuAssertIntEquals(tc, 1, trajectory_obstruction_analyze(masked_geometry, sat_data, trajectory, &params, &config, &masked_serial));
+    CuAssertIntEquals(tc, 1, obstruction_mask_is_current(mask, masked_geometry));
+    CuAssertTrue(tc, mask->blocked_cells > 0);
+    mask->build_time = -1.0;
+    config.thread_count = 4;
+    CuAssertIntEquals(tc, 1, trajectory_obstruction_analyze(masked_geometry, sat_data, trajectory, &params, &config, &masked_parallel));
+    CuAssertDblEquals(tc, -1.0, mask->build_time, 0.0);
+    CuAssertIntEquals(tc, 0, memcmp(masked_serial.satellite_states, masked_parallel.satellite_states, (size_t)point_count * 12));
+    CuAssertIntEquals(tc, 0, memcmp(exact.satellite_states, masked_serial.satellite_states, (size_t)point_count * 12));
+    int obstructed_states = 0;
+    for (int i = 0; i < point_count * 12; i++) {
+        obstructed_states += (masked_serial.satellite_states[i] & TRAJECTORY_SAT_OBSTRUCTED) != 0;
+    }
+    CuAssertTrue(tc, obstructed_states > 0);
+    trajectory_analysis_result_free(&exact);
+    trajectory_analysis_result_free(&masked_serial);
+    trajectory_analysis_result_free(&masked_parallel);
+    config.mask = NULL;
+    obstruction_mask_destroy(mask);
+    aircraft_geometry_destroy(masked_geometry);
+    
+    /* 只有长方体部件的机型：从掩码文件映射回放，同样与完整求交一致 */
+    AircraftGeometry* box_geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    aircraft_geometry_add_component(box_geometry, &component);
+    config.thread_count = 1;
+    config.coherence_tolerance = 0.0;
+    CuAssertIntEquals(tc, 1, trajectory_obstruction_analyze(box_geometry, sat_data, trajectory, &params, &config, &exact));
+    config.coherence_tolerance = OBSTRUCTION_COHERENCE_DEFAULT_TOLERANCE;
+    
+    file_delete("test_replay_mask.bin");
+    ObstructionMask* built = obstruction_mask_create();
+    CuAssertIntEquals(tc, 1, obstruction_mask_load_cached(built, box_geometry, "test_replay_mask.bin"));
+    ObstructionMask* replay_mask = obstruction_mask_create();
+    CuAssertIntEquals(tc, 1, obstruction_mask_load_cached(replay_mask, box_geometry, "test_replay_mask.bin"));
+    CuAssertTrue(tc, replay_mask->cells == NULL);
+    config.mask = replay_mask;
+    config.thread_count = 4;
+    CuAssertIntEquals(tc, 1, trajectory_obstruction_analyze(box_geometry, sat_data, trajectory, &params, &config, &masked_parallel));
+    CuAssertTrue(tc, replay_mask->cells == NULL);
+    CuAssertIntEquals(tc, 0, memcmp(exact.satellite_states, masked_parallel.satellite_states, (size_t)point_count * 12));
+    obstructed_states = 0;
+    for (int i = 0; i < point_count * 12; i++) {
+        obstructed_states += (masked_parallel.satellite_states[i] & TRAJECTORY_SAT_OBSTRUCTED) != 0;
+    }
+    CuAssertTrue(tc, obstructed_states > 0);
+    trajectory_analysis_result_free(&exact);
+    trajectory_analysis_result_free(&masked_parallel);
+    config.mask = NULL;
+    file_delete("test_replay_mask.bin");
+    obstruction_mask_destroy(replay_mask);
+    obstruction_mask_destroy(built);
+    aircraft_geometry_destroy(box_geometry);
+    
+    /* 与逐时刻调用批量接口的结果一致 */
+    for (int step = 0; step < point_count; step += 97) {
+        SatelliteData* snapshot = satellite_data_create(16);
+        for (int i = 0; i < sat_data->satellite_count; i++) {
+            satellite_data_add(snapshot, &sat_data->satellites[i]);
+        }
+        SatelliteEphemerisBatch* snapshot_batch = satellite_ephemeris_batch_create(snapshot);
+        satellite_data_propagate_batch(snapshot, snapshot_batch, trajectory->points[step].timestamp);
+        satellite_ephemeris_batch_destroy(snapshot_batch);
+        BatchObstructionResult batch = {0};
+        CuAssertIntEquals(tc, 1, batch_obstruction_calculate(geometry, snapshot, &trajectory->points[step].state,
+                                                             &params, &batch));
+        CuAssertIntEquals(tc, batch.visible_satellites, parallel.steps[step].visible_satellites);
+        CuAssertIntEquals(tc, batch.obstructed_satellites, parallel.steps[step].obstructed_satellites);
+        CuAssertIntEquals(tc, batch.usable_satellites, parallel.steps[step].usable_satellites);
+        free(batch.analyses);
+        satellite_data_destroy(snapshot);
+    }
+    
+    /* 汇总统计：1Hz下每步1秒 */
+    CuAssertDblEquals(tc, (double)point_count, parallel.total_time, 1e-9);
+    double obstructed_steps = 0.0, obstructed_time = 0.0, outage_steps = 0.0;
+    for (int step = 0; step < point_count; step++) {
+        obstructed_steps += parallel.steps[step].obstructed_satellites;
+        outage_steps += !parallel.steps[step].available;
+    }
+    for (int i = 0; i < 12; i++) {
+        CuAssertIntEquals(tc, i + 1, parallel.satellites[i].prn);
+        CuAssertTrue(tc, parallel.satellites[i].obstructed_time <= parallel.satellites[i].visible_time);
+        obstructed_time += parallel.satellites[i].obstructed_time;
+    }
+    CuAssertDblEquals(tc, obstructed_steps, obstructed_time, 1e-9);
+    CuAssertTrue(tc, obstructed_time > 0.0);
+    CuAssertDblEquals(tc, (double)point_count - outage_steps, parallel.available_time, 1e-9);
+    CuAssertTrue(tc, parallel.longest_outage <= outage_steps);
+    
+    /* 提高可用门限后全程中断 */
+    config.min_usable_satellites = 13;
+    TrajectoryAnalysisResult outage;
+    CuAssertIntEquals(tc, 1, trajectory_obstruction_analyze(geometry, sat_data, trajectory, &params, &config, &outage));
+    CuAssertDblEquals(tc, 0.0, outage.availability_percentage, 0.0);
+    CuAssertDblEquals(tc, (double)point_count, outage.longest_outage, 1e-9);
+    CuAssertTrue(tc, outage.longest_outage_start == trajectory->points[0].timestamp);
+    
+    /* 某个时间步失败时，汇合后在调用线程上报告错误 */
+    trajectory->points[point_count - 1].state.position.latitude = 200.0;
+    TrajectoryAnalysisResult failed;
+    error_clear();
+    CuAssertIntEquals(tc, 0, trajectory_obstruction_analyze(geometry, sat_data, trajectory, &params, &config, &failed));
+    CuAssertPtrNotNull(tc, error_get_last());
+    CuAssertIntEquals(tc, ERROR_CALCULATION, error_get_last()->code);
+    
+    trajectory_analysis_result_free(&serial);
+    trajectory_analysis_result_free(&parallel);
+    trajectory_analysis_result_free(&outage);
+    flight_trajectory_destroy(trajectory);
+    aircraft_geometry_destroy(geometry);
+    satellite_data_destroy(sat_data);
+}
+
+void TestTrajectoryAnalysisBeforeToe(CuTest* tc) {
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    AircraftComponent component = {0};
+    component.part_type = AIRCRAFT_PART_TAIL;
+    component.position = vector3d_create(0.0, 0.0, 5.0);
+    component.size = vector3d_create(30.0, 30.0, 2.0);
+    component.is_obstructing = 1;
+    aircraft_geometry_add_component(geometry, &component);
+    
+    /* 星历参考时刻位于轨迹末尾，整段轨迹都在toe之前 */
+    const time_t toe_time = 1700007200;
+    SatelliteData* sat_data = satellite_data_create(16);
+    for (int i = 0; i < 12; i++) {
+        Satellite sat = {0};
+        sat.prn = i + 1;
+        sat.system = SATELLITE_SYSTEM_GPS;
+        sat.is_valid = 1;
+        sat.valid_time = toe_time;
+        sat.orbit.sqrt_a = 5153.8;
+        sat.orbit.e = 0.01;
+        sat.orbit.i0 = 0.96;
+        sat.orbit.omega0 = -3.0 + 0.5 * i;
+        sat.orbit.omega = 0.3 * i;
+        sat.orbit.m0 = -3.0 + 0.55 * i;
+        satellite_data_add(sat_data, &sat);
+    }
+    
+    /* 两小时内每10分钟一个点，位置和姿态固定 */
+    const int point_count = 13;
+    FlightTrajectory* trajectory = flight_trajectory_create(point_count);
+    for (int i = 0; i < point_count; i++) {
+        TrajectoryPoint point = {0};
+        point.timestamp = toe_time - 7200 + 600 * i;
+        point.state.timestamp = point.timestamp;
+        point.state.position.latitude = 30.0;
+        point.state.position.longitude = 110.0;
+        point.state.position.altitude = 10000.0;
+        point.state.attitude.roll = 20.0;
+        point.state.is_valid = 1;
+        CuAssertIntEquals(tc, 1, flight_trajectory_add_point(trajectory, &point));
+    }
+    
+    ObstructionParams params;
+    obstruction_params_init(&params);
+    params.min_obstruction_angle = 0.0;
+    
+    TrajectoryAnalysisConfig config;
+    trajectory_analysis_config_default(&config);
+    config.thread_count = 2;
+    TrajectoryAnalysisResult result;
+    CuAssertIntEquals(tc, 1, trajectory_obstruction_analyze(geometry, sat_data, trajectory, &params, &config, &result));
+    
+    /* 逐步与标量传播后的单时刻分析一致 */
+    for (int step = 0; step < point_count; step++) {
+        SatelliteData* snapshot = satellite_data_create(16);
+        for (int i = 0; i < sat_data->satellite_count; i++) {
+            Satellite sat = sat_data->satellites[i];
+            CuAssertIntEquals(tc, 1, satellite_position_calculate(&sat, trajectory->points[step].timestamp));
+            satellite_data_add(snapshot, &sat);
+        }
+        BatchObstructionResult batch = {0};
+        CuAssertIntEquals(tc, 1, batch_obstruction_calculate(geometry, snapshot, &trajectory->points[step].state,
+                                                             &params, &batch));
+        CuAssertIntEquals(tc, batch.visible_satellites, result.steps[step].visible_satellites);
+        CuAssertIntEquals(tc, batch.obstructed_satellites, result.steps[step].obstructed_satellites);
+        CuAssertIntEquals(tc, batch.usable_satellites, result.steps[step].usable_satellites);
+        free(batch.analyses);
+        satellite_data_destroy(snapshot);
+    }
+    
+    /* 卫星在toe之前仍在运动，星座可见状态随时间变化 */
+    CuAssertTrue(tc, memcmp(result.satellite_states, &result.satellite_states[(size_t)(point_count - 1) * 12], 12) != 0);
+    
+    trajectory_analysis_result_free(&result);
+    flight_trajectory_destroy(trajectory);
+    aircraft_geometry_destroy(geometry);
+    satellite_data_destroy(sat_data);
+}
+
+void TestComponentTransformCache(CuTest* tc) {
+    AircraftComponent component = {0};
+    component.part_type = AIRCRAFT_PART_ENGINE;
+    component.position = vector3d_create(5.0, 0.0, 0.0);
+    component.size = vector3d_create(2.0, 2.0, 2.0);
+    component.is_obstructing = 1;
+    
+    Ray ray = {0};
+    ray.direction = vector3d_create(1.0, 0.0, 0.0);
+    ray.length = 100.0;
+    
+    /* 无缓存时临时计算，距离为到部件近表面的距离 */
+    Vector3D intersection;
+    double distance = 0.0;
+    CuAssertIntEquals(tc, 0, aircraft_component_transform_is_current(&component));
+    CuAssertIntEquals(tc, 1, ray_component_intersection(&ray, &component, &intersection, &distance));
+    CuAssertDblEquals(tc, 4.0, distance, 1e-9);
+    CuAssertDblEquals(tc, 4.0, intersection.x, 1e-9);
+    
+    /* 旋转后的部件：缓存与临时计算结果一致 */
+    component.rotation = vector3d_create(10.0, 20.0, 45.0);
+    component.size = vector3d_create(4.0, 1.0, 1.0);
+    double uncached = 0.0;
+    CuAssertIntEquals(tc, 1, ray_component_intersection(&ray, &component, NULL, &uncached));
+    
+    aircraft_component_update_transform(&component);
+    CuAssertIntEquals(tc, 1, aircraft_component_transform_is_current(&component));
+    double cached = 0.0;
+    CuAssertIntEquals(tc, 1, ray_component_intersection(&ray, &component, NULL, &cached));
+    CuAssertDblEquals(tc, uncached, cached, 1e-12);
+    
+    /* 逆变换为转置 */
+    RotationMatrix identity = rotation_matrix_multiply(&component.local_to_world, &component.world_to_local);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            CuAssertDblEquals(tc, i == j ? 1.0 : 0.0, identity.m[i][j], 1e-12);
+        }
+    }
+    
+    /* 修改欧拉角后缓存失效 */
+    component.rotation.z = 0.0;
+    CuAssertIntEquals(tc, 0, aircraft_component_transform_is_current(&component));
+    
+    /* 按姿态更新变换不改变几何版本号 (掩码、相干缓存和分析缓存以版本号为内容键) */
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    CuAssertPtrNotNull(tc, geometry);
+    CuAssertIntEquals(tc, 1, aircraft_geometry_add_component(geometry, &component));
+    unsigned int version = geometry->version;
+    AircraftAttitude attitude = {0};
+    attitude.pitch = 5.0;
+    attitude.yaw = 90.0;
+    CuAssertIntEquals(tc, 1, aircraft_geometry_update_transform(geometry, &attitude));
+    CuAssertIntEquals(tc, 1, aircraft_component_transform_is_current(&geometry->components[0]));
+    CuAssertIntEquals(tc, (int)version, (int)geometry->version);
+    aircraft_geometry_destroy(geometry);
+}
+
+void TestGeometryBvh(CuTest* tc) {
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    CuAssertPtrNotNull(tc, geometry);
+    
+    /* 300个随机分布的小部件，包围天线所在区域 */
+    unsigned int seed = 12345;
+    for (int i = 0; i < 300; i++) {
+        AircraftComponent component = {0};
+        component.part_type = (AircraftPart)(1 + i % 5);
+        seed = seed * 1103515245u + 12345u;
+        double x = (double)(seed % 4000) / 100.0 - 20.0;
+        seed = seed * 1103515245u + 12345u;
+        double y = (double)(seed % 4000) / 100.0 - 20.0;
+        seed = seed * 1103515245u + 12345u;
+        double z = (double)(seed % 1000) / 100.0 + 3.0;
+        component.position = vector3d_create(x, y, z);
+        component.size = vector3d_create(1.5, 1.0, 0.5);
+        component.rotation = vector3d_create(0.0, 0.0, (double)(i % 90));
+        component.is_obstructing = (i % 7) != 0;
+        aircraft_geometry_add_component(geometry, &component);
+    }
+    
+    AircraftState aircraft_state = {0};
+    aircraft_state.attitude.pitch = 5.0;
+    aircraft_state.attitude.roll = -10.0;
+    aircraft_state.attitude.yaw = 30.0;
+    
+    ObstructionParams params;
+    obstruction_params_init(&params);
+    params.min_obstruction_angle = 0.0;
+    
+    TransformedGeometry* linear = transformed_geometry_create(geometry->component_count);
+    TransformedGeometry* accelerated = transformed_geometry_create(geometry->component_count);
+    GeometryBvh* bvh = geometry_bvh_create(geometry->components, geometry->component_count);
+    CuAssertPtrNotNull(tc, bvh);
+    CuAssertIntEquals(tc, 257, bvh->index_count);
+    CuAssertIntEquals(tc, 1, transformed_geometry_set_bvh(accelerated, bvh));
+    
+    for (int pass = 0; pass < 2; pass++) {
+        /* 第二轮改变姿态，验证包围盒重新拟合 */
+        if (pass == 1) aircraft_state.attitude.yaw = 75.0;
+        CuAssertIntEquals(tc, 1, transformed_geometry_update(linear, geometry, &aircraft_state.attitude));
+        CuAssertIntEquals(tc, 1, transformed_geometry_update(accelerated, geometry, &aircraft_state.attitude));
+        
+        int blocked = 0;
+        for (int az = 0; az < 360; az += 10) {
+            for (int el = 5; el < 90; el += 5) {
+                double a = degrees_to_radians(az);
+                double e = degrees_to_radians(el);
+                SatellitePosition sat_pos = {0};
+                sat_pos.x = 2.0e7 * cos(e) * cos(a);
+                sat_pos.y = 2.0e7 * cos(e) * sin(a);
+                sat_pos.z = 2.0e7 * sin(e);
+                
+                ObstructionResult expected, actual;
+                obstruction_calculate_transformed(linear, &sat_pos, &params, &expected);
+                obstruction_calculate_transformed(accelerated, &sat_pos, &params, &actual);
+                CuAssertIntEquals(tc, expected.is_obstructed, actual.is_obstructed);
+                CuAssertDblEquals(tc, expected.obstruction_distance, actual.obstruction_distance, 1e-9);
+                CuAssertIntEquals(tc, expected.obstruction_part, actual.obstruction_part);
+                
+                /* 任意命中与最近命中结论一致 */
+                int any = obstruction_ray_blocked(accelerated, &sat_pos);
+                CuAssertIntEquals(tc, obstruction_ray_blocked(linear, &sat_pos), any);
+                CuAssertIntEquals(tc, expected.obstruction_distance > 0.0, any);
+                blocked += any;
+            }
+        }
+        CuAssertTrue(tc, blocked > 0);
+    }
+    
+    geometry_bvh_destroy(bvh);
+    transformed_geometry_destroy(linear);
+    transformed_geometry_destroy(accelerated);
+    aircraft_geometry_destroy(geometry);
+}
+
+void TestRayPacket(CuTest* tc) {
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    unsigned int seed = 777;
+    for (int i = 0; i < 40; i++) {
+        AircraftComponent component = {0};
+        component.part_type = (AircraftPart)(1 + i % 5);
+        seed = seed * 1103515245u + 12345u;
+        double x = (double)(seed % 3000) / 100.0 - 15.0;
+        seed = seed * 1103515245u + 12345u;
+        double y = (double)(seed % 3000) / 100.0 - 15.0;
+        component.position = vector3d_create(x, y, (i % 3 == 0) ? 2.0 : 4.0 + i % 4);
+        component.size = vector3d_create(3.0, 2.0, 1.0);
+        component.rotation = vector3d_create((double)(i % 7), 0.0, (double)(i * 11 % 90));
+        component.is_obstructing = (i % 9) != 0;
+        aircraft_geometry_add_component(geometry, &component);
+    }
+    
+    /* 103条射线 (非通道数整数倍)，包含与坐标轴平行的方向 */
+    const int ray_count = 103;
+    RayPacket* packet = ray_packet_create(ray_count);
+    CuAssertPtrNotNull(tc, packet);
+    CuAssertTrue(tc, packet->capacity >= ray_count && packet->capacity % RAY_PACKET_LANES == 0);
+    CuAssertPtrNotNull(tc, ray_packet_kernel_name());
+    
+    ray_packet_reset(packet, &geometry->antenna_position);
+    Vector3D axes[4] = {{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}, {0.0, -1.0, 0.0}, {0.0, 0.0, -1.0}};
+    for (int i = 0; i < ray_count; i++) {
+        Vector3D direction = axes[i % 4];
+        if (i >= 4) {
+            seed = seed * 1103515245u + 12345u;
+            direction.x = (double)(seed % 2000) / 1000.0 - 1.0;
+            seed = seed * 1103515245u + 12345u;
+            direction.y = (double)(seed % 2000) / 1000.0 - 1.0;
+            seed = seed * 1103515245u + 12345u;
+            direction.z = (double)(seed % 1000) / 1000.0 - 0.2;
+        }
+        CuAssertIntEquals(tc, 1, ray_packet_add(packet, &direction, 1.0e7));
+    }
+    Vector3D zero = {0.0, 0.0, 0.0};
+    CuAssertIntEquals(tc, 0, ray_packet_add(packet, &zero, 1.0));
+    
+    /* 与逐条射线逐个部件的标量求交逐位一致 */
+    int blocked = ray_packet_intersect_components(packet, geometry->components, geometry->component_count);
+    int expected_blocked = 0;
+    for (int i = 0; i < ray_count; i++) {
+        Ray ray;
+        ray.origin = geometry->antenna_position;
+        ray.direction = vector3d_create(packet->dx[i], packet->dy[i], packet->dz[i]);
+        ray.length = packet->length[i];
+        
+        double closest = ray.length;
+        int part = -1;
+        for (int c = 0; c < geometry->component_count; c++) {
+            double distance;
+            if (geometry->components[c].is_obstructing &&
+                ray_component_intersection(&ray, &geometry->components[c], NULL, &distance) &&
+                distance < closest) {
+                closest = distance;
+                part = geometry->components[c].part_type;
+            }
+        }
+        
+        CuAssertIntEquals(tc, part >= 0, packet->blocked[i]);
+        if (part >= 0) {
+            CuAssertDblEquals(tc, closest, packet->distance[i], 0.0);
+            CuAssertIntEquals(tc, part, packet->part_type[i]);
+            expected_blocked++;
+        }
+    }
+    CuAssertIntEquals(tc, expected_blocked, blocked);
+    CuAssertTrue(tc, blocked > 0 && blocked < ray_count);
+    
+    /* 批量卫星遮挡与逐颗计算一致 */
+    AircraftAttitude attitude = {4.0, -6.0, 20.0};
+    TransformedGeometry* transformed = transformed_geometry_create(geometry->component_count);
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(transformed, geometry, &attitude));
+    SatellitePosition satellites[ray_count];
+    for (int i = 0; i < ray_count; i++) {
+        memset(&satellites[i], 0, sizeof(SatellitePosition));
+        satellites[i].x = packet->dx[i] * 2.0e7;
+        satellites[i].y = packet->dy[i] * 2.0e7;
+        satellites[i].z = packet->dz[i] * 2.0e7;
+    }
+    ObstructionParams params;
+    obstruction_params_init(&params);
+    params.min_obstruction_angle = 0.0;
+    ObstructionResult results[ray_count];
+    CuAssertIntEquals(tc, 1, obstruction_calculate_packet(transformed, satellites, ray_count, &params, packet, results));
+    for (int i = 0; i < ray_count; i++) {
+        ObstructionResult expected;
+        obstruction_calculate_transformed(transformed, &satellites[i], &params, &expected);
+        CuAssertIntEquals(tc, expected.is_obstructed, results[i].is_obstructed);
+        CuAssertDblEquals(tc, expected.obstruction_distance, results[i].obstruction_distance, 1e-9);
+        CuAssertIntEquals(tc, expected.obstruction_part, results[i].obstruction_part);
+        CuAssertDblEquals(tc, expected.signal_loss, results[i].signal_loss, 1e-9);
+        CuAssertDblEquals(tc, expected.intersection_point.z, results[i].intersection_point.z, 1e-6);
+    }
+    CuAssertIntEquals(tc, 0, obstruction_calculate_packet(transformed, satellites, packet->capacity + 1,
+                                                          &params, packet, results));
+    ray_packet_destroy(packet);
+    
+    /* 天空图扫描：10°网格为36x10条射线 */
+    RayPacket* sky = ray_packet_create(360);
+    CuAssertIntEquals(tc, 360, ray_packet_fill_hemisphere(sky, &geometry->antenna_position, 10.0));
+    CuAssertDblEquals(tc, 1.0, sky->dz[359], 1e-12);
+    CuAssertDblEquals(tc, 1.0, sky->dx[0], 1e-12);
+    CuAssertTrue(tc, ray_packet_intersect_transformed(sky, transformed) > 0);
+    CuAssertIntEquals(tc, 0, ray_packet_fill_hemisphere(sky, &geometry->antenna_position, 5.0));
+    ray_packet_destroy(sky);
+    
+    transformed_geometry_destroy(transformed);
+    aircraft_geometry_destroy(geometry);
+}
+
+void TestObstructionCoherence(CuTest* tc) {
+    /* 天线上方的平板网格 + 几个不同朝向的部件 */
+    Vector3D vertices[4];
+    vertices[0] = vector3d_create(-4.0, -4.0, 6.0);
+    vertices[1] = vector3d_create(4.0, -4.0, 6.0);
+    vertices[2] = vector3d_create(4.0, 4.0, 6.0);
+    vertices[3] = vector3d_create(-4.0, 4.0, 6.0);
+    int indices[6] = {0, 1, 2, 0, 2, 3};
+    AircraftPart parts[2] = {AIRCRAFT_PART_TAIL, AIRCRAFT_PART_TAIL};
+    
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    CuAssertIntEquals(tc, 1, aircraft_geometry_set_mesh(geometry, triangle_mesh_create(vertices, 4, indices, parts, 2)));
+    for (int i = 0; i < 6; i++) {
+        AircraftComponent component = {0};
+        component.part_type = (AircraftPart)(1 + i % 5);
+        double angle = i * M_PI / 3.0;
+        component.position = vector3d_create(12.0 * cos(angle), 12.0 * sin(angle), 1.0 + i % 3);
+        component.size = vector3d_create(4.0, 3.0, 2.5);
+        component.is_obstructing = 1;
+        CuAssertIntEquals(tc, 1, aircraft_geometry_add_component(geometry, &component));
+    }
+    
+    ObstructionParams params;
+    obstruction_params_init(&params);
+    params.min_obstruction_angle = 0.0;
+    params.precision = 0.1;
+    
+    ObstructionCoherenceCache* cache = obstruction_coherence_create(1.0);
+    CuAssertPtrNotNull(tc, cache);
+    AircraftComponent storage[8];
+    TransformedGeometry transformed;
+    CuAssertIntEquals(tc, 1, transformed_geometry_init(&transformed, storage, 8));
+    
+    /* 60颗卫星均匀分布在天球上，每步绕Z轴转0.05°，姿态偏航每步变化0.02° */
+    const int satellite_count = 60, step_count = 80;
+    int blocked = 0;
+    for (int step = 0; step < step_count; step++) {
+        AircraftAttitude attitude = {0};
+        attitude.pitch = 1.0;
+        attitude.yaw = 30.0 + step * 0.02;
+        CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, geometry, &attitude));
+        
+        for (int i = 0; i < satellite_count; i++) {
+            double z = 1.0 - (2.0 * i + 1.0) / satellite_count;
+            double azimuth = i * 2.39996 + step * 0.05 * M_PI / 180.0;
+            double r = sqrt(1.0 - z * z);
+            Satellite sat = {0};
+            sat.system = SATELLITE_SYSTEM_GPS;
+            sat.prn = i + 1;
+            sat.pos.x = 2.0e7 * r * cos(azimuth);
+            sat.pos.y = 2.0e7 * r * sin(azimuth);
+            sat.pos.z = 2.0e7 * z;
+            
+            /* 遮挡状态和遮挡部件与每步完整求交一致 */
+            ObstructionResult cached, fresh;
+            CuAssertIntEquals(tc, 1, obstruction_coherence_calculate(cache, &transformed, &sat, &params, &cached));
+            CuAssertIntEquals(tc, 1, obstruction_calculate_transformed(&transformed, &sat.pos, &params, &fresh));
+            CuAssertIntEquals(tc, fresh.is_obstructed, cached.is_obstructed);
+            if (fresh.is_obstructed) {
+                CuAssertIntEquals(tc, fresh.obstruction_part, cached.obstruction_part);
+                blocked++;
+            }
+        }
+    }
+    CuAssertTrue(tc, blocked > 0);
+    
+    /* 大部分结果直接复用，只有阴影边界附近的卫星重新求交 */
+    ObstructionCoherenceStats stats;
+    obstruction_coherence_get_stats(cache, &stats);
+    CuAssertTrue(tc, stats.queries == (long long)satellite_count * step_count);
+    CuAssertTrue(tc, stats.reused + stats.computed == stats.queries);
+    CuAssertTrue(tc, stats.reused > stats.queries / 2);
+    
+    /* 几何模型变化后缓存失效，全部重新求交 */
+    AircraftComponent extra = {0};
+    extra.part_type = AIRCRAFT_PART_ENGINE;
+    extra.position = vector3d_create(0.0, 0.0, 10.0);
+    extra.size = vector3d_create(2.0, 2.0, 2.0);
+    extra.is_obstructing = 1;
+    CuAssertIntEquals(tc, 1, aircraft_geometry_add_component(geometry, &extra));
+    AircraftAttitude attitude = {0};
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, geometry, &attitude));
+    
+    Satellite zenith = {0};
+    zenith.system = SATELLITE_SYSTEM_GPS;
+    zenith.prn = 30;
+    zenith.pos.z = 2.0e7;
+    long long computed = stats.computed;
+    ObstructionResult result;
+    CuAssertIntEquals(tc, 1, obstruction_coherence_calculate(cache, &transformed, &zenith, &params, &result));
+    obstruction_coherence_get_stats(cache, &stats);
+    CuAssertTrue(tc, stats.computed == computed + 1);
+    CuAssertIntEquals(tc, 1, result.is_obstructed);
+    
+    /* 超出缓存范围的PRN直接求交 */
+    zenith.prn = OBSTRUCTION_COHERENCE_MAX_PRN + 1;
+    CuAssertIntEquals(tc, 1, obstruction_coherence_calculate(cache, &transformed, &zenith, &params, &result));
+    CuAssertIntEquals(tc, 1, result.is_obstructed);
+    
+    obstruction_coherence_destroy(cache);
+    aircraft_geometry_destroy(geometry);
+}
+
+void TestTriangleMeshModel(CuTest* tc) {
+    /* 天线上方3米的10x10平板 (2个三角形)，另有远处的小三角形凑满多个分块 */
+    Vector3D vertices[4 + 300 * 3];
+    int indices[(2 + 300) * 3];
+    AircraftPart parts[2 + 300];
+    vertices[0] = vector3d_create(-5.0, -5.0, 5.0);
+    vertices[1] = vector3d_create(5.0, -5.0, 5.0);
+    vertices[2] = vector3d_create(5.0, 5.0, 5.0);
+    vertices[3] = vector3d_create(-5.0, 5.0, 5.0);
+    int plate[6] = {0, 1, 2, 0, 2, 3};
+    memcpy(indices, plate, sizeof(plate));
+    parts[0] = parts[1] = AIRCRAFT_PART_TAIL;
+    for (int i = 0; i < 300; i++) {
+        double x = 20.0 + (i % 20), y = -10.0 + (i / 20);
+        vertices[4 + i * 3] = vector3d_create(x, y, -3.0);
+        vertices[5 + i * 3] = vector3d_create(x + 0.5, y, -3.0);
+        vertices[6 + i * 3] = vector3d_create(x, y + 0.5, -3.0);
+        indices[(2 + i) * 3] = 4 + i * 3;
+        indices[(2 + i) * 3 + 1] = 5 + i * 3;
+        indices[(2 + i) * 3 + 2] = 6 + i * 3;
+        parts[2 + i] = AIRCRAFT_PART_ENGINE;
+    }
+    
+    TriangleMesh* mesh = triangle_mesh_create(vertices, 4 + 300 * 3, indices, parts, 302);
+    CuAssertPtrNotNull(tc, mesh);
+    CuAssertIntEquals(tc, 302, mesh->triangle_count);
+    CuAssertIntEquals(tc, 76, mesh->packet_count);
+    CuAssertTrue(tc, mesh->chunk_count > 1);
+    
+    Ray ray = {0};
+    ray.origin = vector3d_create(1.0, 1.0, 2.0);
+    ray.direction = vector3d_create(0.0, 0.0, 1.0);
+    ray.length = 1.0e7;
+    double distance = 0.0;
+    AircraftPart part = AIRCRAFT_PART_FUSELAGE;
+    CuAssertIntEquals(tc, 1, triangle_mesh_intersect_closest(mesh, &ray, &distance, &part));
+    CuAssertDblEquals(tc, 3.0, distance, 1e-12);
+    CuAssertIntEquals(tc, AIRCRAFT_PART_TAIL, part);
+    
+    /* 斜向下射向小三角形区域，与任意命中结论一致 */
+    int hits = 0;
+    for (int k = 0; k < 200; k++) {
+        Vector3D target = vector3d_create(20.0 + k * 0.1, -10.0 + (k % 15) * 1.0 + 0.1, -3.0);
+        Vector3D direction = vector3d_subtract(&target, &ray.origin);
+        Ray slant = ray;
+        slant.direction = vector3d_normalize(&direction);
+        int closest = triangle_mesh_intersect_closest(mesh, &slant, &distance, &part);
+        CuAssertIntEquals(tc, closest, triangle_mesh_intersect_any(mesh, &slant));
+        if (closest) {
+            CuAssertIntEquals(tc, AIRCRAFT_PART_ENGINE, part);
+            CuAssertDblEquals(tc, vector3d_length(&direction), distance, 1e-9);
+            hits++;
+        }
+    }
+    CuAssertTrue(tc, hits > 0 && hits < 200);
+    
+    /* 几何模型接管网格：正上方卫星被遮挡，横滚90°后平板转开 */
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    CuAssertIntEquals(tc, 1, aircraft_geometry_set_mesh(geometry, mesh));
+    
+    ObstructionParams params;
+    obstruction_params_init(&params);
+    params.min_obstruction_angle = 0.0;
+    
+    AircraftAttitude attitude = {0};
+    TransformedGeometry transformed;
+    transformed_geometry_init(&transformed, NULL, 0);
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, geometry, &attitude));
+    
+    SatellitePosition zenith = {0};
+    zenith.z = 2.0e7;
+    ObstructionResult result;
+    CuAssertIntEquals(tc, 1, obstruction_calculate_transformed(&transformed, &zenith, &params, &result));
+    CuAssertDblEquals(tc, 3.0, result.obstruction_distance, 1e-9);
+    CuAssertIntEquals(tc, AIRCRAFT_PART_TAIL, result.obstruction_part);
+    CuAssertIntEquals(tc, 1, obstruction_ray_blocked(&transformed, &zenith));
+    
+    attitude.roll = 90.0;
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, geometry, &attitude));
+    CuAssertIntEquals(tc, 1, obstruction_calculate_transformed(&transformed, &zenith, &params, &result));
+    CuAssertDblEquals(tc, 0.0, result.obstruction_distance, 0.0);
+    CuAssertIntEquals(tc, 0, obstruction_ray_blocked(&transformed, &zenith));
+    aircraft_geometry_destroy(geometry);
+    
+    /* OBJ：四边形按扇形三角化，负索引，组名决定部件 */
+    file_write_text("test_mesh.obj",
+                    "# plate\n"
+                    "v -5 -5 5\nv 5 -5 5\nv 5 5 5\nv -5 5 5\n"
+                    "g left_wing\n"
+                    "f 1/1/1 2/2/1 3/3/1 -1//1\n");
+    TriangleMesh* obj = triangle_mesh_load("test_mesh.obj");
+    CuAssertPtrNotNull(tc, obj);
+    CuAssertIntEquals(tc, 2, obj->triangle_count);
+    CuAssertIntEquals(tc, 1, triangle_mesh_intersect_closest(obj, &ray, &distance, &part));
+    CuAssertIntEquals(tc, AIRCRAFT_PART_WING_LEFT, part);
+    triangle_mesh_destroy(obj);
+    file_delete("test_mesh.obj");
+    
+    /* 部件名：左右和"fin"按完整单词匹配 */
+    CuAssertIntEquals(tc, AIRCRAFT_PART_WING_RIGHT, aircraft_part_from_name("Wing_R"));
+    CuAssertIntEquals(tc, AIRCRAFT_PART_WING_RIGHT, aircraft_part_from_name("right-wing.001"));
+    CuAssertIntEquals(tc, AIRCRAFT_PART_WING_LEFT, aircraft_part_from_name("left_wing_root"));
+    CuAssertIntEquals(tc, AIRCRAFT_PART_WING_LEFT, aircraft_part_from_name("wing_rear"));
+    CuAssertIntEquals(tc, AIRCRAFT_PART_TAIL, aircraft_part_from_name("vertical_fin"));
+    CuAssertIntEquals(tc, AIRCRAFT_PART_FUSELAGE, aircraft_part_from_name("fairing_final"));
+    CuAssertIntEquals(tc, AIRCRAFT_PART_ENGINE, aircraft_part_from_name("Engine2"));
+    
+    /* ASCII STL */
+    file_write_text("test_mesh.stl",
+                    "solid plate\n"
+                    " facet normal 0 0 1\n  outer loop\n"
+                    "   vertex -5 -5 5\n   vertex 5 -5 5\n   vertex 0 5 5\n"
+                    "  endloop\n endfacet\n"
+                    "endsolid plate\n");
+    TriangleMesh* ascii = triangle_mesh_load("test_mesh.stl");
+    CuAssertPtrNotNull(tc, ascii);
+    CuAssertIntEquals(tc, 1, ascii->triangle_count);
+    CuAssertIntEquals(tc, 1, triangle_mesh_intersect_closest(ascii, &ray, &distance, NULL));
+    CuAssertDblEquals(tc, 3.0, distance, 1e-12);
+    triangle_mesh_destroy(ascii);
+    
+    /* 二进制STL (文件头同样以solid开头) */
+    unsigned char binary[84 + 50] = {0};
+    memcpy(binary, "solid binary", 12);
+    binary[80] = 1;
+    float facet[12] = {0.0f, 0.0f, 1.0f, -5.0f, -5.0f, 5.0f, 5.0f, -5.0f, 5.0f, 0.0f, 5.0f, 5.0f};
+    memcpy(binary + 84, facet, sizeof(facet));
+    FILE* file = fopen("test_mesh.stl", "wb");
+    CuAssertPtrNotNull(tc, file);
+    fwrite(binary, 1, sizeof(binary), file);
+    fclose(file);
+    TriangleMesh* stl = triangle_mesh_load_stl("test_mesh.stl");
+    CuAssertPtrNotNull(tc, stl);
+    CuAssertIntEquals(tc, 1, stl->triangle_count);
+    CuAssertIntEquals(tc, 1, triangle_mesh_intersect_closest(stl, &ray, &distance, NULL));
+    CuAssertDblEquals(tc, 3.0, distance, 1e-6);
+    triangle_mesh_destroy(stl);
+    file_delete("test_mesh.stl");
+    
+    CuAssertPtrEquals(tc, NULL, triangle_mesh_load("test_mesh.3ds"));
+}
+
+/* 逐格比较掩码查表与射线求交 (方向取整度数，与单元中心一致) */
+static void assert_mask_matches_raycast(CuTest* tc, TransformedGeometry* transformed) {
+    ObstructionParams params;
+    obstruction_params_init(&params);
+    params.min_obstruction_angle = 0.0;
+    ObstructionParams exact = params;
+    exact.precision = 0.5;
+    
+    int blocked = 0;
+    for (int el = -85; el <= 85; el += 5) {
+        for (int az = 0; az < 360; az += 7) {
+            double e = el * M_PI / 180.0, a = az * M_PI / 180.0;
+            Vector3D body = vector3d_create(cos(e) * cos(a), cos(e) * sin(a), sin(e));
+            Vector3D world = vector3d_rotate(&body, &transformed->body_to_world);
+            SatellitePosition satellite = {0};
+            satellite.x = transformed->antenna_position.x + world.x * 2.0e7;
+            satellite.y = transformed->antenna_position.y + world.y * 2.0e7;
+            satellite.z = transformed->antenna_position.z + world.z * 2.0e7;
+            
+            ObstructionResult masked, traced;
+            CuAssertIntEquals(tc, 1, obstruction_calculate_transformed(transformed, &satellite, &params, &masked));
+            CuAssertIntEquals(tc, 1, obstruction_calculate_transformed(transformed, &satellite, &exact, &traced));
+            CuAssertIntEquals(tc, traced.is_obstructed, masked.is_obstructed);
+            if (traced.is_obstructed) {
+                CuAssertDblEquals(tc, traced.obstruction_distance, masked.obstruction_distance, 1e-5);
+                CuAssertIntEquals(tc, traced.obstruction_part, masked.obstruction_part);
+                CuAssertDblEquals(tc, traced.signal_loss, masked.signal_loss, 1e-5);
+                blocked++;
+            }
+        }
+    }
+    CuAssertTrue(tc, blocked > 0);
+}
+
+void TestObstructionMask(CuTest* tc) {
+    /* 天线上方的平板网格 + 右侧机翼部件 */
+    Vector3D vertices[4];
+    vertices[0] = vector3d_create(-5.0, -5.0, 5.0);
+    vertices[1] = vector3d_create(5.0, -5.0, 5.0);
+    vertices[2] = vector3d_create(5.0, 5.0, 5.0);
+    vertices[3] = vector3d_create(-5.0, 5.0, 5.0);
+    int indices[6] = {0, 1, 2, 0, 2, 3};
+    AircraftPart parts[2] = {AIRCRAFT_PART_TAIL, AIRCRAFT_PART_TAIL};
+    
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    CuAssertIntEquals(tc, 1, aircraft_geometry_set_mesh(geometry, triangle_mesh_create(vertices, 4, indices, parts, 2)));
+    AircraftComponent wing = {0};
+    wing.part_type = AIRCRAFT_PART_WING_RIGHT;
+    wing.position = vector3d_create(0.3, 9.1, 1.2);
+    wing.size = vector3d_create(4.1, 10.3, 0.7);
+    wing.is_obstructing = 1;
+    CuAssertIntEquals(tc, 1, aircraft_geometry_add_component(geometry, &wing));
+    
+    ObstructionMask* mask = obstruction_mask_create();
+    CuAssertPtrNotNull(tc, mask);
+    CuAssertIntEquals(tc, 0, mask->valid);
+    
+    AircraftComponent storage[1];
+    TransformedGeometry transformed;
+    transformed_geometry_init(&transformed, storage, 1);
+    CuAssertIntEquals(tc, 1, transformed_geometry_set_mask(&transformed, mask));
+    AircraftAttitude attitude = {0};
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, geometry, &attitude));
+    CuAssertIntEquals(tc, 1, obstruction_mask_is_current(mask, geometry));
+    CuAssertTrue(tc, mask->blocked_cells > 0);
+    assert_mask_matches_raycast(tc, &transformed);
+    
+    /* 正上方 -> 平板；越过360°的方位回绕到第0列 */
+    Vector3D up = vector3d_create(0.0, 0.0, 1.0);
+    ObstructionMaskCell cell;
+    CuAssertIntEquals(tc, 1, obstruction_mask_lookup(mask, &up, &cell));
+    CuAssertIntEquals(tc, 1, cell.blocked);
+    CuAssertIntEquals(tc, AIRCRAFT_PART_TAIL, cell.part_type);
+    CuAssertDblEquals(tc, 3.0, cell.distance, 1e-6);
+    Vector3D wrap = vector3d_create(1.0, -0.005, 0.0);
+    CuAssertIntEquals(tc, 90 * OBSTRUCTION_MASK_AZIMUTH_CELLS, obstruction_mask_cell_index(&wrap));
+    
+    /* 几何未变化时不重建；天线位置变化后重建 */
+    mask->build_time = -1.0;
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, geometry, &attitude));
+    CuAssertDblEquals(tc, -1.0, mask->build_time, 0.0);
+    Vector3D antenna = vector3d_create(0.0, 0.0, 1.0);
+    aircraft_geometry_set_antenna_position(geometry, &antenna);
+    CuAssertIntEquals(tc, 0, obstruction_mask_is_current(mask, geometry));
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, geometry, &attitude));
+    CuAssertTrue(tc, mask->build_time >= 0.0);
+    CuAssertIntEquals(tc, 1, obstruction_mask_lookup(mask, &up, &cell));
+    CuAssertDblEquals(tc, 4.0, cell.distance, 1e-6);
+    aircraft_geometry_destroy(geometry);
+    
+    /* 刚体网格在非零姿态下：掩码在机体坐标系中保持不变 */
+    geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    CuAssertIntEquals(tc, 1, aircraft_geometry_set_mesh(geometry, triangle_mesh_create(vertices, 4, indices, parts, 2)));
+    attitude.roll = 30.0;
+    attitude.pitch = 10.0;
+    attitude.yaw = 45.0;
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, geometry, &attitude));
+    CuAssertIntEquals(tc, 1, obstruction_mask_is_current(mask, geometry));
+    assert_mask_matches_raycast(tc, &transformed);
+    
+    /* 长方体部件与网格一起随机体刚性旋转，栅格化进掩码：非零姿态下查表与射线求交一致 */
+    CuAssertIntEquals(tc, 1, aircraft_geometry_add_component(geometry, &wing));
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, geometry, &attitude));
+    CuAssertIntEquals(tc, 1, obstruction_mask_is_current(mask, geometry));
+    assert_mask_matches_raycast(tc, &transformed);
+    
+    Vector3D to_wing = vector3d_subtract(&wing.position, &transformed.antenna_position);
+    CuAssertIntEquals(tc, 1, obstruction_mask_lookup(mask, &to_wing, &cell));
+    CuAssertIntEquals(tc, 1, cell.blocked);
+    CuAssertIntEquals(tc, AIRCRAFT_PART_WING_RIGHT, cell.part_type);
+    
+    /* 机体坐标系中指向机翼的视线在世界坐标系中随姿态旋转，查表和求交都命中机翼 */
+    ObstructionParams params;
+    obstruction_params_init(&params);
+    params.min_obstruction_angle = 0.0;
+    ObstructionParams exact = params;
+    exact.precision = 0.5;
+    Vector3D world_to_wing = vector3d_rotate(&to_wing, &transformed.body_to_world);
+    SatellitePosition toward_wing = {0};
+    toward_wing.x = transformed.antenna_position.x + world_to_wing.x * 1.0e6;
+    toward_wing.y = transformed.antenna_position.y + world_to_wing.y * 1.0e6;
+    toward_wing.z = transformed.antenna_position.z + world_to_wing.z * 1.0e6;
+    ObstructionResult result;
+    CuAssertIntEquals(tc, 1, obstruction_calculate_transformed(&transformed, &toward_wing, &params, &result));
+    CuAssertIntEquals(tc, 1, result.is_obstructed);
+    CuAssertIntEquals(tc, AIRCRAFT_PART_WING_RIGHT, result.obstruction_part);
+    CuAssertIntEquals(tc, 1, obstruction_calculate_transformed(&transformed, &toward_wing, &exact, &result));
+    CuAssertIntEquals(tc, 1, result.is_obstructed);
+    CuAssertIntEquals(tc, AIRCRAFT_PART_WING_RIGHT, result.obstruction_part);
+    
+    /* 只有长方体部件、没有网格的机型同样查表 */
+    AircraftGeometry* boxes = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    CuAssertIntEquals(tc, 1, aircraft_geometry_add_component(boxes, &wing));
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, boxes, &attitude));
+    CuAssertIntEquals(tc, 1, obstruction_mask_is_current(mask, boxes));
+    CuAssertTrue(tc, mask->blocked_cells > 0);
+    assert_mask_matches_raycast(tc, &transformed);
+    aircraft_geometry_destroy(boxes);
+    
+    aircraft_geometry_destroy(geometry);
+    obstruction_mask_destroy(mask);
+}
+
+void TestObstructionMaskFile(CuTest* tc) {
+    Vector3D vertices[4];
+    vertices[0] = vector3d_create(-5.0, -5.0, 5.0);
+    vertices[1] = vector3d_create(5.0, -5.0, 5.0);
+    vertices[2] = vector3d_create(5.0, 5.0, 5.0);
+    vertices[3] = vector3d_create(-5.0, 5.0, 5.0);
+    int indices[6] = {0, 1, 2, 0, 2, 3};
+    AircraftPart parts[2] = {AIRCRAFT_PART_TAIL, AIRCRAFT_PART_TAIL};
+    
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    CuAssertIntEquals(tc, 1, aircraft_geometry_set_mesh(geometry, triangle_mesh_create(vertices, 4, indices, parts, 2)));
+    AircraftComponent wing = {0};
+    wing.part_type = AIRCRAFT_PART_WING_RIGHT;
+    wing.position = vector3d_create(0.3, 9.1, 1.2);
+    wing.size = vector3d_create(4.1, 10.3, 0.7);
+    wing.is_obstructing = 1;
+    CuAssertIntEquals(tc, 1, aircraft_geometry_add_component(geometry, &wing));
+    
+    /* 首次构建并保存，第二次直接映射文件 */
+    file_delete("test_mask.bin");
+    ObstructionMask* built = obstruction_mask_create();
+    CuAssertIntEquals(tc, 1, obstruction_mask_load_cached(built, geometry, "test_mask.bin"));
+    CuAssertPtrNotNull(tc, built->cells);
+    CuAssertIntEquals(tc, 1, file_exists("test_mask.bin"));
+    CuAssertTrue(tc, file_size("test_mask.bin") < (long)(sizeof(ObstructionMaskCell) * OBSTRUCTION_MASK_AZIMUTH_CELLS * OBSTRUCTION_MASK_ELEVATION_CELLS));
+    
+    ObstructionMask* mapped = obstruction_mask_create();
+    CuAssertIntEquals(tc, 1, obstruction_mask_load_cached(mapped, geometry, "test_mask.bin"));
+    CuAssertTrue(tc, mapped->cells == NULL);
+    CuAssertPtrNotNull(tc, mapped->mapping);
+    CuAssertIntEquals(tc, 1, obstruction_mask_is_current(mapped, geometry));
+    CuAssertIntEquals(tc, built->blocked_cells, mapped->blocked_cells);
+    
+    /* 映射查询与内存栅格逐单元一致 */
+    for (int e = -90; e <= 90; e++) {
+        for (int a = 0; a < 360; a++) {
+            double el = e * M_PI / 180.0, az = a * M_PI / 180.0;
+            Vector3D direction = vector3d_create(cos(el) * cos(az), cos(el) * sin(az), sin(el));
+            ObstructionMaskCell expected, actual;
+            CuAssertIntEquals(tc, 1, obstruction_mask_lookup(built, &direction, &expected));
+            CuAssertIntEquals(tc, 1, obstruction_mask_lookup(mapped, &direction, &actual));
+            CuAssertIntEquals(tc, expected.blocked, actual.blocked);
+            if (expected.blocked) {
+                CuAssertIntEquals(tc, expected.part_type, actual.part_type);
+                CuAssertDblEquals(tc, expected.distance, actual.distance, 0.0);
+                CuAssertDblEquals(tc, expected.signal_loss, actual.signal_loss, 0.0);
+            }
+        }
+    }
+    
+    /* 挂接映射的掩码后查表结果与射线求交一致，且不会触发重建 */
+    AircraftComponent storage[1];
+    TransformedGeometry transformed;
+    transformed_geometry_init(&transformed, storage, 1);
+    transformed_geometry_set_mask(&transformed, mapped);
+    AircraftAttitude attitude = {0};
+    CuAssertIntEquals(tc, 1, transformed_geometry_update(&transformed, geometry, &attitude));
+    CuAssertTrue(tc, mapped->cells == NULL);
+    assert_mask_matches_raycast(tc, &transformed);
+    
+    /* 姿态不是几何内容：按姿态更新部件变换后指纹不变，文件仍可加载 */
+    unsigned long long fingerprint = obstruction_mask_fingerprint(geometry);
+    attitude.pitch = 8.0;
+    attitude.roll = -15.0;
+    CuAssertIntEquals(tc, 1, aircraft_geometry_update_transform(geometry, &attitude));
+    CuAssertTrue(tc, obstruction_mask_fingerprint(geometry) == fingerprint);
+    ObstructionMask* reloaded = obstruction_mask_create();
+    CuAssertIntEquals(tc, 1, obstruction_mask_load(reloaded, "test_mask.bin", geometry));
+    obstruction_mask_destroy(reloaded);
+    
+    /* 机型不同时拒绝加载，load_cached回退到重新构建 */
+    AircraftGeometry* other = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    CuAssertIntEquals(tc, 1, aircraft_geometry_add_component(other, &wing));
+    CuAssertTrue(tc, obstruction_mask_fingerprint(other) != obstruction_mask_fingerprint(geometry));
+    ObstructionMask* rejected = obstruction_mask_create();
+    CuAssertIntEquals(tc, 0, obstruction_mask_load(rejected, "test_mask.bin", other));
+    CuAssertIntEquals(tc, 0, rejected->valid);
+    
+    /* 损坏的文件被校验和拒绝 */
+    FILE* file = fopen("test_mask.bin", "r+b");
+    CuAssertPtrNotNull(tc, file);
+    fseek(file, -1, SEEK_END);
+    fputc(0x5A ^ fgetc(file), file);
+    fclose(file);
+    CuAssertIntEquals(tc, 0, obstruction_mask_load(rejected, "test_mask.bin", geometry));
+    CuAssertIntEquals(tc, 1, obstruction_mask_load_cached(rejected, geometry, "test_mask.bin"));
+    CuAssertPtrNotNull(tc, rejected->cells);
+    
+    file_delete("test_mask.bin");
+    obstruction_mask_destroy(rejected);
+    obstruction_mask_destroy(mapped);
+    obstruction_mask_destroy(built);
+    aircraft_geometry_destroy(other);
+    aircraft_geometry_destroy(geometry);
+}
+
 void TestVector3DOperations(CuTest* tc) {
     Vector3D v1 = {1.0, 2.0, 3.0};
     Vector3D v2 = {4.0, 5.0, 6.0};
@@ -533,6 +2328,47 @@ void TestUtilsMath(CuTest* tc) {
     CuAssertDblEquals(tc, 5.0, interpolated, 0.001);
 }
 
+void TestFastMathAccuracy(CuTest* tc) {
+    /* 与libm对比，误差须在0.01°和0.01dB要求以内 */
+    double max_atan2 = 0.0, max_acos = 0.0, max_log10 = 0.0;
+    
+    for (int i = 0; i <= 400; i++) {
+        for (int j = 0; j <= 400; j++) {
+            double y = -1.0 + i / 200.0;
+            double x = -1.0 + j / 200.0;
+            double error = fabs(fast_atan2(y, x) - atan2(y, x));
+            if (error > max_atan2) max_atan2 = error;
+        }
+    }
+    for (int i = 0; i <= 200000; i++) {
+        double x = -1.0 + i / 100000.0;
+        double error = fabs(fast_acos(x) - acos(x));
+        if (error > max_acos) max_acos = error;
+    }
+    for (int i = 0; i <= 200000; i++) {
+        double x = exp(-20.0 + i / 5000.0);  /* 覆盖e^-20到e^20 */
+        double error = fabs(fast_log10(x) - log10(x));
+        if (error > max_log10) max_log10 = error;
+    }
+    
+    CuAssertTrue(tc, radians_to_degrees(max_atan2) < 0.001);
+    CuAssertTrue(tc, radians_to_degrees(max_acos) < 1e-5);
+    CuAssertTrue(tc, 20.0 * max_log10 < 1e-5);
+    
+    /* 特殊值与libm一致 */
+    CuAssertDblEquals(tc, M_PI, fast_atan2(0.0, -1.0), 1e-12);
+    CuAssertDblEquals(tc, 0.0, fast_acos(1.0), 1e-7);
+    CuAssertTrue(tc, isnan(fast_acos(1.5)));
+    CuAssertTrue(tc, isnan(fast_log10(-1.0)));
+    
+    /* 运行时开关 */
+    fast_math_set_enabled(1);
+    CuAssertIntEquals(tc, 1, fast_math_is_enabled());
+    CuAssertDblEquals(tc, fast_log10(12345.0), math_log10(12345.0), 0.0);
+    fast_math_set_enabled(0);
+    CuAssertDblEquals(tc, log10(12345.0), math_log10(12345.0), 0.0);
+}
+
 void TestUtilsTime(CuTest* tc) {
     /* 测试时间差计算 */
     time_t time1 = 1000;
@@ -661,6 +2497,285 @@ void TestWebServerStart(CuTest* tc) {
     http_server_destroy(server);
 }
 
+static void test_sleep_ms(int ms) {
+    struct timeval tv;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    select(0, NULL, NULL, NULL, &tv);
+}
+
+static int test_http_connect(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct timeval tv = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void test_http_send(int fd, const char* data) {
+    send(fd, data, strlen(data), 0);
+}
+
+/* 读取恰好一个完整响应 (按Content-Length，不读入后续流水线响应)，返回长度；连接关闭且无数据返回0 */
+static int test_http_read_response(int fd, char* buffer, int size) {
+    int length = 0;
+    int total = -1;
+    while (length < size - 1 && (total < 0 || length < total)) {
+        /* 请求头逐字节读取，找到空行后按Content-Length读取响应体 */
+        int want = total < 0 ? 1 : total - length;
+        int received = (int)recv(fd, buffer + length, want, 0);
+        if (received <= 0) break;
+        length += received;
+        buffer[length] = '\0';
+        if (total < 0 && length >= 4 && strcmp(buffer + length - 4, "\r\n\r\n") == 0) {
+            const char* content_length = strstr(buffer, "Content-Length: ");
+            total = length + (content_length ? atoi(content_length + 16) : 0);
+        }
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+void TestHttpServerReactor(CuTest* tc) {
+    HttpServerConfig config = {0};
+    http_server_config_init(&config);
+    config.port = 18181;
+    config.io_threads = 2;
+    config.max_connections = 3;
+    config.timeout = 1;
+    
+    HttpServer* server = http_server_create(&config);
+    CuAssertPtrNotNull(tc, server);
+    CuAssertIntEquals(tc, 1, http_server_start(server));
+    CuAssertIntEquals(tc, 2, server->io_thread_count);
+    char response[16384];
+    
+    /* 请求头只发了一半的慢客户端不阻塞其他客户端 */
+    int slow = test_http_connect(config.port);
+    CuAssertTrue(tc, slow >= 0);
+    test_http_send(slow, "GET /api/status HTTP/1.1\r\nHo");
+    int fast = test_http_connect(config.port);
+    CuAssertTrue(tc, fast >= 0);
+    test_http_send(fast, "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    CuAssertTrue(tc, test_http_read_response(fast, response, sizeof(response)) > 0);
+    CuAssertTrue(tc, strstr(response, "HTTP/1.1 200 OK") != NULL);
+    close(fast);
+    
+    test_http_send(slow, "st: localhost\r\n\r\n");
+    CuAssertTrue(tc, test_http_read_response(slow, response, sizeof(response)) > 0);
+    CuAssertTrue(tc, strstr(response, "\"status\":\"running\"") != NULL);
+    close(slow);
+    
+    /* 请求体分两次到达，按Content-Length读完整后才处理 */
+    int post = test_http_connect(config.port);
+    test_http_send(post, "POST /api/status HTTP/1.1\r\ncontent-length: 10\r\n\r\n01234");
+    test_sleep_ms(50);
+    test_http_send(post, "56789");
+    CuAssertTrue(tc, test_http_read_response(post, response, sizeof(response)) > 0);
+    CuAssertTrue(tc, strstr(response, "HTTP/1.1 200") != NULL);
+    close(post);
+    
+    /* 连接数达到上限后新连接收到503 */
+    for (int i = 0; i < 50 && server->connection_count > 0; i++) test_sleep_ms(20);
+    int idle[3];
+    for (int i = 0; i < 3; i++) {
+        idle[i] = test_http_connect(config.port);
+        CuAssertTrue(tc, idle[i] >= 0);
+    }
+    for (int i = 0; i < 50 && server->connection_count < 3; i++) test_sleep_ms(20);
+    CuAssertIntEquals(tc, 3, server->connection_count);
+    int rejected = test_http_connect(config.port);
+    CuAssertTrue(tc, test_http_read_response(rejected, response, sizeof(response)) > 0);
+    CuAssertTrue(tc, strstr(response, "503") != NULL);
+    close(rejected);
+    
+    /* 空闲连接超时后被关闭，名额释放 */
+    CuAssertIntEquals(tc, 0, (int)recv(idle[0], response, sizeof(response), 0));
+    for (int i = 0; i < 3; i++) close(idle[i]);
+    for (int i = 0; i < 50 && server->connection_count > 0; i++) test_sleep_ms(20);
+    CuAssertIntEquals(tc, 0, server->connection_count);
+    
+    CuAssertIntEquals(tc, 1, http_server_stop(server));
+    http_server_destroy(server);
+}
+
+void TestHttpKeepAlive(CuTest* tc) {
+    HttpServerConfig config = {0};
+    http_server_config_init(&config);
+    config.port = 18182;
+    config.io_threads = 1;
+    config.keepalive_timeout = 1;
+    
+    HttpServer* server = http_server_create(&config);
+    CuAssertPtrNotNull(tc, server);
+    CuAssertIntEquals(tc, 1, http_server_start(server));
+    char response[16384];
+    
+    /* 一次发送三个流水线请求，响应按请求顺序返回，连接保持 */
+    int fd = test_http_connect(config.port);
+    CuAssertTrue(tc, fd >= 0);
+    test_http_send(fd, "GET /api/status HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                       "GET /missing HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                       "POST /api/status HTTP/1.1\r\nContent-Length: 4\r\n\r\nabcd"
+                       "GET / HTTP/1.1\r\n");
+    CuAssertTrue(tc, test_http_read_response(fd, response, sizeof(response)) > 0);
+    CuAssertTrue(tc, strstr(response, "\"status\":\"running\"") != NULL);
+    CuAssertTrue(tc, strstr(response, "Connection: keep-alive") != NULL);
+    CuAssertTrue(tc, test_http_read_response(fd, response, sizeof(response)) > 0);
+    CuAssertTrue(tc, strncmp(response, "HTTP/1.1 404", 12) == 0);
+    CuAssertTrue(tc, test_http_read_response(fd, response, sizeof(response)) > 0);
+    CuAssertTrue(tc, strncmp(response, "HTTP/1.1 200", 12) == 0);
+    
+    /* 最后一个请求的其余部分稍后到达，仍在同一连接上处理 */
+    test_http_send(fd, "Host: localhost\r\n\r\n");
+    CuAssertTrue(tc, test_http_read_response(fd, response, sizeof(response)) > 0);
+    CuAssertTrue(tc, strstr(response, "<html>") != NULL);
+    
+    /* Connection: close -> 响应后关闭 */
+    test_http_send(fd, "GET /api/status HTTP/1.1\r\nConnection: close\r\n\r\n");
+    CuAssertTrue(tc, test_http_read_response(fd, response, sizeof(response)) > 0);
+    CuAssertTrue(tc, strstr(response, "Connection: close") != NULL);
+    CuAssertIntEquals(tc, 0, (int)recv(fd, response, sizeof(response), 0));
+    close(fd);
+    
+    /* HTTP/1.0默认关闭；保持的连接空闲超时后关闭 */
+    fd = test_http_connect(config.port);
+    test_http_send(fd, "GET / HTTP/1.0\r\n\r\n");
+    CuAssertTrue(tc, test_http_read_response(fd, response, sizeof(response)) > 0);
+    CuAssertIntEquals(tc, 0, (int)recv(fd, response, sizeof(response), 0));
+    close(fd);
+    
+    fd = test_http_connect(config.port);
+    test_http_send(fd, "GET / HTTP/1.1\r\n\r\n");
+    CuAssertTrue(tc, test_http_read_response(fd, response, sizeof(response)) > 0);
+    time_t idle_start = time(NULL);
+    CuAssertIntEquals(tc, 0, (int)recv(fd, response, sizeof(response), 0));
+    CuAssertTrue(tc, time(NULL) - idle_start <= 3);
+    close(fd);
+    
+    CuAssertIntEquals(tc, 1, http_server_stop(server));
+    http_server_destroy(server);
+}
+
+void TestHttpWorkerPool(CuTest* tc) {
+    HttpServerConfig config = {0};
+    http_server_config_init(&config);
+    HttpServer* server = http_server_create(&config);
+    CuAssertPtrNotNull(tc, server);
+    
+    /* 不启动事件循环，用一个I/O线程对象接收完成的任务 */
+    HttpIoThread io;
+    memset(&io, 0, sizeof(io));
+    io.server = server;
+    io.wake_fd = -1;
+    pthread_mutex_init(&io.completed_mutex, NULL);
+    
+    int limits[HTTP_API_ENDPOINT_COUNT] = {0};
+    limits[API_ANALYSIS] = 1;
+    HttpWorkerPool* pool = http_worker_pool_create(server, 2, 3, limits);
+    CuAssertPtrNotNull(tc, pool);
+    
+    /* 工作线程启动前任务只排队：分析端点超过上限、队列满时拒绝 */
+    const ApiEndpointType endpoints[5] = {API_ANALYSIS, API_ANALYSIS, API_STATUS, API_STATUS, API_STATUS};
+    const int expected[5] = {1, 0, 1, 1, 0};
+    for (int i = 0; i < 5; i++) {
+        HttpApiJob* job = (HttpApiJob*)safe_malloc(sizeof(HttpApiJob));
+        memset(job, 0, sizeof(HttpApiJob));
+        job->io = &io;
+        job->endpoint = endpoints[i];
+        job->keep_alive = 1;
+        job->request.method = HTTP_GET;
+        job->request.path = safe_strdup(endpoints[i] == API_STATUS ? "/api/status" : "/api/analysis");
+        int accepted = http_worker_pool_submit(pool, job);
+        CuAssertIntEquals(tc, expected[i], accepted);
+        if (!accepted) http_api_job_destroy(job);
+    }
+    
+    HttpWorkerPoolStats stats;
+    http_worker_pool_get_stats(pool, &stats);
+    CuAssertIntEquals(tc, 3, stats.queue_depth);
+    CuAssertIntEquals(tc, 2, (int)stats.rejected);
+    CuAssertIntEquals(tc, 1, stats.in_flight[API_ANALYSIS]);
+    
+    test_sleep_ms(20);
+    CuAssertIntEquals(tc, 1, http_worker_pool_start(pool));
+    for (int i = 0; i < 100; i++) {
+        http_worker_pool_get_stats(pool, &stats);
+        if (stats.completed == 3) break;
+        test_sleep_ms(20);
+    }
+    CuAssertIntEquals(tc, 3, (int)stats.completed);
+    CuAssertIntEquals(tc, 0, stats.queue_depth);
+    CuAssertIntEquals(tc, 0, stats.in_flight[API_ANALYSIS]);
+    CuAssertTrue(tc, stats.max_wait_ms >= 15.0);
+    
+    /* 完成的任务交回I/O线程，带序列化好的响应 */
+    int completed = 0;
+    HttpApiJob* job = io.completed;
+    while (job) {
+        HttpApiJob* next = job->next;
+        char* output = response_buffer_flatten(&job->output);
+        CuAssertPtrNotNull(tc, output);
+        CuAssertTrue(tc, strncmp(output, "HTTP/1.1 ", 9) == 0);
+        if (job->endpoint == API_STATUS) {
+            CuAssertTrue(tc, strncmp(output, "HTTP/1.1 200", 12) == 0);
+            CuAssertTrue(tc, strstr(output, "Connection: keep-alive") != NULL);
+        }
+        safe_free((void**)&output);
+        http_api_job_destroy(job);
+        completed++;
+        job = next;
+    }
+    CuAssertIntEquals(tc, 3, completed);
+    
+    http_worker_pool_destroy(pool);
+    pthread_mutex_destroy(&io.completed_mutex);
+    http_server_destroy(server);
+    
+    /* 服务器状态中报告线程池指标 (销毁服务器时已释放配置中的字符串) */
+    http_server_config_init(&config);
+    config.port = 18183;
+    config.io_threads = 1;
+    config.api_workers = 2;
+    server = http_server_create(&config);
+    CuAssertPtrNotNull(tc, server);
+    CuAssertIntEquals(tc, 1, http_server_start(server));
+    char response[16384];
+    int fd = test_http_connect(config.port);
+    CuAssertTrue(tc, fd >= 0);
+    test_http_send(fd, "GET /api/status HTTP/1.1\r\n\r\nGET /api/status HTTP/1.1\r\n\r\n");
+    CuAssertTrue(tc, test_http_read_response(fd, response, sizeof(response)) > 0);
+    CuAssertTrue(tc, test_http_read_response(fd, response, sizeof(response)) > 0);
+    CuAssertTrue(tc, strstr(response, "\"worker_pool\":{\"workers\":2") != NULL);
+    CuAssertTrue(tc, strstr(response, "\"completed\":1") != NULL);
+    close(fd);
+    
+    /* 请求仍在提交和执行时停止：I/O线程先结束，线程池随后销毁 */
+    int burst[4];
+    for (int i = 0; i < 4; i++) {
+        burst[i] = test_http_connect(config.port);
+        CuAssertTrue(tc, burst[i] >= 0);
+        for (int j = 0; j < 8; j++) {
+            test_http_send(burst[i], "GET /api/status HTTP/1.1\r\n\r\n");
+        }
+    }
+    CuAssertIntEquals(tc, 1, http_server_stop(server));
+    CuAssertPtrEquals(tc, NULL, server->worker_pool);
+    for (int i = 0; i < 4; i++) {
+        close(burst[i]);
+    }
+    http_server_destroy(server);
+}
+
 void TestHttpRequestParse(CuTest* tc) {
     HttpRequest* request = http_request_create();
     CuAssertPtrNotNull(tc, request);
@@ -699,6 +2814,348 @@ void TestApiHandleRequest(CuTest* tc) {
     CuAssertTrue(tc, 1); /* 占位符 */
 }
 
+/* 直接调用API处理函数，返回响应体中的数据部分 */
+static int test_api_get(HttpServer* server, const char* path, const char* query, HttpResponse* response) {
+    HttpRequest request;
+    memset(&request, 0, sizeof(request));
+    request.method = HTTP_GET;
+    request.path = safe_strdup(path);
+    request.query_string = query ? safe_strdup(query) : NULL;
+    http_response_reset(response);
+    int result = api_handle_request(&request, response, server);
+    if (result) {
+        /* 处理函数把响应体写在分块缓冲区中，拼成连续字符串便于断言 */
+        response->body = response_buffer_flatten(&response->payload);
+    }
+    http_request_reset(&request);
+    return result;
+}
+
+static double test_json_number(const char* json, const char* name) {
+    char pattern[128];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", name);
+    const char* found = strstr(json, pattern);
+    return found ? atof(found + strlen(pattern)) : -1.0;
+}
+
+void TestApiAnalysisCache(CuTest* tc) {
+    AircraftGeometry* geometry = aircraft_geometry_create(AIRCRAFT_MODEL_COMMERCIAL);
+    AircraftComponent component = {0};
+    component.part_type = AIRCRAFT_PART_TAIL;
+    component.position = vector3d_create(0.0, 0.0, 5.0);
+    component.size = vector3d_create(30.0, 30.0, 2.0);
+    component.is_obstructing = 1;
+    aircraft_geometry_add_component(geometry, &component);
+    
+    SatelliteData* sat_data = satellite_data_create(16);
+    for (int i = 0; i < 12; i++) {
+        Satellite sat = {0};
+        sat.prn = i + 1;
+        sat.system = SATELLITE_SYSTEM_GPS;
+        sat.is_valid = 1;
+        sat.valid_time = 1700000000;
+        sat.orbit.sqrt_a = 5153.8;
+        sat.orbit.e = 0.01;
+        sat.orbit.i0 = 0.96;
+        sat.orbit.omega0 = -3.0 + 0.5 * i;
+        sat.orbit.omega = 0.3 * i;
+        sat.orbit.m0 = -3.0 + 0.55 * i;
+        satellite_data_add(sat_data, &sat);
+    }
+    
+    const int point_count = 60;
+    FlightTrajectory* trajectory = flight_trajectory_create(point_count + 1);
+    trajectory->trajectory_id = 7;
+    for (int i = 0; i < point_count; i++) {
+        TrajectoryPoint point = {0};
+        point.timestamp = 1700000000 + i;
+        point.state.timestamp = point.timestamp;
+        point.state.position.latitude = 30.0 + i * 0.001;
+        point.state.position.longitude = 110.0;
+        point.state.position.altitude = 10000.0;
+        point.state.attitude.roll = 30.0 * sin(i * 0.2);
+        point.state.attitude.yaw = 45.0;
+        point.state.is_valid = 1;
+        flight_trajectory_add_point(trajectory, &point);
+    }
+    
+    HttpServerConfig config = {0};
+    http_server_config_init(&config);
+    config.port = 18186;
+    config.io_threads = 1;
+    HttpServer* server = http_server_create(&config);
+    CuAssertPtrNotNull(tc, server);
+    http_server_set_data(server, sat_data, trajectory, geometry);
+    
+    /* 参考结果：逐点的批量计算 (轨迹分析关闭相干缓存时与之一致) */
+    ObstructionParams params;
+    obstruction_params_init(&params);
+    TrajectoryAnalysisConfig analysis_config;
+    trajectory_analysis_config_default(&analysis_config);
+    analysis_config.thread_count = 1;
+    analysis_config.coherence_tolerance = 0.0;
+    TrajectoryAnalysisResult reference;
+    CuAssertIntEquals(tc, 1, trajectory_obstruction_analyze(geometry, sat_data, trajectory, &params,
+                                                            &analysis_config, &reference));
+    
+    /* 按轨迹点下标范围分析 */
+    HttpResponse response;
+    memset(&response, 0, sizeof(response));
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "start_point=10&end_point=30", &response));
+    CuAssertIntEquals(tc, 200, response.status_code);
+    CuAssertIntEquals(tc, 20, (int)test_json_number(response.body, "points_analyzed"));
+    CuAssertIntEquals(tc, 29, (int)test_json_number(response.body, "last_point"));
+    double usable_sum = 0.0;
+    int min_usable = 100;
+    for (int step = 10; step < 30; step++) {
+        usable_sum += reference.steps[step].usable_satellites;
+        if (reference.steps[step].usable_satellites < min_usable) min_usable = reference.steps[step].usable_satellites;
+    }
+    CuAssertDblEquals(tc, usable_sum / 20.0, test_json_number(response.body, "average_usable_satellites"), 0.005);
+    CuAssertIntEquals(tc, min_usable, (int)test_json_number(response.body, "min_usable_satellites"));
+    CuAssertIntEquals(tc, reference.steps[29].usable_satellites, (int)test_json_number(response.body, "usable_satellites"));
+    CuAssertTrue(tc, strstr(response.body, "\"satellite_prn\":12") != NULL);
+    char first_body[16384];
+    snprintf(first_body, sizeof(first_body), "%s", response.body);
+    
+    /* 相同请求命中缓存，返回同一结果 */
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "start_point=10&end_point=30", &response));
+    CuAssertTrue(tc, strstr(response.body, "(缓存)") != NULL);
+    CuAssertTrue(tc, strstr(response.body, strstr(first_body, "\"data\":")) != NULL);
+    AnalysisCacheStats stats;
+    analysis_cache_get_stats(server->analysis_cache, &stats);
+    CuAssertIntEquals(tc, 1, (int)stats.hits);
+    CuAssertIntEquals(tc, 1, (int)stats.misses);
+    
+    /* 命中时缓存与响应共享同一份结果，发送完成后只释放引用 */
+    AnalysisCache* cache = analysis_cache_create();
+    AnalysisCacheKey key;
+    int key_params = 7;
+    analysis_cache_key_init(&key, sat_data, trajectory, geometry, &key_params, sizeof(key_params));
+    ResponseBuffer data;
+    response_buffer_init(&data);
+    response_buffer_append_string(&data, "{\"points_analyzed\":");
+    response_buffer_append_string(&data, "20}");
+    AnalysisCacheBlob* blob = analysis_cache_blob_create(&data);
+    CuAssertPtrNotNull(tc, blob);
+    CuAssertStrEquals(tc, "{\"points_analyzed\":20}", blob->json);
+    CuAssertIntEquals(tc, 1, analysis_cache_put(cache, &key, blob));
+    AnalysisCacheBlob* hit = analysis_cache_get(cache, &key);
+    CuAssertPtrEquals(tc, blob, hit);
+    CuAssertIntEquals(tc, 3, atomic_load(&blob->refcount));
+    response_buffer_reset(&data);
+    CuAssertIntEquals(tc, 1, analysis_cache_blob_attach(&data, hit));
+    CuAssertTrue(tc, data.head->data == blob->json);
+    analysis_cache_clear(cache);
+    analysis_cache_blob_release(blob);
+    CuAssertIntEquals(tc, 1, atomic_load(&blob->refcount));
+    CuAssertIntEquals(tc, (int)strlen("{\"points_analyzed\":20}"), (int)data.length);
+    response_buffer_reset(&data);
+    analysis_cache_destroy(cache);
+    
+    /* 时间范围与等价的下标范围共用缓存项 */
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "start_time=1700000010&end_time=1700000029", &response));
+    analysis_cache_get_stats(server->analysis_cache, &stats);
+    CuAssertIntEquals(tc, 2, (int)stats.hits);
+    CuAssertIntEquals(tc, 1, stats.entries);
+    
+    /* 轨迹变化后版本号递增，重新计算 */
+    TrajectoryPoint extra = trajectory->points[point_count - 1];
+    extra.timestamp += 1;
+    flight_trajectory_add_point(trajectory, &extra);
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "start_point=10&end_point=30", &response));
+    CuAssertTrue(tc, strstr(response.body, "(缓存)") == NULL);
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", NULL, &response));
+    CuAssertIntEquals(tc, point_count + 1, (int)test_json_number(response.body, "points_analyzed"));
+    analysis_cache_get_stats(server->analysis_cache, &stats);
+    CuAssertIntEquals(tc, 3, (int)stats.misses);
+    CuAssertIntEquals(tc, 3, stats.entries);
+    
+    /* 没有星历的卫星使用当前位置：位置变化不递增版本号，但参与缓存键 */
+    Satellite* fixed = &sat_data->satellites[11];
+    fixed->orbit.sqrt_a = 0.0;
+    fixed->pos.x = -2.0e7;
+    fixed->pos.y = 1.2e7;
+    fixed->pos.z = 1.0e7;
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "start_point=10&end_point=30", &response));
+    CuAssertTrue(tc, strstr(response.body, "(缓存)") == NULL);
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "start_point=10&end_point=30", &response));
+    CuAssertTrue(tc, strstr(response.body, "(缓存)") != NULL);
+    fixed->pos.x += 1000.0;
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "start_point=10&end_point=30", &response));
+    CuAssertTrue(tc, strstr(response.body, "(缓存)") == NULL);
+    
+    /* 空范围和未知轨迹：处理成功，由状态码告知客户端，错误信息指明哪个边界导致为空 */
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "start_time=1800000000", &response));
+    CuAssertIntEquals(tc, 400, response.status_code);
+    CuAssertTrue(tc, strstr(response.body, "\"success\":0") != NULL);
+    CuAssertTrue(tc, strstr(response.body, "start_time=1800000000") != NULL);
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "end_point=0", &response));
+    CuAssertIntEquals(tc, 400, response.status_code);
+    CuAssertTrue(tc, strstr(response.body, "end_point=0") != NULL);
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "start_point=100", &response));
+    CuAssertIntEquals(tc, 400, response.status_code);
+    CuAssertTrue(tc, strstr(response.body, "start_point=100") != NULL);
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "end_time=1600000000", &response));
+    CuAssertIntEquals(tc, 400, response.status_code);
+    CuAssertTrue(tc, strstr(response.body, "end_time=1600000000") != NULL);
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "start_point=5&end_point=6", &response));
+    CuAssertIntEquals(tc, 200, response.status_code);
+    CuAssertIntEquals(tc, 1, (int)test_json_number(response.body, "points_analyzed"));
+    CuAssertIntEquals(tc, 1, test_api_get(server, "/api/analysis", "trajectory_id=8", &response));
+    CuAssertIntEquals(tc, 404, response.status_code);
+    CuAssertTrue(tc, strstr(response.body, "\"error\":") != NULL);
+    
+    /* 经工作线程池序列化后，状态码原样到达客户端 */
+    CuAssertIntEquals(tc, 1, http_server_start(server));
+    int fd = test_http_connect(18186);
+    CuAssertTrue(tc, fd >= 0);
+    char reply[4096];
+    test_http_send(fd, "GET /api/analysis?start_time=1800000000 HTTP/1.1\r\nHost: x\r\n\r\n");
+    CuAssertTrue(tc, test_http_read_response(fd, reply, sizeof(reply)) > 0);
+    CuAssertTrue(tc, strncmp(reply, "HTTP/1.1 400 Bad Request", 24) == 0);
+    CuAssertTrue(tc, strstr(reply, "所选范围内没有轨迹点") != NULL);
+    test_http_send(fd, "GET /api/analysis?trajectory_id=8 HTTP/1.1\r\nHost: x\r\n\r\n");
+    CuAssertTrue(tc, test_http_read_response(fd, reply, sizeof(reply)) > 0);
+    CuAssertTrue(tc, strncmp(reply, "HTTP/1.1 404 Not Found", 22) == 0);
+    test_http_send(fd, "GET /api/analysis?start_point=10&end_point=30 HTTP/1.1\r\nHost: x\r\n\r\n");
+    CuAssertTrue(tc, test_http_read_response(fd, reply, sizeof(reply)) > 0);
+    CuAssertTrue(tc, strncmp(reply, "HTTP/1.1 200 OK", 15) == 0);
+    close(fd);
+    http_server_stop(server);
+    
+    /* 更换数据对象时清空缓存 */
+    http_server_set_data(server, sat_data, trajectory, geometry);
+    analysis_cache_get_stats(server->analysis_cache, &stats);
+    CuAssertIntEquals(tc, 0, stats.entries);
+    
+    http_response_reset(&response);
+    trajectory_analysis_result_free(&reference);
+    http_server_destroy(server);
+    flight_trajectory_destroy(trajectory);
+    satellite_data_destroy(sat_data);
+    aircraft_geometry_destroy(geometry);
+}
+
+void TestResponseBuffer(CuTest* tc) {
+    ResponseBuffer buffer;
+    response_buffer_init(&buffer);
+    
+    /* 追加跨越块边界：先填满尾块再分配新块 */
+    char fill[RESPONSE_CHUNK_SIZE];
+    memset(fill, 'a', sizeof(fill));
+    CuAssertIntEquals(tc, 1, response_buffer_append(&buffer, fill, 100));
+    CuAssertIntEquals(tc, 1, response_buffer_append(&buffer, fill, sizeof(fill)));
+    CuAssertIntEquals(tc, 100 + RESPONSE_CHUNK_SIZE, (int)buffer.length);
+    CuAssertIntEquals(tc, RESPONSE_CHUNK_SIZE, (int)buffer.head->length);
+    CuAssertIntEquals(tc, 100, (int)buffer.tail->length);
+    
+    /* 超过一个块的格式化输出放入单独的大块 */
+    CuAssertIntEquals(tc, 1, response_buffer_printf(&buffer, "%.*s|%d", RESPONSE_CHUNK_SIZE - 1, fill, 42));
+    size_t expected = 100 + RESPONSE_CHUNK_SIZE + (RESPONSE_CHUNK_SIZE - 1) + 3;
+    CuAssertIntEquals(tc, (int)expected, (int)buffer.length);
+    
+    /* 接管堆内存 (不复制) 和移动另一个缓冲区的块 */
+    char* owned = safe_strdup("<attached>");
+    CuAssertIntEquals(tc, 1, response_buffer_attach(&buffer, owned, strlen(owned)));
+    CuAssertTrue(tc, buffer.tail->data == owned);
+    ResponseBuffer other;
+    response_buffer_init(&other);
+    response_buffer_append_string(&other, "<spliced>");
+    response_buffer_splice(&buffer, &other);
+    CuAssertPtrEquals(tc, NULL, other.head);
+    CuAssertIntEquals(tc, 0, (int)other.length);
+    expected += 19;
+    CuAssertIntEquals(tc, (int)expected, (int)buffer.length);
+    
+    char* text = response_buffer_flatten(&buffer);
+    CuAssertPtrNotNull(tc, text);
+    CuAssertIntEquals(tc, (int)expected, (int)strlen(text));
+    CuAssertTrue(tc, strcmp(text + expected - 22, "|42<attached><spliced>") == 0);
+    char small[16];
+    CuAssertIntEquals(tc, -1, response_buffer_copy(&buffer, small, sizeof(small)));
+    
+    /* iovec覆盖全部未消费数据，消费后释放已发送的块 */
+    struct iovec iov[RESPONSE_MAX_IOV];
+    int count = response_buffer_iovec(&buffer, iov, RESPONSE_MAX_IOV);
+    CuAssertIntEquals(tc, 5, count);
+    size_t total = 0;
+    for (int i = 0; i < count; i++) total += iov[i].iov_len;
+    CuAssertIntEquals(tc, (int)expected, (int)total);
+    
+    response_buffer_consume(&buffer, RESPONSE_CHUNK_SIZE + 50);
+    CuAssertIntEquals(tc, (int)(expected - RESPONSE_CHUNK_SIZE - 50), (int)buffer.length);
+    count = response_buffer_iovec(&buffer, iov, RESPONSE_MAX_IOV);
+    CuAssertIntEquals(tc, 4, count);
+    CuAssertIntEquals(tc, 50, (int)iov[0].iov_len);
+    CuAssertTrue(tc, memcmp(iov[0].iov_base, text + RESPONSE_CHUNK_SIZE + 50, 50) == 0);
+    
+    response_buffer_consume(&buffer, buffer.length);
+    CuAssertIntEquals(tc, 0, (int)buffer.length);
+    CuAssertIntEquals(tc, 0, response_buffer_iovec(&buffer, iov, RESPONSE_MAX_IOV));
+    /* 未外接的尾块保留下来继续追加 */
+    CuAssertPtrNotNull(tc, buffer.head);
+    response_buffer_append_string(&buffer, "next");
+    CuAssertIntEquals(tc, 4, (int)buffer.length);
+    response_buffer_reset(&buffer);
+    CuAssertPtrEquals(tc, NULL, buffer.head);
+    safe_free((void**)&text);
+    
+    /* 完整轨迹响应超过单个块，经sendmsg分散写出 */
+    const int point_count = 2000;
+    FlightTrajectory* trajectory = flight_trajectory_create(point_count);
+    for (int i = 0; i < point_count; i++) {
+        TrajectoryPoint point = {0};
+        point.timestamp = 1700000000 + i;
+        point.state.timestamp = point.timestamp;
+        point.state.position.latitude = 30.0 + i * 0.001;
+        point.state.position.longitude = 110.0;
+        point.state.position.altitude = 10000.0;
+        point.state.is_valid = 1;
+        flight_trajectory_add_point(trajectory, &point);
+    }
+    
+    HttpServerConfig config = {0};
+    http_server_config_init(&config);
+    config.port = 18184;
+    config.io_threads = 1;
+    HttpServer* server = http_server_create(&config);
+    CuAssertPtrNotNull(tc, server);
+    http_server_set_data(server, NULL, trajectory, NULL);
+    CuAssertIntEquals(tc, 1, http_server_start(server));
+    
+    int fd = test_http_connect(18184);
+    CuAssertTrue(tc, fd >= 0);
+    const int response_size = 1 << 20;
+    char* response = (char*)safe_malloc(response_size);
+    CuAssertPtrNotNull(tc, response);
+    test_http_send(fd, "GET /api/trajectory?max_points=-1 HTTP/1.1\r\nHost: x\r\n\r\n");
+    int length = test_http_read_response(fd, response, response_size);
+    CuAssertTrue(tc, strncmp(response, "HTTP/1.1 200", 12) == 0);
+    const char* content_length = strstr(response, "Content-Length: ");
+    const char* body = strstr(response, "\r\n\r\n");
+    CuAssertPtrNotNull(tc, content_length);
+    CuAssertPtrNotNull(tc, body);
+    body += 4;
+    CuAssertIntEquals(tc, atoi(content_length + 16), (int)(response + length - body));
+    CuAssertTrue(tc, response + length - body > 8 * RESPONSE_CHUNK_SIZE);
+    CuAssertTrue(tc, strstr(body, "\"timestamp\":1700001999") != NULL);
+    CuAssertTrue(tc, strcmp(response + length - 2, "}}") == 0);
+    
+    /* 默认仍只返回抽样的点 */
+    test_http_send(fd, "GET /api/trajectory HTTP/1.1\r\nHost: x\r\n\r\n");
+    length = test_http_read_response(fd, response, response_size);
+    CuAssertTrue(tc, strncmp(response, "HTTP/1.1 200", 12) == 0);
+    CuAssertTrue(tc, length < 8 * RESPONSE_CHUNK_SIZE);
+    CuAssertTrue(tc, strstr(response, "\"timestamp\":1700001999") == NULL);
+    
+    close(fd);
+    safe_free((void**)&response);
+    http_server_stop(server);
+    http_server_destroy(server);
+    flight_trajectory_destroy(trajectory);
+}
+
 void TestJsonSerialize(CuTest* tc) {
     /* 测试JSON序列化 */
     Satellite satellite = {0};